@@ -84,7 +84,9 @@ namespace mtconnect {
       m_schemaVersion(GetOption<string>(options, config::SchemaVersion)),
       m_deviceXmlPath(deviceXmlPath),
       m_circularBuffer(GetOption<int>(options, config::BufferSize).value_or(17),
-                       GetOption<int>(options, config::CheckpointFrequency).value_or(1000)),
+                       GetOption<int>(options, config::CheckpointFrequency).value_or(1000),
+                       IsOptionSet(options, config::LockFreeBuffer),
+                       GetOption<int>(options, config::SequenceIndexSize).value_or(0)),
       m_pretty(IsOptionSet(options, mtconnect::configuration::Pretty))
   {
     using namespace asset;
@@ -97,6 +99,32 @@ namespace mtconnect {
     QIFDocumentWrapper::registerAsset();
     ComponentConfigurationParameters::registerAsset();
 
+    if (auto dir = GetOption<string>(options, config::PersistentBuffer); dir && !dir->empty())
+    {
+      try
+      {
+        m_circularBuffer.setStore(
+            make_unique<buffer::SegmentStore>(*dir, m_circularBuffer.getBufferSize()));
+      }
+      catch (std::filesystem::filesystem_error &e)
+      {
+        LOG(error) << "Cannot open the persistent buffer in " << *dir << ": " << e.what();
+      }
+    }
+
+    if (auto dir = GetOption<string>(options, config::TieredBuffer); dir && !dir->empty())
+    {
+      try
+      {
+        m_circularBuffer.setColdStore(make_unique<buffer::ColdStore>(
+            *dir, GetOption<int>(options, config::TieredBufferSize).value_or(16777216)));
+      }
+      catch (std::filesystem::filesystem_error &e)
+      {
+        LOG(error) << "Cannot open the tiered buffer in " << *dir << ": " << e.what();
+      }
+    }
+
     m_assetStorage = make_unique<AssetBuffer>(
         GetOption<int>(options, mtconnect::configuration::MaxAssets).value_or(1024));
     m_versionDeviceXml = IsOptionSet(options, mtconnect::configuration::VersionDeviceXml);
@@ -170,6 +198,24 @@ namespace mtconnect {
 
     if (!m_observationsInitialized)
     {
+      // Restore the observations from the last run before the data items become unavailable
+      if (m_circularBuffer.isPersistent())
+      {
+        // The restored observations are keyed by the data item indexes
+        for (auto device : m_deviceIndex)
+          m_circularBuffer.getDataItemIndexes().assign(*device);
+
+        m_circularBuffer.restore([this](const string &id) -> DataItemPtr {
+          for (auto device : m_deviceIndex)
+          {
+            const auto &items = device->getDeviceDataItems();
+            if (auto it = items.find(id); it != items.end())
+              return it->lock();
+          }
+          return nullptr;
+        });
+      }
+
       for (auto device : m_deviceIndex)
         initializeDataItems(device);
 
@@ -198,6 +244,9 @@ namespace mtconnect {
 
   Agent::~Agent()
   {
+    for (auto metrics : m_metrics)
+      metrics->stop();
+    m_metrics.clear();
     m_xmlParser.reset();
     m_sinks.clear();
     m_sources.clear();
@@ -229,6 +278,9 @@ namespace mtconnect {
         m_loopback->receive(d, "AVAILABLE"s);
       }
 
+      for (auto metrics : m_metrics)
+        metrics->start();
+
       // Start all the sources
       for (auto source : m_sources)
         source->start();
@@ -261,17 +313,17 @@ namespace mtconnect {
 
     // Signal all observers
     LOG(info) << "Signaling observers to close sessions";
-    for (auto di : m_dataItemMap)
-    {
-      auto ldi = di.second.lock();
-      if (ldi)
-        ldi->signalObservers(0);
-    }
+    m_circularBuffer.getSubscriptions().signalAll(0);
 
     LOG(info) << "Shutting down sinks";
     for (auto sink : m_sinks)
       sink->stop();
 
+    for (auto metrics : m_metrics)
+      metrics->stop();
+
+    m_circularBuffer.flush();
+
     LOG(info) << "Shutting down completed";
 
     m_started = false;
@@ -603,6 +655,13 @@ namespace mtconnect {
         LOG(info) << "Device " << *uuid << " updating circular buffer";
         m_circularBuffer.updateDataItems(m_dataItemMap);
 
+        // The indexes of the removed data items are reused by new data items
+        for (const auto &id : skip)
+        {
+          if (m_dataItemMap.count(id) == 0)
+            m_circularBuffer.getDataItemIndexes().release(id);
+        }
+
         if (m_intSchemaVersion > SCHEMA_VERSION(2, 2))
           device->addHash();
 
@@ -791,6 +850,24 @@ namespace mtconnect {
         LOG(fatal) << "Error creating the agent device: " << e->what();
       throw EntityError("Cannot create AgentDevice");
     }
+
+    // Publish the hit and miss rates of the REST sink chunk caches
+    for (auto sink : m_sinks)
+    {
+      if (auto rest = dynamic_pointer_cast<sink::rest_sink::RestService>(sink))
+      {
+        for (auto &[prefix, cache] : rest->getChunkCaches())
+        {
+          m_agentDevice->addChunkCache(prefix);
+          auto contract = m_pipelineContext->m_contract.get();
+          m_metrics.emplace_back(make_shared<pipeline::ComputeMetrics>(
+              m_strand, contract, prefix + "_hit_rate", cache->getHits()));
+          m_metrics.emplace_back(make_shared<pipeline::ComputeMetrics>(
+              m_strand, contract, prefix + "_miss_rate", cache->getMisses()));
+        }
+      }
+    }
+
     addDevice(m_agentDevice);
   }
 
@@ -909,13 +986,16 @@ namespace mtconnect {
   {
     NAMED_SCOPE("Agent::initializeDataItems");
 
-    // Initialize the id mapping for the devices and set all data items to UNAVAILABLE
+    // Initialize the id mapping for the devices and set all data items to UNAVAILABLE. The ids
+    // are unique by now, so the data items are given the indexes of their ids.
+    auto &indexes = m_circularBuffer.getDataItemIndexes();
     for (auto item : device->getDeviceDataItems())
     {
       if (item.expired())
         continue;
 
       auto d = item.lock();
+      indexes.assign(*d);
       if ((!skip || skip->count(d->getId()) > 0) && m_dataItemMap.count(d->getId()) > 0)
       {
         auto di = m_dataItemMap[d->getId()].lock();
@@ -1049,9 +1129,13 @@ namespace mtconnect {
   {
     NAMED_SCOPE("Agent::loadCachedProbe");
 
-    // Reload the document for path resolution
-    auto xmlPrinter = dynamic_cast<printer::XmlPrinter *>(m_printers["xml"].get());
-    m_xmlParser->loadDocument(xmlPrinter->printProbe(0, 0, 0, 0, 0, getDevices()));
+    // Paths are resolved on the device model. The document is only reloaded for paths the
+    // path filter does not support.
+    m_pathFilters.modelChanged(getDevices());
+    {
+      std::lock_guard<std::mutex> lock(m_probeDocumentMutex);
+      m_probeDocumentLoaded = false;
+    }
 
     for (auto &printer : m_printers)
       printer.second->setModelChangeTime(getCurrentTime(GMT_UV_SEC));
@@ -1354,6 +1438,24 @@ namespace mtconnect {
     return dataPath;
   }
 
+  void Agent::getDataItemsForPath(const std::string &path, FilterSet &filter)
+  {
+    if (m_pathFilters.getDataItems(path, filter))
+      return;
+
+    {
+      std::lock_guard<std::mutex> lock(m_probeDocumentMutex);
+      if (!m_probeDocumentLoaded)
+      {
+        auto xmlPrinter = dynamic_cast<printer::XmlPrinter *>(m_printers["xml"].get());
+        m_xmlParser->loadDocument(xmlPrinter->printProbe(0, 0, 0, 0, 0, getDevices()));
+        m_probeDocumentLoaded = true;
+      }
+    }
+
+    m_xmlParser->getDataItems(filter, path);
+  }
+
   void AgentPipelineContract::deliverAssetCommand(entity::EntityPtr command)
   {
     const std::string &cmd = command->getValue<string>();
@@ -30,6 +30,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <string>
@@ -45,7 +46,9 @@
 #include "mtconnect/configuration/service.hpp"
 #include "mtconnect/device_model/agent_device.hpp"
 #include "mtconnect/device_model/device.hpp"
+#include "mtconnect/device_model/path_filter.hpp"
 #include "mtconnect/parser/xml_parser.hpp"
+#include "mtconnect/pipeline/deliver.hpp"
 #include "mtconnect/pipeline/pipeline.hpp"
 #include "mtconnect/pipeline/pipeline_contract.hpp"
 #include "mtconnect/printer/printer.hpp"
@@ -430,6 +433,16 @@ namespace mtconnect {
     std::string devicesAndPath(const std::optional<std::string> &path, const DevicePtr device,
                                const std::optional<std::string> &deviceType = std::nullopt) const;
 
+    /// @brief Get the data items selected by an XPath
+    ///
+    /// The path is evaluated on the device model and the result is cached until the model
+    /// changes. Paths that are not supported by `device_model::PathFilter` are evaluated by the
+    /// XML parser on the probe document, which is printed and parsed when first needed.
+    ///
+    /// @param[in] path the path from `devicesAndPath()`
+    /// @param[out] filter the ids of the data items
+    void getDataItemsForPath(const std::string &path, FilterSet &filter);
+
     /// @brief Creates unique ids for the device model and maps to the originals
     ///
     /// Also updates the agents data item map by adding the new ids. Duplicate original
@@ -459,10 +472,15 @@ namespace mtconnect {
 
     observation::ObservationPtr getLatest(const std::string &id)
     {
-      return m_circularBuffer.getLatest().getObservation(id);
+      if (auto di = getDataItemById(id))
+        return getLatest(di);
+      return nullptr;
     }
 
-    observation::ObservationPtr getLatest(const DataItemPtr &di) { return getLatest(di->getId()); }
+    observation::ObservationPtr getLatest(const DataItemPtr &di)
+    {
+      return m_circularBuffer.getLatest().getObservation(di->getIndex());
+    }
 
   protected:
     ConfigOptions m_options;
@@ -484,11 +502,17 @@ namespace mtconnect {
     source::SourceList m_sources;
     sink::SinkList m_sinks;
 
+    // Metrics for the agent device
+    std::list<std::shared_ptr<pipeline::ComputeMetrics>> m_metrics;
+
     // Pipeline
     pipeline::PipelineContextPtr m_pipelineContext;
 
     // Pointer to the configuration file for node access
     std::unique_ptr<parser::XmlParser> m_xmlParser;
+    std::mutex m_probeDocumentMutex;
+    bool m_probeDocumentLoaded {false};
+    device_model::PathFilterCache m_pathFilters;
     PrinterMap m_printers;
 
     // Agent Device
@@ -650,8 +674,7 @@ namespace mtconnect {
                              const std::optional<std::string> &deviceType) const override
     {
       std::string dataPath = m_agent->devicesAndPath(path, device, deviceType);
-      const auto &parser = m_agent->getXmlParser();
-      parser->getDataItems(filter, dataPath);
+      m_agent->getDataItemsForPath(dataPath, filter);
     }
 
     buffer::CircularBuffer &getCircularBuffer() override { return m_agent->getCircularBuffer(); }
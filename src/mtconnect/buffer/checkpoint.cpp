@@ -24,16 +24,14 @@ using namespace std;
 namespace mtconnect {
   using namespace observation;
   using namespace entity;
+  using namespace device_model::data_item;
   namespace buffer {
-    Checkpoint::Checkpoint(const Checkpoint &checkpoint, const FilterSetOpt &filterSet)
+    Checkpoint::Checkpoint(const Checkpoint &checkpoint, const FilterBitsOpt &filter)
     {
-      FilterSetOpt filter;
-      if (!filterSet && checkpoint.hasFilter())
-        filter = checkpoint.m_filter;
+      if (!filter && checkpoint.hasFilter())
+        copy(checkpoint, checkpoint.m_filter);
       else
-        filter = filterSet;
-
-      copy(checkpoint, filter);
+        copy(checkpoint, filter);
     }
 
     void Checkpoint::clear() { m_observations.clear(); }
@@ -124,54 +122,61 @@ namespace mtconnect {
 
     void Checkpoint::addObservation(ObservationPtr obs)
     {
-      if (obs->isOrphan() || (m_filter && m_filter->count(obs->getDataItem()->getId()) == 0))
-      {
+      if (obs->isOrphan())
         return;
-      }
 
       auto item = obs->getDataItem();
-      const auto &id = item->getId();
-      auto old = m_observations.find(id);
+      if (m_filter && !m_filter->test(item->getIndex()))
+        return;
 
-      if (old != m_observations.end())
+      // Only the nodes on the path to this entry are copied if they are shared
+      auto &old = m_observations[item->getIndex()];
+      if (old)
       {
         if (item->isCondition())
         {
           auto cond = dynamic_pointer_cast<Condition>(obs);
           // Chain event only if it is normal or unavailable and the
           // previous condition was not normal or unavailable
-          addObservation(cond, std::forward<ObservationPtr>(old->second));
+          addObservation(cond, std::forward<ObservationPtr>(old));
         }
         else if (item->isDataSet())
         {
           auto set = dynamic_pointer_cast<DataSetEvent>(obs);
-          addObservation(set, std::forward<ObservationPtr>(old->second));
+          addObservation(set, std::forward<ObservationPtr>(old));
         }
         else
         {
-          old->second = obs;
+          old = obs;
         }
       }
       else
       {
-        m_observations[id] = dynamic_pointer_cast<Observation>(obs->getptr());
+        old = dynamic_pointer_cast<Observation>(obs->getptr());
       }
     }
 
-    void Checkpoint::copy(const Checkpoint &checkpoint, const FilterSetOpt &filterSet)
+    void Checkpoint::copy(const Checkpoint &checkpoint, const FilterBitsOpt &filter)
     {
       clear();
 
-      if (filterSet)
+      if (filter && checkpoint.m_filter)
       {
-        m_filter = filterSet;
+        // Entries hidden by the filter of the other checkpoint must stay hidden
+        m_filter.emplace();
+        for (auto index : filter->getIndexes())
+        {
+          if (checkpoint.m_filter->test(index))
+            m_filter->set(index);
+        }
       }
-
-      for (const auto &event : checkpoint.m_observations)
+      else
       {
-        if (!m_filter || m_filter->count(event.first) > 0)
-          m_observations[event.first] = dynamic_pointer_cast<Observation>(event.second->getptr());
+        m_filter = filter;
       }
+
+      // The entries are shared until either checkpoint changes them
+      m_observations = checkpoint.m_observations;
     }
 
     static inline void addToList(ObservationList &list, ObservationPtr obs)
@@ -189,55 +194,48 @@ namespace mtconnect {
       }
     }
 
-    void Checkpoint::getObservations(ObservationList &list, const FilterSetOpt &filterSet) const
+    void Checkpoint::getObservations(ObservationList &list, const FilterBitsOpt &filter) const
     {
-      if (filterSet)
-      {
-        for (const auto &id : *filterSet)
-        {
-          auto obs = m_observations.find(id);
-          if (obs != m_observations.end() && !obs->second->isOrphan())
-          {
-            addToList(list, obs->second);
-          }
-        }
-      }
-      else
+      if (!filter && !m_filter)
       {
         for (const auto &obs : m_observations)
         {
           if (!obs.second->isOrphan())
-          {
             addToList(list, obs.second);
-          }
         }
+        return;
+      }
+
+      // Look up the entries of the set bits instead of testing every entry
+      const auto &bits = filter ? *filter : *m_filter;
+      const auto *other = filter && m_filter ? &*m_filter : nullptr;
+      for (auto index : bits.getIndexes())
+      {
+        if (other && !other->test(index))
+          continue;
+
+        auto obs = m_observations.find(index);
+        if (obs != nullptr && !(*obs)->isOrphan())
+          addToList(list, *obs);
       }
     }
 
-    void Checkpoint::filter(const FilterSet &filterSet)
+    void Checkpoint::filter(const FilterBits &filter)
     {
-      m_filter = filterSet;
+      m_filter = filter;
 
       if (m_filter->empty())
         return;
 
-      auto it = m_observations.begin();
-      while (it != m_observations.end())
+      std::vector<size_t> removed;
+      for (const auto &item : m_observations)
       {
-        if (!m_filter->count(it->first))
-        {
-#ifdef _WINDOWS
-          it = m_observations.erase(it);
-#else
-          auto pos = it++;
-          m_observations.erase(pos);
-#endif
-        }
-        else
-        {
-          ++it;
-        }
+        if (!m_filter->test(item.first))
+          removed.push_back(item.first);
       }
+
+      for (auto index : removed)
+        m_observations.erase(index);
     }
 
     ObservationPtr Checkpoint::dataSetDifference(const ObservationPtr &obs,
@@ -23,13 +23,29 @@
 #include <unordered_map>
 #include <vector>
 
+#include "data_item_indexes.hpp"
+#include "filter_bits.hpp"
 #include "mtconnect/config.hpp"
 #include "mtconnect/observation/observation.hpp"
 #include "mtconnect/utilities.hpp"
+#include "persistent_map.hpp"
 
 /// @brief Internal storage of observations
 namespace mtconnect::buffer {
+  /// @brief The data item indexes are dense, so they are used as their own hash
+  struct IndexHash
+  {
+    size_t operator()(size_t index) const { return index; }
+  };
+
+  /// @brief Map of data item indexes to the latest observation, shared between checkpoints
+  using ObservationMap = PersistentMap<size_t, observation::ObservationPtr, IndexHash>;
+
   /// @brief A point in time snapshot of all data items with a optional filter
+  ///
+  /// The observations are kept in a persistent map, so copying a checkpoint shares all the
+  /// entries with the original and only the entries changed afterwards are copied. The filter is
+  /// applied when the observations are read and added.
   class AGENT_LIB_API Checkpoint
   {
   public:
@@ -37,9 +53,12 @@ namespace mtconnect::buffer {
     Checkpoint() = default;
 
     /// @brief Copy constructor for a checkpoint
+    ///
+    /// The copy shares the observations with the checkpoint and is O(1).
+    ///
     /// @param[in] checkpoint the previous checkpoint
-    /// @param[in] filterSet an optional set of data item ids for filtering
-    Checkpoint(const Checkpoint &checkpoint, const FilterSetOpt &filterSet = std::nullopt);
+    /// @param[in] filter an optional set of data item indexes for filtering
+    Checkpoint(const Checkpoint &checkpoint, const FilterBitsOpt &filter = std::nullopt);
     ~Checkpoint();
 
     /// @brief Add an observation to the checkpoint
@@ -64,12 +83,11 @@ namespace mtconnect::buffer {
       using namespace std;
 
       auto di = obs->getDataItem();
-      const auto &id = di->getId();
-      auto old = m_observations.find(id);
+      auto old = m_observations.find(di->getIndex());
 
-      if (old != m_observations.end())
+      if (old != nullptr)
       {
-        auto &oldObs = old->second;
+        auto &oldObs = *old;
         // Filter out unavailable duplicates, only allow through changed
         // state. If both are unavailable, disregard.
         if (obs->isUnavailable() != oldObs->isUnavailable())
@@ -147,24 +165,25 @@ namespace mtconnect::buffer {
 
     /// @brief copy another checkpoint to this checkpoint
     /// @param[in] checkpoint a checkpoint to copy
-    /// @param[in] filterSet an optional filter set
-    void copy(Checkpoint const &checkpoint, const FilterSetOpt &filterSet = std::nullopt);
+    /// @param[in] filter an optional set of data item indexes
+    void copy(Checkpoint const &checkpoint, const FilterBitsOpt &filter = std::nullopt);
 
     /// @brief clear the contents of this checkpoint
     void clear();
 
     /// @brief Add a filter to the checkpoint
-    void filter(const FilterSet &filterSet);
+    /// @param[in] filter the data item indexes to keep
+    void filter(const FilterBits &filter);
     /// @brief does this checkpoint have a filter?
     /// @return `true` if a checkpoint exists
     bool hasFilter() const { return bool(m_filter); }
 
-    /// @brief get a map of data item id to observation shared pointers
-    /// @return a map of ids to observations
-    const std::unordered_map<std::string, observation::ObservationPtr> &getObservations() const
-    {
-      return m_observations;
-    }
+    /// @brief get a map of data item index to observation shared pointers
+    ///
+    /// The map is not filtered, copying the map is O(1).
+    ///
+    /// @return a map of data item indexes to observations
+    const ObservationMap &getObservations() const { return m_observations; }
 
     /// @brief updates the data item reference of an observation in a checkpoint
     ///
@@ -174,46 +193,58 @@ namespace mtconnect::buffer {
     /// @param[in] diMap the map of data ids to data item pointers
     void updateDataItems(std::unordered_map<std::string, WeakDataItemPtr> &diMap)
     {
-      auto iter = m_observations.begin();
-      while (iter != m_observations.end())
+      std::vector<size_t> orphans;
+      for (const auto &item : m_observations)
       {
-        auto item = *iter;
         if (item.second->isOrphan())
-        {
-          iter = m_observations.erase(iter);
-        }
+          orphans.push_back(item.first);
         else
-        {
           item.second->updateDataItem(diMap);
-          iter++;
-        }
       }
+
+      for (const auto &id : orphans)
+        m_observations.erase(id);
     }
 
     /// @brief Get a list of observations from the checkpoint
     /// @param[in,out] list the list to add the observations to
-    /// @param[in] filter an optional filter for the observations
+    /// @param[in] filter an optional set of data item indexes for the observations
     void getObservations(observation::ObservationList &list,
-                         const FilterSetOpt &filter = std::nullopt) const;
+                         const FilterBitsOpt &filter = std::nullopt) const;
 
     /// @brief Get an observation for a data item id
     /// @param[in] id the data item id
+    /// @param[in] indexes the indexes of the data item ids
     /// @return shared pointer to the observation if it exists
-    observation::ObservationPtr getObservation(const std::string &id) const
+    observation::ObservationPtr getObservation(const std::string &id,
+                                               const DataItemIndexes &indexes) const
     {
-      auto pos = m_observations.find(id);
-      if (pos != m_observations.end())
-        return pos->second;
+      if (auto index = indexes.find(id))
+        return getObservation(*index);
       return nullptr;
     }
 
+    /// @brief Get an observation for a data item index
+    /// @param[in] index the data item index
+    /// @return shared pointer to the observation if it exists
+    observation::ObservationPtr getObservation(size_t index) const
+    {
+      if (m_filter && !m_filter->test(index))
+        return nullptr;
+
+      auto pos = m_observations.find(index);
+      if (pos == nullptr)
+        return nullptr;
+      return *pos;
+    }
+
   protected:
     void addObservation(observation::ConditionPtr event, observation::ObservationPtr &&old);
     void addObservation(const observation::DataSetEventPtr event,
                         observation::ObservationPtr &&old);
 
   protected:
-    std::unordered_map<std::string, observation::ObservationPtr> m_observations;
-    FilterSetOpt m_filter;
+    ObservationMap m_observations;
+    FilterBitsOpt m_filter;
   };
 }  // namespace mtconnect::buffer
@@ -19,36 +19,74 @@
 
 #include <boost/circular_buffer.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <vector>
 
 #include "checkpoint.hpp"
+#include "cold_store.hpp"
+#include "data_item_indexes.hpp"
+#include "filter_bits.hpp"
+#include "observation_codec.hpp"
+#include "segment_store.hpp"
+#include "sequence_index.hpp"
 #include "mtconnect/config.hpp"
 #include "mtconnect/entity/requirement.hpp"
 #include "mtconnect/logging.hpp"
 #include "mtconnect/observation/observation.hpp"
+#include "mtconnect/observation/subscription_engine.hpp"
 #include "mtconnect/utilities.hpp"
 
 namespace mtconnect::buffer {
   using SequenceNumber_t = uint64_t;
 
   /// @brief Limited epherimal in-memory storage of observations and checkpoint management
+  ///
+  /// The observations are kept in a power of two ring of slots indexed by the low bits of the
+  /// sequence number. Every slot is stamped with the sequence number of the observation it holds.
+  /// There is a single writer serialized by the buffer mutex. When the buffer is lock free, readers
+  /// do not take the mutex: the slot stamp is checked before and after the observation is loaded
+  /// (a per-slot sequence lock) and evicted or partially written slots are skipped.
+  ///
+  /// The data item index of each slot is also kept in a parallel compact array so filtered reads
+  /// can scan for matching slots without touching the observations. An optional sequence index
+  /// keeps the recent sequence numbers of each data item so requests for a few data items do not
+  /// scan the buffer at all.
+  ///
+  /// When the buffer has a segment store every observation is also appended to the store, and
+  /// the observations, checkpoints, and instance id are restored from the store when the agent
+  /// starts. When the buffer has a cold store the observations evicted from the ring are moved
+  /// to it, and samples and checkpoints before the first sequence are read from it.
   class AGENT_LIB_API CircularBuffer
   {
   public:
     /// @brief Create a circular buffer
     /// @param bufferSize the size of the circular buffer
     /// @param checkpointFreq how often to create checkpoints
-    CircularBuffer(unsigned int bufferSize, int checkpointFreq)
-      : m_sequence(1ull),
-        m_firstSequence(m_sequence),
+    /// @param lockFree readers of the sliding buffer do not take the buffer mutex
+    /// @param sequenceIndexSize the number of sequence numbers indexed for each data item, `0`
+    /// disables the sequence index
+    CircularBuffer(unsigned int bufferSize, int checkpointFreq, bool lockFree = false,
+                   size_t sequenceIndexSize = 0)
+      : m_lockFree(lockFree),
+        m_sequence(1ull),
+        m_firstSequence(1ull),
         m_slidingBufferSize(1 << bufferSize),
-        m_slidingBuffer(m_slidingBufferSize),
+        m_mask(m_slidingBufferSize - 1),
+        m_slots(std::make_unique<Slot[]>(m_slidingBufferSize)),
+        m_indexes(std::make_unique<FilterBits::Index[]>(m_slidingBufferSize)),
         m_checkpointFreq(checkpointFreq),
         m_checkpointCount(m_slidingBufferSize / checkpointFreq),
         m_checkpoints(m_checkpointCount)
-    {}
+    {
+      if (sequenceIndexSize > 0)
+        m_sequenceIndex = std::make_unique<SequenceIndex>(sequenceIndexSize);
+    }
 
     ~CircularBuffer() { m_checkpoints.clear(); }
 
@@ -57,11 +95,11 @@ namespace mtconnect::buffer {
     /// @return shared pointer to an obseration at sequence
     observation::ObservationPtr getFromBuffer(uint64_t seq) const
     {
-      auto off = seq - m_firstSequence;
-      if (off < m_slidingBufferSize)
-        return m_slidingBuffer[off];
-      else
+      if (seq < m_firstSequence.load(std::memory_order_acquire) ||
+          seq >= m_sequence.load(std::memory_order_acquire))
         return observation::ObservationPtr();
+      else
+        return readSlot(seq);
     }
 
     /// @brief get index into underlying circular buffer at a sequence number
@@ -71,22 +109,195 @@ namespace mtconnect::buffer {
 
     /// @brief Get the current sequence number
     /// @return sequence number one greater than last observation in circular buffer
-    SequenceNumber_t getSequence() const { return m_sequence; }
+    SequenceNumber_t getSequence() const { return m_sequence.load(std::memory_order_acquire); }
     /// @brief get the buffer size
     /// @return the buffer size
     unsigned int getBufferSize() const { return m_slidingBufferSize; }
 
     /// @brief get the first sequence number in the circular buffer
     /// @return first sequence
-    SequenceNumber_t getFirstSequence() const { return m_firstSequence; }
+    SequenceNumber_t getFirstSequence() const
+    {
+      return m_firstSequence.load(std::memory_order_acquire);
+    }
+
+    /// @brief get the oldest sequence number that can be read
+    /// @return the first sequence in the cold store if there is one, otherwise the first sequence
+    SequenceNumber_t getOldestSequence() const
+    {
+      auto first = m_firstSequence.load(std::memory_order_acquire);
+      if (m_coldStore)
+      {
+        auto oldest = m_coldStore->getFirstSequence();
+        if (oldest != 0 && oldest < first)
+          return oldest;
+      }
+      return first;
+    }
+
+    /// @brief is the buffer read without locking
+    /// @return `true` if the readers do not need to hold the buffer mutex
+    bool isLockFree() const { return m_lockFree; }
+    /// @brief does the buffer have a sequence index
+    /// @return `true` if the sequence numbers of each data item are indexed
+    bool hasSequenceIndex() const { return bool(m_sequenceIndex); }
+    /// @brief get the subscriptions of the change observers waiting for new observations
+    /// @return the subscription engine notified when an observation is added
+    observation::SubscriptionEngine &getSubscriptions() { return m_subscriptions; }
+    /// @brief get the dense indexes of the data item ids
+    /// @return the indexes the observations and checkpoints are keyed by
+    DataItemIndexes &getDataItemIndexes() { return m_dataItemIndexes; }
+    /// @brief get the dense indexes of the data item ids
+    /// @return the indexes the observations and checkpoints are keyed by
+    const DataItemIndexes &getDataItemIndexes() const { return m_dataItemIndexes; }
+    /// @brief convert a filter set to the data item indexes of its ids
+    /// @param[in] filterSet optional filter set of data item ids
+    /// @return the filter as data item indexes if there is a filter set
+    FilterBitsOpt getFilterBits(const FilterSetOpt &filterSet) const
+    {
+      FilterBitsOpt bits;
+      if (filterSet)
+        bits.emplace(*filterSet, m_dataItemIndexes);
+      return bits;
+    }
+
+    /// @name Persistence methods
+    ///@{
+
+    /// @brief keep the observations in a segment store
+    ///
+    /// The instance id is taken from the store if it has observations, otherwise a new instance
+    /// id is saved in the store.
+    ///
+    /// @param[in] store the segment store
+    void setStore(std::unique_ptr<SegmentStore> &&store)
+    {
+      std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
+      m_store = std::move(store);
+      if (!m_store)
+      {
+        m_instanceId.reset();
+        return;
+      }
+
+      if (!m_store->empty())
+        m_instanceId = m_store->getInstanceId();
+      if (!m_instanceId)
+      {
+        m_instanceId = getCurrentTimeInSec();
+        m_store->setInstanceId(*m_instanceId);
+      }
+    }
+    /// @brief is the buffer kept in a segment store
+    /// @return `true` if there is a store
+    bool isPersistent() const { return bool(m_store); }
+    /// @brief get the instance id preserved by the segment store
+    /// @return the instance id if the buffer is persistent
+    std::optional<uint64_t> getInstanceId() const { return m_instanceId; }
+
+    /// @brief restore the observations from the segment store
+    ///
+    /// Only restores into an empty buffer. The observations keep their sequence numbers and the
+    /// checkpoints are rebuilt as they are added. Observations of data items that are no longer
+    /// in the device model are skipped.
+    ///
+    /// @param[in] lookup finds a data item by id
+    /// @return the number of observations restored
+    size_t restore(const ObservationCodec::DataItemLookup &lookup)
+    {
+      std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
+      std::unique_lock<std::shared_mutex> cpLock(m_checkpointLock);
+
+      if (!m_store || m_sequence != 1)
+        return 0;
+
+      size_t count = 0;
+      bool first = true;
+      m_store->read([&](const char *data, size_t size, bool snapshot) {
+        SequenceNumber_t seq;
+        observation::ObservationPtr obs;
+        try
+        {
+          obs = ObservationCodec::decode(data, size, lookup, seq);
+        }
+        catch (std::out_of_range &e)
+        {
+          LOG(warning) << "Cannot restore observation: " << e.what();
+          return;
+        }
+
+        if (snapshot)
+        {
+          // The state before the oldest observation in the store
+          if (obs)
+          {
+            m_first.addObservation(obs);
+            m_latest.addObservation(obs);
+          }
+          return;
+        }
+
+        if (first)
+        {
+          // The first checkpoint covers the first sequence, the incremental checkpoints follow
+          m_firstSequence.store(seq, std::memory_order_release);
+          if (obs)
+          {
+            m_first.addObservation(obs);
+            m_latest.addObservation(obs);
+            writeSlot(seq, obs);
+          }
+          first = false;
+        }
+        else if (seq < m_sequence)
+        {
+          return;
+        }
+        else
+        {
+          append(seq, obs);
+        }
+
+        m_sequence.store(seq + 1, std::memory_order_release);
+        if (obs)
+          count++;
+      });
+
+      LOG(info) << "Restored " << count << " observations, the next sequence is "
+               << m_sequence.load();
+      return count;
+    }
+
+    /// @brief write the buffered observations to the segment store
+    void flush()
+    {
+      std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
+      if (m_store)
+        m_store->flush();
+    }
+
+    /// @brief move the observations evicted from the ring to a cold store
+    /// @param[in] store the cold store
+    void setColdStore(std::unique_ptr<ColdStore> &&store)
+    {
+      std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
+      std::unique_lock<std::shared_mutex> cpLock(m_checkpointLock);
+      m_coldStore = std::move(store);
+    }
+    /// @brief does the buffer have a cold store
+    /// @return `true` if evicted observations are kept in a cold store
+    bool hasColdStore() const { return bool(m_coldStore); }
+    ///@}
 
     /// @brief update the data item references when device model changes
     /// @param diMap the map of data item ids to new data item entities
     void updateDataItems(std::unordered_map<std::string, WeakDataItemPtr> &diMap)
     {
-      for (auto &o : m_slidingBuffer)
+      std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
+      for (auto seq = m_firstSequence.load(); seq < m_sequence; seq++)
       {
-        if (o->isOrphan())
+        auto o = readSlot(seq);
+        if (!o || o->isOrphan())
         {
           continue;
         }
@@ -94,8 +305,11 @@ namespace mtconnect::buffer {
       }
 
       // checkpoints will remove orphans from its observations
+      std::unique_lock<std::shared_mutex> cpLock(m_checkpointLock);
       m_first.updateDataItems(diMap);
       m_latest.updateDataItems(diMap);
+      if (m_coldStore)
+        m_coldStore->updateDataItems(diMap);
 
       for (auto &cp : m_checkpoints)
       {
@@ -105,14 +319,50 @@ namespace mtconnect::buffer {
 
     /// @brief Set the sequence number
     ///
-    /// recomputes the first sequence if the sequence is larger than the circular buffer size.
+    /// recomputes the first sequence if the sequence is larger than the circular buffer size. The
+    /// observations in the buffer are moved so they are the last observations before the new
+    /// sequence number.
     ///
     /// @param seq the new sequence number
     void setSequence(SequenceNumber_t seq)
     {
-      m_sequence = seq;
+      std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
+      std::unique_lock<std::shared_mutex> cpLock(m_checkpointLock);
+
+      std::vector<observation::ObservationPtr> observations;
+      for (auto s = m_firstSequence.load(); s < m_sequence; s++)
+      {
+        observations.emplace_back(readSlot(s));
+        clearSlot(s);
+      }
+
+      if (m_sequenceIndex)
+        m_sequenceIndex->clear();
+      if (m_coldStore)
+        m_coldStore->clear();
+
+      auto first = m_firstSequence.load();
       if (seq > m_slidingBufferSize)
-        m_firstSequence = seq - m_slidingBuffer.size();
+        first = seq - observations.size();
+
+      if (m_store)
+      {
+        m_store->reset();
+        m_store->startSegment(first, snapshot(m_first));
+      }
+
+      for (size_t i = 0; i < observations.size() && first + i < seq; i++)
+      {
+        if (observations[i])
+        {
+          writeSlot(first + i, observations[i]);
+          if (m_store)
+            m_store->append(first + i, observations[i]);
+        }
+      }
+
+      m_firstSequence.store(first, std::memory_order_release);
+      m_sequence.store(seq, std::memory_order_release);
     }
 
     /// @brief Add an observation to the circular buffer
@@ -128,34 +378,34 @@ namespace mtconnect::buffer {
 
       std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
       auto dataItem = observation->getDataItem();
-      auto seq = m_sequence;
+      auto seq = m_sequence.load();
 
       observation->setSequence(seq);
-      m_slidingBuffer.push_back(observation);
-      m_latest.addObservation(observation);
 
-      // Special case for the first event in the series to prime the first checkpoint.
-      if (seq == 1)
-        m_first.addObservation(observation);
-      else if (m_slidingBuffer.full())
       {
-        observation::ObservationPtr old = m_slidingBuffer.front();
-        m_first.addObservation(old);
-        if (old->getSequence() > 1)
-          m_firstSequence++;
-        // assert(old->getSequence() == m_firstSequence);
-      }
+        // Lock free readers of the checkpoints hold the shared lock
+        std::unique_lock<std::shared_mutex> cpLock(m_checkpointLock, std::defer_lock);
+        if (m_lockFree)
+          cpLock.lock();
 
-      // Checkpoint management
-      if (m_checkpointCount > 0 && (seq % m_checkpointFreq) == 0)
-      {
-        // Copy the checkpoint from the current into the slot
-        m_checkpoints.push_back(std::make_unique<Checkpoint>(m_latest));
+        // Special case for the first event in the series to prime the first checkpoint.
+        if (seq == 1)
+          m_first.addObservation(observation);
+
+        // Segments start with the state before their first observation
+        if (m_store && m_store->needsSegment())
+          m_store->startSegment(seq, snapshot(m_latest));
+
+        append(seq, observation);
       }
 
-      dataItem->signalObservers(m_sequence);
+      if (m_store)
+        m_store->append(seq, observation);
+
+      // Publish the observation before the observers are signaled
+      m_sequence.store(seq + 1, std::memory_order_release);
 
-      m_sequence++;
+      m_subscriptions.notify(dataItem->getIndex(), seq);
 
       return seq;
     }
@@ -164,9 +414,15 @@ namespace mtconnect::buffer {
     ///@{
 
     /// @brief Get the checkpoint at the end of the circular buffer
+    ///
+    /// The caller must hold a shared lock on the buffer.
+    ///
     /// @return reference to the checkpoint
     const Checkpoint &getLatest() const { return m_latest; }
     /// @brief Get the checkpoint at the beginning of the circular buffer
+    ///
+    /// The caller must hold a shared lock on the buffer.
+    ///
     /// @return reference to the checkpoint
     const Checkpoint &getFirst() const { return m_first; }
     auto getCheckpointFreq() const { return m_checkpointFreq; }
@@ -188,45 +444,53 @@ namespace mtconnect::buffer {
     std::unique_ptr<Checkpoint> getCheckpointAt(SequenceNumber_t at,
                                                 const FilterSetOpt &filterSet) const
     {
-      std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
+      auto bits = getFilterBits(filterSet);
+
+      // Checkpoints before the ring are rebuilt from the cold store without holding the buffer
+      if (m_coldStore && at < m_firstSequence.load(std::memory_order_acquire))
+      {
+        if (auto check = m_coldStore->getCheckpointAt(at, bits))
+          return check;
+      }
+
+      std::shared_lock<const CircularBuffer> lock(*this);
 
       // Compute the closest checkpoint. If the checkpoint is after the
       // first checkpoint and before the next incremental checkpoint,
       // use first.
-      auto fi = (m_firstSequence / m_checkpointFreq);
+      SequenceNumber_t firstSequence = m_firstSequence;
+      auto fi = (firstSequence / m_checkpointFreq);
       auto in = (at / m_checkpointFreq);
       int dt = int(in - fi) - 1;
 
       std::unique_ptr<Checkpoint> check;
-      decltype(m_slidingBuffer.cbegin()) iter;
-      decltype(m_slidingBuffer.cend()) end;
+      SequenceNumber_t from;
 
       if (dt < 0)
       {
-        check = std::make_unique<Checkpoint>(m_first, filterSet);
-        if (at == m_firstSequence)
+        check = std::make_unique<Checkpoint>(m_first, bits);
+        if (at == firstSequence)
           return check;
 
-        iter = m_slidingBuffer.cbegin();
-        end = iter + (at - m_firstSequence) + 1;
+        from = firstSequence;
       }
       else
       {
-        check = std::make_unique<Checkpoint>(*m_checkpoints[dt], filterSet);
+        check = std::make_unique<Checkpoint>(*m_checkpoints[dt], bits);
 
         auto cps = in * m_checkpointFreq;
         if (at == cps)
           return check;
 
-        auto ind = cps - m_firstSequence;
-        iter = m_slidingBuffer.cbegin() + ind;
-        end = iter + (at - cps) + 1;
+        from = cps;
       }
 
       // Roll forward from the checkpoint.
-      while (iter != end)
+      for (auto seq = from; seq <= at; seq++)
       {
-        check->addObservation(*iter++);
+        auto obs = readSlot(seq);
+        if (obs)
+          check->addObservation(obs);
       }
 
       return check;
@@ -234,6 +498,9 @@ namespace mtconnect::buffer {
     ///@}
 
     /// @brief Get a list of observations from the circular buffer
+    ///
+    /// When there is a cold store, observations before the first sequence are read from it.
+    ///
     /// @param[in] count maximum number of observations to get
     /// @param[in] filterSet optional filter set of data item ids
     /// @param[in] start optional starting sequence
@@ -249,19 +516,29 @@ namespace mtconnect::buffer {
     {
       auto results = std::make_unique<observation::ObservationList>();
 
-      std::lock_guard<std::recursive_mutex> lock(m_sequenceLock);
-      firstSeq = m_firstSequence;
+      // Convert the filter once so the scan only tests bits
+      auto bits = getFilterBits(filterSet);
+
+      std::unique_lock<std::recursive_mutex> lock(m_sequenceLock, std::defer_lock);
+      if (!m_lockFree)
+        lock.lock();
+
+      // Snapshot the range, the slot stamps catch any observations evicted while reading
+      SequenceNumber_t sequence = m_sequence.load(std::memory_order_acquire);
+      SequenceNumber_t firstSequence = m_firstSequence.load(std::memory_order_acquire);
+
+      firstSeq = firstSequence;
       int limit, inc;
 
       SequenceNumber_t first;
-      size_t max = m_slidingBuffer.size();
+      size_t max = sequence - firstSequence;
 
       // Determine where to start and direction of iteration.
       if (count >= 0)
       {
         if (to)
         {
-          if (start && *start > m_firstSequence)
+          if (start && *start > firstSequence)
             firstSeq = *start;
           first = *to;
           inc = -1;
@@ -275,37 +552,149 @@ namespace mtconnect::buffer {
       }
       else
       {
-        first = (start && *start < m_sequence) ? *start : m_sequence - 1;
+        first = (start && *start < sequence) ? *start : sequence - 1;
         limit = -count;
         inc = -1;
       }
 
-      size_t min = firstSeq - m_firstSequence;
-      size_t i = first - m_firstSequence;
-      for (int added = 0; added < limit && i < max && i >= min; i += inc)
+      // The range continues into the cold store when it starts before the ring
+      auto matches = [&bits](const observation::ObservationPtr &obs) {
+        return !obs->isOrphan() && (!bits || bits->test(obs->getDataItem()->getIndex()));
+      };
+      std::optional<SequenceNumber_t> coldLow;
+      if (m_coldStore && (count < 0 || (start && *start < firstSequence)))
       {
-        // Filter out according to if it exists in the list
-        auto &event = m_slidingBuffer[i];
-        if (!event->isOrphan())
+        auto oldest = m_coldStore->getFirstSequence();
+        if (oldest != 0 && oldest < firstSequence)
+          coldLow = count < 0 ? oldest : std::max(*start, oldest);
+      }
+
+      // The cold store has its own mutex, so it is read without holding the buffer
+      if (coldLow && inc > 0 && limit > 0)
+      {
+        int added = 0;
+        std::optional<SequenceNumber_t> last;
+        SequenceNumber_t low = *coldLow, high = firstSequence - 1;
+        while (true)
+        {
+          if (lock.owns_lock())
+            lock.unlock();
+          auto visited = m_coldStore->visit(low, high, true,
+                                            [&](const observation::ObservationPtr &obs) {
+                                              if (matches(obs))
+                                              {
+                                                results->push_back(obs);
+                                                if (++added >= limit)
+                                                  return false;
+                                              }
+                                              return true;
+                                            });
+          if (visited)
+            last = visited;
+          if (!m_lockFree)
+            lock.lock();
+          if (added >= limit)
+            break;
+
+          // The observations evicted while reading are in the cold store now
+          auto next = m_firstSequence.load(std::memory_order_acquire);
+          if (next <= high + 1)
+            break;
+          low = high + 1;
+          high = next - 1;
+        }
+
+        if (added >= limit)
         {
-          const std::string &dataId = event->getDataItem()->getId();
-          if (!filterSet || filterSet->count(dataId) > 0)
+          end = *last + 1;
+          endOfBuffer = false;
+          firstSeq = m_coldStore->getFirstSequence();
+          return results;
+        }
+        limit -= added;
+
+        // Continue with the ring from its current front
+        sequence = m_sequence.load(std::memory_order_acquire);
+        firstSequence = high + 1;
+        firstSeq = first = firstSequence;
+        max = sequence - firstSequence;
+      }
+
+      size_t min = firstSeq - firstSequence;
+      size_t i = first - firstSequence;
+
+      // A sparse filter reads the sequence numbers from the index instead of scanning
+      std::optional<size_t> indexed;
+      if (bits && m_sequenceIndex && limit > 0 && i < max && i >= min)
+        indexed = readFromIndex(*bits, firstSequence, min, max, i, inc, limit, *results);
+
+      if (indexed)
+        i = *indexed;
+      else
+      {
+        for (int added = 0; added < limit && i < max && i >= min; i += inc)
+        {
+          // Skip to the next slot with a data item in the filter
+          if (bits)
           {
-            results->push_back(event);
-            added++;
+            if (inc > 0)
+              i = findForward(*bits, firstSequence, i, max);
+            else
+              i = findBackward(*bits, firstSequence, min, i);
+            if (i >= max || i < min)
+              break;
+          }
+
+          // The index array may be ahead of the slot, so check the observation as well
+          auto event = readSlot(firstSequence + i);
+          if (event && !event->isOrphan())
+          {
+            if (!bits || bits->test(event->getDataItem()->getIndex()))
+            {
+              results->push_back(event);
+              added++;
+            }
           }
         }
       }
 
       if (to)
-        end = first < m_sequence ? first + 1 : m_sequence;
+        end = first < sequence ? first + 1 : sequence;
       else
-        end = m_firstSequence + i;
+        end = firstSequence + i;
 
       if (count >= 0)
-        endOfBuffer = i + m_firstSequence >= m_sequence;
+        endOfBuffer = i + firstSequence >= sequence;
       else
-        endOfBuffer = i + m_firstSequence <= m_firstSequence;
+        endOfBuffer = i + firstSequence <= firstSequence;
+
+      // Reading backward continues from the start of the ring into the cold store
+      if (coldLow && inc < 0 && results->size() < size_t(limit) && *coldLow <= first)
+      {
+        auto high = std::min<SequenceNumber_t>(first, firstSequence - 1);
+        size_t remaining = size_t(limit) - results->size();
+        size_t added = 0;
+        if (lock.owns_lock())
+          lock.unlock();
+        auto last = m_coldStore->visit(*coldLow, high, false,
+                                       [&](const observation::ObservationPtr &obs) {
+                                         if (matches(obs))
+                                         {
+                                           results->push_back(obs);
+                                           if (++added >= remaining)
+                                             return false;
+                                         }
+                                         return true;
+                                       });
+        if (count < 0)
+        {
+          endOfBuffer = added < remaining;
+          end = endOfBuffer ? *coldLow - 1 : *last - 1;
+        }
+      }
+
+      if (m_coldStore && firstSeq == firstSequence)
+        firstSeq = getOldestSequence();
 
       return results;
     }
@@ -319,19 +708,273 @@ namespace mtconnect::buffer {
     auto unlock() { return m_sequenceLock.unlock(); }
     /// @brief try to lock the mutex
     auto try_lock() { return m_sequenceLock.try_lock(); }
+
+    /// @brief lock the buffer for reading
+    ///
+    /// Locks the mutex unless the buffer is lock free, then only the checkpoints are locked
+    /// against the writer.
+    void lock_shared() const
+    {
+      if (m_lockFree)
+        m_checkpointLock.lock_shared();
+      else
+        m_sequenceLock.lock();
+    }
+    /// @brief unlock the buffer for reading
+    void unlock_shared() const
+    {
+      if (m_lockFree)
+        m_checkpointLock.unlock_shared();
+      else
+        m_sequenceLock.unlock();
+    }
+    /// @brief try to lock the buffer for reading
+    bool try_lock_shared() const
+    {
+      if (m_lockFree)
+        return m_checkpointLock.try_lock_shared();
+      else
+        return m_sequenceLock.try_lock();
+    }
     ///@}
 
   protected:
+    /// @brief A slot in the ring stamped with the sequence number of its observation
+    struct Slot
+    {
+      std::atomic<SequenceNumber_t> m_sequence {0};
+      observation::ObservationPtr m_observation;
+    };
+
+    /// @brief read the observation at a sequence number from its slot
+    /// @param[in] seq the sequence number
+    /// @return the observation or `nullptr` if the slot holds a different sequence
+    observation::ObservationPtr readSlot(SequenceNumber_t seq) const
+    {
+      const auto &slot = m_slots[seq & m_mask];
+      if (slot.m_sequence.load(std::memory_order_acquire) != seq)
+        return nullptr;
+      if (!m_lockFree)
+        return slot.m_observation;
+
+      auto obs = std::atomic_load_explicit(&slot.m_observation, std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.m_sequence.load(std::memory_order_relaxed) != seq)
+        return nullptr;
+
+      return obs;
+    }
+
+    /// @brief find the next offset from the base sequence with a data item in the filter
+    /// @param[in] bits the filter
+    /// @param[in] base the sequence number of offset 0
+    /// @param[in] i the first offset to check
+    /// @param[in] max one past the last offset to check
+    /// @return the offset or `max` if there are none
+    size_t findForward(const FilterBits &bits, SequenceNumber_t base, size_t i, size_t max) const
+    {
+      while (i < max)
+      {
+        // Scan up to the end of the ring or the range
+        size_t pos = (base + i) & m_mask;
+        size_t n = std::min<size_t>(max - i, m_slidingBufferSize - pos);
+        auto found = bits.findNext(m_indexes.get(), pos, pos + n);
+        if (found < pos + n)
+          return i + (found - pos);
+        i += n;
+      }
+      return max;
+    }
+
+    /// @brief find the previous offset from the base sequence with a data item in the filter
+    /// @param[in] bits the filter
+    /// @param[in] base the sequence number of offset 0
+    /// @param[in] min the last offset to check
+    /// @param[in] i the first offset to check, working backward
+    /// @return the offset or `min - 1` if there are none
+    size_t findBackward(const FilterBits &bits, SequenceNumber_t base, size_t min, size_t i) const
+    {
+      size_t end = i + 1;
+      while (end > min)
+      {
+        // Scan back to the start of the ring or the range
+        size_t last = (base + end - 1) & m_mask;
+        size_t n = std::min<size_t>(end - min, last + 1);
+        auto found = bits.findPrev(m_indexes.get(), last + 1 - n, last + 1);
+        if (found < last + 1)
+          return end - 1 - (last - found);
+        end -= n;
+      }
+      return min - 1;
+    }
+
+    /// @brief read the observations for a sparse filter using the sequence index
+    ///
+    /// The offsets are from the first sequence in the buffer, like the scan in `getObservations`.
+    ///
+    /// @param[in] bits the filter
+    /// @param[in] firstSequence the first sequence in the buffer
+    /// @param[in] min the lowest offset to read
+    /// @param[in] max one past the highest offset to read
+    /// @param[in] i the offset to start at
+    /// @param[in] inc `1` to read forward, `-1` to read backward
+    /// @param[in] limit the maximum number of observations
+    /// @param[out] results the observations
+    /// @return the offset after the last observation read, or `std::nullopt` if the index does
+    ///         not have all the sequence numbers or the filter is not sparse
+    std::optional<size_t> readFromIndex(const FilterBits &bits, SequenceNumber_t firstSequence,
+                                        size_t min, size_t max, size_t i, int inc, int limit,
+                                        observation::ObservationList &results) const
+    {
+      // Lock free readers share the lock the writer holds while it updates the index
+      std::shared_lock<std::shared_mutex> lock(m_checkpointLock, std::defer_lock);
+      if (m_lockFree)
+        lock.lock();
+
+      SequenceNumber_t low = firstSequence + (inc > 0 ? i : min);
+      SequenceNumber_t high = firstSequence + (inc > 0 ? max - 1 : i);
+
+      auto indexes = bits.getIndexes();
+      size_t candidates = 0;
+      for (auto index : indexes)
+      {
+        if (!m_sequenceIndex->isComplete(index, low))
+          return std::nullopt;
+        candidates += m_sequenceIndex->count(index, low, high);
+      }
+
+      // Scanning is faster when many of the observations match
+      if (candidates * 4 > high - low + 1)
+        return std::nullopt;
+
+      int added = 0;
+      std::optional<size_t> next;
+      m_sequenceIndex->visit(indexes, low, high, inc > 0, [&](SequenceNumber_t seq) {
+        auto event = readSlot(seq);
+        if (event && !event->isOrphan() && bits.test(event->getDataItem()->getIndex()))
+        {
+          results.push_back(event);
+          if (++added >= limit)
+          {
+            next = size_t(seq - firstSequence) + inc;
+            return false;
+          }
+        }
+        return true;
+      });
+
+      if (next)
+        return next;
+      else
+        return inc > 0 ? max : min - 1;
+    }
+
+    /// @brief get the observations in a checkpoint for a segment snapshot
+    /// @param[in] checkpoint the checkpoint
+    /// @return the observations with each condition chain from the oldest to the newest
+    static observation::ObservationList snapshot(const Checkpoint &checkpoint)
+    {
+      observation::ObservationList list;
+      checkpoint.getObservations(list);
+      list.reverse();
+      return list;
+    }
+
+    /// @brief add an observation at a sequence number to the ring and the checkpoints
+    ///
+    /// The caller holds the locks. Evicts the observations that no longer fit in the ring. A
+    /// `nullptr` observation leaves the slot empty, the checkpoints are still updated.
+    ///
+    /// @param[in] seq the sequence number
+    /// @param[in] observation the observation
+    void append(SequenceNumber_t seq, const observation::ObservationPtr &observation)
+    {
+      while (seq - m_firstSequence >= m_slidingBufferSize)
+      {
+        // The first checkpoint is at the evicted observation before it moves
+        if (m_coldStore)
+        {
+          auto evicted = readSlot(m_firstSequence);
+          if (evicted && !evicted->isOrphan())
+            m_coldStore->add(evicted, m_first);
+        }
+
+        // The oldest observation is overwritten, the next becomes the front of the buffer
+        auto first = m_firstSequence.load() + 1;
+        auto old = readSlot(first);
+        if (old)
+          m_first.addObservation(old);
+        m_firstSequence.store(first, std::memory_order_release);
+      }
+
+      if (observation)
+      {
+        writeSlot(seq, observation);
+        m_latest.addObservation(observation);
+      }
+
+      // Checkpoint management
+      if (m_checkpointCount > 0 && (seq % m_checkpointFreq) == 0)
+      {
+        // Copy the checkpoint from the current into the slot
+        m_checkpoints.push_back(std::make_unique<Checkpoint>(m_latest));
+      }
+    }
+
+    /// @brief write an observation into the slot for a sequence number
+    /// @param[in] seq the sequence number
+    /// @param[in] obs the observation
+    void writeSlot(SequenceNumber_t seq, const observation::ObservationPtr &obs)
+    {
+      auto &slot = m_slots[seq & m_mask];
+      auto di = obs->getDataItem();
+      // Lock free readers scan the indexes while they are written, they check the slot after
+      m_indexes[seq & m_mask].store(di ? uint32_t(di->getIndex()) : FilterBits::NoIndex,
+                                    std::memory_order_relaxed);
+      if (m_sequenceIndex && di)
+        m_sequenceIndex->add(di->getIndex(), seq);
+      if (!m_lockFree)
+      {
+        slot.m_observation = obs;
+        slot.m_sequence.store(seq, std::memory_order_relaxed);
+        return;
+      }
+
+      slot.m_sequence.store(0, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      std::atomic_store_explicit(&slot.m_observation, obs, std::memory_order_release);
+      slot.m_sequence.store(seq, std::memory_order_release);
+    }
+
+    /// @brief release the observation in the slot for a sequence number
+    /// @param[in] seq the sequence number
+    void clearSlot(SequenceNumber_t seq)
+    {
+      auto &slot = m_slots[seq & m_mask];
+      slot.m_sequence.store(0, std::memory_order_release);
+      std::atomic_store(&slot.m_observation, observation::ObservationPtr());
+    }
+
+  protected:
+    bool m_lockFree {false};
+
     // Access control to the buffer
     mutable std::recursive_mutex m_sequenceLock;
+    // Access control to the checkpoints for lock free readers
+    mutable std::shared_mutex m_checkpointLock;
 
     // Sequence number
-    volatile SequenceNumber_t m_sequence;
-    volatile SequenceNumber_t m_firstSequence;
+    std::atomic<SequenceNumber_t> m_sequence;
+    std::atomic<SequenceNumber_t> m_firstSequence;
 
     // The sliding/circular buffer to hold all of the events/sample data
     unsigned int m_slidingBufferSize;
-    boost::circular_buffer<observation::ObservationPtr> m_slidingBuffer;
+    SequenceNumber_t m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+    // The data item index of the observation in each slot
+    std::unique_ptr<FilterBits::Index[]> m_indexes;
+    // Optional sequence numbers of each data item
+    std::unique_ptr<SequenceIndex> m_sequenceIndex;
 
     // Checkpoints
     SequenceNumber_t m_checkpointFreq;
@@ -340,5 +983,17 @@ namespace mtconnect::buffer {
     Checkpoint m_latest;
     Checkpoint m_first;
     boost::circular_buffer<std::unique_ptr<Checkpoint>> m_checkpoints;
+
+    // Optional persistent storage of the observations
+    std::unique_ptr<SegmentStore> m_store;
+    std::optional<uint64_t> m_instanceId;
+    // Optional storage of the observations evicted from the ring
+    std::unique_ptr<ColdStore> m_coldStore;
+
+    // Change observers waiting for observations
+    observation::SubscriptionEngine m_subscriptions;
+
+    // The dense indexes of the data item ids
+    DataItemIndexes m_dataItemIndexes;
   };
 }  // namespace mtconnect::buffer
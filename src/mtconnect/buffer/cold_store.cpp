@@ -0,0 +1,613 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "cold_store.hpp"
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include "mtconnect/device_model/data_item/data_item.hpp"
+#include "mtconnect/logging.hpp"
+#include "observation_codec.hpp"
+
+using namespace std;
+namespace fs = std::filesystem;
+namespace io = boost::iostreams;
+
+namespace mtconnect::buffer {
+  using namespace observation;
+
+  static const string g_extension(".blk");
+  static constexpr size_t g_cacheSize = 4;
+
+  static void putVarint(string &out, uint64_t v)
+  {
+    while (v >= 0x80)
+    {
+      out.push_back(char(uint8_t(v) | 0x80));
+      v >>= 7;
+    }
+    out.push_back(char(v));
+  }
+
+  static void putSigned(string &out, int64_t v)
+  {
+    putVarint(out, (uint64_t(v) << 1) ^ uint64_t(v >> 63));
+  }
+
+  static void putString(string &out, const string &s)
+  {
+    putVarint(out, s.size());
+    out.append(s);
+  }
+
+  /// @brief Read the columns of a block
+  class ColumnReader
+  {
+  public:
+    ColumnReader(const string &data) : m_pos(data.data()), m_end(data.data() + data.size()) {}
+
+    uint64_t getVarint()
+    {
+      uint64_t v = 0;
+      for (int shift = 0; shift < 64; shift += 7)
+      {
+        if (m_pos >= m_end)
+          throw out_of_range("Truncated block");
+        auto b = uint8_t(*m_pos++);
+        v |= uint64_t(b & 0x7F) << shift;
+        if ((b & 0x80) == 0)
+          return v;
+      }
+      throw out_of_range("Invalid varint in block");
+    }
+
+    int64_t getSigned()
+    {
+      auto v = getVarint();
+      return int64_t(v >> 1) ^ -int64_t(v & 1);
+    }
+
+    pair<const char *, size_t> getString()
+    {
+      auto size = getVarint();
+      if (size > size_t(m_end - m_pos))
+        throw out_of_range("Truncated block");
+      auto s = m_pos;
+      m_pos += size;
+      return {s, size_t(size)};
+    }
+
+  protected:
+    const char *m_pos;
+    const char *m_end;
+  };
+
+  static int64_t micros(const Timestamp &ts)
+  {
+    return chrono::duration_cast<chrono::microseconds>(ts.time_since_epoch()).count();
+  }
+
+  ColdStore::ColdStore(const fs::path &directory, size_t maxObservations, size_t blockSize)
+    : m_directory(directory),
+      m_maxObservations(maxObservations),
+      m_blockSize(std::max<size_t>(blockSize, 1))
+  {
+    fs::create_directories(m_directory);
+
+    // The history starts over with each run of the agent
+    for (const auto &entry : fs::directory_iterator(m_directory))
+    {
+      if (entry.is_regular_file() && entry.path().extension() == g_extension)
+      {
+        std::error_code ec;
+        fs::remove(entry.path(), ec);
+      }
+    }
+
+    m_writer = std::thread([this]() { run(); });
+  }
+
+  ColdStore::~ColdStore()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_lock);
+      m_stop = true;
+    }
+    m_ready.notify_all();
+    m_writer.join();
+
+    clear();
+  }
+
+  void ColdStore::clear()
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (const auto &block : m_blocks)
+    {
+      std::error_code ec;
+      fs::remove(block.m_path, ec);
+    }
+    // A block the writer is writing is removed when it is done
+    m_blocks.clear();
+    m_queue.clear();
+    m_count = 0;
+    m_cache.clear();
+    m_pending.reset();
+    m_pendingCheckpoint.reset();
+  }
+
+  void ColdStore::add(const ObservationPtr &obs, const Checkpoint &checkpoint)
+  {
+    auto di = obs->getDataItem();
+    if (!di)
+      return;
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (!m_pending)
+    {
+      m_pending = make_shared<Observations>();
+      m_pending->reserve(m_blockSize);
+      m_pendingCheckpoint = make_shared<Checkpoint>(checkpoint);
+    }
+
+    m_pending->push_back(obs);
+    m_dataItems.try_emplace(di->getId(), di);
+
+    if (m_pending->size() >= m_blockSize)
+    {
+      // The block is read from memory until the writer has written it
+      const auto &observations = *m_pending;
+      char name[32];
+      snprintf(name, sizeof(name), "%020llu",
+               static_cast<unsigned long long>(observations.front()->getSequence()));
+      Block block {observations.front()->getSequence(), observations.back()->getSequence(),
+                   observations.size(), m_directory / (name + g_extension), m_pendingCheckpoint,
+                   m_pending};
+      m_blocks.push_back(block);
+      m_count += block.m_count;
+      m_queue.push_back(m_pending);
+
+      m_pending.reset();
+      m_pendingCheckpoint.reset();
+      m_ready.notify_one();
+    }
+  }
+
+  void ColdStore::flush()
+  {
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_written.wait(lock, [this]() { return m_queue.empty() && !m_writing; });
+  }
+
+  void ColdStore::run()
+  {
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (true)
+    {
+      m_ready.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+      if (m_stop)
+        break;
+
+      auto observations = m_queue.front();
+      m_queue.pop_front();
+
+      auto block = find_if(m_blocks.begin(), m_blocks.end(), [&observations](const Block &b) {
+        return b.m_unwritten == observations;
+      });
+      if (block == m_blocks.end())
+        continue;
+      auto path = block->m_path;
+      m_writing = true;
+
+      // Compress and write without blocking the circular buffer or the readers
+      lock.unlock();
+      bool written = write(*observations, path);
+      lock.lock();
+
+      // The block may have been trimmed or cleared while it was written
+      block = find_if(m_blocks.begin(), m_blocks.end(), [&observations](const Block &b) {
+        return b.m_unwritten == observations;
+      });
+      if (block == m_blocks.end())
+      {
+        std::error_code ec;
+        fs::remove(path, ec);
+      }
+      else if (!written)
+      {
+        LOG(error) << "Cannot write observation block " << path << ", the observations are lost";
+        m_count -= block->m_count;
+        m_blocks.erase(block);
+      }
+      else
+      {
+        block->m_unwritten.reset();
+
+        // The observations are still in memory, keep them for the next reads
+        m_cache.emplace_front(block->m_first, observations);
+        if (m_cache.size() > g_cacheSize)
+          m_cache.pop_back();
+
+        trim();
+      }
+
+      m_writing = false;
+      m_written.notify_all();
+    }
+  }
+
+  bool ColdStore::write(const Observations &observations, const fs::path &path) const
+  {
+    auto count = observations.size();
+
+    string raw;
+    putVarint(raw, count);
+
+    // Sequence numbers and timestamps as deltas
+    SequenceNumber seq = 0;
+    for (const auto &obs : observations)
+    {
+      putVarint(raw, obs->getSequence() - seq);
+      seq = obs->getSequence();
+    }
+    int64_t ts = 0;
+    for (const auto &obs : observations)
+    {
+      auto t = micros(obs->getTimestamp());
+      putSigned(raw, t - ts);
+      ts = t;
+    }
+
+    // Data item ids and states through dictionaries
+    unordered_map<string, size_t> ids, states;
+    vector<const string *> idList, stateList;
+    vector<size_t> idColumn, stateColumn;
+    idColumn.reserve(count);
+    stateColumn.reserve(count);
+    string state;
+    for (const auto &obs : observations)
+    {
+      auto di = obs->getDataItem();
+      auto id = ids.try_emplace(di ? di->getId() : string(), ids.size());
+      if (id.second)
+        idList.push_back(&id.first->first);
+      idColumn.push_back(id.first->second);
+
+      state.clear();
+      ObservationCodec::encodeState(obs, state);
+      auto st = states.try_emplace(state, states.size());
+      if (st.second)
+        stateList.push_back(&st.first->first);
+      stateColumn.push_back(st.first->second);
+    }
+
+    putVarint(raw, idList.size());
+    for (auto id : idList)
+      putString(raw, *id);
+    for (auto i : idColumn)
+      putVarint(raw, i);
+
+    putVarint(raw, stateList.size());
+    for (auto s : stateList)
+      putString(raw, *s);
+    for (auto i : stateColumn)
+      putVarint(raw, i);
+
+    string compressed;
+    {
+      io::filtering_ostream out;
+      out.push(io::zlib_compressor());
+      out.push(io::back_inserter(compressed));
+      out.write(raw.data(), raw.size());
+    }
+
+    ofstream file(path, ios::binary | ios::out | ios::trunc);
+    file.write(compressed.data(), compressed.size());
+    return bool(file);
+  }
+
+  void ColdStore::trim()
+  {
+    while (m_blocks.size() > 1 && m_count > m_maxObservations)
+    {
+      auto &block = m_blocks.front();
+      std::error_code ec;
+      fs::remove(block.m_path, ec);
+      m_cache.remove_if([&block](const auto &entry) { return entry.first == block.m_first; });
+      if (block.m_unwritten)
+        m_queue.erase(remove(m_queue.begin(), m_queue.end(), block.m_unwritten), m_queue.end());
+      m_count -= block.m_count;
+      m_blocks.pop_front();
+    }
+  }
+
+  ColdStore::ObservationsPtr ColdStore::load(const Block &block) const
+  {
+    if (block.m_unwritten)
+      return block.m_unwritten;
+
+    {
+      std::lock_guard<std::mutex> lock(m_lock);
+      for (auto it = m_cache.begin(); it != m_cache.end(); it++)
+      {
+        if (it->first == block.m_first)
+        {
+          m_cache.splice(m_cache.begin(), m_cache, it);
+          return it->second;
+        }
+      }
+    }
+
+    string raw;
+    try
+    {
+      ifstream file(block.m_path, ios::binary | ios::in);
+      string compressed((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+      io::filtering_istream in;
+      in.push(io::zlib_decompressor());
+      in.push(io::array_source(compressed.data(), compressed.size()));
+      io::copy(in, io::back_inserter(raw));
+    }
+    catch (io::zlib_error &e)
+    {
+      LOG(error) << "Cannot read observation block " << block.m_path << ": " << e.what();
+      return nullptr;
+    }
+
+    auto observations = make_shared<Observations>();
+    try
+    {
+      ColumnReader reader(raw);
+      auto count = reader.getVarint();
+
+      vector<SequenceNumber> seqs(count);
+      SequenceNumber seq = 0;
+      for (auto &s : seqs)
+        s = seq += reader.getVarint();
+
+      vector<Timestamp> times(count);
+      int64_t ts = 0;
+      for (auto &t : times)
+        t = Timestamp(chrono::microseconds(ts += reader.getSigned()));
+
+      vector<DataItemPtr> dataItems(reader.getVarint());
+      {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (auto &di : dataItems)
+        {
+          auto [data, size] = reader.getString();
+          auto it = m_dataItems.find(string(data, size));
+          if (it != m_dataItems.end())
+            di = it->second.lock();
+        }
+      }
+      vector<size_t> idColumn(count);
+      for (auto &i : idColumn)
+        i = reader.getVarint();
+
+      vector<pair<const char *, size_t>> states(reader.getVarint());
+      for (auto &s : states)
+        s = reader.getString();
+
+      observations->reserve(count);
+      for (size_t i = 0; i < count; i++)
+      {
+        auto st = reader.getVarint();
+        if (idColumn[i] >= dataItems.size() || st >= states.size())
+          throw out_of_range("Invalid dictionary index in block");
+
+        const auto &di = dataItems[idColumn[i]];
+        if (!di)
+          continue;
+
+        auto obs = ObservationCodec::decodeState(di, times[i], seqs[i], states[st].first,
+                                                 states[st].second);
+        if (obs)
+          observations->push_back(obs);
+      }
+    }
+    catch (out_of_range &e)
+    {
+      LOG(error) << "Cannot decode observation block " << block.m_path << ": " << e.what();
+      return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_cache.emplace_front(block.m_first, observations);
+    if (m_cache.size() > g_cacheSize)
+      m_cache.pop_back();
+
+    return observations;
+  }
+
+  ColdStore::SequenceNumber ColdStore::getFirstSequence() const
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (!m_blocks.empty())
+      return m_blocks.front().m_first;
+    else if (m_pending)
+      return m_pending->front()->getSequence();
+    else
+      return 0;
+  }
+
+  ColdStore::SequenceNumber ColdStore::getSequence() const
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (m_pending)
+      return m_pending->back()->getSequence() + 1;
+    else if (!m_blocks.empty())
+      return m_blocks.back().m_last + 1;
+    else
+      return 0;
+  }
+
+  static inline bool bySequence(const ObservationPtr &obs, uint64_t seq)
+  {
+    return obs->getSequence() < seq;
+  }
+
+  std::optional<ColdStore::SequenceNumber> ColdStore::visit(SequenceNumber low,
+                                                            SequenceNumber high, bool forward,
+                                                            const Visitor &visitor) const
+  {
+    // Copy the blocks in the range, the pending observations are copied as a last block
+    vector<Block> blocks;
+    Observations pending;
+    {
+      std::lock_guard<std::mutex> lock(m_lock);
+      for (const auto &block : m_blocks)
+      {
+        if (block.m_last >= low && block.m_first <= high)
+          blocks.push_back(block);
+      }
+      if (m_pending)
+      {
+        auto first = lower_bound(m_pending->begin(), m_pending->end(), low, bySequence);
+        for (auto it = first; it != m_pending->end() && (*it)->getSequence() <= high; it++)
+          pending.push_back(*it);
+      }
+    }
+
+    std::optional<SequenceNumber> last;
+    auto visitObservations = [&](const Observations &observations) -> bool {
+      auto first = lower_bound(observations.begin(), observations.end(), low, bySequence);
+      auto end = upper_bound(first, observations.end(), high,
+                             [](SequenceNumber seq, const ObservationPtr &obs) {
+                               return seq < obs->getSequence();
+                             });
+      if (forward)
+      {
+        for (auto it = first; it != end; it++)
+        {
+          last = (*it)->getSequence();
+          if (!visitor(*it))
+            return false;
+        }
+      }
+      else
+      {
+        for (auto it = end; it != first; it--)
+        {
+          last = (*(it - 1))->getSequence();
+          if (!visitor(*(it - 1)))
+            return false;
+        }
+      }
+      return true;
+    };
+
+    if (forward)
+    {
+      for (const auto &block : blocks)
+      {
+        auto observations = load(block);
+        if (observations && !visitObservations(*observations))
+          return last;
+      }
+      visitObservations(pending);
+    }
+    else
+    {
+      if (!visitObservations(pending))
+        return last;
+      for (auto it = blocks.rbegin(); it != blocks.rend(); it++)
+      {
+        auto observations = load(*it);
+        if (observations && !visitObservations(*observations))
+          return last;
+      }
+    }
+
+    return last;
+  }
+
+  std::unique_ptr<Checkpoint> ColdStore::getCheckpointAt(SequenceNumber at,
+                                                         const FilterBitsOpt &filter) const
+  {
+    std::shared_ptr<Checkpoint> base;
+    SequenceNumber first = 0;
+    {
+      std::lock_guard<std::mutex> lock(m_lock);
+      auto block = upper_bound(m_blocks.begin(), m_blocks.end(), at,
+                               [](SequenceNumber seq, const Block &b) { return seq < b.m_first; });
+      if (m_pending && at >= m_pending->front()->getSequence())
+      {
+        base = m_pendingCheckpoint;
+        first = m_pending->front()->getSequence();
+      }
+      else if (block != m_blocks.begin())
+      {
+        base = (block - 1)->m_checkpoint;
+        first = (block - 1)->m_first;
+      }
+    }
+
+    if (!base)
+      return nullptr;
+
+    // The checkpoint of a block includes its first observation
+    auto check = make_unique<Checkpoint>(*base, filter);
+    if (at > first)
+    {
+      visit(first + 1, at, true, [&check](const ObservationPtr &obs) {
+        check->addObservation(obs);
+        return true;
+      });
+    }
+
+    return check;
+  }
+
+  void ColdStore::updateDataItems(std::unordered_map<std::string, WeakDataItemPtr> &diMap)
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    for (auto &[id, di] : m_dataItems)
+    {
+      auto ndi = diMap.find(id);
+      if (ndi != diMap.end())
+        di = ndi->second;
+    }
+
+    if (m_pending)
+    {
+      for (auto &obs : *m_pending)
+      {
+        if (!obs->isOrphan())
+          obs->updateDataItem(diMap);
+      }
+    }
+
+    for (auto &block : m_blocks)
+      block.m_checkpoint->updateDataItems(diMap);
+    if (m_pendingCheckpoint)
+      m_pendingCheckpoint->updateDataItems(diMap);
+
+    // Decode the blocks again with the new data items
+    m_cache.clear();
+  }
+}  // namespace mtconnect::buffer
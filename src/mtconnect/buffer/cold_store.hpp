@@ -0,0 +1,160 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "checkpoint.hpp"
+#include "mtconnect/config.hpp"
+#include "mtconnect/observation/observation.hpp"
+#include "mtconnect/utilities.hpp"
+
+namespace mtconnect::buffer {
+  /// @brief Compressed on-disk history of the observations evicted from the circular buffer
+  ///
+  /// Evicted observations are collected into blocks. A full block is written as columns: the
+  /// sequence numbers and timestamps as deltas, and the data item ids and observation states
+  /// through a dictionary of the distinct values in the block. The columns are compressed with
+  /// zlib and written to a block file. Each block keeps the checkpoint at its first observation
+  /// in memory, so a checkpoint in the history only replays one block.
+  ///
+  /// The oldest blocks are removed when there are more than the maximum number of observations.
+  /// The history only covers the current run of the agent, the block files from a previous run
+  /// are removed when the store is created.
+  ///
+  /// Adding is serialized by the circular buffer and only collects the observations, a full block
+  /// is compressed and written by a background writer thread. The block is read from memory until
+  /// its file is written. Readers can read concurrently with the writer.
+  class AGENT_LIB_API ColdStore
+  {
+  public:
+    using SequenceNumber = uint64_t;
+    /// @brief Function called with each observation, returns `false` to stop
+    using Visitor = std::function<bool(const observation::ObservationPtr &)>;
+
+    /// @brief create a cold store in a directory, the directory is created if it does not exist
+    /// @param[in] directory the directory for the block files
+    /// @param[in] maxObservations the maximum number of observations to keep
+    /// @param[in] blockSize the number of observations in a block
+    /// @throws std::filesystem::filesystem_error if the directory cannot be created
+    ColdStore(const std::filesystem::path &directory, size_t maxObservations,
+              size_t blockSize = 4096);
+    ~ColdStore();
+
+    /// @brief add an observation evicted from the circular buffer
+    ///
+    /// Observations must be added in sequence order.
+    ///
+    /// @param[in] obs the observation
+    /// @param[in] checkpoint the checkpoint at the observation, including the observation
+    void add(const observation::ObservationPtr &obs, const Checkpoint &checkpoint);
+
+    /// @brief wait until the writer has written all the full blocks
+    void flush();
+
+    /// @brief get the sequence number of the oldest observation
+    /// @return the sequence number or `0` if the store is empty
+    SequenceNumber getFirstSequence() const;
+    /// @brief get the sequence number after the newest observation
+    /// @return the sequence number or `0` if the store is empty
+    SequenceNumber getSequence() const;
+    /// @brief `true` if there are no observations
+    bool empty() const { return getFirstSequence() == 0; }
+
+    /// @brief visit the observations in a range of sequence numbers
+    /// @param[in] low the first sequence number
+    /// @param[in] high the last sequence number
+    /// @param[in] forward `true` to visit in increasing order
+    /// @param[in] visitor called with each observation
+    /// @return the last sequence number visited, or `std::nullopt` if none were visited
+    std::optional<SequenceNumber> visit(SequenceNumber low, SequenceNumber high, bool forward,
+                                        const Visitor &visitor) const;
+
+    /// @brief get a checkpoint at a sequence number in the store
+    /// @param[in] at the sequence number
+    /// @param[in] filter the data item indexes to apply to the new checkpoint
+    /// @return the checkpoint or `nullptr` if the sequence number is not in the store
+    std::unique_ptr<Checkpoint> getCheckpointAt(SequenceNumber at,
+                                                const FilterBitsOpt &filter) const;
+
+    /// @brief remove all the observations
+    void clear();
+
+    /// @brief update the data item references when the device model changes
+    /// @param diMap the map of data item ids to new data item entities
+    void updateDataItems(std::unordered_map<std::string, WeakDataItemPtr> &diMap);
+
+  protected:
+    using Observations = std::vector<observation::ObservationPtr>;
+    using ObservationsPtr = std::shared_ptr<const Observations>;
+
+    struct Block
+    {
+      SequenceNumber m_first;
+      SequenceNumber m_last;
+      size_t m_count;
+      std::filesystem::path m_path;
+      std::shared_ptr<Checkpoint> m_checkpoint;
+      ObservationsPtr m_unwritten;  ///< the observations until the block file is written
+    };
+
+    void run();
+    bool write(const Observations &observations, const std::filesystem::path &path) const;
+    void trim();
+    ObservationsPtr load(const Block &block) const;
+
+  protected:
+    std::filesystem::path m_directory;
+    size_t m_maxObservations;
+    size_t m_blockSize;
+
+    mutable std::mutex m_lock;
+    std::deque<Block> m_blocks;
+    size_t m_count {0};
+
+    // The block being collected
+    std::shared_ptr<Observations> m_pending;
+    std::shared_ptr<Checkpoint> m_pendingCheckpoint;
+
+    // The data items of the stored observations by id
+    std::unordered_map<std::string, WeakDataItemPtr> m_dataItems;
+
+    // Recently decoded blocks, the most recent at the front
+    mutable std::list<std::pair<SequenceNumber, ObservationsPtr>> m_cache;
+
+    // The full blocks waiting for the writer thread
+    std::deque<ObservationsPtr> m_queue;
+    bool m_writing {false};
+    bool m_stop {false};
+    std::condition_variable m_ready;
+    std::condition_variable m_written;
+    std::thread m_writer;
+  };
+}  // namespace mtconnect::buffer
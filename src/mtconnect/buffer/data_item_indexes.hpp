@@ -0,0 +1,138 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/device_model/device.hpp"
+#include "mtconnect/utilities.hpp"
+
+namespace mtconnect::buffer {
+  /// @brief The dense indexes of the data item ids in the device model
+  ///
+  /// The agent assigns the indexes when it initializes the data items of a device, after the ids
+  /// are made unique. Data items with the same id share the index, so it is stable when a device
+  /// is updated. The index of an id removed from the device model is reused by the next new id.
+  class AGENT_LIB_API DataItemIndexes
+  {
+  public:
+    DataItemIndexes() = default;
+    DataItemIndexes(const DataItemIndexes &) = delete;
+
+    /// @brief give a data item the index of its id, creating one if it is a new id
+    /// @param[in] dataItem the data item
+    /// @return the index
+    size_t assign(device_model::data_item::DataItem &dataItem)
+    {
+      std::unique_lock<std::shared_mutex> lock(m_mutex);
+      return assignIndex(dataItem);
+    }
+
+    /// @brief give all the data items of a device the indexes of their ids
+    /// @param[in] device the device
+    void assign(const device_model::Device &device)
+    {
+      std::unique_lock<std::shared_mutex> lock(m_mutex);
+      for (const auto &item : device.getDeviceDataItems())
+      {
+        if (auto di = item.lock())
+          assignIndex(*di);
+      }
+    }
+
+    /// @brief free the index of an id that was removed from the device model
+    /// @param[in] id the data item id
+    void release(const std::string &id)
+    {
+      std::unique_lock<std::shared_mutex> lock(m_mutex);
+      if (auto pos = m_indexes.find(id); pos != m_indexes.end())
+      {
+        m_free.push_back(pos->second);
+        m_indexes.erase(pos);
+      }
+    }
+
+    /// @brief find the index of a data item id
+    /// @param[in] id the data item id
+    /// @return the index if the id has one
+    std::optional<size_t> find(const std::string &id) const
+    {
+      std::shared_lock<std::shared_mutex> lock(m_mutex);
+      if (auto pos = m_indexes.find(id); pos != m_indexes.end())
+        return pos->second;
+      return std::nullopt;
+    }
+
+    /// @brief call a function with the index of each id in a filter set
+    ///
+    /// The lock is taken once for the whole set. Ids without an index are skipped.
+    ///
+    /// @param[in] filterSet the data item ids
+    /// @param[in] f the function called with each index
+    template <typename F>
+    void find(const FilterSet &filterSet, F &&f) const
+    {
+      std::shared_lock<std::shared_mutex> lock(m_mutex);
+      for (const auto &id : filterSet)
+      {
+        if (auto pos = m_indexes.find(id); pos != m_indexes.end())
+          f(pos->second);
+      }
+    }
+
+    /// @brief get the number of indexes in use or free
+    /// @return one more than the largest index
+    size_t size() const
+    {
+      std::shared_lock<std::shared_mutex> lock(m_mutex);
+      return m_count;
+    }
+
+  protected:
+    size_t assignIndex(device_model::data_item::DataItem &dataItem)
+    {
+      auto [pos, added] = m_indexes.try_emplace(dataItem.getId(), 0);
+      if (added)
+      {
+        if (m_free.empty())
+        {
+          pos->second = m_count++;
+        }
+        else
+        {
+          pos->second = m_free.back();
+          m_free.pop_back();
+        }
+      }
+      dataItem.setIndex(pos->second);
+      return pos->second;
+    }
+
+  protected:
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<std::string, size_t> m_indexes;
+    std::vector<size_t> m_free;
+    size_t m_count {0};
+  };
+}  // namespace mtconnect::buffer
@@ -0,0 +1,268 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+// The vector scan reads the index array without atomic loads, so thread sanitizer builds use the
+// scalar scan
+#if defined(__SANITIZE_THREAD__)
+#define MTCONNECT_FILTER_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define MTCONNECT_FILTER_TSAN 1
+#endif
+#endif
+
+#if !defined(MTCONNECT_FILTER_TSAN) && defined(__AVX2__)
+#include <immintrin.h>
+#define MTCONNECT_FILTER_AVX2 1
+#define MTCONNECT_FILTER_AVX2_TARGET
+#elif !defined(MTCONNECT_FILTER_TSAN) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MTCONNECT_FILTER_AVX2 1
+#define MTCONNECT_FILTER_AVX2_TARGET __attribute__((target("avx2")))
+#define MTCONNECT_FILTER_AVX2_DISPATCH 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "data_item_indexes.hpp"
+#include "mtconnect/config.hpp"
+#include "mtconnect/utilities.hpp"
+
+namespace mtconnect::buffer {
+  /// @brief A set of data item indexes as a bitset
+  ///
+  /// Built once from a `FilterSet` so membership is a bit test on the data item index instead of
+  /// a string lookup. Also scans an array of data item indexes for the next or previous member,
+  /// eight indexes at a time when the processor has AVX2.
+  class AGENT_LIB_API FilterBits
+  {
+  public:
+    /// @brief an entry of an index array, the writer updates it while readers scan
+    using Index = std::atomic<uint32_t>;
+    static_assert(sizeof(Index) == sizeof(uint32_t) && Index::is_always_lock_free,
+                  "index arrays are scanned as arrays of uint32_t");
+
+    /// @brief the index stored for slots without a data item, it is never a member
+    static constexpr uint32_t NoIndex = std::numeric_limits<uint32_t>::max();
+
+    /// @brief create an empty filter
+    FilterBits() { resize(0); }
+    /// @brief create a filter from the data item ids in a filter set
+    ///
+    /// Ids that are not the id of a data item are ignored.
+    ///
+    /// @param[in] filterSet the data item ids
+    /// @param[in] indexes the indexes of the data item ids
+    FilterBits(const FilterSet &filterSet, const DataItemIndexes &indexes)
+    {
+      resize(0);
+      indexes.find(filterSet, [this](size_t index) { set(index); });
+    }
+
+    /// @brief add a data item index to the filter
+    /// @param[in] index the data item index
+    void set(size_t index)
+    {
+      if (test(index))
+        return;
+      if (index >= m_sentinel)
+        resize(index + 1);
+      m_words[index >> 5] |= 1u << (index & 31);
+      m_count++;
+    }
+
+    /// @brief check if a data item index is in the filter
+    /// @param[in] index the data item index
+    /// @return `true` if the index is in the filter
+    bool test(size_t index) const
+    {
+      return index < m_sentinel && (m_words[index >> 5] & (1u << (index & 31))) != 0;
+    }
+
+    /// @brief `true` if the filter has no data items
+    bool empty() const { return m_count == 0; }
+    /// @brief the number of data items in the filter
+    size_t size() const { return m_count; }
+
+    /// @brief get the data item indexes in the filter
+    /// @return the indexes in increasing order
+    std::vector<size_t> getIndexes() const
+    {
+      std::vector<size_t> indexes;
+      indexes.reserve(m_count);
+      for (size_t w = 0; w < m_words.size(); w++)
+      {
+        for (auto word = m_words[w]; word != 0; word &= word - 1)
+        {
+          size_t bit = 0;
+          while ((word & (1u << bit)) == 0)
+            bit++;
+          indexes.push_back((w << 5) + bit);
+        }
+      }
+      return indexes;
+    }
+
+    /// @brief find the first position in a range of an index array with an index in the filter
+    /// @param[in] indexes the array of data item indexes
+    /// @param[in] begin the first position
+    /// @param[in] end one past the last position
+    /// @return the position or `end` if none are in the filter
+    size_t findNext(const Index *indexes, size_t begin, size_t end) const
+    {
+#ifdef MTCONNECT_FILTER_AVX2
+      if (hasAvx2())
+        return findNextAvx2(indexes, begin, end);
+#endif
+      for (auto i = begin; i < end; i++)
+      {
+        if (test(indexes[i].load(std::memory_order_relaxed)))
+          return i;
+      }
+      return end;
+    }
+
+    /// @brief find the last position in a range of an index array with an index in the filter
+    /// @param[in] indexes the array of data item indexes
+    /// @param[in] begin the first position
+    /// @param[in] end one past the last position
+    /// @return the position or `end` if none are in the filter
+    size_t findPrev(const Index *indexes, size_t begin, size_t end) const
+    {
+#ifdef MTCONNECT_FILTER_AVX2
+      if (hasAvx2())
+        return findPrevAvx2(indexes, begin, end);
+#endif
+      for (auto i = end; i > begin; i--)
+      {
+        if (test(indexes[i - 1].load(std::memory_order_relaxed)))
+          return i - 1;
+      }
+      return end;
+    }
+
+  protected:
+    // Keep one bit past the largest index clear, indexes outside the filter are clamped to it
+    void resize(size_t size)
+    {
+      m_sentinel = uint32_t(std::max<size_t>(size, m_sentinel));
+      m_words.resize((size_t(m_sentinel) >> 5) + 1, 0);
+    }
+
+#ifdef MTCONNECT_FILTER_AVX2
+    static bool hasAvx2()
+    {
+#ifdef MTCONNECT_FILTER_AVX2_DISPATCH
+      static const bool avx2 = __builtin_cpu_supports("avx2");
+      return avx2;
+#else
+      return true;
+#endif
+    }
+
+    static unsigned lowestBit(unsigned mask)
+    {
+#ifdef _MSC_VER
+      unsigned long bit;
+      _BitScanForward(&bit, mask);
+      return unsigned(bit);
+#else
+      return unsigned(__builtin_ctz(mask));
+#endif
+    }
+
+    static unsigned highestBit(unsigned mask)
+    {
+#ifdef _MSC_VER
+      unsigned long bit;
+      _BitScanReverse(&bit, mask);
+      return unsigned(bit);
+#else
+      return 31u - unsigned(__builtin_clz(mask));
+#endif
+    }
+
+    // Bit i of the result is set if indexes[i] is in the filter. Each aligned 32 bit lane is
+    // read whole, like a relaxed load, the caller checks the slot before using a match.
+    MTCONNECT_FILTER_AVX2_TARGET unsigned matchAvx2(const Index *indexes) const
+    {
+      const auto sentinel = _mm256_set1_epi32(int(m_sentinel));
+      auto index = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(indexes));
+      index = _mm256_min_epu32(index, sentinel);
+      auto words = _mm256_i32gather_epi32(reinterpret_cast<const int *>(m_words.data()),
+                                          _mm256_srli_epi32(index, 5), 4);
+      auto bits = _mm256_srlv_epi32(words, _mm256_and_si256(index, _mm256_set1_epi32(31)));
+      bits = _mm256_slli_epi32(bits, 31);
+      return unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(bits)));
+    }
+
+    MTCONNECT_FILTER_AVX2_TARGET size_t findNextAvx2(const Index *indexes, size_t begin,
+                                                     size_t end) const
+    {
+      auto i = begin;
+      for (; i + 8 <= end; i += 8)
+      {
+        if (auto mask = matchAvx2(indexes + i))
+          return i + lowestBit(mask);
+      }
+      for (; i < end; i++)
+      {
+        if (test(indexes[i].load(std::memory_order_relaxed)))
+          return i;
+      }
+      return end;
+    }
+
+    MTCONNECT_FILTER_AVX2_TARGET size_t findPrevAvx2(const Index *indexes, size_t begin,
+                                                     size_t end) const
+    {
+      auto i = end;
+      for (; i >= begin + 8; i -= 8)
+      {
+        if (auto mask = matchAvx2(indexes + i - 8))
+          return i - 8 + highestBit(mask);
+      }
+      for (; i > begin; i--)
+      {
+        if (test(indexes[i - 1].load(std::memory_order_relaxed)))
+          return i - 1;
+      }
+      return end;
+    }
+#endif
+
+  protected:
+    std::vector<uint32_t> m_words;
+    uint32_t m_sentinel {0};
+    size_t m_count {0};
+  };
+
+  /// @brief Optional filter bits
+  using FilterBitsOpt = std::optional<FilterBits>;
+}  // namespace mtconnect::buffer
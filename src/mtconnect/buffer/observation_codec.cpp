@@ -0,0 +1,388 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "observation_codec.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "mtconnect/device_model/data_item/data_item.hpp"
+#include "mtconnect/logging.hpp"
+
+using namespace std;
+
+namespace mtconnect {
+  using namespace observation;
+  using namespace entity;
+  namespace buffer {
+    // Property value tags, the same as the ValueType enumeration where there is one
+    enum Tag : uint8_t
+    {
+      EMPTY = 0x0,
+      STRING = 0x3,
+      INTEGER = 0x4,
+      DOUBLE = 0x5,
+      BOOL = 0x6,
+      VECTOR = 0x7,
+      DATA_SET = 0x8,
+      TIMESTAMP = 0x9,
+      NULL_VALUE = 0xA
+    };
+
+    // Flags for the observation state
+    enum Flags : uint8_t
+    {
+      UNAVAILABLE = 0x1,
+      CONDITION = 0x2
+    };
+
+    template <typename T>
+    static inline void put(string &out, const T &v)
+    {
+      out.append(reinterpret_cast<const char *>(&v), sizeof(T));
+    }
+
+    static inline void putString(string &out, const string &s)
+    {
+      put(out, uint32_t(s.size()));
+      out.append(s);
+    }
+
+    /// @brief Read values from an encoded observation
+    class Reader
+    {
+    public:
+      Reader(const char *data, size_t size) : m_pos(data), m_end(data + size) {}
+
+      template <typename T>
+      T get()
+      {
+        check(sizeof(T));
+        T v;
+        memcpy(&v, m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return v;
+      }
+
+      string getString()
+      {
+        auto size = get<uint32_t>();
+        check(size);
+        string s(m_pos, size);
+        m_pos += size;
+        return s;
+      }
+
+    protected:
+      void check(size_t size)
+      {
+        if (size_t(m_end - m_pos) < size)
+          throw out_of_range("Truncated observation");
+      }
+
+    protected:
+      const char *m_pos;
+      const char *m_end;
+    };
+
+    static void encodeDataSet(const DataSet &set, string &out);
+
+    static void encodeDataSetValue(const DataSetValue &value, string &out)
+    {
+      visit(overloaded {[&out](const monostate &) { put(out, uint8_t(EMPTY)); },
+                        [&out](const DataSet &v) {
+                          put(out, uint8_t(DATA_SET));
+                          encodeDataSet(v, out);
+                        },
+                        [&out](const string &v) {
+                          put(out, uint8_t(STRING));
+                          putString(out, v);
+                        },
+                        [&out](const int64_t &v) {
+                          put(out, uint8_t(INTEGER));
+                          put(out, v);
+                        },
+                        [&out](const double &v) {
+                          put(out, uint8_t(DOUBLE));
+                          put(out, v);
+                        }},
+            value);
+    }
+
+    static void encodeDataSet(const DataSet &set, string &out)
+    {
+      put(out, uint32_t(set.size()));
+      for (const auto &entry : set)
+      {
+        putString(out, entry.m_key);
+        put(out, uint8_t(entry.m_removed));
+        encodeDataSetValue(entry.m_value, out);
+      }
+    }
+
+    static DataSet decodeDataSet(Reader &reader);
+
+    static DataSetValue decodeDataSetValue(Reader &reader)
+    {
+      switch (reader.get<uint8_t>())
+      {
+        case DATA_SET:
+          return decodeDataSet(reader);
+
+        case STRING:
+          return reader.getString();
+
+        case INTEGER:
+          return reader.get<int64_t>();
+
+        case DOUBLE:
+          return reader.get<double>();
+
+        default:
+          return monostate();
+      }
+    }
+
+    static DataSet decodeDataSet(Reader &reader)
+    {
+      DataSet set;
+      auto count = reader.get<uint32_t>();
+      for (uint32_t i = 0; i < count; i++)
+      {
+        auto key = reader.getString();
+        bool removed = reader.get<uint8_t>() != 0;
+        set.emplace(key, decodeDataSetValue(reader), removed);
+      }
+      return set;
+    }
+
+    // Returns false if the value cannot be stored
+    static bool encodeValue(const Value &value, string &out)
+    {
+      return visit(overloaded {[&out](const monostate &) {
+                                 put(out, uint8_t(EMPTY));
+                                 return true;
+                               },
+                               [&out](const string &v) {
+                                 put(out, uint8_t(STRING));
+                                 putString(out, v);
+                                 return true;
+                               },
+                               [&out](const int64_t &v) {
+                                 put(out, uint8_t(INTEGER));
+                                 put(out, v);
+                                 return true;
+                               },
+                               [&out](const double &v) {
+                                 put(out, uint8_t(DOUBLE));
+                                 put(out, v);
+                                 return true;
+                               },
+                               [&out](const bool &v) {
+                                 put(out, uint8_t(BOOL));
+                                 put(out, uint8_t(v));
+                                 return true;
+                               },
+                               [&out](const Vector &v) {
+                                 put(out, uint8_t(VECTOR));
+                                 put(out, uint32_t(v.size()));
+                                 for (auto d : v)
+                                   put(out, d);
+                                 return true;
+                               },
+                               [&out](const DataSet &v) {
+                                 put(out, uint8_t(DATA_SET));
+                                 encodeDataSet(v, out);
+                                 return true;
+                               },
+                               [&out](const Timestamp &v) {
+                                 put(out, uint8_t(TIMESTAMP));
+                                 put(out, int64_t(chrono::duration_cast<chrono::microseconds>(
+                                                      v.time_since_epoch())
+                                                      .count()));
+                                 return true;
+                               },
+                               [&out](const nullptr_t &) {
+                                 put(out, uint8_t(NULL_VALUE));
+                                 return true;
+                               },
+                               [](const auto &) { return false; }},
+                   value);
+    }
+
+    static Value decodeValue(Reader &reader)
+    {
+      switch (reader.get<uint8_t>())
+      {
+        case STRING:
+          return reader.getString();
+
+        case INTEGER:
+          return reader.get<int64_t>();
+
+        case DOUBLE:
+          return reader.get<double>();
+
+        case BOOL:
+          return reader.get<uint8_t>() != 0;
+
+        case VECTOR:
+        {
+          Vector v(reader.get<uint32_t>());
+          for (auto &d : v)
+            d = reader.get<double>();
+          return v;
+        }
+
+        case DATA_SET:
+          return decodeDataSet(reader);
+
+        case TIMESTAMP:
+          return Timestamp(chrono::microseconds(reader.get<int64_t>()));
+
+        case NULL_VALUE:
+          return nullptr;
+
+        default:
+          return monostate();
+      }
+    }
+
+    static const char *levelName(Condition::Level level)
+    {
+      switch (level)
+      {
+        case Condition::NORMAL:
+          return "NORMAL";
+        case Condition::WARNING:
+          return "WARNING";
+        case Condition::FAULT:
+          return "FAULT";
+        default:
+          return "UNAVAILABLE";
+      }
+    }
+
+    void ObservationCodec::encode(const ObservationPtr &obs, uint64_t sequence, string &out)
+    {
+      auto di = obs->getDataItem();
+      if (!di)
+        return;
+
+      put(out, sequence);
+      put(out, int64_t(chrono::duration_cast<chrono::microseconds>(
+                           obs->getTimestamp().time_since_epoch())
+                           .count()));
+      putString(out, di->getId());
+      encodeState(obs, out);
+    }
+
+    void ObservationCodec::encodeState(const ObservationPtr &obs, string &out)
+    {
+      auto di = obs->getDataItem();
+      if (!di)
+        return;
+
+      uint8_t flags = 0;
+      uint8_t level = 0;
+      if (obs->isUnavailable())
+        flags |= UNAVAILABLE;
+      if (auto cond = dynamic_pointer_cast<Condition>(obs))
+      {
+        flags |= CONDITION;
+        level = uint8_t(cond->getLevel());
+      }
+      put(out, flags);
+      put(out, level);
+
+      // The properties from the data item are set again when the observation is made
+      const auto &diProps = di->getObservationProperties();
+      auto countPos = out.size();
+      uint16_t count = 0;
+      put(out, count);
+      for (const auto &[key, value] : obs->getProperties())
+      {
+        if (key == "timestamp" || key == "sequence" || diProps.count(key) > 0)
+          continue;
+
+        auto pos = out.size();
+        putString(out, key);
+        if (encodeValue(value, out))
+          count++;
+        else
+          out.resize(pos);
+      }
+      memcpy(out.data() + countPos, &count, sizeof(count));
+    }
+
+    static ObservationPtr readState(Reader &reader, const DataItemPtr &di,
+                                    const Timestamp &timestamp, uint64_t sequence)
+    {
+      auto flags = reader.get<uint8_t>();
+      auto level = Condition::Level(reader.get<uint8_t>());
+
+      Properties props;
+      auto count = reader.get<uint16_t>();
+      for (uint16_t i = 0; i < count; i++)
+      {
+        auto key = reader.getString();
+        props.insert_or_assign(key, decodeValue(reader));
+      }
+
+      if (!di || di->isCondition() != ((flags & CONDITION) != 0))
+        return nullptr;
+
+      if (di->isCondition())
+        props.insert_or_assign("level", string(levelName(level)));
+      else if ((flags & UNAVAILABLE) != 0)
+        props.insert_or_assign("VALUE", "UNAVAILABLE"s);
+
+      try
+      {
+        ErrorList errors;
+        auto obs = Observation::make(di, props, timestamp, errors);
+        obs->setSequence(sequence);
+        return obs;
+      }
+      catch (EntityError &e)
+      {
+        LOG(warning) << "Cannot restore observation " << sequence << " for " << di->getId()
+                     << ": " << e.what();
+        return nullptr;
+      }
+    }
+
+    ObservationPtr ObservationCodec::decode(const char *data, size_t size,
+                                            const DataItemLookup &lookup, uint64_t &sequence)
+    {
+      Reader reader(data, size);
+      sequence = reader.get<uint64_t>();
+      Timestamp timestamp {chrono::microseconds(reader.get<int64_t>())};
+      auto id = reader.getString();
+
+      return readState(reader, lookup(id), timestamp, sequence);
+    }
+
+    ObservationPtr ObservationCodec::decodeState(const DataItemPtr &dataItem,
+                                                 const Timestamp &timestamp, uint64_t sequence,
+                                                 const char *data, size_t size)
+    {
+      Reader reader(data, size);
+      return readState(reader, dataItem, timestamp, sequence);
+    }
+  }  // namespace buffer
+}  // namespace mtconnect
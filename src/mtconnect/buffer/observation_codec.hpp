@@ -0,0 +1,81 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/observation/observation.hpp"
+#include "mtconnect/utilities.hpp"
+
+namespace mtconnect::buffer {
+  /// @brief Compact binary encoding of observations for storage
+  ///
+  /// An observation is written as its sequence number, timestamp, data item id, unavailable
+  /// state, condition level, and the properties that are not copied from the data item. Numbers
+  /// are written in the byte order of the host, the encoding is meant for local files only.
+  class AGENT_LIB_API ObservationCodec
+  {
+  public:
+    /// @brief Function to find a data item by id when decoding
+    using DataItemLookup = std::function<DataItemPtr(const std::string &)>;
+
+    /// @brief append an observation to a buffer
+    /// @param[in] obs the observation
+    /// @param[in] sequence the sequence number of the observation in the circular buffer
+    /// @param[in,out] out the buffer
+    static void encode(const observation::ObservationPtr &obs, uint64_t sequence,
+                       std::string &out);
+
+    /// @brief decode an observation
+    ///
+    /// Observations for data items that can no longer be found or that no longer match the data
+    /// item are skipped.
+    ///
+    /// @param[in] data the encoded observation
+    /// @param[in] size the size of the encoded observation
+    /// @param[in] lookup finds the data item for the observation
+    /// @param[out] sequence the sequence number of the observation, even if it is skipped
+    /// @return the observation or `nullptr` if it was skipped
+    /// @throws std::out_of_range if the data is truncated
+    static observation::ObservationPtr decode(const char *data, size_t size,
+                                              const DataItemLookup &lookup, uint64_t &sequence);
+
+    /// @brief append the state of an observation to a buffer
+    ///
+    /// The state is the unavailable state, condition level, and properties without the sequence
+    /// number, timestamp, and data item.
+    ///
+    /// @param[in] obs the observation
+    /// @param[in,out] out the buffer
+    static void encodeState(const observation::ObservationPtr &obs, std::string &out);
+
+    /// @brief decode an observation from its state
+    /// @param[in] dataItem the data item of the observation
+    /// @param[in] timestamp the timestamp of the observation
+    /// @param[in] sequence the sequence number of the observation
+    /// @param[in] data the encoded state
+    /// @param[in] size the size of the encoded state
+    /// @return the observation or `nullptr` if it no longer matches the data item
+    /// @throws std::out_of_range if the data is truncated
+    static observation::ObservationPtr decodeState(const DataItemPtr &dataItem,
+                                                   const Timestamp &timestamp, uint64_t sequence,
+                                                   const char *data, size_t size);
+  };
+}  // namespace mtconnect::buffer
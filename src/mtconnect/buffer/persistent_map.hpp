@@ -0,0 +1,382 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+
+namespace mtconnect::buffer {
+  /// @brief A persistent hash array mapped trie with copy-on-write nodes
+  ///
+  /// Copying the map shares the whole trie with the original. When a map is modified, only the
+  /// nodes on the path to the changed entry that are still shared with another map are copied.
+  /// Copies are O(1) and each change is O(log32 n), so a series of versions of a large map costs
+  /// memory proportional to the changes between them.
+  ///
+  /// The map is not thread safe. A node is modified in place only when this map holds the only
+  /// reference, so readers that hold a copy of the map may read it while another copy is modified.
+  ///
+  /// @tparam Key the key type
+  /// @tparam Value the value type
+  /// @tparam Hash the hash function for the key
+  template <typename Key, typename Value, typename Hash = std::hash<Key>>
+  class PersistentMap
+  {
+  public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<Key, Value>;
+
+  protected:
+    static constexpr unsigned BITS = 5;
+    static constexpr unsigned MASK = (1u << BITS) - 1;
+    static constexpr unsigned HASH_BITS = sizeof(size_t) * 8;
+
+    struct Node;
+    using NodePtr = std::shared_ptr<Node>;
+
+    /// @brief An entry in a node is either a sub-trie or a leaf with a key and value
+    struct Entry
+    {
+      NodePtr m_node;
+      size_t m_hash {0};
+      value_type m_value;
+    };
+
+    /// @brief A trie node with a bitmap of the occupied positions and the compacted entries.
+    ///
+    /// Once all the bits of the hash are consumed the node holds the colliding leaves in order.
+    struct Node
+    {
+      uint32_t m_bitmap {0};
+      std::vector<Entry> m_entries;
+    };
+
+  public:
+    /// @brief Forward iterator over the key value pairs
+    class const_iterator
+    {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = typename PersistentMap::value_type;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const value_type *;
+      using reference = const value_type &;
+
+      const_iterator() = default;
+      explicit const_iterator(const Node *root)
+      {
+        if (root)
+        {
+          m_stack.emplace_back(root, 0);
+          advance();
+        }
+      }
+
+      reference operator*() const
+      {
+        const auto &[node, i] = m_stack.back();
+        return node->m_entries[i].m_value;
+      }
+      pointer operator->() const { return &operator*(); }
+
+      const_iterator &operator++()
+      {
+        m_stack.back().second++;
+        advance();
+        return *this;
+      }
+      const_iterator operator++(int)
+      {
+        auto it = *this;
+        ++(*this);
+        return it;
+      }
+
+      bool operator==(const const_iterator &other) const { return m_stack == other.m_stack; }
+      bool operator!=(const const_iterator &other) const { return m_stack != other.m_stack; }
+
+    protected:
+      // Move to the first leaf at or after the current position
+      void advance()
+      {
+        while (!m_stack.empty())
+        {
+          auto [node, i] = m_stack.back();
+          if (i >= node->m_entries.size())
+          {
+            m_stack.pop_back();
+            if (!m_stack.empty())
+              m_stack.back().second++;
+          }
+          else if (node->m_entries[i].m_node)
+          {
+            m_stack.emplace_back(node->m_entries[i].m_node.get(), 0);
+          }
+          else
+          {
+            return;
+          }
+        }
+      }
+
+    protected:
+      std::vector<std::pair<const Node *, size_t>> m_stack;
+    };
+
+  public:
+    PersistentMap() = default;
+    PersistentMap(const PersistentMap &other) = default;
+    PersistentMap(PersistentMap &&other) noexcept
+      : m_root(std::move(other.m_root)), m_size(other.m_size)
+    {
+      other.m_size = 0;
+    }
+    ~PersistentMap() = default;
+
+    PersistentMap &operator=(const PersistentMap &other) = default;
+    PersistentMap &operator=(PersistentMap &&other) noexcept
+    {
+      m_root = std::move(other.m_root);
+      m_size = other.m_size;
+      other.m_size = 0;
+      return *this;
+    }
+
+    /// @brief the number of entries
+    size_t size() const { return m_size; }
+    /// @brief `true` if the map has no entries
+    bool empty() const { return m_size == 0; }
+    /// @brief remove all entries
+    void clear()
+    {
+      m_root.reset();
+      m_size = 0;
+    }
+
+    /// @brief check if two maps share the same trie
+    /// @param[in] other the other map
+    /// @return `true` if no changes have been made to either map since they were copied
+    bool shares(const PersistentMap &other) const { return m_root == other.m_root; }
+
+    const_iterator begin() const { return const_iterator(m_root.get()); }
+    const_iterator end() const { return const_iterator(); }
+
+    /// @brief find a value
+    /// @param[in] key the key
+    /// @return a pointer to the value or `nullptr` if the key is not in the map
+    const Value *find(const Key &key) const
+    {
+      auto hash = Hash {}(key);
+      const Node *node = m_root.get();
+      for (unsigned shift = 0; node; shift += BITS)
+      {
+        if (shift >= HASH_BITS)
+        {
+          for (const auto &e : node->m_entries)
+            if (e.m_value.first == key)
+              return &e.m_value.second;
+          return nullptr;
+        }
+
+        auto bit = (hash >> shift) & MASK;
+        if ((node->m_bitmap & (1u << bit)) == 0)
+          return nullptr;
+
+        const auto &e = node->m_entries[position(node->m_bitmap, bit)];
+        if (e.m_node)
+          node = e.m_node.get();
+        else if (e.m_hash == hash && e.m_value.first == key)
+          return &e.m_value.second;
+        else
+          return nullptr;
+      }
+      return nullptr;
+    }
+
+    /// @brief get a value
+    /// @param[in] key the key
+    /// @return the value
+    /// @throws std::out_of_range if the key is not in the map
+    const Value &at(const Key &key) const
+    {
+      auto value = find(key);
+      if (value == nullptr)
+        throw std::out_of_range("PersistentMap::at: key not found");
+      return *value;
+    }
+
+    /// @brief count the entries for a key
+    /// @param[in] key the key
+    /// @return 1 if the key is in the map, otherwise 0
+    size_t count(const Key &key) const { return find(key) != nullptr ? 1 : 0; }
+
+    /// @brief get a modifiable reference to the value for a key
+    ///
+    /// Copies any shared nodes on the path to the entry and inserts a default value if the key is
+    /// not in the map.
+    ///
+    /// @param[in] key the key
+    /// @return a reference to the value
+    Value &operator[](const Key &key)
+    {
+      auto hash = Hash {}(key);
+      NodePtr *ptr = &m_root;
+      for (unsigned shift = 0;; shift += BITS)
+      {
+        Node *node = own(*ptr);
+        if (shift >= HASH_BITS)
+        {
+          for (auto &e : node->m_entries)
+            if (e.m_value.first == key)
+              return e.m_value.second;
+
+          m_size++;
+          node->m_entries.push_back(Entry {nullptr, hash, {key, Value()}});
+          return node->m_entries.back().m_value.second;
+        }
+
+        auto bit = (hash >> shift) & MASK;
+        auto pos = position(node->m_bitmap, bit);
+        if ((node->m_bitmap & (1u << bit)) == 0)
+        {
+          m_size++;
+          node->m_bitmap |= (1u << bit);
+          auto it = node->m_entries.insert(node->m_entries.begin() + pos,
+                                           Entry {nullptr, hash, {key, Value()}});
+          return it->m_value.second;
+        }
+
+        auto &e = node->m_entries[pos];
+        if (!e.m_node)
+        {
+          if (e.m_hash == hash && e.m_value.first == key)
+            return e.m_value.second;
+
+          // Push the existing leaf down into a new node and continue from there
+          auto sub = std::make_shared<Node>();
+          auto next = shift + BITS;
+          if (next < HASH_BITS)
+            sub->m_bitmap = 1u << ((e.m_hash >> next) & MASK);
+          sub->m_entries.emplace_back(std::move(e));
+          e = Entry {sub, 0, {}};
+        }
+        ptr = &e.m_node;
+      }
+    }
+
+    /// @brief insert or replace a value
+    /// @param[in] key the key
+    /// @param[in] value the value
+    void insert_or_assign(const Key &key, const Value &value) { (*this)[key] = value; }
+
+    /// @brief remove a key
+    /// @param[in] key the key
+    /// @return the number of entries removed
+    size_t erase(const Key &key)
+    {
+      if (find(key) == nullptr)
+        return 0;
+
+      erase(m_root, Hash {}(key), key, 0);
+      if (m_root->m_entries.empty())
+        m_root.reset();
+      m_size--;
+      return 1;
+    }
+
+  protected:
+    static unsigned position(uint32_t bitmap, unsigned bit)
+    {
+      return unsigned(std::bitset<32>(bitmap & ((1u << bit) - 1)).count());
+    }
+
+    // Make sure the node is only referenced by this map, copy it if it is shared
+    static Node *own(NodePtr &ptr)
+    {
+      if (!ptr)
+        ptr = std::make_shared<Node>();
+      else if (ptr.use_count() > 1)
+        ptr = std::make_shared<Node>(*ptr);
+      else
+        std::atomic_thread_fence(std::memory_order_acquire);
+      return ptr.get();
+    }
+
+    // The key must be in the map
+    static void erase(NodePtr &ptr, size_t hash, const Key &key, unsigned shift)
+    {
+      Node *node = own(ptr);
+      if (shift >= HASH_BITS)
+      {
+        for (auto it = node->m_entries.begin(); it != node->m_entries.end(); it++)
+        {
+          if (it->m_value.first == key)
+          {
+            node->m_entries.erase(it);
+            break;
+          }
+        }
+        return;
+      }
+
+      auto bit = (hash >> shift) & MASK;
+      auto pos = position(node->m_bitmap, bit);
+      auto &e = node->m_entries[pos];
+      if (e.m_node)
+      {
+        erase(e.m_node, hash, key, shift + BITS);
+        auto &sub = e.m_node->m_entries;
+
+        // Pull a single remaining leaf back up so lookups stay short
+        if (sub.size() == 1 && !sub.front().m_node)
+        {
+          Entry leaf = std::move(sub.front());
+          e = std::move(leaf);
+        }
+        else if (!sub.empty())
+        {
+          return;
+        }
+        else
+        {
+          node->m_bitmap &= ~(1u << bit);
+          node->m_entries.erase(node->m_entries.begin() + pos);
+        }
+      }
+      else
+      {
+        node->m_bitmap &= ~(1u << bit);
+        node->m_entries.erase(node->m_entries.begin() + pos);
+      }
+    }
+
+  protected:
+    NodePtr m_root;
+    size_t m_size {0};
+  };
+}  // namespace mtconnect::buffer
@@ -0,0 +1,338 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "segment_store.hpp"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "mtconnect/logging.hpp"
+#include "observation_codec.hpp"
+
+using namespace std;
+namespace fs = std::filesystem;
+namespace ip = boost::interprocess;
+
+namespace mtconnect::buffer {
+  static const string g_extension(".seg");
+  static const string g_instanceFile("instance");
+  static constexpr auto g_flushInterval = chrono::seconds(1);
+
+  // Visit the complete records of a segment file, returns the number of observations after the
+  // snapshot
+  static size_t readSegment(const fs::path &path, const SegmentStore::RecordHandler &handler,
+                            bool snapshot)
+  {
+    std::error_code ec;
+    auto size = fs::file_size(path, ec);
+    if (ec || size < sizeof(uint32_t))
+      return 0;
+
+    try
+    {
+      ip::file_mapping file(path.string().c_str(), ip::read_only);
+      ip::mapped_region region(file, ip::read_only);
+
+      auto data = static_cast<const char *>(region.get_address());
+      size = region.get_size();
+
+      uint32_t snapshotCount;
+      memcpy(&snapshotCount, data, sizeof(snapshotCount));
+
+      size_t count = 0, pos = sizeof(snapshotCount);
+      while (pos + sizeof(uint32_t) <= size)
+      {
+        uint32_t len;
+        memcpy(&len, data + pos, sizeof(len));
+        pos += sizeof(len);
+        if (len > size - pos)
+        {
+          LOG(warning) << "Segment " << path << " ends with a partial observation";
+          break;
+        }
+
+        bool inSnapshot = count < snapshotCount;
+        if (handler && (snapshot || !inSnapshot))
+          handler(data + pos, len, inSnapshot);
+        pos += len;
+        count++;
+      }
+
+      return count > snapshotCount ? count - snapshotCount : 0;
+    }
+    catch (ip::interprocess_exception &e)
+    {
+      LOG(warning) << "Cannot map segment " << path << ": " << e.what();
+      return 0;
+    }
+  }
+
+  SegmentStore::SegmentStore(const fs::path &directory, size_t retain)
+    : m_directory(directory), m_retain(retain), m_segmentSize(std::max<size_t>(retain / 4, 1))
+  {
+    fs::create_directories(m_directory);
+
+    // The segment names are zero padded, so they sort in sequence order
+    vector<fs::path> paths;
+    for (const auto &entry : fs::directory_iterator(m_directory))
+    {
+      if (entry.is_regular_file() && entry.path().extension() == g_extension)
+        paths.push_back(entry.path());
+    }
+    sort(paths.begin(), paths.end());
+
+    for (const auto &path : paths)
+    {
+      auto count = readSegment(path, nullptr, false);
+      m_segments.push_back({path, count});
+      m_records += count;
+    }
+
+    LOG(info) << "Opened observation segments in " << m_directory << " with " << m_records
+              << " observations";
+
+    m_writer = std::thread([this]() { run(); });
+  }
+
+  SegmentStore::~SegmentStore()
+  {
+    // The writer finishes the queued work before it stops
+    {
+      std::lock_guard<std::mutex> lock(m_lock);
+      m_stop = true;
+    }
+    m_ready.notify_all();
+    m_writer.join();
+
+    close();
+  }
+
+  fs::path SegmentStore::segmentPath(SequenceNumber seq) const
+  {
+    char name[32];
+    snprintf(name, sizeof(name), "%020llu", static_cast<unsigned long long>(seq));
+    return m_directory / (name + g_extension);
+  }
+
+  void SegmentStore::encode(SequenceNumber seq, const observation::ObservationPtr &obs)
+  {
+    auto start = m_buffer.size();
+    m_buffer.append(sizeof(uint32_t), '\0');
+    ObservationCodec::encode(obs, seq, m_buffer);
+
+    uint32_t len = uint32_t(m_buffer.size() - start - sizeof(uint32_t));
+    if (len == 0)
+      m_buffer.resize(start);
+    else
+      memcpy(m_buffer.data() + start, &len, sizeof(len));
+  }
+
+  void SegmentStore::startSegment(SequenceNumber seq, observation::ObservationList snapshot)
+  {
+    trim();
+
+    auto path = segmentPath(seq);
+    m_segments.push_back({path, 0});
+    m_segmentStarted = true;
+
+    queue({Work::START, path, seq, nullptr, std::move(snapshot)});
+  }
+
+  void SegmentStore::append(SequenceNumber seq, const observation::ObservationPtr &obs)
+  {
+    // Observations without a data item are not encoded
+    if (!obs->getDataItem())
+      return;
+
+    if (needsSegment())
+      startSegment(seq, {});
+
+    queue({Work::APPEND, {}, seq, obs, {}});
+    m_segments.back().m_records++;
+    m_records++;
+  }
+
+  void SegmentStore::queue(Work &&work)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_lock);
+      m_queue.emplace_back(std::move(work));
+    }
+    m_ready.notify_one();
+  }
+
+  void SegmentStore::flush()
+  {
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_written.wait(lock, [this]() { return m_queue.empty() && !m_writing; });
+
+    // The writer is idle until more work is queued
+    if (m_output.is_open())
+      m_output.flush();
+  }
+
+  void SegmentStore::run()
+  {
+    auto lastFlush = chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    while (true)
+    {
+      m_ready.wait_for(lock, g_flushInterval, [this]() { return m_stop || !m_queue.empty(); });
+      if (m_stop && m_queue.empty())
+        break;
+
+      std::deque<Work> work;
+      work.swap(m_queue);
+      m_writing = true;
+
+      // Encode and write without blocking the circular buffer
+      lock.unlock();
+      for (const auto &w : work)
+        write(w);
+
+      auto now = chrono::steady_clock::now();
+      if (now - lastFlush >= g_flushInterval)
+      {
+        if (m_output.is_open())
+          m_output.flush();
+        lastFlush = now;
+      }
+      lock.lock();
+
+      m_writing = false;
+      m_written.notify_all();
+    }
+  }
+
+  void SegmentStore::write(const Work &work)
+  {
+    switch (work.m_type)
+    {
+      case Work::START:
+      {
+        close();
+        m_output.open(work.m_path, ios::binary | ios::out | ios::trunc);
+        if (!m_output.is_open())
+        {
+          LOG(error) << "Cannot create observation segment " << work.m_path;
+          return;
+        }
+        m_outputPath = work.m_path;
+
+        uint32_t count = 0;
+        m_buffer.assign(sizeof(count), '\0');
+        for (const auto &obs : work.m_snapshot)
+        {
+          auto size = m_buffer.size();
+          encode(obs->getSequence(), obs);
+          if (m_buffer.size() > size)
+            count++;
+        }
+        memcpy(m_buffer.data(), &count, sizeof(count));
+        m_output.write(m_buffer.data(), m_buffer.size());
+        break;
+      }
+
+      case Work::APPEND:
+      {
+        if (!m_output.is_open())
+          return;
+
+        m_buffer.clear();
+        encode(work.m_sequence, work.m_observation);
+        if (!m_buffer.empty())
+          m_output.write(m_buffer.data(), m_buffer.size());
+        break;
+      }
+
+      case Work::REMOVE:
+      {
+        if (m_output.is_open() && m_outputPath == work.m_path)
+          close();
+
+        std::error_code ec;
+        fs::remove(work.m_path, ec);
+        if (ec)
+          LOG(warning) << "Cannot remove observation segment " << work.m_path << ": "
+                       << ec.message();
+        break;
+      }
+    }
+  }
+
+  void SegmentStore::close()
+  {
+    if (m_output.is_open())
+      m_output.close();
+    m_outputPath.clear();
+  }
+
+  void SegmentStore::trim()
+  {
+    // Remove the oldest segment if the newer segments retain enough observations
+    while (!m_segments.empty() && m_records - m_segments.front().m_records >= m_retain)
+    {
+      queue({Work::REMOVE, m_segments.front().m_path, 0, nullptr, {}});
+      m_records -= m_segments.front().m_records;
+      m_segments.pop_front();
+    }
+  }
+
+  void SegmentStore::reset()
+  {
+    for (const auto &segment : m_segments)
+      queue({Work::REMOVE, segment.m_path, 0, nullptr, {}});
+    m_segments.clear();
+    m_records = 0;
+    m_segmentStarted = false;
+  }
+
+  void SegmentStore::read(const RecordHandler &handler)
+  {
+    flush();
+    bool snapshot = true;
+    for (const auto &segment : m_segments)
+    {
+      readSegment(segment.m_path, handler, snapshot);
+      snapshot = false;
+    }
+  }
+
+  optional<uint64_t> SegmentStore::getInstanceId() const
+  {
+    ifstream file(m_directory / g_instanceFile);
+    uint64_t id;
+    if (file >> id)
+      return id;
+    else
+      return nullopt;
+  }
+
+  void SegmentStore::setInstanceId(uint64_t id)
+  {
+    ofstream file(m_directory / g_instanceFile, ios::out | ios::trunc);
+    file << id << endl;
+    if (!file)
+      LOG(error) << "Cannot save the instance id in " << m_directory;
+  }
+}  // namespace mtconnect::buffer
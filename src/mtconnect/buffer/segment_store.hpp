@@ -0,0 +1,160 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/observation/observation.hpp"
+
+namespace mtconnect::buffer {
+  /// @brief Append only segment files of encoded observations
+  ///
+  /// Each segment file is named with the sequence number of its first observation, so the
+  /// segments are ordered by sequence number. A segment starts with a snapshot of the checkpoint
+  /// before its first observation, so the oldest segment can be removed without losing the
+  /// observations that have not changed since. The snapshot and the observations are records,
+  /// the size of the record followed by the observation encoded with `ObservationCodec`. New
+  /// observations are always appended to a new segment after the store is opened, so a record
+  /// partially written when the agent stopped is only at the end of a segment and is ignored.
+  ///
+  /// Segments are read through a memory mapping. The oldest segments are removed when the
+  /// remaining segments have at least the number of observations to retain. The instance id of
+  /// the agent is kept in the directory with the segments.
+  ///
+  /// The circular buffer serializes the calls. Starting a segment and appending only queue the
+  /// work, a background writer thread encodes the observations and opens, writes and removes the
+  /// segment files without blocking the circular buffer. The writer flushes the segment file at
+  /// least once a second and when the segment is closed.
+  class AGENT_LIB_API SegmentStore
+  {
+  public:
+    using SequenceNumber = uint64_t;
+    /// @brief Function called with each encoded observation, `snapshot` is `true` for the
+    /// observations in the snapshot of the oldest segment
+    using RecordHandler = std::function<void(const char *data, size_t size, bool snapshot)>;
+
+    /// @brief open a store in a directory, the directory is created if it does not exist
+    /// @param[in] directory the directory for the segment files
+    /// @param[in] retain the minimum number of observations to keep
+    /// @throws std::filesystem::filesystem_error if the directory cannot be created
+    SegmentStore(const std::filesystem::path &directory, size_t retain);
+    ~SegmentStore();
+
+    /// @brief check if the next observation starts a new segment
+    /// @return `true` if `startSegment` should be called before `append`
+    bool needsSegment() const
+    {
+      return !m_segmentStarted || m_segments.back().m_records >= m_segmentSize;
+    }
+    /// @brief start a new segment and remove the segments that are no longer needed
+    /// @param[in] seq the sequence number of the first observation in the segment
+    /// @param[in] snapshot the observations in the checkpoint before `seq`, each condition
+    /// chain from the oldest to the newest
+    void startSegment(SequenceNumber seq, observation::ObservationList snapshot);
+    /// @brief append an observation
+    /// @param[in] seq the sequence number of the observation in the buffer
+    /// @param[in] obs the observation
+    void append(SequenceNumber seq, const observation::ObservationPtr &obs);
+    /// @brief wait until the writer has written the queued work and flush the segment file
+    void flush();
+    /// @brief remove all the segments
+    void reset();
+    /// @brief read the snapshot of the oldest segment and all the observations from the oldest
+    /// to the newest
+    /// @param[in] handler called with each record
+    void read(const RecordHandler &handler);
+
+    /// @brief `true` if there are no records
+    bool empty() const { return m_records == 0; }
+    /// @brief the number of records in the segments
+    size_t size() const { return m_records; }
+
+    /// @brief get the instance id saved with the segments
+    /// @return the instance id if one was saved
+    std::optional<uint64_t> getInstanceId() const;
+    /// @brief save the instance id with the segments
+    /// @param[in] id the instance id
+    void setInstanceId(uint64_t id);
+
+  protected:
+    struct Segment
+    {
+      std::filesystem::path m_path;
+      size_t m_records {0};
+    };
+
+    /// @brief A file operation for the writer thread
+    struct Work
+    {
+      enum Type
+      {
+        START,   ///< open the segment file at `m_path` and write the snapshot
+        APPEND,  ///< write `m_observation` to the open segment
+        REMOVE   ///< remove the segment file at `m_path`
+      };
+
+      Type m_type;
+      std::filesystem::path m_path;
+      SequenceNumber m_sequence {0};
+      observation::ObservationPtr m_observation;
+      observation::ObservationList m_snapshot;
+    };
+
+    std::filesystem::path segmentPath(SequenceNumber seq) const;
+    void queue(Work &&work);
+    void run();
+    void write(const Work &work);
+    void encode(SequenceNumber seq, const observation::ObservationPtr &obs);
+    void close();
+    void trim();
+
+  protected:
+    std::filesystem::path m_directory;
+    size_t m_retain;
+    size_t m_segmentSize;
+
+    // The segments and records as queued by the circular buffer
+    size_t m_records {0};
+    std::deque<Segment> m_segments;
+    bool m_segmentStarted {false};
+
+    // Owned by the writer thread
+    std::ofstream m_output;
+    std::filesystem::path m_outputPath;
+    std::string m_buffer;
+
+    // The work waiting for the writer thread
+    std::mutex m_lock;
+    std::deque<Work> m_queue;
+    bool m_writing {false};
+    bool m_stop {false};
+    std::condition_variable m_ready;
+    std::condition_variable m_written;
+    std::thread m_writer;
+  };
+}  // namespace mtconnect::buffer
@@ -0,0 +1,162 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <boost/circular_buffer.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+
+namespace mtconnect::buffer {
+  /// @brief Secondary index of the sequence numbers of each data item in the circular buffer
+  ///
+  /// Each data item index has a ring of at most `size` sequence numbers, so the memory is bounded
+  /// by the size times the number of data items. When a ring is full the oldest sequence number
+  /// is dropped and the data item is only complete from the sequence after it. The sequence
+  /// numbers are not removed when the circular buffer evicts observations, callers restrict the
+  /// range to the sequences in the buffer.
+  ///
+  /// The index is not thread safe, the circular buffer serializes access.
+  class AGENT_LIB_API SequenceIndex
+  {
+  public:
+    using SequenceNumber = uint64_t;
+
+    /// @brief create a sequence index
+    /// @param[in] size the maximum number of sequence numbers kept for each data item
+    explicit SequenceIndex(size_t size) : m_size(size) {}
+
+    /// @brief add the sequence number of an observation
+    ///
+    /// Sequence numbers must be added in increasing order.
+    ///
+    /// @param[in] index the data item index
+    /// @param[in] seq the sequence number
+    void add(size_t index, SequenceNumber seq)
+    {
+      if (index >= m_entries.size())
+        m_entries.resize(index + 1);
+
+      auto &entry = m_entries[index];
+      if (entry.m_sequences.capacity() == 0)
+        entry.m_sequences.set_capacity(m_size);
+      else if (entry.m_sequences.full())
+        entry.m_completeFrom = entry.m_sequences.front() + 1;
+      entry.m_sequences.push_back(seq);
+    }
+
+    /// @brief remove all the sequence numbers
+    void clear() { m_entries.clear(); }
+
+    /// @brief check if all the sequence numbers of a data item from a sequence number are kept
+    /// @param[in] index the data item index
+    /// @param[in] from the sequence number
+    /// @return `true` if none of the sequence numbers at or after `from` have been dropped
+    bool isComplete(size_t index, SequenceNumber from) const
+    {
+      return index >= m_entries.size() || from >= m_entries[index].m_completeFrom;
+    }
+
+    /// @brief count the sequence numbers of a data item in a range
+    /// @param[in] index the data item index
+    /// @param[in] low the first sequence number
+    /// @param[in] high the last sequence number
+    /// @return the number of sequence numbers in `[low, high]`
+    size_t count(size_t index, SequenceNumber low, SequenceNumber high) const
+    {
+      if (index >= m_entries.size())
+        return 0;
+      const auto &seqs = m_entries[index].m_sequences;
+      auto first = std::lower_bound(seqs.begin(), seqs.end(), low);
+      auto last = std::upper_bound(first, seqs.end(), high);
+      return size_t(last - first);
+    }
+
+    /// @brief visit the sequence numbers of a set of data items in order
+    /// @param[in] indexes the data item indexes
+    /// @param[in] low the first sequence number
+    /// @param[in] high the last sequence number
+    /// @param[in] forward `true` to visit in increasing order
+    /// @param[in] callback called with each sequence number, returns `false` to stop
+    void visit(const std::vector<size_t> &indexes, SequenceNumber low, SequenceNumber high,
+               bool forward, const std::function<bool(SequenceNumber)> &callback) const
+    {
+      using Iterator = boost::circular_buffer<SequenceNumber>::const_iterator;
+      struct Range
+      {
+        Iterator m_first;
+        Iterator m_last;
+      };
+
+      // Merge the ranges of each data item, the next sequence is at the top of the heap
+      std::vector<Range> ranges;
+      for (auto index : indexes)
+      {
+        if (index >= m_entries.size())
+          continue;
+        const auto &seqs = m_entries[index].m_sequences;
+        auto first = std::lower_bound(seqs.begin(), seqs.end(), low);
+        auto last = std::upper_bound(first, seqs.end(), high);
+        if (first != last)
+          ranges.push_back({first, last});
+      }
+
+      auto next = [forward](const Range &range) {
+        return forward ? *range.m_first : *(range.m_last - 1);
+      };
+      auto later = [&](size_t a, size_t b) {
+        return forward ? next(ranges[a]) > next(ranges[b]) : next(ranges[a]) < next(ranges[b]);
+      };
+      std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heap(later);
+      for (size_t i = 0; i < ranges.size(); i++)
+        heap.push(i);
+
+      while (!heap.empty())
+      {
+        auto i = heap.top();
+        heap.pop();
+
+        auto &range = ranges[i];
+        if (!callback(next(range)))
+          return;
+
+        if (forward)
+          range.m_first++;
+        else
+          range.m_last--;
+        if (range.m_first != range.m_last)
+          heap.push(i);
+      }
+    }
+
+  protected:
+    struct Entry
+    {
+      boost::circular_buffer<SequenceNumber> m_sequences;
+      SequenceNumber m_completeFrom {0};
+    };
+
+    size_t m_size;
+    std::vector<Entry> m_entries;
+  };
+}  // namespace mtconnect::buffer
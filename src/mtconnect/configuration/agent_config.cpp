@@ -756,6 +756,11 @@ namespace mtconnect::configuration {
                 {configuration::BufferSize, int(DEFAULT_SLIDING_BUFFER_EXP)},
                 {configuration::MaxAssets, int(DEFAULT_MAX_ASSETS)},
                 {configuration::CheckpointFrequency, 1000},
+                {configuration::LockFreeBuffer, false},
+                {configuration::SequenceIndexSize, 0},
+                {configuration::PersistentBuffer, ""s},
+                {configuration::TieredBuffer, ""s},
+                {configuration::TieredBufferSize, 16777216},
                 {configuration::LegacyTimeout, 600s},
                 {configuration::CreateUniqueIds, false},
                 {configuration::ReconnectInterval, 10000ms},
@@ -774,6 +779,10 @@ namespace mtconnect::configuration {
                 {configuration::Port, 5000},
                 {configuration::MaxCachedFileSize, "20k"s},
                 {configuration::MinCompressFileSize, "100k"s},
+                {configuration::HttpAcceptors, 1},
+                {configuration::HttpCompression, true},
+                {configuration::HttpCompressionLevel, 6},
+                {configuration::HttpMinCompressSize, "1k"s},
                 {configuration::ServiceName, "MTConnect Agent"s},
                 {configuration::SchemaVersion, ""s},
                 {configuration::LogStreams, false},
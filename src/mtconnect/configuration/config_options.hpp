@@ -49,8 +49,13 @@ namespace mtconnect {
     DECLARE_CONFIGURATION(BufferSize);
     DECLARE_CONFIGURATION(CheckpointFrequency);
     DECLARE_CONFIGURATION(Devices);
+    DECLARE_CONFIGURATION(HttpAcceptors);
+    DECLARE_CONFIGURATION(HttpCompression);
+    DECLARE_CONFIGURATION(HttpCompressionLevel);
     DECLARE_CONFIGURATION(HttpHeaders);
+    DECLARE_CONFIGURATION(HttpMinCompressSize);
     DECLARE_CONFIGURATION(JsonVersion);
+    DECLARE_CONFIGURATION(LockFreeBuffer);
     DECLARE_CONFIGURATION(LogStreams);
     DECLARE_CONFIGURATION(MaxAssets);
     DECLARE_CONFIGURATION(MaxCachedFileSize);
@@ -58,13 +63,17 @@ namespace mtconnect {
     DECLARE_CONFIGURATION(MinimumConfigReloadAge);
     DECLARE_CONFIGURATION(MonitorConfigFiles);
     DECLARE_CONFIGURATION(MonitorInterval);
+    DECLARE_CONFIGURATION(PersistentBuffer);
     DECLARE_CONFIGURATION(PidFile);
     DECLARE_CONFIGURATION(Port);
     DECLARE_CONFIGURATION(Pretty);
     DECLARE_CONFIGURATION(SchemaVersion);
+    DECLARE_CONFIGURATION(SequenceIndexSize);
     DECLARE_CONFIGURATION(ServerIp);
     DECLARE_CONFIGURATION(ServiceName);
     DECLARE_CONFIGURATION(Sender);
+    DECLARE_CONFIGURATION(TieredBuffer);
+    DECLARE_CONFIGURATION(TieredBufferSize);
     DECLARE_CONFIGURATION(TlsCertificateChain);
     DECLARE_CONFIGURATION(TlsCertificatePassword);
     DECLARE_CONFIGURATION(TlsClientCAs);
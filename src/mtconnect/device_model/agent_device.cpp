@@ -159,6 +159,34 @@ namespace mtconnect {
       }
     }
 
+    void AgentDevice::addChunkCache(const std::string &id)
+    {
+      using namespace entity;
+      using namespace device_model::data_item;
+
+      {
+        ErrorList errors;
+        auto di = DataItem::make({{"type", "CHUNK_CACHE_HIT_RATE"s},
+                                  {"id", id + "_hit_rate"s},
+                                  {"units", "COUNT/SECOND"s},
+                                  {"statistic", "AVERAGE"s},
+                                  {"category", "SAMPLE"s}},
+                                 errors);
+        addDataItem(di, errors);
+      }
+
+      {
+        ErrorList errors;
+        auto di = DataItem::make({{"type", "CHUNK_CACHE_MISS_RATE"s},
+                                  {"id", id + "_miss_rate"s},
+                                  {"units", "COUNT/SECOND"s},
+                                  {"statistic", "AVERAGE"s},
+                                  {"category", "SAMPLE"s}},
+                                 errors);
+        addDataItem(di, errors);
+      }
+    }
+
     void AgentDevice::addRequiredDataItems()
     {
       using namespace entity;
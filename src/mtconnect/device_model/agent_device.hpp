@@ -57,6 +57,10 @@ namespace mtconnect {
       /// @param adapter the adapter
       void addAdapter(const source::adapter::AdapterPtr adapter);
 
+      /// @brief Add the data items for the hit and miss rates of a REST sink chunk cache
+      /// @param id the prefix of the data item ids
+      void addChunkCache(const std::string &id);
+
       /// @brief get the connection status data item for an addapter
       /// @param adapter the adapter name
       /// @return shared pointer to the data item
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <limits>
 #include <map>
 
 #include "constraints.hpp"
@@ -45,7 +46,7 @@ namespace mtconnect {
     /// @brief DataItem related entities
     namespace data_item {
       /// @brief Data Item entity
-      class AGENT_LIB_API DataItem : public entity::Entity, public observation::ChangeSignaler
+      class AGENT_LIB_API DataItem : public entity::Entity
       {
       public:
         /// @brief MTConnect DataItem Enumeration for category
@@ -86,6 +87,9 @@ namespace mtconnect {
         static entity::FactoryPtr getFactory();
         static entity::FactoryPtr getRoot();
 
+        /// @brief the index of a data item that has not been given one
+        static constexpr size_t NoIndex = std::numeric_limits<uint32_t>::max();
+
         /// @brief make method to create
         /// @param[in] props data item properties
         /// @param[in,out] errors list of errors creating the data item
@@ -106,6 +110,17 @@ namespace mtconnect {
 
         /// @brief get the data item id
         const auto &getId() const { return m_id; }
+        /// @brief get the dense index of the data item id
+        ///
+        /// The agent gives every data item id a small integer index when it initializes the data
+        /// items of a device. Data items with the same id share the index, so it is stable when a
+        /// device is updated.
+        ///
+        /// @return the index or `NoIndex` if it has not been assigned
+        size_t getIndex() const { return m_index; }
+        /// @brief set the dense index of the data item id
+        /// @param[in] index the index
+        void setIndex(size_t index) { m_index = index; }
         /// @brief get the data item name
         const auto &getName() const { return m_name; }
         /// @brief get the data item source
@@ -277,6 +292,7 @@ namespace mtconnect {
       protected:
         // Unique ID for each component
         std::string m_id;
+        size_t m_index {NoIndex};
         std::optional<std::string> m_originalId;
 
         // Name for itself
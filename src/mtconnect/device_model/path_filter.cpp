@@ -0,0 +1,592 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "path_filter.hpp"
+
+#include <cctype>
+#include <set>
+#include <tuple>
+
+#include "device.hpp"
+#include "mtconnect/entity/entity.hpp"
+#include "mtconnect/entity/requirement.hpp"
+#include "mtconnect/logging.hpp"
+
+using namespace std;
+
+namespace mtconnect {
+  using namespace entity;
+  namespace device_model {
+    namespace {
+      /// @brief Recursive descent parser for the supported XPath subset
+      class PathParser
+      {
+      public:
+        PathParser(string_view text) : m_text(text) {}
+
+        bool parse(vector<PathFilter::Path> &paths)
+        {
+          do
+          {
+            skipSpace();
+            auto &path = paths.emplace_back();
+            if (!parsePath(path))
+              return false;
+            skipSpace();
+          } while (accept('|'));
+
+          return m_pos == m_text.size();
+        }
+
+      protected:
+        bool atEnd() const { return m_pos >= m_text.size(); }
+
+        void skipSpace()
+        {
+          while (!atEnd() && isspace(static_cast<unsigned char>(m_text[m_pos])))
+            m_pos++;
+        }
+
+        bool accept(string_view token)
+        {
+          if (m_text.substr(m_pos, token.size()) == token)
+          {
+            m_pos += token.size();
+            return true;
+          }
+          return false;
+        }
+
+        bool accept(char c)
+        {
+          if (!atEnd() && m_text[m_pos] == c)
+          {
+            m_pos++;
+            return true;
+          }
+          return false;
+        }
+
+        static bool isNameChar(char c)
+        {
+          return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-' || c == '.';
+        }
+
+        /// @brief Parse a name without a namespace prefix
+        bool parseName(string &name)
+        {
+          auto start = m_pos;
+          if (atEnd() ||
+              !(isalpha(static_cast<unsigned char>(m_text[m_pos])) || m_text[m_pos] == '_'))
+            return false;
+          while (!atEnd() && isNameChar(m_text[m_pos]))
+            m_pos++;
+
+          // Prefixed names and functions are left to the XML parser
+          if (!atEnd() && (m_text[m_pos] == ':' || m_text[m_pos] == '('))
+            return false;
+
+          name = string(m_text.substr(start, m_pos - start));
+          return true;
+        }
+
+        bool keyword(string_view word)
+        {
+          skipSpace();
+          if (m_text.substr(m_pos, word.size()) == word &&
+              (m_pos + word.size() >= m_text.size() || !isNameChar(m_text[m_pos + word.size()])))
+          {
+            m_pos += word.size();
+            return true;
+          }
+          return false;
+        }
+
+        bool parsePath(PathFilter::Path &path)
+        {
+          bool descendant = false;
+          if (accept("//"))
+          {
+            path.m_absolute = true;
+            descendant = true;
+          }
+          else if (accept('/'))
+          {
+            path.m_absolute = true;
+          }
+
+          do
+          {
+            auto &step = path.m_steps.emplace_back();
+            step.m_descendant = descendant;
+            if (accept('*'))
+              step.m_name = "*";
+            else if (!parseName(step.m_name))
+              return false;
+
+            while (accept('['))
+            {
+              auto &condition = step.m_predicates.emplace_back();
+              if (!parseOr(condition))
+                return false;
+              skipSpace();
+              if (!accept(']'))
+                return false;
+            }
+
+            if (accept("//"))
+              descendant = true;
+            else if (accept('/'))
+              descendant = false;
+            else
+              break;
+          } while (true);
+
+          return true;
+        }
+
+        bool parseOr(PathFilter::Condition &condition)
+        {
+          PathFilter::Condition first;
+          if (!parseAnd(first))
+            return false;
+          if (!keyword("or"))
+          {
+            condition = std::move(first);
+            return true;
+          }
+
+          condition.m_operation = PathFilter::Condition::OR;
+          condition.m_operands.emplace_back(std::move(first));
+          do
+          {
+            if (!parseAnd(condition.m_operands.emplace_back()))
+              return false;
+          } while (keyword("or"));
+
+          return true;
+        }
+
+        bool parseAnd(PathFilter::Condition &condition)
+        {
+          PathFilter::Condition first;
+          if (!parsePrimary(first))
+            return false;
+          if (!keyword("and"))
+          {
+            condition = std::move(first);
+            return true;
+          }
+
+          condition.m_operation = PathFilter::Condition::AND;
+          condition.m_operands.emplace_back(std::move(first));
+          do
+          {
+            if (!parsePrimary(condition.m_operands.emplace_back()))
+              return false;
+          } while (keyword("and"));
+
+          return true;
+        }
+
+        bool parsePrimary(PathFilter::Condition &condition)
+        {
+          skipSpace();
+          if (accept('('))
+          {
+            if (!parseOr(condition))
+              return false;
+            skipSpace();
+            return accept(')');
+          }
+
+          if (!accept('@') || !parseName(condition.m_attribute))
+            return false;
+
+          skipSpace();
+          if (accept("!="))
+            condition.m_operation = PathFilter::Condition::NOT_EQUAL;
+          else if (accept('='))
+            condition.m_operation = PathFilter::Condition::EQUAL;
+          else
+          {
+            condition.m_operation = PathFilter::Condition::EXISTS;
+            return true;
+          }
+
+          skipSpace();
+          if (atEnd() || (m_text[m_pos] != '\'' && m_text[m_pos] != '"'))
+            return false;
+          auto quote = m_text[m_pos++];
+          auto end = m_text.find(quote, m_pos);
+          if (end == string_view::npos)
+            return false;
+
+          condition.m_value = string(m_text.substr(m_pos, end - m_pos));
+          m_pos = end + 1;
+
+          return true;
+        }
+
+      protected:
+        string_view m_text;
+        size_t m_pos {0};
+      };
+    }  // namespace
+
+    PathFilterPtr PathFilter::compile(string_view path)
+    {
+      auto filter = make_shared<PathFilter>();
+      PathParser parser(path);
+      if (!parser.parse(filter->m_paths))
+        return nullptr;
+
+      return filter;
+    }
+
+    namespace {
+      /// @brief An element of the probe document
+      ///
+      /// The document, `MTConnectDevices`, and `Devices` elements are not entities. The `Header`
+      /// is left out since it cannot contain data items.
+      struct PathNode
+      {
+        enum Kind : uint8_t
+        {
+          DOCUMENT,
+          ROOT,
+          DEVICES,
+          ENTITY
+        };
+
+        Kind m_kind;
+        const Entity *m_entity {nullptr};
+
+        bool operator<(const PathNode &o) const
+        {
+          return tie(m_kind, m_entity) < tie(o.m_kind, o.m_entity);
+        }
+      };
+
+      /// @brief Navigates the device model as the elements of the probe document
+      class PathDocument
+      {
+      public:
+        PathDocument(const list<DevicePtr> &devices) : m_devices(devices) {}
+
+        /// @brief Call `f` with each child element of the node
+        template <typename F>
+        void forEachChild(const PathNode &node, F &&f) const
+        {
+          switch (node.m_kind)
+          {
+            case PathNode::DOCUMENT:
+              f(PathNode {PathNode::ROOT});
+              break;
+
+            case PathNode::ROOT:
+              f(PathNode {PathNode::DEVICES});
+              break;
+
+            case PathNode::DEVICES:
+              for (const auto &device : m_devices)
+                f(PathNode {PathNode::ENTITY, device.get()});
+              break;
+
+            case PathNode::ENTITY:
+            {
+              // Entities are printed as elements the same way as entity::XmlPrinter
+              const auto &attrs = node.m_entity->getAttributes();
+              for (const auto &[key, value] : node.m_entity->getProperties())
+              {
+                if (islower(key.getName()[0]) || attrs.count(key) > 0)
+                  continue;
+
+                if (holds_alternative<EntityPtr>(value))
+                {
+                  f(PathNode {PathNode::ENTITY, get<EntityPtr>(value).get()});
+                }
+                else if (holds_alternative<EntityList>(value))
+                {
+                  for (const auto &entity : get<EntityList>(value))
+                    f(PathNode {PathNode::ENTITY, entity.get()});
+                }
+              }
+              break;
+            }
+          }
+        }
+
+        /// @brief Call `f` with each descendant element of the node in document order
+        template <typename F>
+        void forEachDescendant(const PathNode &node, F &&f) const
+        {
+          forEachChild(node, [this, &f](const PathNode &child) {
+            f(child);
+            forEachDescendant(child, f);
+          });
+        }
+
+        /// @brief The qualified name of the element
+        string_view name(const PathNode &node) const
+        {
+          switch (node.m_kind)
+          {
+            case PathNode::ROOT:
+              return "MTConnectDevices";
+
+            case PathNode::DEVICES:
+              return "Devices";
+
+            case PathNode::ENTITY:
+              return node.m_entity->getName();
+
+            default:
+              return string_view();
+          }
+        }
+
+        /// @brief The name of the element without the namespace
+        string_view localName(const PathNode &node) const
+        {
+          if (node.m_kind == PathNode::ENTITY)
+            return node.m_entity->getName().getName();
+          else
+            return name(node);
+        }
+
+        /// @brief Get the text of an attribute
+        /// @return `false` if the element does not have the attribute
+        bool attribute(const PathNode &node, const string &name, string &text) const
+        {
+          if (node.m_kind != PathNode::ENTITY || node.m_entity->isHidden(name))
+            return false;
+
+          const auto &properties = node.m_entity->getProperties();
+          auto it = properties.find(name);
+          if (it == properties.end())
+            return false;
+
+          const auto &key = it->first;
+          if (!islower(key.getName()[0]) && node.m_entity->getAttributes().count(key) == 0)
+            return false;
+
+          const auto &value = it->second;
+          if (holds_alternative<string>(value))
+          {
+            text = get<string>(value);
+            return true;
+          }
+          else if (holds_alternative<EntityPtr>(value) || holds_alternative<EntityList>(value) ||
+                   holds_alternative<DataSet>(value))
+          {
+            return false;
+          }
+
+          Value converted = value;
+          ConvertValueToType(converted, ValueType::STRING);
+          text = get<string>(converted);
+          return true;
+        }
+
+        bool test(const PathNode &node, const PathFilter::Condition &condition) const
+        {
+          using Condition = PathFilter::Condition;
+          switch (condition.m_operation)
+          {
+            case Condition::AND:
+              for (const auto &c : condition.m_operands)
+                if (!test(node, c))
+                  return false;
+              return true;
+
+            case Condition::OR:
+              for (const auto &c : condition.m_operands)
+                if (test(node, c))
+                  return true;
+              return false;
+
+            default:
+            {
+              string text;
+              if (!attribute(node, condition.m_attribute, text))
+                return false;
+              if (condition.m_operation == Condition::EQUAL)
+                return text == condition.m_value;
+              if (condition.m_operation == Condition::NOT_EQUAL)
+                return text != condition.m_value;
+              return true;
+            }
+          }
+        }
+
+        bool matches(const PathNode &node, const PathFilter::Step &step) const
+        {
+          if (node.m_kind == PathNode::DOCUMENT)
+            return false;
+          if (step.m_name != "*" && name(node) != step.m_name)
+            return false;
+
+          for (const auto &predicate : step.m_predicates)
+            if (!test(node, predicate))
+              return false;
+
+          return true;
+        }
+
+        /// @brief Add the data items for a selected element the same as `XmlParser::getDataItems()`
+        void collect(const PathNode &node, FilterSet &filter, set<string> &components) const
+        {
+          auto element = localName(node);
+          string id;
+          if (element == "DataItem")
+          {
+            if (attribute(node, "id", id))
+              filter.insert(id);
+          }
+          else if (element == "DataItems")
+          {
+            forEachChild(node, [&](const PathNode &child) {
+              if (localName(child) == "DataItem" && attribute(child, "id", id))
+                filter.insert(id);
+            });
+          }
+          else if (element == "Reference")
+          {
+            if (attribute(node, "dataItemId", id) && !id.empty())
+              filter.insert(id);
+          }
+          else if (element == "DataItemRef")
+          {
+            if (attribute(node, "idRef", id) && !id.empty())
+              filter.insert(id);
+          }
+          else if (element == "ComponentRef")
+          {
+            // Each referenced component is only visited once to prevent cycles
+            if (attribute(node, "idRef", id) && !id.empty() && components.insert(id).second)
+            {
+              forEachDescendant(PathNode {PathNode::DOCUMENT}, [&](const PathNode &n) {
+                string other;
+                if (attribute(n, "id", other) && other == id)
+                  collect(n, filter, components);
+              });
+            }
+          }
+          else
+          {
+            // Find all the data items and references below this node
+            forEachChild(node, [&](const PathNode &child) {
+              forEachDescendant(child, [&](const PathNode &n) {
+                auto name = localName(n);
+                if (name == "DataItem" || name == "Reference" || name == "DataItemRef" ||
+                    name == "ComponentRef")
+                  collect(n, filter, components);
+              });
+            });
+          }
+        }
+
+      protected:
+        const list<DevicePtr> &m_devices;
+      };
+    }  // namespace
+
+    void PathFilter::getDataItems(const list<DevicePtr> &devices, FilterSet &filter) const
+    {
+      PathDocument document(devices);
+      set<PathNode> selected;
+      set<string> components;
+
+      for (const auto &path : m_paths)
+      {
+        // Relative paths start at the MTConnectDevices element
+        vector<PathNode> context {PathNode {path.m_absolute ? PathNode::DOCUMENT : PathNode::ROOT}};
+        for (const auto &step : path.m_steps)
+        {
+          vector<PathNode> next;
+          set<PathNode> seen;
+          auto visit = [&](const PathNode &node) {
+            if (document.matches(node, step) && seen.insert(node).second)
+              next.emplace_back(node);
+          };
+
+          for (const auto &node : context)
+          {
+            if (step.m_descendant)
+              document.forEachDescendant(node, visit);
+            else
+              document.forEachChild(node, visit);
+          }
+          context.swap(next);
+        }
+
+        for (const auto &node : context)
+        {
+          if (selected.insert(node).second)
+            document.collect(node, filter, components);
+        }
+      }
+    }
+
+    bool PathFilterCache::getDataItems(const string &path, FilterSet &filter)
+    {
+      uint64_t version;
+      list<DevicePtr> devices;
+      {
+        lock_guard<mutex> lock(m_mutex);
+        auto it = m_results.find(path);
+        if (it != m_results.end())
+        {
+          if (!it->second)
+            return false;
+          filter.insert(it->second->begin(), it->second->end());
+          return true;
+        }
+        version = m_version;
+        devices = m_devices;
+      }
+
+      optional<FilterSet> result;
+      if (auto compiled = PathFilter::compile(path))
+      {
+        result.emplace();
+        compiled->getDataItems(devices, *result);
+      }
+      else
+      {
+        LOG(debug) << "Path is not supported by the path filter: " << path;
+      }
+
+      {
+        lock_guard<mutex> lock(m_mutex);
+        if (version == m_version)
+        {
+          if (m_results.size() >= m_maxSize)
+            m_results.clear();
+          m_results.emplace(path, result);
+        }
+      }
+
+      if (!result)
+        return false;
+
+      filter.insert(result->begin(), result->end());
+      return true;
+    }
+  }  // namespace device_model
+}  // namespace mtconnect
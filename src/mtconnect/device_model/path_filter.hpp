@@ -0,0 +1,152 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/utilities.hpp"
+
+namespace mtconnect {
+  namespace device_model {
+    class Device;
+    using DevicePtr = std::shared_ptr<Device>;
+
+    class PathFilter;
+    using PathFilterPtr = std::shared_ptr<PathFilter>;
+
+    /// @brief Selects data items with the subset of XPath used for the `path` parameter
+    ///
+    /// The path is evaluated on the device model as if it were the probe document. This avoids
+    /// printing and parsing the document. The supported subset is:
+    /// - absolute and relative location paths with `/` and `//` steps
+    /// - element names and `*`, without namespace prefixes
+    /// - attribute predicates, such as `[@type="POSITION"]`, `[@id!='x']`, and `[@name]`,
+    ///   combined with `and`, `or`, and parentheses
+    /// - unions of paths separated by `|`
+    ///
+    /// `compile()` returns `nullptr` for anything else so the caller can fall back to a full
+    /// XPath implementation.
+    class AGENT_LIB_API PathFilter
+    {
+    public:
+      /// @brief Compile a path
+      /// @param[in] path the XPath expression
+      /// @return the compiled path or `nullptr` if the path is not in the supported subset
+      static PathFilterPtr compile(std::string_view path);
+
+      /// @brief Find the data items selected by the path
+      ///
+      /// The elements selected are treated the same as the XML parser: `DataItem` and
+      /// references add their ids, `ComponentRef` adds the data items of the referenced
+      /// component, and other elements add all the data items and references below them.
+      ///
+      /// @param[in] devices the devices, including the agent device
+      /// @param[out] filter the ids of the data items
+      void getDataItems(const std::list<DevicePtr> &devices, FilterSet &filter) const;
+
+      /// @brief A predicate condition on the attributes of an element
+      struct Condition
+      {
+        enum Operation : uint8_t
+        {
+          EXISTS,     ///< `@attribute`
+          EQUAL,      ///< `@attribute='value'`
+          NOT_EQUAL,  ///< `@attribute!='value'`
+          AND,        ///< all operands are true
+          OR          ///< any operand is true
+        };
+
+        Operation m_operation {EXISTS};
+        std::string m_attribute;
+        std::string m_value;
+        std::vector<Condition> m_operands;
+      };
+
+      /// @brief One step of a location path
+      struct Step
+      {
+        bool m_descendant {false};  ///< `true` for `//`, `false` for `/`
+        std::string m_name;         ///< the element name or `*`
+        std::vector<Condition> m_predicates;
+      };
+
+      /// @brief A location path
+      struct Path
+      {
+        bool m_absolute {false};  ///< `true` if the path starts from the document
+        std::vector<Step> m_steps;
+      };
+
+    protected:
+      std::vector<Path> m_paths;
+    };
+
+    /// @brief Memoizes the data items selected by paths for a version of the device model
+    ///
+    /// The cache keeps the devices of the current model version. The results for a path are
+    /// kept until the model changes. Paths that cannot be compiled are remembered as well so
+    /// they are only parsed once.
+    class AGENT_LIB_API PathFilterCache
+    {
+    public:
+      /// @brief Create a cache
+      /// @param[in] maxSize the number of paths to remember before the cache is cleared
+      PathFilterCache(size_t maxSize = 1024) : m_maxSize(maxSize) {}
+
+      /// @brief Get the data items selected by a path
+      /// @param[in] path the XPath expression
+      /// @param[out] filter the ids of the data items
+      /// @return `false` if the path is not in the subset supported by `PathFilter`
+      bool getDataItems(const std::string &path, FilterSet &filter);
+
+      /// @brief Forget the results when the device model changes
+      /// @param[in] devices the new devices, including the agent device
+      void modelChanged(const std::list<DevicePtr> &devices)
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_version++;
+        m_devices = devices;
+        m_results.clear();
+      }
+
+      /// @brief Get the version of the device model
+      /// @return the number of times the model has changed
+      uint64_t getModelVersion() const
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_version;
+      }
+
+    protected:
+      mutable std::mutex m_mutex;
+      uint64_t m_version {0};
+      size_t m_maxSize;
+      std::list<DevicePtr> m_devices;
+      std::unordered_map<std::string, std::optional<FilterSet>> m_results;
+    };
+  }  // namespace device_model
+}  // namespace mtconnect
@@ -149,6 +149,17 @@ namespace mtconnect {
       /// @brief get a const reference to the properties
       /// @return properties
       const Properties &getProperties() const { return m_properties; }
+      /// @brief get all the properties including the ones derived from the entity's state
+      ///
+      /// Some entities, like observations, keep properties outside of the property map. This
+      /// method is used by the printers and scripts when they need the complete property set.
+      ///
+      /// @param[out] scratch storage used if the properties need to be merged
+      /// @return the properties or `scratch` if derived properties were added
+      virtual const Properties &getAllProperties(Properties &scratch) const
+      {
+        return m_properties;
+      }
       /// @brief get a property for a ley
       /// @param n the key
       /// @return The property or a Value with std::monstate() if not found
@@ -157,7 +168,10 @@ namespace mtconnect {
         static Value noValue {std::monostate()};
         auto it = m_properties.find(n);
         if (it == m_properties.end())
-          return noValue;
+        {
+          auto derived = getDerivedProperty(n);
+          return derived ? *derived : noValue;
+        }
         else
           return it->second;
       }
@@ -176,7 +190,7 @@ namespace mtconnect {
       /// @return `true` if the property exists
       bool hasProperty(const std::string &n) const
       {
-        return m_properties.find(n) != m_properties.end();
+        return m_properties.find(n) != m_properties.end() || getDerivedProperty(n) != nullptr;
       }
       /// @brief checks if there is a `VALUE` property
       /// @return `true` if there is a `VALUE`
@@ -317,7 +331,11 @@ namespace mtconnect {
       template <typename T>
       const std::optional<T> maybeGet(const std::string &name) const
       {
-        return OptionallyGet<T>(name, m_properties);
+        auto &v = getProperty(name);
+        if (std::holds_alternative<std::monostate>(v))
+          return std::nullopt;
+        else
+          return std::get<T>(v);
       }
       /// @brief gets `VALUE` property if it exists
       /// @tparam T the property type
@@ -422,6 +440,13 @@ namespace mtconnect {
         hash(sha1, skip);
       }
 
+      /// @brief Get a property that is not held in the property map
+      ///
+      /// Subclasses that derive properties from their state override this method.
+      /// @param[in] name the key
+      /// @return a pointer to the value or `nullptr` if there is no derived property
+      virtual const Value *getDerivedProperty(const std::string &name) const { return nullptr; }
+
       Value &getProperty_(const std::string &name)
       {
         static Value noValue {std::monostate()};
@@ -133,7 +133,8 @@ namespace mtconnect::entity {
 
       PropertyVisitor visitor {m_writer, *this, obj, entity};
 
-      for (auto &prop : entity->getProperties())
+      Properties scratch;
+      for (auto &prop : entity->getAllProperties(scratch))
       {
         if (m_includeHidden || !entity->isHidden(prop.first))
         {
@@ -143,6 +144,95 @@ namespace mtconnect::entity {
       }
     }
 
+    /// @brief create a json object from an entity with preformatted properties
+    ///
+    /// Cover method for `printEntity()` with fragments
+    ///
+    /// @param entity the entity
+    /// @param fragments the preformatted properties
+    /// @param extra properties that are not held by the entity
+    template <typename F, typename E>
+    void print(const EntityPtr entity, const F &fragments, const E &extra)
+    {
+      AutoJsonObject obj(m_writer);
+      obj.Key(entity->getName());
+      printEntity(entity, fragments, extra);
+    }
+
+    /// @brief Convert properties of an entity into a json object splicing in preformatted
+    ///        properties
+    ///
+    /// The fragments hold a key (`m_key`) and the key and value already written as json strings
+    /// (`m_jsonKey` and `m_jsonValue`). The entity's properties, the fragments, and the extra
+    /// properties are each sorted by key and are merged in order. If a key is in more than one,
+    /// the entity's property is written before the fragment and the fragment before the extra
+    /// property.
+    ///
+    /// @param entity the entity
+    /// @param fragments the preformatted properties
+    /// @param extra properties that are not held by the entity
+    /// @tparam F Type of iterable collection of fragments
+    /// @tparam E Type of iterable collection of `Property`
+    template <typename F, typename E>
+    void printEntity(const EntityPtr entity, const F &fragments, const E &extra)
+    {
+      std::optional<AutoJsonObject<T>> obj;
+      if (!entity->isSimpleList())
+        obj.emplace(m_writer);
+
+      PropertyVisitor visitor {m_writer, *this, obj, entity};
+
+      const auto &properties = entity->getProperties();
+      auto prop = properties.begin();
+      auto fragment = fragments.begin();
+      auto ext = extra.begin();
+      while (true)
+      {
+        const std::string *key = nullptr;
+        if (prop != properties.end())
+          key = &prop->first;
+        if (fragment != fragments.end() && (key == nullptr || fragment->m_key < *key))
+          key = &fragment->m_key;
+        if (ext != extra.end() && (key == nullptr || ext->first < *key))
+          key = &ext->first;
+        if (key == nullptr)
+          break;
+
+        bool written = false;
+        if (prop != properties.end() && prop->first == *key)
+        {
+          if (m_includeHidden || !entity->isHidden(prop->first))
+          {
+            visitor.m_key = &prop->first;
+            visit(visitor, prop->second);
+          }
+          written = true;
+          prop++;
+        }
+        if (fragment != fragments.end() && fragment->m_key == *key)
+        {
+          if (!written)
+          {
+            m_writer.RawValue(fragment->m_jsonKey.data(), fragment->m_jsonKey.size(),
+                              rapidjson::kStringType);
+            m_writer.RawValue(fragment->m_jsonValue.data(), fragment->m_jsonValue.size(),
+                              rapidjson::kStringType);
+          }
+          written = true;
+          fragment++;
+        }
+        if (ext != extra.end() && ext->first == *key)
+        {
+          if (!written)
+          {
+            visitor.m_key = &ext->first;
+            visit(visitor, ext->second);
+          }
+          ext++;
+        }
+      }
+    }
+
     /// @brief Helper method to serialize a list entity list using json version 1 format
     /// @param[in] list a list of EntityPtr objects
     /// @tparam T2 Type of iterable collection must contain Entity subclass
@@ -0,0 +1,218 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "pool_allocator.hpp"
+
+#include <array>
+
+using namespace std;
+
+namespace mtconnect::entity {
+  // Slabs are about 64k so small blocks do not take a trip to the heap too often
+  static constexpr size_t SlabSize = 64 * 1024;
+  // The most free blocks a thread keeps for each size class and how many move at a time
+  static constexpr size_t CacheLimit = 64;
+  static constexpr size_t CacheBatch = CacheLimit / 2;
+
+  // The pools are never destroyed so blocks can be released by threads and static objects that
+  // go away after the pools would have.
+  static array<BlockPool *, BlockPool::SizeClasses> &pools()
+  {
+    static array<BlockPool *, BlockPool::SizeClasses> *pools = [] {
+      auto p = new array<BlockPool *, BlockPool::SizeClasses>();
+      for (size_t i = 0; i < BlockPool::SizeClasses; i++)
+        (*p)[i] = new BlockPool((i + 1) * BlockPool::Granularity, i);
+      return p;
+    }();
+    return *pools;
+  }
+
+  // Set when the thread's cache is destroyed, a trivially destructible thread local stays valid
+  // for the blocks released by the static destructors that run after the cache is gone
+  static thread_local bool t_exited {false};
+
+  /// @brief per thread free lists, returned to the pools when the thread exits
+  struct ThreadBlockCache
+  {
+    ~ThreadBlockCache()
+    {
+      auto &all = pools();
+      for (size_t i = 0; i < BlockPool::SizeClasses; i++)
+      {
+        if (m_heads[i] != nullptr)
+          all[i]->release(m_heads[i], tail(i));
+        m_heads[i] = nullptr;
+      }
+      t_exited = true;
+    }
+
+    BlockPool::FreeBlock *tail(size_t i)
+    {
+      auto block = m_heads[i];
+      while (block->m_next != nullptr)
+        block = block->m_next;
+      return block;
+    }
+
+    array<BlockPool::FreeBlock *, BlockPool::SizeClasses> m_heads {};
+    array<size_t, BlockPool::SizeClasses> m_counts {};
+  };
+
+  static thread_local ThreadBlockCache t_cache;
+
+  BlockPool::BlockPool(size_t blockSize, size_t index)
+    : m_blockSize(blockSize), m_index(index), m_blocksPerSlab(max<size_t>(16, SlabSize / blockSize))
+  {}
+
+  BlockPool::~BlockPool()
+  {
+    for (auto slab : m_slabs)
+      ::operator delete(slab);
+  }
+
+  BlockPool &BlockPool::forSize(size_t size)
+  {
+    auto index = size == 0 ? 0 : (size + Granularity - 1) / Granularity - 1;
+    return *pools()[index];
+  }
+
+  void *BlockPool::allocate()
+  {
+    m_allocations.fetch_add(1, memory_order_relaxed);
+
+    if (t_exited)
+      return refill();
+
+    auto &head = t_cache.m_heads[m_index];
+    if (head == nullptr)
+      return refill();
+
+    auto block = head;
+    head = block->m_next;
+    t_cache.m_counts[m_index]--;
+    return block;
+  }
+
+  void BlockPool::deallocate(void *p)
+  {
+    m_releases.fetch_add(1, memory_order_relaxed);
+
+    auto block = static_cast<FreeBlock *>(p);
+    if (t_exited)
+    {
+      block->m_next = nullptr;
+      release(block, block);
+      return;
+    }
+
+    auto &head = t_cache.m_heads[m_index];
+    auto &count = t_cache.m_counts[m_index];
+    block->m_next = head;
+    head = block;
+    count++;
+
+    // Give half the cache back so a thread that only releases, like the one evicting from the
+    // circular buffer, does not hold on to the blocks the ingest threads need.
+    if (count > CacheLimit)
+    {
+      auto first = head;
+      auto last = head;
+      for (size_t i = 1; i < CacheBatch; i++)
+        last = last->m_next;
+      head = last->m_next;
+      last->m_next = nullptr;
+      count -= CacheBatch;
+      release(first, last);
+    }
+  }
+
+  void *BlockPool::refill()
+  {
+    // Take a batch from the shared free list, or cut a new slab, and keep the rest in the cache
+    FreeBlock *first {nullptr};
+    FreeBlock *last {nullptr};
+    size_t count {0};
+    {
+      lock_guard<mutex> lock(m_mutex);
+      if (m_free == nullptr)
+      {
+        auto slab = static_cast<char *>(::operator new(m_blockSize * m_blocksPerSlab));
+        m_slabs.push_back(slab);
+        for (size_t i = m_blocksPerSlab; i > 0; i--)
+        {
+          auto block = reinterpret_cast<FreeBlock *>(slab + (i - 1) * m_blockSize);
+          block->m_next = m_free;
+          m_free = block;
+        }
+      }
+
+      first = m_free;
+      last = first;
+      count = 1;
+      while (count < CacheBatch && last->m_next != nullptr)
+      {
+        last = last->m_next;
+        count++;
+      }
+      m_free = last->m_next;
+      last->m_next = nullptr;
+    }
+
+    if (t_exited)
+    {
+      if (first->m_next != nullptr)
+        release(first->m_next, last);
+      return first;
+    }
+
+    t_cache.m_heads[m_index] = first->m_next;
+    t_cache.m_counts[m_index] = count - 1;
+    return first;
+  }
+
+  void BlockPool::release(FreeBlock *first, FreeBlock *last)
+  {
+    lock_guard<mutex> lock(m_mutex);
+    last->m_next = m_free;
+    m_free = first;
+  }
+
+  BlockPool::Statistics BlockPool::getStatistics() const
+  {
+    Statistics stats;
+    stats.m_allocations = m_allocations.load(memory_order_relaxed);
+    stats.m_releases = m_releases.load(memory_order_relaxed);
+    lock_guard<mutex> lock(m_mutex);
+    stats.m_slabs = m_slabs.size();
+    stats.m_blocks = m_slabs.size() * m_blocksPerSlab;
+    return stats;
+  }
+
+  BlockPool::Statistics BlockPool::totals()
+  {
+    Statistics total;
+    for (auto pool : pools())
+    {
+      auto stats = pool->getStatistics();
+      total.m_allocations += stats.m_allocations;
+      total.m_releases += stats.m_releases;
+      total.m_slabs += stats.m_slabs;
+      total.m_blocks += stats.m_blocks;
+    }
+    return total;
+  }
+}  // namespace mtconnect::entity
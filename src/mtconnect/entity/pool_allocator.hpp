@@ -0,0 +1,168 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+
+namespace mtconnect::entity {
+  /// @brief A pool of fixed size blocks carved out of slabs
+  ///
+  /// Blocks that are released are kept on a free list and reused by the next allocation, so the
+  /// slabs grow to the high water mark of live objects and are then recycled. For observations
+  /// this is the size of the circular buffer plus the checkpoints: a block is returned to the
+  /// pool when the observation is evicted from the buffer and no checkpoint or request refers to
+  /// it. Each thread keeps a small cache of free blocks so the pool lock is only taken when the
+  /// cache is empty or full.
+  class AGENT_LIB_API BlockPool
+  {
+  public:
+    /// @brief the block sizes are multiples of the granularity, also the block alignment
+    static constexpr size_t Granularity = 16;
+    /// @brief the largest block allocated from a pool
+    static constexpr size_t MaxBlockSize = 512;
+    /// @brief the number of size classes
+    static constexpr size_t SizeClasses = MaxBlockSize / Granularity;
+
+    /// @brief pool counters
+    struct Statistics
+    {
+      uint64_t m_allocations {0};  ///< blocks handed out
+      uint64_t m_releases {0};     ///< blocks returned
+      uint64_t m_slabs {0};        ///< slabs allocated from the heap
+      uint64_t m_blocks {0};       ///< blocks in all slabs
+    };
+
+    /// @brief create a pool
+    /// @param[in] blockSize the size of each block, a multiple of `Granularity`
+    /// @param[in] index the size class index of this pool
+    BlockPool(size_t blockSize, size_t index);
+    BlockPool(const BlockPool &) = delete;
+    ~BlockPool();
+
+    /// @brief get a block from the thread cache, the free list, or a new slab
+    /// @return a pointer to a block of `getBlockSize()` bytes
+    void *allocate();
+    /// @brief return a block to the thread cache
+    /// @param[in] block the block
+    void deallocate(void *block);
+
+    /// @brief get the block size
+    size_t getBlockSize() const { return m_blockSize; }
+    /// @brief get the pool counters
+    Statistics getStatistics() const;
+
+    /// @brief check if an object of a size can be allocated from a pool
+    static constexpr bool fits(size_t size, size_t align)
+    {
+      return size <= MaxBlockSize && align <= Granularity;
+    }
+    /// @brief get the pool for an object size
+    /// @param[in] size the object size, must fit in `MaxBlockSize`
+    /// @return the pool with the smallest block that holds the object
+    static BlockPool &forSize(size_t size);
+    /// @brief get the counters summed over all the pools
+    static Statistics totals();
+
+  protected:
+    friend struct ThreadBlockCache;
+
+    struct FreeBlock
+    {
+      FreeBlock *m_next;
+    };
+
+    void *refill();
+    void release(FreeBlock *first, FreeBlock *last);
+
+  protected:
+    const size_t m_blockSize;
+    const size_t m_index;
+    const size_t m_blocksPerSlab;
+
+    mutable std::mutex m_mutex;
+    FreeBlock *m_free {nullptr};
+    std::vector<void *> m_slabs;
+
+    std::atomic<uint64_t> m_allocations {0};
+    std::atomic<uint64_t> m_releases {0};
+  };
+
+  /// @brief Standard allocator that allocates single objects from the block pools
+  ///
+  /// Used with `std::allocate_shared` so the object and its shared pointer control block are one
+  /// pooled block. Arrays and objects too large for the pools are allocated from the heap.
+  ///
+  /// @tparam T the type allocated
+  template <typename T>
+  class PoolAllocator
+  {
+  public:
+    using value_type = T;
+
+    PoolAllocator() noexcept = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U> &) noexcept
+    {}
+
+    T *allocate(std::size_t n)
+    {
+      if (n == 1 && BlockPool::fits(sizeof(T), alignof(T)))
+        return static_cast<T *>(BlockPool::forSize(sizeof(T)).allocate());
+      else
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept
+    {
+      if (n == 1 && BlockPool::fits(sizeof(T), alignof(T)))
+        BlockPool::forSize(sizeof(T)).deallocate(p);
+      else
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U> &) const noexcept
+    {
+      return true;
+    }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U> &) const noexcept
+    {
+      return false;
+    }
+  };
+
+  /// @brief Make a shared object allocated from the block pools
+  /// @tparam T the type of the object
+  /// @tparam Args the constructor argument types
+  /// @param[in] args the constructor arguments
+  /// @return shared pointer to the object
+  template <typename T, typename... Args>
+  inline std::shared_ptr<T> MakePooled(Args &&...args)
+  {
+    return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+  }
+}  // namespace mtconnect::entity
@@ -181,6 +181,12 @@ namespace mtconnect {
       }
       void operator()(const string &arg, Timestamp &ts)
       {
+        if (auto parsed = parseIso8601(arg))
+        {
+          ts = *parsed;
+          return;
+        }
+
         istringstream in(arg);
 
         // If there isa a time portion in the string, parse the time
@@ -279,10 +285,13 @@ namespace mtconnect {
       {
         if (arg.size() > 0)
         {
-          stringstream s;
-          for (auto &v : arg)
-            s << formatted(v) << ' ';
-          v = string_view(s.str().c_str(), s.str().size() - 1);
+          v.clear();
+          for (auto &d : arg)
+          {
+            if (!v.empty())
+              v.push_back(' ');
+            appendDouble(v, d);
+          }
         }
       }
       template <typename T>
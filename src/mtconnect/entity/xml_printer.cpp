@@ -177,7 +177,8 @@ namespace mtconnect {
                            const std::unordered_set<std::string> &namespaces)
     {
       NAMED_SCOPE("entity.xml_printer");
-      const auto &properties = entity->getProperties();
+      Properties scratch;
+      const auto &properties = entity->getAllProperties(scratch);
       const auto order = entity->getOrder();
       const auto *localNamespaces = &namespaces;
 
@@ -23,6 +23,7 @@
 #include <thread>
 
 #include "mtconnect/sink/sink.hpp"
+#include "subscription_engine.hpp"
 
 using namespace std;
 
@@ -95,43 +96,43 @@ namespace mtconnect::observation {
       observer->signal(sequence);
   }
 
-  AsyncObserver::AsyncObserver(boost::asio::io_context::strand &strand,
-                               buffer::CircularBuffer &buffer, FilterSet &&filter,
-                               std::chrono::milliseconds interval,
+  AsyncObserver::AsyncObserver(ObserverStrand &strand, buffer::CircularBuffer &buffer,
+                               FilterSet &&filter, std::chrono::milliseconds interval,
                                std::chrono::milliseconds heartbeat)
     : m_interval(interval),
       m_heartbeat(heartbeat),
       m_last(std::chrono::system_clock::now()),
       m_filter(std::move(filter)),
       m_strand(strand),
-      m_observer(strand),
+      m_observer(m_strand),
       m_buffer(buffer)
   {}
 
-  void AsyncObserver::observe(const std::optional<SequenceNumber_t> &from, Resolver resolver)
+  AsyncObserver::~AsyncObserver() { m_buffer.getSubscriptions().unsubscribe(&m_observer); }
+
+  void AsyncObserver::observe(const std::optional<SequenceNumber_t> &from)
   {
     using std::placeholders::_1;
 
     SequenceNumber_t firstSeq, next;
     {
       std::lock_guard<buffer::CircularBuffer> lock(m_buffer);
-      firstSeq = m_buffer.getFirstSequence();
+      firstSeq = m_buffer.getOldestSequence();
       next = m_buffer.getSequence();
     }
 
-    std::lock_guard<ChangeObserver> lock(m_observer);
-    m_observer.m_handler = boost::bind(&AsyncObserver::handleSignal, getptr(), _1);
-
-    // This object will automatically clean up all the observer from the
-    // signalers in an exception proof manor.
-    // Add observers
-    for (const auto &item : m_filter)
     {
-      auto cs = resolver(item);
-      if (cs)
-        cs->addObserver(&m_observer);
+      std::lock_guard<ChangeObserver> lock(m_observer);
+      m_observer.m_handler = boost::bind(&AsyncObserver::handleSignal, getptr(), _1);
     }
 
+    // Subscribe without holding the observer lock, the buffer signals the observer while it holds
+    // the subscription lock. The destructor removes the subscription.
+    m_buffer.getSubscriptions().subscribe(
+        &m_observer, buffer::FilterBits(m_filter, m_buffer.getDataItemIndexes()));
+
+    std::lock_guard<ChangeObserver> lock(m_observer);
+
     // If we are starting from the beginning of the buffer, signal the handler
     // to set the sequence to the fisrt sequence in the buffer to avoid a race
     // condition.
@@ -228,7 +229,7 @@ namespace mtconnect::observation {
 
     /// Check if we're falling too far behind. If we are, generate an
     /// MTConnectError and return.
-    if (m_sequence != 0 && m_sequence < m_buffer.getFirstSequence())
+    if (m_sequence != 0 && m_sequence < m_buffer.getOldestSequence())
     {
       LOG(warning) << "Client fell too far behind, disconnecting";
       fail(boost::beast::http::status::not_found, "Client fell too far behind, disconnecting");
@@ -35,14 +35,17 @@ namespace mtconnect::buffer {
 namespace mtconnect::observation {
   class ChangeSignaler;
 
+  /// @brief The strand observers dispatch their handlers on
+  using ObserverStrand = boost::asio::strand<boost::asio::io_context::executor_type>;
+
   /// @brief A class to observe a data item and signal when data changes
   class AGENT_LIB_API ChangeObserver
   {
   public:
     /// @brief Create a change observer that runs in a strand
     /// @param[in] strand the strand
-    ChangeObserver(boost::asio::io_context::strand &strand)
-      : m_strand(strand), m_timer(strand.context())
+    ChangeObserver(ObserverStrand &strand)
+      : m_strand(strand), m_timer(strand.get_inner_executor())
     {}
 
     virtual ~ChangeObserver();
@@ -144,7 +147,7 @@ namespace mtconnect::observation {
     ///@}
 
   private:
-    boost::asio::io_context::strand &m_strand;
+    ObserverStrand &m_strand;
     mutable std::recursive_mutex m_mutex;
     boost::asio::steady_timer m_timer;
 
@@ -188,8 +191,8 @@ namespace mtconnect::observation {
   /// @brief Asyncronous change context for waiting for changes
   ///
   /// This class must be subclassed and provide a fail and isRunning method.
-  /// The caller first calls observe to resolve the filter ids to the signalers. This must be done
-  /// before the first handlerComplete is called asyncronously. The observer handles calling the
+  /// The caller first calls observe to subscribe to the buffer's subscription engine with the
+  /// filter. This must be done before the first handlerComplete is called asyncronously. The observer handles calling the
   /// handler whenever a new observation is available or the heartbeat has timed out keeping track
   /// of the sequence number of the last signaled observation or if the observer is still at the end
   /// of the buffer and nothing is signaled.
@@ -202,29 +205,25 @@ namespace mtconnect::observation {
     /// @Brief callback when observations are ready
     using Handler = std::function<SequenceNumber_t(std::shared_ptr<AsyncObserver>)>;
 
-    /// @brief Resolve a string to a change signaler
-    using Resolver = std::function<ChangeSignaler *(const std::string &id)>;
-
     /// @brief create async observer to manage data item callbacks
     /// @param contract the sink contract to use to get the buffer information
     /// @param strand the strand to handle the async actions
     /// @param interval minimum amount of time to wait for observations
     /// @param heartbeat maximum amount of time to wait before sending a heartbeat
-    AsyncObserver(boost::asio::io_context::strand &strand,
-                  mtconnect::buffer::CircularBuffer &buffer, FilterSet &&filter,
-                  std::chrono::milliseconds interval, std::chrono::milliseconds heartbeat);
-    /// @brief default destructor
-    virtual ~AsyncObserver() = default;
+    AsyncObserver(ObserverStrand &strand, mtconnect::buffer::CircularBuffer &buffer,
+                  FilterSet &&filter, std::chrono::milliseconds interval,
+                  std::chrono::milliseconds heartbeat);
+    /// @brief removes the subscription from the buffer
+    virtual ~AsyncObserver();
 
     /// @brief Get a shared pointed
     auto getptr() const { return const_cast<AsyncObserver *>(this)->shared_from_this(); }
 
-    /// @brief sets up the `ChangeObserver` using the filter and initializes the references to the
-    /// buffer
+    /// @brief subscribes the `ChangeObserver` to the buffer using the filter and initializes the
+    /// references to the buffer
     /// @param from optional starting point. If not specified, defaults to the beginning of the
     /// buffer
-    /// @param resolver resolve an id to a signaler
-    void observe(const std::optional<SequenceNumber_t> &from, Resolver resolver);
+    void observe(const std::optional<SequenceNumber_t> &from);
 
     /// @brief handle the operation completion after the handler is called
     ///
@@ -250,6 +249,7 @@ namespace mtconnect::observation {
     auto getSequence() const { return m_sequence; }
     auto isEndOfBuffer() const { return m_endOfBuffer; }
     const auto &getFilter() const { return m_filter; }
+    auto &getStrand() { return m_strand; }
 
     ///@}
     ///
@@ -272,7 +272,7 @@ namespace mtconnect::observation {
         0};  //! the maximum amount of time to wait before sending a heartbeat
     std::chrono::system_clock::time_point m_last;  //! the last time the handler completed
     FilterSet m_filter;                            //! The data items to be observed
-    boost::asio::io_context::strand m_strand;      //! Strand to use for aync dispatch
+    ObserverStrand m_strand;                       //! Strand to use for aync dispatch
 
     ChangeObserver m_observer;                    //! the change observer
     mtconnect::buffer::CircularBuffer &m_buffer;  //! reference to the circular buffer
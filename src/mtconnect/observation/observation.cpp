@@ -22,6 +22,7 @@
 
 #include "mtconnect/device_model/data_item/data_item.hpp"
 #include "mtconnect/entity/factory.hpp"
+#include "mtconnect/entity/pool_allocator.hpp"
 #include "mtconnect/logging.hpp"
 
 #ifdef _WINDOWS
@@ -41,14 +42,14 @@ namespace mtconnect {
       static FactoryPtr factory;
       if (!factory)
       {
-        factory = make_shared<Factory>(Requirements({{"dataItemId", true},
-                                                     {"timestamp", ValueType::TIMESTAMP, true},
+        factory = make_shared<Factory>(Requirements({{"dataItemId", false},
+                                                     {"timestamp", ValueType::TIMESTAMP, false},
                                                      {"sequence", false},
                                                      {"subType", false},
                                                      {"name", false},
                                                      {"compositionId", false}}),
                                        [](const std::string &name, Properties &props) -> EntityPtr {
-                                         return make_shared<Observation>(name, props);
+                                         return MakePooled<Observation>(name, props);
                                        });
 
         factory->registerFactory("Events:Message", Message::getFactory());
@@ -106,9 +107,14 @@ namespace mtconnect {
     {
       NAMED_SCOPE("Observation");
 
-      auto props = entity::Properties(incompingProps);
-      setProperties(dataItem, props);
-      props.insert_or_assign("timestamp", timestamp);
+      // The data item properties, timestamp, and sequence are held outside of the map
+      const auto &shared = dataItem->getObservationProperties();
+      entity::Properties props;
+      for (const auto &prop : incompingProps)
+      {
+        if (prop.first != "timestamp" && prop.first != "sequence" && shared.count(prop.first) == 0)
+          props.insert(props.end(), prop);
+      }
 
       bool unavailable {false};
       string level;
@@ -178,7 +184,7 @@ namespace mtconnect {
       {
         factory = make_shared<Factory>(*Observation::getFactory());
         factory->setFunction([](const std::string &name, Properties &props) -> EntityPtr {
-          return make_shared<Event>(name, props);
+          return MakePooled<Event>(name, props);
         });
         factory->addRequirements(
             Requirements {{"VALUE", false}, {"resetTriggered", ValueType::USTRING, false}});
@@ -194,7 +200,7 @@ namespace mtconnect {
       {
         factory = make_shared<Factory>(*Observation::getFactory());
         factory->setFunction([](const std::string &name, Properties &props) -> EntityPtr {
-          auto ent = make_shared<DataSetEvent>(name, props);
+          auto ent = MakePooled<DataSetEvent>(name, props);
           auto v = ent->m_properties.find("VALUE");
           if (v != ent->m_properties.end())
           {
@@ -218,7 +224,7 @@ namespace mtconnect {
       {
         factory = make_shared<Factory>(*DataSetEvent::getFactory());
         factory->setFunction([](const std::string &name, Properties &props) -> EntityPtr {
-          auto ent = make_shared<TableEvent>(name, props);
+          auto ent = MakePooled<TableEvent>(name, props);
           auto v = ent->m_properties.find("VALUE");
           if (v != ent->m_properties.end())
           {
@@ -241,7 +247,7 @@ namespace mtconnect {
       {
         factory = make_shared<Factory>(*Observation::getFactory());
         factory->setFunction([](const std::string &name, Properties &props) -> EntityPtr {
-          return make_shared<DoubleEvent>(name, props);
+          return MakePooled<DoubleEvent>(name, props);
         });
         factory->addRequirements(Requirements({{"resetTriggered", ValueType::USTRING, false},
                                                {"statistic", ValueType::USTRING, false},
@@ -258,7 +264,7 @@ namespace mtconnect {
       {
         factory = make_shared<Factory>(*Observation::getFactory());
         factory->setFunction([](const std::string &name, Properties &props) -> EntityPtr {
-          return make_shared<IntEvent>(name, props);
+          return MakePooled<IntEvent>(name, props);
         });
         factory->addRequirements(Requirements({{"resetTriggered", ValueType::USTRING, false},
                                                {"statistic", ValueType::USTRING, false},
@@ -275,7 +281,7 @@ namespace mtconnect {
       {
         factory = make_shared<Factory>(*Observation::getFactory());
         factory->setFunction([](const std::string &name, Properties &props) -> EntityPtr {
-          return make_shared<Sample>(name, props);
+          return MakePooled<Sample>(name, props);
         });
         factory->addRequirements(Requirements({{"sampleRate", ValueType::DOUBLE, false},
                                                {"resetTriggered", ValueType::USTRING, false},
@@ -293,7 +299,7 @@ namespace mtconnect {
       {
         factory = make_shared<Factory>(*Sample::getFactory());
         factory->setFunction([](const std::string &name, Properties &props) -> EntityPtr {
-          return make_shared<ThreeSpaceSample>(name, props);
+          return MakePooled<ThreeSpaceSample>(name, props);
         });
         factory->addRequirements(Requirements({{"VALUE", ValueType::VECTOR, 3, false}}));
       }
@@ -307,7 +313,7 @@ namespace mtconnect {
       {
         factory = make_shared<Factory>(*Sample::getFactory());
         factory->setFunction([](const std::string &name, Properties &props) -> EntityPtr {
-          auto ent = make_shared<Timeseries>(name, props);
+          auto ent = MakePooled<Timeseries>(name, props);
           auto v = ent->m_properties.find("VALUE");
           if (v != ent->m_properties.end())
           {
@@ -330,7 +336,7 @@ namespace mtconnect {
       {
         factory = make_shared<Factory>(*Observation::getFactory());
         factory->setFunction([](const std::string &name, Properties &props) -> EntityPtr {
-          auto cond = make_shared<Condition>(name, props);
+          auto cond = MakePooled<Condition>(name, props);
           if (cond)
           {
             if (auto code = cond->m_properties.find("conditionId");
@@ -365,7 +371,7 @@ namespace mtconnect {
       {
         factory = make_shared<Factory>(*Event::getFactory());
         factory->setFunction([](const std::string &name, Properties &props) -> EntityPtr {
-          auto ent = make_shared<AssetEvent>(name, props);
+          auto ent = MakePooled<AssetEvent>(name, props);
           if (!ent->hasProperty("assetType") && !ent->hasValue())
           {
             ent->setProperty("assetType", "UNAVAILABLE"s);
@@ -384,7 +390,7 @@ namespace mtconnect {
       {
         factory = make_shared<Factory>(*Event::getFactory());
         factory->setFunction([](const std::string &name, Properties &props) -> EntityPtr {
-          return make_shared<DeviceEvent>(name, props);
+          return MakePooled<DeviceEvent>(name, props);
         });
         factory->addRequirements(Requirements {{"hash", false}});
       }
@@ -398,7 +404,7 @@ namespace mtconnect {
       {
         factory = make_shared<Factory>(*Event::getFactory());
         factory->setFunction([](const std::string &name, Properties &props) -> EntityPtr {
-          return make_shared<Message>(name, props);
+          return MakePooled<Message>(name, props);
         });
         factory->addRequirements(Requirements({{"nativeCode", false}}));
       }
@@ -412,7 +418,7 @@ namespace mtconnect {
       {
         factory = make_shared<Factory>(*Event::getFactory());
         factory->setFunction([](const std::string &name, Properties &props) -> EntityPtr {
-          return make_shared<Alarm>(name, props);
+          return MakePooled<Alarm>(name, props);
         });
         factory->addRequirements(Requirements({{"code", false},
                                                {"nativeCode", false},
@@ -439,7 +445,7 @@ namespace mtconnect {
 
     ConditionPtr Condition::deepCopy()
     {
-      auto n = make_shared<Condition>(*this);
+      auto n = MakePooled<Condition>(*this);
 
       if (m_prev)
       {
@@ -459,7 +465,7 @@ namespace mtconnect {
           return nullptr;
       }
 
-      auto n = make_shared<Condition>(*this);
+      auto n = MakePooled<Condition>(*this);
 
       if (m_prev)
       {
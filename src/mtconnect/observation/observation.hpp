@@ -29,6 +29,7 @@
 #include "mtconnect/device_model/component.hpp"
 #include "mtconnect/device_model/data_item/data_item.hpp"
 #include "mtconnect/entity/entity.hpp"
+#include "mtconnect/entity/pool_allocator.hpp"
 #include "mtconnect/utilities.hpp"
 
 /// @brief Observation namespace
@@ -39,6 +40,12 @@ namespace mtconnect::observation {
   using ObservationList = std::list<ObservationPtr>;
 
   /// @brief Abstract observation
+  ///
+  /// The observation keeps a compact representation. The timestamp and sequence number are
+  /// typed members read with `getTimestamp()` and `getSequence()`, and the data item properties
+  /// (`dataItemId`, `name`, `subType`, and `compositionId`) are shared with the data item and
+  /// returned from `getProperty()`. None of these are in the property map, they are merged by
+  /// `getAllProperties()` when a printer or script needs the complete property set.
   class AGENT_LIB_API Observation : public entity::Entity
   {
   public:
@@ -47,7 +54,7 @@ namespace mtconnect::observation {
 
     static entity::FactoryPtr getFactory();
     ~Observation() override = default;
-    virtual ObservationPtr copy() const { return std::make_shared<Observation>(); }
+    virtual ObservationPtr copy() const { return entity::MakePooled<Observation>(); }
 
     /// @brief Method to create an observation for a data item
     ///
@@ -70,12 +77,14 @@ namespace mtconnect::observation {
         props.emplace(prop);
     }
 
-    /// @brief set the associated data item and its properties
+    /// @brief set the associated data item
+    ///
+    /// The data item properties are shared with the data item and removed from the property map
     /// @param[in] dataItem the data item
     void setDataItem(const DataItemPtr dataItem)
     {
       m_dataItem = dataItem;
-      setProperties(dataItem, m_properties);
+      compact(dataItem);
     }
 
     /// @brief get the associated data item
@@ -99,21 +108,27 @@ namespace mtconnect::observation {
 
     /// @brief set the timestamp
     /// @param[in] ts the timestamp
-    void setTimestamp(const Timestamp &ts)
-    {
-      m_timestamp = ts;
-      setProperty("timestamp", m_timestamp);
-    }
+    void setTimestamp(const Timestamp &ts) { m_timestamp = ts; }
     /// @brief get the timestamp
     /// @return the timestamp
     auto getTimestamp() const { return m_timestamp; }
 
     /// @brief set the sequence number
     /// @param[in] sequence the sequence number
-    void setSequence(int64_t sequence)
+    void setSequence(int64_t sequence) { m_sequence = sequence; }
+
+    /// @brief get the properties merged with the data item properties, timestamp, and sequence
+    /// @param[out] scratch storage for the merged properties
+    /// @return `scratch` with all the properties of the observation
+    const entity::Properties &getAllProperties(entity::Properties &scratch) const override
     {
-      m_sequence = sequence;
-      setProperty("sequence", sequence);
+      scratch = m_properties;
+      if (auto di = m_dataItem.lock())
+        setProperties(di, scratch);
+      scratch.emplace("timestamp", m_timestamp);
+      if (m_sequence > 0)
+        scratch.emplace("sequence", int64_t(m_sequence));
+      return scratch;
     }
     /// @brief make the observation unavailable
     virtual void makeUnavailable()
@@ -149,7 +164,7 @@ namespace mtconnect::observation {
       if ((*di) < (*odi))
         return true;
       else if (*di == *odi)
-        return m_sequence < another.m_sequence;
+        return getSequence() < another.getSequence();
       else
         return false;
     }
@@ -176,6 +191,33 @@ namespace mtconnect::observation {
     /// @brief Clear the reset triggered state
     void clearResetTriggered() { m_properties.erase("resetTriggered"); }
 
+  protected:
+    /// @brief remove the properties that are shared with the data item or held in fixed fields
+    /// @param[in] dataItem the data item
+    void compact(const DataItemPtr dataItem)
+    {
+      for (auto &prop : dataItem->getObservationProperties())
+        m_properties.erase(prop.first);
+      m_properties.erase("timestamp");
+      m_properties.erase("sequence");
+    }
+
+    /// @brief get the data item properties
+    /// @param[in] name the key
+    /// @return a pointer to the value or `nullptr` if there is no derived property
+    const entity::Value *getDerivedProperty(const std::string &name) const override
+    {
+      auto di = m_dataItem.lock();
+      if (di)
+      {
+        const auto &props = di->getObservationProperties();
+        auto it = props.find(name);
+        if (it != props.end())
+          return &it->second;
+      }
+      return nullptr;
+    }
+
   protected:
     Timestamp m_timestamp;
     bool m_unavailable {false};
@@ -193,7 +235,7 @@ namespace mtconnect::observation {
     static entity::FactoryPtr getFactory();
     ~Sample() override = default;
 
-    ObservationPtr copy() const override { return std::make_shared<Sample>(*this); }
+    ObservationPtr copy() const override { return entity::MakePooled<Sample>(*this); }
   };
 
   /// @brief An MTConnect Sample with a Vector with three values for X, Y and Z, or A, B, and C.
@@ -217,7 +259,7 @@ namespace mtconnect::observation {
     static entity::FactoryPtr getFactory();
     ~Timeseries() override = default;
 
-    ObservationPtr copy() const override { return std::make_shared<Timeseries>(*this); }
+    ObservationPtr copy() const override { return entity::MakePooled<Timeseries>(*this); }
   };
 
   class Condition;
@@ -245,7 +287,7 @@ namespace mtconnect::observation {
     using Observation::Observation;
     static entity::FactoryPtr getFactory();
     ~Condition() override = default;
-    ObservationPtr copy() const override { return std::make_shared<Condition>(*this); }
+    ObservationPtr copy() const override { return entity::MakePooled<Condition>(*this); }
 
     ConditionPtr getptr() { return std::dynamic_pointer_cast<Condition>(Entity::getptr()); }
 
@@ -407,7 +449,7 @@ namespace mtconnect::observation {
     using Observation::Observation;
     static entity::FactoryPtr getFactory();
     ~Event() override = default;
-    ObservationPtr copy() const override { return std::make_shared<Event>(*this); }
+    ObservationPtr copy() const override { return entity::MakePooled<Event>(*this); }
   };
 
   /// @brief An `Event` that has a double value
@@ -419,7 +461,7 @@ namespace mtconnect::observation {
     using Observation::Observation;
     static entity::FactoryPtr getFactory();
     ~DoubleEvent() override = default;
-    ObservationPtr copy() const override { return std::make_shared<DoubleEvent>(*this); }
+    ObservationPtr copy() const override { return entity::MakePooled<DoubleEvent>(*this); }
   };
 
   /// @brief An `Event` that has a integer value
@@ -431,7 +473,7 @@ namespace mtconnect::observation {
     using Observation::Observation;
     static entity::FactoryPtr getFactory();
     ~IntEvent() override = default;
-    ObservationPtr copy() const override { return std::make_shared<IntEvent>(*this); }
+    ObservationPtr copy() const override { return entity::MakePooled<IntEvent>(*this); }
   };
 
   /// @brief An `Event` that has a data set representation
@@ -443,7 +485,7 @@ namespace mtconnect::observation {
     using Event::Event;
     static entity::FactoryPtr getFactory();
     ~DataSetEvent() override = default;
-    ObservationPtr copy() const override { return std::make_shared<DataSetEvent>(*this); }
+    ObservationPtr copy() const override { return entity::MakePooled<DataSetEvent>(*this); }
 
     /// @brief makes the data set unavailable and sets the count to 0
     void makeUnavailable() override
@@ -475,7 +517,7 @@ namespace mtconnect::observation {
   public:
     using DataSetEvent::DataSetEvent;
     static entity::FactoryPtr getFactory();
-    ObservationPtr copy() const override { return std::make_shared<TableEvent>(*this); }
+    ObservationPtr copy() const override { return entity::MakePooled<TableEvent>(*this); }
   };
 
   /// @brief An asset changed or removed Event
@@ -485,7 +527,7 @@ namespace mtconnect::observation {
     using Event::Event;
     static entity::FactoryPtr getFactory();
     ~AssetEvent() override = default;
-    ObservationPtr copy() const override { return std::make_shared<AssetEvent>(*this); }
+    ObservationPtr copy() const override { return entity::MakePooled<AssetEvent>(*this); }
 
   protected:
   };
@@ -497,7 +539,7 @@ namespace mtconnect::observation {
     using Event::Event;
     static entity::FactoryPtr getFactory();
     ~DeviceEvent() override = default;
-    ObservationPtr copy() const override { return std::make_shared<DeviceEvent>(*this); }
+    ObservationPtr copy() const override { return entity::MakePooled<DeviceEvent>(*this); }
 
   protected:
   };
@@ -511,7 +553,7 @@ namespace mtconnect::observation {
     using Event::Event;
     static entity::FactoryPtr getFactory();
     ~Message() override = default;
-    ObservationPtr copy() const override { return std::make_shared<Message>(*this); }
+    ObservationPtr copy() const override { return entity::MakePooled<Message>(*this); }
   };
 
   /// @brief A deprecated Alarm type.
@@ -525,7 +567,7 @@ namespace mtconnect::observation {
     using Event::Event;
     static entity::FactoryPtr getFactory();
     ~Alarm() override = default;
-    ObservationPtr copy() const override { return std::make_shared<Alarm>(*this); }
+    ObservationPtr copy() const override { return entity::MakePooled<Alarm>(*this); }
   };
 
   using ObservationComparer = bool (*)(ObservationPtr &, ObservationPtr &);
@@ -0,0 +1,75 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "subscription_engine.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+using namespace std;
+
+namespace mtconnect::observation {
+  void SubscriptionEngine::subscribe(ChangeObserver *observer, buffer::FilterBits &&filter)
+  {
+    unique_lock<shared_mutex> lock(m_mutex);
+    auto it = find_if(m_subscriptions.begin(), m_subscriptions.end(),
+                      [observer](const auto &sub) { return sub.m_observer == observer; });
+    if (it != m_subscriptions.end())
+      it->m_filter = std::move(filter);
+    else
+      m_subscriptions.push_back({observer, std::move(filter)});
+  }
+
+  bool SubscriptionEngine::unsubscribe(ChangeObserver *observer)
+  {
+    unique_lock<shared_mutex> lock(m_mutex);
+    auto it = find_if(m_subscriptions.begin(), m_subscriptions.end(),
+                      [observer](const auto &sub) { return sub.m_observer == observer; });
+    if (it == m_subscriptions.end())
+      return false;
+
+    // Order does not matter, move the last subscription into the hole
+    if (it != m_subscriptions.end() - 1)
+      *it = std::move(m_subscriptions.back());
+    m_subscriptions.pop_back();
+    return true;
+  }
+
+  bool SubscriptionEngine::isSubscribed(const ChangeObserver *observer) const
+  {
+    shared_lock<shared_mutex> lock(m_mutex);
+    return any_of(m_subscriptions.begin(), m_subscriptions.end(),
+                  [observer](const auto &sub) { return sub.m_observer == observer; });
+  }
+
+  void SubscriptionEngine::notify(size_t index, SequenceNumber_t sequence) const
+  {
+    shared_lock<shared_mutex> lock(m_mutex);
+    for (const auto &sub : m_subscriptions)
+    {
+      if (sub.m_filter.test(index))
+        sub.m_observer->signal(sequence);
+    }
+  }
+
+  void SubscriptionEngine::signalAll(SequenceNumber_t sequence) const
+  {
+    shared_lock<shared_mutex> lock(m_mutex);
+    for (const auto &sub : m_subscriptions)
+      sub.m_observer->signal(sequence);
+  }
+}  // namespace mtconnect::observation
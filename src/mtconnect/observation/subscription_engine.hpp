@@ -0,0 +1,78 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <shared_mutex>
+#include <vector>
+
+#include "change_observer.hpp"
+#include "mtconnect/buffer/filter_bits.hpp"
+#include "mtconnect/config.hpp"
+
+namespace mtconnect::observation {
+  /// @brief Wakes the change observers interested in a new observation
+  ///
+  /// The circular buffer notifies the engine once for each observation it appends with the index
+  /// of the observation's data item. Each subscription holds a data item index bitset, so the
+  /// engine tests one bit per subscription and signals only the observers whose filter contains
+  /// the data item. Subscribing and unsubscribing add or remove one entry, so their cost does not
+  /// depend on the number of data items in the filter.
+  class AGENT_LIB_API SubscriptionEngine
+  {
+  public:
+    SubscriptionEngine() = default;
+    SubscriptionEngine(const SubscriptionEngine &) = delete;
+
+    /// @brief add or replace the subscription of an observer
+    /// @param[in] observer the change observer to signal
+    /// @param[in] filter the indexes of the data items the observer is interested in
+    void subscribe(ChangeObserver *observer, buffer::FilterBits &&filter);
+    /// @brief remove the subscription of an observer
+    /// @param[in] observer the change observer
+    /// @return `true` if the observer was subscribed
+    bool unsubscribe(ChangeObserver *observer);
+    /// @brief check if an observer is subscribed
+    /// @param[in] observer the change observer
+    /// @return `true` if the observer is subscribed
+    bool isSubscribed(const ChangeObserver *observer) const;
+    /// @brief get the number of subscriptions
+    size_t size() const
+    {
+      std::shared_lock<std::shared_mutex> lock(m_mutex);
+      return m_subscriptions.size();
+    }
+
+    /// @brief signal the observers interested in a data item
+    /// @param[in] index the data item index
+    /// @param[in] sequence the sequence number of the observation
+    void notify(size_t index, SequenceNumber_t sequence) const;
+    /// @brief signal every observer, used to wake the observers when the agent stops
+    /// @param[in] sequence the sequence number, 0 wakes the observers without a new sequence
+    void signalAll(SequenceNumber_t sequence) const;
+
+  protected:
+    struct Subscription
+    {
+      ChangeObserver *m_observer;
+      buffer::FilterBits m_filter;
+    };
+
+    mutable std::shared_mutex m_mutex;
+    std::vector<Subscription> m_subscriptions;
+  };
+}  // namespace mtconnect::observation
@@ -31,7 +31,7 @@ namespace mtconnect {
       /// @brief shared values associated with data items
       struct State : TransformState
       {
-        std::unordered_map<std::string, double> m_lastSampleValue;
+        std::unordered_map<size_t, double> m_lastSampleValue;
       };
 
       /// @brief Construct a delta filter
@@ -63,26 +63,26 @@ namespace mtconnect {
         if (o->isOrphan())
           return EntityPtr();
         auto di = o->getDataItem();
-        auto &id = di->getId();
+        auto index = di->getIndex();
 
         if (o->isUnavailable())
         {
-          m_state->m_lastSampleValue.erase(id);
+          m_state->m_lastSampleValue.erase(index);
           return next(std::move(entity));
         }
 
         auto filter = *di->getMinimumDelta();
         double value = o->getValue<double>();
-        if (filterMinimumDelta(id, value, filter))
+        if (filterMinimumDelta(index, value, filter))
           return EntityPtr();
 
         return next(std::move(entity));
       }
 
     protected:
-      bool filterMinimumDelta(const std::string &id, const double value, const double fv)
+      bool filterMinimumDelta(size_t index, const double value, const double fv)
       {
-        auto last = m_state->m_lastSampleValue.find(id);
+        auto last = m_state->m_lastSampleValue.find(index);
         if (last != m_state->m_lastSampleValue.end())
         {
           double lv = last->second;
@@ -94,7 +94,7 @@ namespace mtconnect {
         }
         else
         {
-          m_state->m_lastSampleValue[id] = value;
+          m_state->m_lastSampleValue[index] = value;
         }
 
         return false;
@@ -57,7 +57,8 @@ namespace mtconnect::pipeline {
       std::chrono::milliseconds m_period;
     };
 
-    using LastObservationMap = std::unordered_map<std::string, LastObservation>;
+    /// @brief Last observations by data item index
+    using LastObservationMap = std::unordered_map<size_t, LastObservation>;
     using LastObservationIterator = LastObservationMap::iterator;
 
     /// @brief A shared state variable containing the last observation
@@ -98,20 +99,20 @@ namespace mtconnect::pipeline {
           return EntityPtr();
 
         auto di = obs->getDataItem();
-        auto &id = di->getId();
+        auto index = di->getIndex();
 
         if (obs->isUnavailable())
         {
-          m_state->m_lastObservation.erase(id);
+          m_state->m_lastObservation.erase(index);
         }
         else
         {
-          auto last = m_state->m_lastObservation.find(id);
+          auto last = m_state->m_lastObservation.find(index);
           if (last == m_state->m_lastObservation.end())
           {
             auto period =
                 chrono::milliseconds(static_cast<int64_t>(*di->getMinimumPeriod() * 1000.0));
-            auto res = m_state->m_lastObservation.try_emplace(id, period, m_strand);
+            auto res = m_state->m_lastObservation.try_emplace(index, period, m_strand);
             if (res.second)
               last = res.first;
             else
@@ -122,7 +123,7 @@ namespace mtconnect::pipeline {
           }
 
           // If filtered, return an empty entity.
-          if (filtered(last->second, id, obs))
+          if (filtered(last->second, index, obs))
             return EntityPtr();
         }
       }
@@ -132,7 +133,7 @@ namespace mtconnect::pipeline {
 
   protected:
     // Returns true if the observation is filtered.
-    bool filtered(LastObservation &last, const std::string &id, observation::ObservationPtr &obs)
+    bool filtered(LastObservation &last, size_t index, observation::ObservationPtr &obs)
     {
       using namespace std;
       using namespace chrono;
@@ -165,7 +166,7 @@ namespace mtconnect::pipeline {
         // and be triggered when the timer expires. The end of the period is still the
         // same, so keep the timer as is.
         if (!observed)
-          delayDelivery(last, id);
+          delayDelivery(last, index);
 
 #ifdef DEBUG_PERIOD_FILTER
         std::cout << "Filtering Delayed " << format(ts) << std::endl;
@@ -198,7 +199,7 @@ namespace mtconnect::pipeline {
 #ifdef DEBUG_PERIOD_FILTER
         std::cout << "  last timestamp set to " << format(last.m_next) << std::endl;
 #endif
-        delayDelivery(last, id);
+        delayDelivery(last, index);
 
 #ifdef DEBUG_PERIOD_FILTER
         std::cout << ">>>> Sending " << format(ts) << std::endl;
@@ -233,7 +234,7 @@ namespace mtconnect::pipeline {
       }
     }
 
-    void delayDelivery(LastObservation &last, const std::string &id)
+    void delayDelivery(LastObservation &last, size_t index)
     {
       using std::placeholders::_1;
       using namespace std;
@@ -250,14 +251,15 @@ namespace mtconnect::pipeline {
       std::cout << "Delaying " << format(last.m_observation->getTimestamp()) << " for "
                 << duration_cast<milliseconds>(delta).count() << std::endl;
 #endif
-      // Bind the strand so we do not have races. Use the data item id so there are
+      // Bind the strand so we do not have races. Use the data item index so there are
       // no race conditions due to LastObservation lifecycle.
-      last.m_timer.async_wait([this, id](boost::system::error_code ec) {
-        boost::asio::dispatch(m_strand, boost::bind(&PeriodFilter::sendObservation, this, id, ec));
+      last.m_timer.async_wait([this, index](boost::system::error_code ec) {
+        boost::asio::dispatch(m_strand,
+                              boost::bind(&PeriodFilter::sendObservation, this, index, ec));
       });
     }
 
-    void sendObservation(const std::string id, boost::system::error_code ec)
+    void sendObservation(size_t index, boost::system::error_code ec)
     {
       if (ec)
       {
@@ -277,7 +279,7 @@ namespace mtconnect::pipeline {
         std::lock_guard<TransformState> guard(*m_state);
 
         // Find the entry for this data item and make sure there is an observation
-        auto lastIt = m_state->m_lastObservation.find(id);
+        auto lastIt = m_state->m_lastObservation.find(index);
         if (lastIt != m_state->m_lastObservation.end() && lastIt->second.m_observation)
         {
           auto &last = lastIt->second;
@@ -282,6 +282,9 @@ namespace mtconnect::pipeline {
 
   inline static Timestamp parseTimestamp(const std::string value)
   {
+    if (auto ts = parseIso8601(value))
+      return *ts;
+
     Timestamp ts;
     istringstream in(value);
     in >> std::setw(6) >> date::parse("%FT%T", ts);
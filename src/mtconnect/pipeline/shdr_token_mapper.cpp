@@ -368,7 +368,7 @@ namespace mtconnect {
       if (auto timestamped = std::dynamic_pointer_cast<Timestamped>(entity))
       {
         // Don't copy the tokens.
-        auto res = std::make_shared<Observations>(*timestamped, TokenList {});
+        auto res = entity::MakePooled<Observations>(*timestamped, TokenList {});
         EntityList entities;
 
         auto &tokens = timestamped->m_tokens;
@@ -22,6 +22,7 @@
 
 #include "mtconnect/config.hpp"
 #include "mtconnect/entity/entity.hpp"
+#include "mtconnect/entity/pool_allocator.hpp"
 #include "transform.hpp"
 
 namespace mtconnect::pipeline {
@@ -53,7 +54,7 @@ namespace mtconnect::pipeline {
       entity::Properties props;
       if (auto source = data->maybeGet<std::string>("source"))
         props["source"] = *source;
-      auto result = std::make_shared<Tokens>("Tokens", props);
+      auto result = entity::MakePooled<Tokens>("Tokens", props);
       tokenize(body, result->m_tokens);
       return next(result);
     }
@@ -103,11 +103,18 @@ namespace mtconnect::pipeline {
     bool has_t {timestamp.find('T') != string::npos};
     if (has_t)
     {
-      istringstream in(timestamp.data());
-      in >> std::setw(6) >> parse("%FT%T", result);
-      if (!in.good())
+      if (auto ts = parseIso8601(timestamp))
       {
-        result = now();
+        result = *ts;
+      }
+      else
+      {
+        istringstream in(timestamp.data());
+        in >> std::setw(6) >> parse("%FT%T", result);
+        if (!in.good())
+        {
+          result = now();
+        }
       }
 
       if (!relative)
@@ -178,7 +185,7 @@ namespace mtconnect::pipeline {
       if (auto tokens = std::dynamic_pointer_cast<Tokens>(ptr);
           tokens && tokens->m_tokens.size() > 0)
       {
-        res = std::make_shared<Timestamped>(*tokens);
+        res = entity::MakePooled<Timestamped>(*tokens);
         token = res->m_tokens.front();
         res->m_tokens.pop_front();
       }
@@ -233,7 +240,7 @@ namespace mtconnect::pipeline {
       if (auto tokens = std::dynamic_pointer_cast<Tokens>(ptr);
           tokens && tokens->m_tokens.size() > 0)
       {
-        res = std::make_shared<Timestamped>(*tokens);
+        res = entity::MakePooled<Timestamped>(*tokens);
         res->m_tokens.pop_front();
       }
       else if (res->hasProperty("timestamp"))
@@ -51,7 +51,7 @@ namespace mtconnect::pipeline {
       auto event = std::dynamic_pointer_cast<Event>(entity);
       if (!entity)
         throw EntityError("Unexpected Entity type in UpcaseValue: ", entity->getName());
-      auto nos = std::make_shared<Event>(*event.get());
+      auto nos = entity::MakePooled<Event>(*event.get());
 
       upcase(std::get<std::string>(nos->getValue()));
       return next(nos);
@@ -113,7 +113,8 @@ namespace mtconnect::printer {
   {
     defaultSchemaVersion();
 
-    StringBuffer output;
+    string doc;
+    JsonStringOutput output(doc);
     RenderJson(output, m_pretty || pretty, [&](auto &writer) {
       AutoJsonObject obj(writer);
       {
@@ -123,7 +124,7 @@ namespace mtconnect::printer {
         {
           AutoJsonObject obj(writer, "Header");
           header(obj, m_version, m_senderName, instanceId, bufferSize, *m_schemaVersion,
-                 m_modelChangeTime);
+                 getModelChangeTime());
         }
         {
           if (m_jsonVersion > 1)
@@ -158,7 +159,7 @@ namespace mtconnect::printer {
       }
     });
 
-    return string(output.GetString(), output.GetLength());
+    return doc;
   }
 
   std::string JsonPrinter::printProbe(const uint64_t instanceId, const unsigned int bufferSize,
@@ -170,7 +171,8 @@ namespace mtconnect::printer {
   {
     defaultSchemaVersion();
 
-    StringBuffer output;
+    string doc;
+    JsonStringOutput output(doc);
     RenderJson(output, m_pretty || pretty, [&](auto &writer) {
       entity::JsonPrinter printer(writer, m_jsonVersion, includeHidden);
 
@@ -180,7 +182,7 @@ namespace mtconnect::printer {
       {
         AutoJsonObject obj(writer, "Header");
         probeAssetHeader(obj, m_version, m_senderName, instanceId, bufferSize, assetBufferSize,
-                         assetCount, *m_schemaVersion, m_modelChangeTime);
+                         assetCount, *m_schemaVersion, getModelChangeTime());
       }
       {
         obj.Key("Devices");
@@ -188,7 +190,7 @@ namespace mtconnect::printer {
       }
     });
 
-    return string(output.GetString(), output.GetLength());
+    return doc;
   }
 
   std::string JsonPrinter::printAssets(const uint64_t instanceId, const unsigned int bufferSize,
@@ -197,7 +199,8 @@ namespace mtconnect::printer {
   {
     defaultSchemaVersion();
 
-    StringBuffer output;
+    string doc;
+    JsonStringOutput output(doc);
     RenderJson(output, m_pretty || pretty, [&](auto &writer) {
       entity::JsonPrinter printer(writer, m_jsonVersion);
 
@@ -207,14 +210,14 @@ namespace mtconnect::printer {
       {
         AutoJsonObject obj(writer, "Header");
         probeAssetHeader(obj, m_version, m_senderName, instanceId, 0, bufferSize, assetCount,
-                         *m_schemaVersion, m_modelChangeTime);
+                         *m_schemaVersion, getModelChangeTime());
       }
       {
         obj.Key("Assets");
         printer.printEntityList(asset);
       }
     });
-    return string(output.GetString(), output.GetLength());
+    return doc;
   }
 
   using namespace boost;
@@ -247,6 +250,28 @@ namespace mtconnect::printer {
     DataItem::Category m_category;
   };
 
+  /// @brief Print an observation splicing in the data item's preformatted properties
+  ///
+  /// Only the timestamp, sequence, value, and the observation's own properties are formatted.
+  /// `extra` holds the timestamp and sequence and is reused between observations.
+  template <typename P>
+  inline void printObservation(P &printer, const ObservationRef &ref, bool named,
+                               ObservationFragmentCache &cache, uint64_t modelVersion,
+                               std::vector<entity::Property> &extra)
+  {
+    const auto &observation = ref.m_observation;
+    extra.clear();
+    if (observation->getSequence() > 0)
+      extra.emplace_back("sequence", int64_t(observation->getSequence()));
+    extra.emplace_back("timestamp", observation->getTimestamp());
+
+    auto fragments = cache.get(*ref.m_dataItem, modelVersion);
+    if (named)
+      printer.print(observation, *fragments, extra);
+    else
+      printer.printEntity(observation, *fragments, extra);
+  }
+
   using ObservationMap = multi_index_container<
       ObservationRef,
       indexed_by<ordered_non_unique<composite_key<
@@ -258,13 +283,15 @@ namespace mtconnect::printer {
           const_mem_fun<ObservationRef, SequenceNumber_t, &ObservationRef::getSequence>>>>>;
 
   template <typename T>
-  void printSampleVersion1(T &writer, uint32_t jsonVersion, ObservationMap &observations)
+  void printSampleVersion1(T &writer, uint32_t jsonVersion, ObservationMap &observations,
+                           ObservationFragmentCache &fragments, uint64_t modelVersion)
   {
     using WriterType = decltype(writer);
     using StackType = JsonStack<WriterType>;
 
     StackType stack(writer);
     entity::JsonPrinter printer(writer, jsonVersion);
+    std::vector<entity::Property> extra;
 
     AutoJsonArray streams(writer, "Streams");
 
@@ -312,14 +339,15 @@ namespace mtconnect::printer {
         stack.addArray(ref.m_dataItem->getCategoryText());
       }
 
-      printer.print(ref.m_observation);
+      printObservation(printer, ref, true, fragments, modelVersion, extra);
     }
 
     stack.clear();
   }
 
   template <typename T>
-  void printSampleVersion2(T &writer, uint32_t jsonVersion, ObservationMap &observations)
+  void printSampleVersion2(T &writer, uint32_t jsonVersion, ObservationMap &observations,
+                           ObservationFragmentCache &fragments, uint64_t modelVersion)
   {
     using WriterType = decltype(writer);
     using StackType = JsonStack<WriterType>;
@@ -328,6 +356,7 @@ namespace mtconnect::printer {
     AutoJsonArray devStream(writer, "DeviceStream");
     StackType stack(writer);
     entity::JsonPrinter printer(writer, jsonVersion);
+    std::vector<entity::Property> extra;
 
     std::string_view deviceId;
     std::string_view componentId;
@@ -384,7 +413,7 @@ namespace mtconnect::printer {
         stack.addArray(obsType);
       }
 
-      printer.printEntity(ref.m_observation);
+      printObservation(printer, ref, false, fragments, modelVersion, extra);
     }
 
     stack.clear();
@@ -397,7 +426,8 @@ namespace mtconnect::printer {
   {
     defaultSchemaVersion();
 
-    StringBuffer output;
+    string doc;
+    JsonStringOutput output(doc);
     RenderJson(output, m_pretty || pretty, [&](auto &writer) {
       AutoJsonObject top(writer);
       AutoJsonObject obj(writer, "MTConnectStreams");
@@ -405,7 +435,7 @@ namespace mtconnect::printer {
       {
         AutoJsonObject obj(writer, "Header");
         streamHeader(obj, m_version, m_senderName, instanceId, bufferSize, nextSeq, firstSeq,
-                     lastSeq, *m_schemaVersion, m_modelChangeTime);
+                     lastSeq, *m_schemaVersion, getModelChangeTime());
       }
 
       {
@@ -420,9 +450,9 @@ namespace mtconnect::printer {
           }
 
           if (m_jsonVersion == 1)
-            printSampleVersion1(writer, m_jsonVersion, obs);
+            printSampleVersion1(writer, m_jsonVersion, obs, m_fragments, m_modelVersion);
           else if (m_jsonVersion == 2)
-            printSampleVersion2(writer, m_jsonVersion, obs);
+            printSampleVersion2(writer, m_jsonVersion, obs, m_fragments, m_modelVersion);
         }
         else
         {
@@ -431,6 +461,6 @@ namespace mtconnect::printer {
       }
     });
 
-    return string(output.GetString(), output.GetLength());
+    return doc;
   }
 }  // namespace mtconnect::printer
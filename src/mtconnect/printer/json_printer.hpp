@@ -19,6 +19,7 @@
 
 #include "mtconnect/asset/cutting_tool.hpp"
 #include "mtconnect/config.hpp"
+#include "mtconnect/printer/observation_fragments.hpp"
 #include "mtconnect/printer/printer.hpp"
 #include "mtconnect/utilities.hpp"
 
@@ -55,5 +56,6 @@ namespace mtconnect::printer {
     std::string m_version;
     std::string m_hostname;
     uint32_t m_jsonVersion;
+    mutable ObservationFragmentCache m_fragments;
   };
 }  // namespace mtconnect::printer
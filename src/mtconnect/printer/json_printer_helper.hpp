@@ -18,6 +18,7 @@
 #pragma once
 
 #include <cmath>
+#include <string>
 #include <rapidjson/document.h>
 #include <rapidjson/prettywriter.h>
 #include <rapidjson/stringbuffer.h>
@@ -25,6 +26,28 @@
 
 namespace mtconnect::printer {
 
+  /// @brief A rapidjson output stream appending to a string
+  ///
+  /// Documents are rendered directly into the string that is returned to the caller instead of
+  /// being copied out of a `rapidjson::StringBuffer`.
+  class AGENT_LIB_API JsonStringOutput
+  {
+  public:
+    using Ch = char;
+
+    /// @brief Create an output stream for a string
+    /// @param[in] out the string to append to
+    JsonStringOutput(std::string &out) : m_out(out) {}
+
+    /// @brief append a character
+    void Put(Ch c) { m_out.push_back(c); }
+    /// @brief nothing to flush, the characters are in the string
+    void Flush() {}
+
+  protected:
+    std::string &m_out;
+  };
+
   /// @brief Abstract helper wrapping the rapidjson writer and providing some helper methods
   /// serializing types.
   ///
@@ -335,7 +358,7 @@ namespace mtconnect::printer {
   /// Calls func with the writer allowing the correct templates to be instantiated depending on
   /// pretty printing.
   ///
-  /// @param[in] output the rapidjson output object, like `StringBuffer`
+  /// @param[in] output the rapidjson output object, like `StringBuffer` or `JsonStringOutput`
   /// @param[in] pretty `true` creates a `rapidjson::PrettyWriter` and `false` creates a
   /// `rapidjson::Writer`
   /// @param[in] func the lambda to callback with the writer
@@ -346,13 +369,13 @@ namespace mtconnect::printer {
   {
     if (pretty)
     {
-      rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(output);
+      rapidjson::PrettyWriter<T> writer(output);
       writer.SetIndent(' ', 2);
       func(writer);
     }
     else
     {
-      rapidjson::Writer<rapidjson::StringBuffer> writer(output);
+      rapidjson::Writer<T> writer(output);
       func(writer);
     }
   }
@@ -0,0 +1,93 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "observation_fragments.hpp"
+
+#include <mutex>
+
+#include "mtconnect/printer/json_printer_helper.hpp"
+#include "mtconnect/printer/xml_printer_helper.hpp"
+
+using namespace std;
+
+namespace mtconnect::printer {
+  using namespace device_model::data_item;
+
+  ObservationFragmentsPtr ObservationFragmentCache::get(const DataItem &dataItem,
+                                                        uint64_t modelVersion)
+  {
+    {
+      shared_lock<shared_mutex> lock(m_mutex);
+      if (m_modelVersion == modelVersion)
+      {
+        // A data item freed with the old model may share an address with a new one
+        auto it = m_entries.find(&dataItem);
+        if (it != m_entries.end() && !it->second.m_dataItem.expired())
+          return it->second.m_fragments;
+      }
+    }
+
+    auto fragments = make_shared<const ObservationFragments>(
+        build(dataItem.getObservationProperties()));
+
+    unique_lock<shared_mutex> lock(m_mutex);
+    if (m_modelVersion != modelVersion)
+    {
+      m_entries.clear();
+      m_modelVersion = modelVersion;
+    }
+    m_entries.insert_or_assign(&dataItem, Entry {dataItem.weak_from_this(), fragments});
+
+    return fragments;
+  }
+
+  ObservationFragments ObservationFragmentCache::build(const entity::Properties &properties)
+  {
+    ObservationFragments fragments;
+    for (const auto &[key, value] : properties)
+    {
+      const auto &text = std::get<string>(value);
+      ObservationFragment fragment {key};
+
+      {
+        XmlWriter writer(false);
+        THROW_IF_XML2_ERROR(xmlTextWriterStartDocument(writer, nullptr, "UTF-8", nullptr));
+        THROW_IF_XML2_ERROR(xmlTextWriterStartElement(writer, BAD_CAST "x"));
+        THROW_IF_XML2_ERROR(
+            xmlTextWriterWriteAttribute(writer, BAD_CAST key.c_str(), BAD_CAST text.c_str()));
+        auto element = writer.getFragment();
+        fragment.m_xml = element.substr(element.rfind("<x") + 2);
+      }
+
+      {
+        JsonStringOutput output(fragment.m_jsonKey);
+        rapidjson::Writer<JsonStringOutput> writer(output);
+        writer.String(key.data(), rapidjson::SizeType(key.size()));
+      }
+
+      {
+        JsonStringOutput output(fragment.m_jsonValue);
+        rapidjson::Writer<JsonStringOutput> writer(output);
+        writer.String(text.data(), rapidjson::SizeType(text.size()));
+      }
+
+      fragments.emplace_back(std::move(fragment));
+    }
+
+    return fragments;
+  }
+}  // namespace mtconnect::printer
@@ -0,0 +1,75 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/device_model/data_item/data_item.hpp"
+
+namespace mtconnect::printer {
+  /// @brief The serialized forms of a data item property shared by its observations
+  struct ObservationFragment
+  {
+    std::string m_key;        ///< the property key
+    std::string m_xml;        ///< ` key="value"` escaped as an XML attribute
+    std::string m_jsonKey;    ///< the key as a JSON string
+    std::string m_jsonValue;  ///< the value as a JSON string
+  };
+  using ObservationFragments = std::vector<ObservationFragment>;
+  using ObservationFragmentsPtr = std::shared_ptr<const ObservationFragments>;
+
+  /// @brief Caches the observation properties of each data item serialized for a printer
+  ///
+  /// The fragments are in the same order as the data item's observation properties. The cache is
+  /// cleared when the printer's model version changes.
+  class AGENT_LIB_API ObservationFragmentCache
+  {
+  public:
+    /// @brief get the fragments for a data item, building them the first time
+    /// @param[in] dataItem the data item
+    /// @param[in] modelVersion the printer's model version
+    /// @return the observation property fragments
+    ObservationFragmentsPtr get(const device_model::data_item::DataItem &dataItem,
+                                uint64_t modelVersion);
+
+    /// @brief serialize observation properties
+    ///
+    /// The fragments are written with the same writers as the printers so they escape the same
+    /// way.
+    ///
+    /// @param[in] properties the data item's observation properties
+    /// @return the fragments
+    static ObservationFragments build(const entity::Properties &properties);
+
+  protected:
+    struct Entry
+    {
+      std::weak_ptr<const entity::Entity> m_dataItem;
+      ObservationFragmentsPtr m_fragments;
+    };
+
+    std::shared_mutex m_mutex;
+    uint64_t m_modelVersion {0};
+    std::unordered_map<const device_model::data_item::DataItem *, Entry> m_entries;
+  };
+}  // namespace mtconnect::printer
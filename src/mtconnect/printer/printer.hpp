@@ -17,8 +17,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -114,22 +116,44 @@ namespace mtconnect {
       /// @return the mime type
       virtual std::string mimeType() const = 0;
       /// @brief Set the last model change time
+      ///
+      /// The time is swapped atomically, the printers read it while the device model changes.
+      ///
       /// @param t the time
-      void setModelChangeTime(const std::string &t) { m_modelChangeTime = t; }
+      void setModelChangeTime(const std::string &t)
+      {
+        std::atomic_store(&m_modelChangeTime, std::make_shared<const std::string>(t));
+        m_modelVersion++;
+      }
       /// @brief Get the last model change time
       /// @return the time
-      const std::string &getModelChangeTime() { return m_modelChangeTime; }
+      std::string getModelChangeTime() const { return *std::atomic_load(&m_modelChangeTime); }
+      /// @brief Get the model version
+      ///
+      /// The version changes every time the device model or the printer settings change, so
+      /// documents rendered from the device model can be reused while the version is the same.
+      ///
+      /// @return the model version
+      uint64_t getModelVersion() const { return m_modelVersion; }
 
       /// @brief set the schema version we are generating
       /// @param s the version
-      void setSchemaVersion(const std::string &s) { m_schemaVersion = s; }
+      void setSchemaVersion(const std::string &s)
+      {
+        m_schemaVersion = s;
+        m_modelVersion++;
+      }
       /// @brief Get the schema version
       /// @return the schema version
       const auto &getSchemaVersion() const { return m_schemaVersion; }
 
       /// @brief sets the sener name for the header
       /// @param name the name of the sender
-      void setSenderName(const std::string &s) { m_senderName = s; }
+      void setSenderName(const std::string &s)
+      {
+        m_senderName = s;
+        m_modelVersion++;
+      }
 
       /// @brief gets the sender name
       /// @returns the name of the sender in the header
@@ -148,9 +172,11 @@ namespace mtconnect {
 
     protected:
       bool m_pretty;
-      std::string m_modelChangeTime;
+      std::shared_ptr<const std::string> m_modelChangeTime {
+          std::make_shared<const std::string>()};
       std::optional<std::string> m_schemaVersion;
       std::string m_senderName {"localhost"};
+      std::atomic<uint64_t> m_modelVersion {0};
     };
   }  // namespace printer
 }  // namespace mtconnect
@@ -34,6 +34,7 @@
 #include "mtconnect/logging.hpp"
 #include "mtconnect/version.h"
 #include "xml_printer.hpp"
+#include "xml_streams_printer.hpp"
 
 #define strfy(line) #line
 #define THROW_IF_XML2_ERROR(expr)                                           \
@@ -57,10 +58,13 @@ namespace mtconnect::printer {
   class AGENT_LIB_API XmlWriter
   {
   public:
-    XmlWriter(bool pretty) : m_writer(nullptr), m_buf(nullptr)
+    XmlWriter(bool pretty) : m_writer(nullptr)
     {
-      THROW_IF_XML2_NULL(m_buf = xmlBufferCreate());
-      THROW_IF_XML2_NULL(m_writer = xmlNewTextWriterMemory(m_buf, 0));
+      xmlOutputBufferPtr out;
+      THROW_IF_XML2_NULL(out = xmlOutputBufferCreateIO(append, nullptr, &m_content, nullptr));
+      if ((m_writer = xmlNewTextWriter(out)) == nullptr)
+        xmlOutputBufferClose(out);
+      THROW_IF_XML2_NULL(m_writer);
       if (pretty)
       {
         THROW_IF_XML2_ERROR(xmlTextWriterSetIndent(m_writer, 1));
@@ -75,11 +79,6 @@ namespace mtconnect::printer {
         xmlFreeTextWriter(m_writer);
         m_writer = nullptr;
       }
-      if (m_buf != nullptr)
-      {
-        xmlBufferFree(m_buf);
-        m_buf = nullptr;
-      }
     }
 
     operator xmlTextWriterPtr() { return m_writer; }
@@ -92,12 +91,29 @@ namespace mtconnect::printer {
         xmlFreeTextWriter(m_writer);
         m_writer = nullptr;
       }
-      return string((char *)m_buf->content, m_buf->use);
+      return std::move(m_content);
+    }
+
+    string getFragment()
+    {
+      if (m_writer != nullptr)
+      {
+        xmlFreeTextWriter(m_writer);
+        m_writer = nullptr;
+      }
+      return std::move(m_content);
+    }
+
+  protected:
+    static int append(void *context, const char *buffer, int len)
+    {
+      static_cast<string *>(context)->append(buffer, len);
+      return len;
     }
 
   protected:
     xmlTextWriterPtr m_writer;
-    xmlBufferPtr m_buf;
+    string m_content;
   };
 
   XmlPrinter::XmlPrinter(bool pretty) : Printer(pretty) { NAMED_SCOPE("xml.printer"); }
@@ -446,6 +462,20 @@ namespace mtconnect::printer {
 
     try
     {
+      if (m_fastStreams && !(m_pretty || pretty))
+      {
+        // Write the header with libxml2 and the streams directly into the document
+        XmlWriter writer(false);
+        initXmlDoc(writer, eSTREAMS, instanceId, bufferSize, 0, 0, nextSeq, firstSeq, lastSeq);
+        ret = writer.getFragment();
+
+        observations.sort(ObservationCompare);
+        XmlStreamsPrinter streams(m_streamsNsSet, m_fragments, m_modelVersion);
+        if (streams.print(ret, observations))
+          return ret;
+        ret.clear();
+      }
+
       XmlWriter writer(m_pretty || pretty);
 
       initXmlDoc(writer, eSTREAMS, instanceId, bufferSize, 0, 0, nextSeq, firstSeq, lastSeq);
@@ -673,7 +703,7 @@ namespace mtconnect::printer {
 
     if (major > 1 || (major == 1 && minor >= 7))
     {
-      addAttribute(writer, "deviceModelChangeTime", m_modelChangeTime);
+      addAttribute(writer, "deviceModelChangeTime", getModelChangeTime());
     }
 
     if (aType == eASSETS || aType == eDEVICES)
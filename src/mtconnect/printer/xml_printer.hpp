@@ -21,6 +21,7 @@
 
 #include "mtconnect/asset/asset.hpp"
 #include "mtconnect/config.hpp"
+#include "mtconnect/printer/observation_fragments.hpp"
 #include "mtconnect/printer/printer.hpp"
 #include "mtconnect/utilities.hpp"
 
@@ -105,6 +106,14 @@ namespace mtconnect {
       /// @param style the stype sheet
       void setErrorStyle(const std::string &style);
 
+      /// @brief Write the streams of documents without indentation directly into the document
+      ///
+      /// The output is the same as writing every element with libxml2.
+      /// @param fast `true` to bypass libxml2 for the streams, the default
+      void setFastStreams(bool fast) { m_fastStreams = fast; }
+      /// @brief get if the streams are written directly into the document
+      bool getFastStreams() const { return m_fastStreams; }
+
       /// @name For testing
       ///@{
 
@@ -195,6 +204,9 @@ namespace mtconnect {
       std::string m_devicesStyle;
       std::string m_errorStyle;
       std::string m_assetStyle;
+
+      bool m_fastStreams {true};
+      mutable ObservationFragmentCache m_fragments;
     };
   }  // namespace printer
 }  // namespace mtconnect
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <string>
+
 #include <libxml/xmlwriter.h>
 
 #include "mtconnect/config.hpp"
@@ -28,11 +30,18 @@ namespace mtconnect::printer {
   {
   public:
     /// @brief Construct an XmlWriter creating setting up the buffer for writing.
+    ///
+    /// The document is written directly into the string returned by `getContent()`, so it is
+    /// not copied out of a libxml2 buffer.
+    ///
     /// @param pretty `true` if output is formatted with indentation
-    XmlWriter(bool pretty) : m_writer(nullptr), m_buf(nullptr)
+    XmlWriter(bool pretty) : m_writer(nullptr)
     {
-      THROW_IF_XML2_NULL(m_buf = xmlBufferCreate());
-      THROW_IF_XML2_NULL(m_writer = xmlNewTextWriterMemory(m_buf, 0));
+      xmlOutputBufferPtr out;
+      THROW_IF_XML2_NULL(out = xmlOutputBufferCreateIO(append, nullptr, &m_content, nullptr));
+      if ((m_writer = xmlNewTextWriter(out)) == nullptr)
+        xmlOutputBufferClose(out);
+      THROW_IF_XML2_NULL(m_writer);
       if (pretty)
       {
         THROW_IF_XML2_ERROR(xmlTextWriterSetIndent(m_writer, 1));
@@ -47,11 +56,6 @@ namespace mtconnect::printer {
         xmlFreeTextWriter(m_writer);
         m_writer = nullptr;
       }
-      if (m_buf != nullptr)
-      {
-        xmlBufferFree(m_buf);
-        m_buf = nullptr;
-      }
     }
 
     /// @brief cast this object as a xmlTextWriterPtr
@@ -59,6 +63,9 @@ namespace mtconnect::printer {
     operator xmlTextWriterPtr() { return m_writer; }
 
     /// @brief Get the content of the buffer as a string. Free the writer if it is allocated.
+    ///
+    /// Freeing the writer flushes the remaining output. The content is moved out of the writer.
+    ///
     /// @return content as a string
     std::string getContent()
     {
@@ -68,12 +75,34 @@ namespace mtconnect::printer {
         xmlFreeTextWriter(m_writer);
         m_writer = nullptr;
       }
-      return std::string((char *)m_buf->content, m_buf->use);
+      return std::move(m_content);
+    }
+
+    /// @brief Get the content written so far without ending the document and free the writer.
+    ///
+    /// Used to render a fragment, such as a single element, that is spliced into another document.
+    ///
+    /// @return content as a string
+    std::string getFragment()
+    {
+      if (m_writer != nullptr)
+      {
+        xmlFreeTextWriter(m_writer);
+        m_writer = nullptr;
+      }
+      return std::move(m_content);
+    }
+
+  protected:
+    static int append(void *context, const char *buffer, int len)
+    {
+      static_cast<std::string *>(context)->append(buffer, len);
+      return len;
     }
 
   protected:
     xmlTextWriterPtr m_writer;
-    xmlBufferPtr m_buf;
+    std::string m_content;
   };
 
   /// @brief Wrapper to create an XML open element
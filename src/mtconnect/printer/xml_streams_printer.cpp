@@ -0,0 +1,285 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "xml_streams_printer.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+
+#include "mtconnect/device_model/device.hpp"
+#include "mtconnect/entity/xml_printer.hpp"
+#include "mtconnect/printer/xml_printer_helper.hpp"
+
+using namespace std;
+
+namespace mtconnect::printer {
+  using namespace observation;
+  using namespace entity;
+  using namespace device_model;
+  using namespace device_model::data_item;
+
+  /// @brief `true` if the text is written the same with or without XML escaping
+  ///
+  /// Any character libxml2 may replace with an entity or character reference, and all non-ASCII
+  /// text, is left to the libxml2 writer.
+  static inline bool isPlain(string_view text)
+  {
+    for (unsigned char c : text)
+    {
+      if (c < 0x20 || c > 0x7E || c == '&' || c == '<' || c == '>' || c == '"')
+        return false;
+    }
+    return true;
+  }
+
+  /// @brief Format a value the way the entity::XmlPrinter converts it to a string
+  /// @returns a pointer to the string value or to `temp` if it was converted
+  static inline const string *valueText(const Value &value, string &temp)
+  {
+    if (auto s = get_if<string>(&value))
+      return s;
+    else if (auto d = get_if<double>(&value))
+    {
+      temp.clear();
+      appendDouble(temp, *d);
+    }
+    else if (auto i = get_if<int64_t>(&value))
+    {
+      char buffer[24];
+      temp.assign(buffer, to_chars(buffer, buffer + sizeof(buffer), *i).ptr);
+    }
+    else if (auto ts = get_if<Timestamp>(&value))
+      temp = format(*ts);
+    else
+    {
+      Value conv = value;
+      ConvertValueToType(conv, ValueType::STRING);
+      temp = std::move(get<string>(conv));
+    }
+    return &temp;
+  }
+
+  /// @brief append an attribute if it is not empty
+  /// @returns `false` if the value must be escaped
+  static inline bool appendAttribute(string &doc, const char *key, const string &value)
+  {
+    if (value.empty())
+      return true;
+    if (!isPlain(value))
+      return false;
+
+    doc.append(" ").append(key).append("=\"").append(value).append("\"");
+    return true;
+  }
+
+  bool XmlStreamsPrinter::print(string &doc, const ObservationList &observations)
+  {
+    auto start = doc.size();
+    bool streams = false;
+    string_view deviceId, componentId;
+    const char *category = nullptr;
+
+    for (auto &observation : observations)
+    {
+      if (observation->isOrphan())
+        continue;
+
+      const auto &dataItem = observation->getDataItem();
+      const auto &component = dataItem->getComponent();
+      const auto &device = component->getDevice();
+
+      if (!streams)
+      {
+        doc.append("<Streams>");
+        streams = true;
+      }
+
+      if (deviceId != device->getId())
+      {
+        if (category)
+          doc.append("</").append(category).append(">");
+        if (!componentId.empty())
+          doc.append("</ComponentStream>");
+        if (!deviceId.empty())
+          doc.append("</DeviceStream>");
+        category = nullptr;
+        componentId = {};
+
+        doc.append("<DeviceStream");
+        if (!appendAttribute(doc, "name", device->getComponentName().value_or("")) ||
+            !appendAttribute(doc, "uuid", device->getUuid().value_or("")))
+        {
+          doc.resize(start);
+          return false;
+        }
+        doc.append(">");
+        deviceId = device->getId();
+      }
+
+      if (componentId != component->getId())
+      {
+        if (category)
+          doc.append("</").append(category).append(">");
+        if (!componentId.empty())
+          doc.append("</ComponentStream>");
+        category = nullptr;
+
+        doc.append("<ComponentStream");
+        if (!appendAttribute(doc, "component", component->getName()) ||
+            (component->getComponentName() &&
+             !appendAttribute(doc, "name", *component->getComponentName())) ||
+            !appendAttribute(doc, "componentId", component->getId()))
+        {
+          doc.resize(start);
+          return false;
+        }
+        doc.append(">");
+        componentId = component->getId();
+      }
+
+      if (category == nullptr || strcmp(category, dataItem->getCategoryText()) != 0)
+      {
+        if (category)
+          doc.append("</").append(category).append(">");
+        category = dataItem->getCategoryText();
+        doc.append("<").append(category).append(">");
+      }
+
+      if (!printObservation(doc, *observation, *dataItem))
+        printFallback(doc, observation);
+    }
+
+    if (streams)
+    {
+      if (category)
+        doc.append("</").append(category).append(">");
+      doc.append("</ComponentStream></DeviceStream></Streams>");
+    }
+    else
+    {
+      doc.append("<Streams/>");
+    }
+
+    // The libxml2 writer ends a document without indentation with a new line
+    doc.append("</MTConnectStreams>\n");
+
+    return true;
+  }
+
+  bool XmlStreamsPrinter::printObservation(string &doc, const Observation &observation,
+                                           const DataItem &dataItem)
+  {
+    const auto &name = observation.getName();
+    if (name.hasNs())
+      return false;
+
+    // Merge the attributes in the same order as getAllProperties(): the observation properties
+    // take precedence over the data item properties, timestamp, and sequence
+    m_attributes.clear();
+    const Value *value = nullptr;
+    for (const auto &prop : observation.getProperties())
+    {
+      const auto &key = prop.first;
+      if (key == "VALUE")
+        value = &prop.second;
+      else if (key.hasNs() || !islower(static_cast<unsigned char>(key[0])))
+        return false;
+      else if (!observation.isHidden(key))
+        m_attributes.push_back({key, nullptr, &prop.second});
+    }
+
+    auto add = [this](string_view key, const string *text, const Value *value) {
+      auto it = find_if(m_attributes.begin(), m_attributes.end(),
+                        [key](const Attribute &a) { return a.m_key == key; });
+      if (it == m_attributes.end())
+        m_attributes.push_back({key, text, value});
+    };
+    m_dataItemFragments = m_fragments.get(dataItem, m_modelVersion);
+    for (const auto &fragment : *m_dataItemFragments)
+      add(fragment.m_key, &fragment.m_xml, nullptr);
+    m_timestamp = observation.getTimestamp();
+    add("timestamp", nullptr, &m_timestamp);
+    if (observation.getSequence() > 0)
+    {
+      m_sequence = int64_t(observation.getSequence());
+      add("sequence", nullptr, &m_sequence);
+    }
+
+    sort(m_attributes.begin(), m_attributes.end(),
+         [](const Attribute &a, const Attribute &b) { return a.m_key < b.m_key; });
+
+    auto mark = doc.size();
+    doc.append("<").append(name);
+    for (const auto &attr : m_attributes)
+    {
+      if (attr.m_text)
+      {
+        doc.append(*attr.m_text);
+      }
+      else
+      {
+        const string *text = valueText(*attr.m_value, m_text);
+        if (!isPlain(*text))
+        {
+          doc.resize(mark);
+          return false;
+        }
+        doc.append(" ").append(attr.m_key).append("=\"").append(*text).append("\"");
+      }
+    }
+
+    const string *text = nullptr;
+    if (value)
+    {
+      if (holds_alternative<DataSet>(*value) || holds_alternative<EntityPtr>(*value) ||
+          holds_alternative<EntityList>(*value))
+      {
+        doc.resize(mark);
+        return false;
+      }
+
+      text = valueText(*value, m_text);
+      if (!isPlain(*text))
+      {
+        doc.resize(mark);
+        return false;
+      }
+    }
+
+    if (text && !text->empty())
+      doc.append(">").append(*text).append("</").append(name).append(">");
+    else
+      doc.append("/>");
+
+    return true;
+  }
+
+  void XmlStreamsPrinter::printFallback(string &doc, const ObservationPtr &observation)
+  {
+    // Start the document so attributes are encoded as UTF-8 the same as in the document, then
+    // skip the XML declaration
+    XmlWriter writer(false);
+    THROW_IF_XML2_ERROR(xmlTextWriterStartDocument(writer, nullptr, "UTF-8", nullptr));
+    entity::XmlPrinter printer;
+    printer.print(writer, observation, m_namespaces);
+    auto element = writer.getFragment();
+    auto start = element.find('<', element.find("?>"));
+    doc.append(element, start);
+  }
+}  // namespace mtconnect::printer
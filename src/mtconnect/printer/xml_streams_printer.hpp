@@ -0,0 +1,78 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/observation/observation.hpp"
+#include "mtconnect/printer/observation_fragments.hpp"
+
+namespace mtconnect::printer {
+  /// @brief Writes the `Streams` of an MTConnectStreams document directly into a string
+  ///
+  /// The output is byte for byte the same as the libxml2 text writer without indentation. The
+  /// attributes an observation takes from its data item are spliced in from the printer's
+  /// fragment cache. Observations with values that must be escaped, namespaces, or child elements
+  /// other than the value are written with the entity::XmlPrinter.
+  class AGENT_LIB_API XmlStreamsPrinter
+  {
+  public:
+    /// @brief Create a printer for one document
+    /// @param[in] namespaces the declared Streams namespaces
+    /// @param[in] fragments the printer's cache of the data item attributes
+    /// @param[in] modelVersion the printer's model version
+    XmlStreamsPrinter(const std::unordered_set<std::string> &namespaces,
+                      ObservationFragmentCache &fragments, uint64_t modelVersion)
+      : m_namespaces(namespaces), m_fragments(fragments), m_modelVersion(modelVersion)
+    {}
+
+    /// @brief Append the `Streams` element and close the `MTConnectStreams` element
+    /// @param[in,out] doc the document with the open root element and the header
+    /// @param[in] observations the observations sorted by device, component, and category
+    /// @return `false` if a device or component attribute must be escaped, `doc` is left
+    ///         unchanged and the document must be written with libxml2
+    bool print(std::string &doc, const observation::ObservationList &observations);
+
+  protected:
+    /// @brief An attribute taken from the data item or the observation
+    struct Attribute
+    {
+      std::string_view m_key;
+      const std::string *m_text;     ///< the preformatted data item attribute
+      const entity::Value *m_value;  ///< the observation value if there is no text
+    };
+
+    bool printObservation(std::string &doc, const observation::Observation &observation,
+                          const device_model::data_item::DataItem &dataItem);
+    void printFallback(std::string &doc, const observation::ObservationPtr &observation);
+
+  protected:
+    const std::unordered_set<std::string> &m_namespaces;
+    ObservationFragmentCache &m_fragments;
+    uint64_t m_modelVersion;
+    ObservationFragmentsPtr m_dataItemFragments;
+    std::vector<Attribute> m_attributes;
+    entity::Value m_timestamp;
+    entity::Value m_sequence;
+    std::string m_text;
+  };
+}  // namespace mtconnect::printer
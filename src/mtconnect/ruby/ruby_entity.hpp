@@ -434,7 +434,8 @@ namespace mtconnect::ruby {
           mrb, entityClass, "properties",
           [](mrb_state *mrb, mrb_value self) {
             auto entity = MRubySharedPtr<Entity>::unwrap(self);
-            auto props = entity->getProperties();
+            Properties scratch;
+            const auto &props = entity->getAllProperties(scratch);
 
             return toRuby(mrb, props);
           },
@@ -447,10 +448,9 @@ namespace mtconnect::ruby {
 
             mrb_get_args(mrb, "z", &key);
 
-            auto props = entity->getProperties();
-            auto it = props.find(key);
-            if (it != props.end())
-              return toRuby(mrb, it->second);
+            const auto &value = entity->getProperty(key);
+            if (!std::holds_alternative<std::monostate>(value))
+              return toRuby(mrb, value);
             else
               return mrb_nil_value();
           },
@@ -47,12 +47,13 @@ namespace mtconnect {
                                  const ConfigOptions &options, const ptree &config)
         : Sink("Mqtt2Service", std::move(contract)),
           m_context(context),
-          m_strand(context),
+          m_strand(boost::asio::make_strand(context)),
           m_options(options),
           m_currentTimer(context)
       {
-        // Unique id number for agent instance
-        m_instanceId = getCurrentTimeInSec();
+        // Unique id number for agent instance, preserved when the buffer is restored
+        m_instanceId =
+            m_sinkContract->getCircularBuffer().getInstanceId().value_or(getCurrentTimeInSec());
 
         auto jsonPrinter = dynamic_cast<printer::JsonPrinter *>(m_sinkContract->getPrinter("json"));
 
@@ -183,9 +184,9 @@ namespace mtconnect {
 
       struct AsyncSample : public observation::AsyncObserver
       {
-        AsyncSample(boost::asio::io_context::strand &strand,
-                    mtconnect::buffer::CircularBuffer &buffer, FilterSet &&filter,
-                    std::chrono::milliseconds interval, std::chrono::milliseconds heartbeat,
+        AsyncSample(observation::ObserverStrand &strand, mtconnect::buffer::CircularBuffer &buffer,
+                    FilterSet &&filter, std::chrono::milliseconds interval,
+                    std::chrono::milliseconds heartbeat,
                     std::shared_ptr<MqttClient> client, DevicePtr device)
           : observation::AsyncObserver(strand, buffer, std::move(filter), interval, heartbeat),
             m_device(device),
@@ -236,9 +237,7 @@ namespace mtconnect {
                                        std::move(filterSet), m_sampleInterval, 600s, m_client, dev);
           sampler->m_sink = getptr();
           sampler->m_handler = boost::bind(&Mqtt2Service::publishSample, this, _1);
-          sampler->observe(seq, [this](const std::string &id) {
-            return m_sinkContract->getDataItemById(id).get();
-          });
+          sampler->observe(seq);
           publishSample(sampler);
         }
       }
@@ -257,13 +256,12 @@ namespace mtconnect {
         SequenceNumber_t firstSeq, lastSeq;
 
         {
+          // The buffer locks itself while reading
           auto &buffer = m_sinkContract->getCircularBuffer();
-          std::lock_guard<buffer::CircularBuffer> lock(buffer);
-
-          lastSeq = buffer.getSequence() - 1;
           observations =
               buffer.getObservations(m_sampleCount, sampler->getFilter(), sampler->getSequence(),
                                      nullopt, end, firstSeq, observer->m_endOfBuffer);
+          lastSeq = buffer.getSequence() - 1;
         }
 
         doc = m_printer->printSample(m_instanceId,
@@ -315,10 +313,9 @@ namespace mtconnect {
             auto &buffer = m_sinkContract->getCircularBuffer();
             std::lock_guard<buffer::CircularBuffer> lock(buffer);
 
-            firstSeq = buffer.getFirstSequence();
+            firstSeq = buffer.getOldestSequence();
             seq = buffer.getSequence();
-            m_sinkContract->getCircularBuffer().getLatest().getObservations(observations,
-                                                                            filterSet);
+            buffer.getLatest().getObservations(observations, buffer.getFilterBits(filterSet));
           }
 
           auto doc = m_printer->printSample(m_instanceId,
@@ -216,7 +216,7 @@ namespace mtconnect {
         uint64_t m_instanceId;
 
         boost::asio::io_context &m_context;
-        boost::asio::io_context::strand m_strand;
+        observation::ObserverStrand m_strand;
 
         ConfigOptions m_options;
 
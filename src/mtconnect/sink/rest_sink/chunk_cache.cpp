@@ -0,0 +1,113 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "chunk_cache.hpp"
+
+#include <boost/container_hash/hash.hpp>
+
+#include <algorithm>
+
+#include "mtconnect/logging.hpp"
+
+using namespace std;
+
+namespace mtconnect::sink::rest_sink {
+  optional<ChunkCache::Chunk> ChunkCache::find(const Key &key)
+  {
+    lock_guard<mutex> lock(m_mutex);
+    auto now = chrono::steady_clock::now();
+    auto it = find_if(m_entries.begin(), m_entries.end(), [&key, now, this](const Entry &entry) {
+      return entry.m_key == key && now - entry.m_created < m_maxAge;
+    });
+    if (it == m_entries.end())
+    {
+      (*m_misses)++;
+      report();
+      return nullopt;
+    }
+
+    (*m_hits)++;
+    report();
+    return it->m_chunk;
+  }
+
+  void ChunkCache::insert(const Key &key, const Chunk &chunk)
+  {
+    lock_guard<mutex> lock(m_mutex);
+    auto now = chrono::steady_clock::now();
+
+    // Chunks rendered for an older buffer sequence will never be asked for again, and a chunk
+    // for the same key is replaced when it has expired.
+    m_entries.erase(remove_if(m_entries.begin(), m_entries.end(),
+                              [&key, now, this](const Entry &entry) {
+                                return entry.m_key.m_bufferSequence < key.m_bufferSequence ||
+                                       now - entry.m_created >= m_maxAge ||
+                                       entry.m_key == key;
+                              }),
+                    m_entries.end());
+    if (m_entries.size() >= m_maxSize)
+      m_entries.erase(m_entries.begin());
+
+    m_entries.push_back({key, chunk, now});
+  }
+
+  SharedChunk ChunkCache::encode(const Chunk &chunk, StreamCompressor::Encoding encoding,
+                                 int level)
+  {
+    if (!chunk.m_encodings)
+      return make_shared<const string>(
+          StreamCompressor::compress(encoding, level, *chunk.m_content));
+
+    // Concurrent requests wait for the first one to compress the chunk
+    lock_guard<mutex> lock(chunk.m_encodings->m_mutex);
+    auto &encoded = encoding == StreamCompressor::GZIP ? chunk.m_encodings->m_gzip
+                                                       : chunk.m_encodings->m_deflate;
+    if (!encoded)
+      encoded =
+          make_shared<const string>(StreamCompressor::compress(encoding, level, *chunk.m_content));
+    return encoded;
+  }
+
+  size_t ChunkCache::hash(const FilterSet &filter)
+  {
+    size_t seed = filter.size();
+    for (const auto &id : filter)
+      boost::hash_combine(seed, id);
+    return seed;
+  }
+
+  void ChunkCache::report()
+  {
+    using namespace std::chrono_literals;
+
+    // Log the hit ratio for the last period every 10 seconds while streams are active
+    auto now = chrono::steady_clock::now();
+    if (now - m_lastReport < 10s)
+      return;
+
+    auto statistics = getStatistics();
+    Statistics delta;
+    delta.m_hits = statistics.m_hits - m_lastReported.m_hits;
+    delta.m_misses = statistics.m_misses - m_lastReported.m_misses;
+    LOG(debug) << m_name << " cache - hit ratio for last 10 seconds: " << delta.hitRatio()
+               << " (" << delta.m_hits << " hits, " << delta.m_misses
+               << " misses), overall: " << statistics.hitRatio();
+
+    m_lastReported = statistics;
+    m_lastReport = now;
+  }
+}  // namespace mtconnect::sink::rest_sink
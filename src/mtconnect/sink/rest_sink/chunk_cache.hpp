@@ -0,0 +1,180 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "compression.hpp"
+#include "mtconnect/config.hpp"
+#include "mtconnect/utilities.hpp"
+#include "session.hpp"
+
+namespace mtconnect::printer {
+  class Printer;
+}
+
+namespace mtconnect::sink::rest_sink {
+  /// @brief Shares the rendered documents of identical requests
+  ///
+  /// Requests with the same printer, filter, count, starting sequence and formatting render the
+  /// same document for the same state of the circular buffer. The first request renders it and
+  /// the others write the same immutable buffer. The buffer sequence is part of the key, so
+  /// entries become stale when a new observation arrives and are purged on the next insert.
+  /// Entries also expire after a maximum age so the document creation time stays current when
+  /// the buffer is idle.
+  class AGENT_LIB_API ChunkCache
+  {
+  public:
+    /// @brief The parameters that determine the content of a document
+    struct Key
+    {
+      const printer::Printer *m_printer {nullptr};
+      std::shared_ptr<const FilterSet> m_filter;  ///< shared by all the chunks of a stream
+      size_t m_filterHash {0};
+      int m_count {0};              ///< 0 for a current request
+      SequenceNumber_t m_from {0};  ///< 0 when the request starts at the oldest sequence
+      bool m_pretty {false};
+      bool m_eventStream {false};             ///< the document is formatted as an event
+      SequenceNumber_t m_bufferSequence {0};  ///< the next sequence of the circular buffer
+
+      bool operator==(const Key &other) const
+      {
+        return m_printer == other.m_printer && m_filterHash == other.m_filterHash &&
+               m_count == other.m_count && m_from == other.m_from &&
+               m_pretty == other.m_pretty && m_eventStream == other.m_eventStream &&
+               m_bufferSequence == other.m_bufferSequence &&
+               (m_filter == other.m_filter ||
+                (m_filter && other.m_filter && *m_filter == *other.m_filter));
+      }
+    };
+
+    /// @brief The compressed encodings of a chunk, made the first time a client accepts one
+    struct Encodings
+    {
+      std::mutex m_mutex;
+      SharedChunk m_gzip;
+      SharedChunk m_deflate;
+    };
+
+    /// @brief A rendered chunk and the results of the sample fetch
+    struct Chunk
+    {
+      SharedChunk m_content;
+      SequenceNumber_t m_end {0};
+      bool m_endOfBuffer {false};
+      std::shared_ptr<Encodings> m_encodings;  ///< shared by the copies, empty if not kept
+    };
+
+    /// @brief Cache counters
+    struct Statistics
+    {
+      uint64_t m_hits {0};
+      uint64_t m_misses {0};
+
+      /// @brief the fraction of the lookups that found a chunk
+      double hitRatio() const
+      {
+        auto total = m_hits + m_misses;
+        return total == 0 ? 0.0 : double(m_hits) / double(total);
+      }
+    };
+
+    /// @brief Create a chunk cache
+    /// @param name the name used when logging the hit ratio
+    /// @param maxSize the most chunks kept for the current buffer sequence
+    /// @param maxAge how long a chunk can be reused
+    ChunkCache(const std::string &name, size_t maxSize = 32,
+               std::chrono::milliseconds maxAge = std::chrono::seconds(1))
+      : m_name(name), m_maxSize(maxSize), m_maxAge(maxAge)
+    {}
+    ChunkCache(const ChunkCache &) = delete;
+
+    /// @brief find a chunk rendered for the same key
+    /// @param[in] key the chunk key
+    /// @return the chunk if one was rendered
+    std::optional<Chunk> find(const Key &key);
+    /// @brief add a rendered chunk and purge the chunks for older buffer sequences
+    /// @param[in] key the chunk key
+    /// @param[in] chunk the rendered chunk
+    void insert(const Key &key, const Chunk &chunk);
+    /// @brief remove all the chunks
+    void clear()
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_entries.clear();
+    }
+
+    /// @brief get the number of chunks in the cache
+    size_t size() const
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_entries.size();
+    }
+    /// @brief get the hit and miss counters
+    Statistics getStatistics() const { return {*m_hits, *m_misses}; }
+    /// @brief get the shared count of the lookups that found a chunk for the agent metrics
+    auto &getHits() { return m_hits; }
+    /// @brief get the shared count of the lookups that did not find a chunk for the agent metrics
+    auto &getMisses() { return m_misses; }
+
+    /// @brief get a chunk in a content encoding
+    ///
+    /// The encoding is compressed once and kept with the chunk for the other requests. A chunk
+    /// without encodings is compressed for each call.
+    ///
+    /// @param[in] chunk the chunk
+    /// @param[in] encoding the content encoding
+    /// @param[in] level the zlib compression level
+    /// @return the compressed content
+    static SharedChunk encode(const Chunk &chunk, StreamCompressor::Encoding encoding, int level);
+
+    /// @brief hash a filter set, the same for equal sets
+    /// @param[in] filter the filter set
+    /// @return the hash
+    static size_t hash(const FilterSet &filter);
+
+  protected:
+    void report();
+
+  protected:
+    struct Entry
+    {
+      Key m_key;
+      Chunk m_chunk;
+      std::chrono::steady_clock::time_point m_created;
+    };
+
+    const std::string m_name;
+    mutable std::mutex m_mutex;
+    std::vector<Entry> m_entries;
+    size_t m_maxSize;
+    std::chrono::milliseconds m_maxAge;
+
+    std::shared_ptr<std::atomic_size_t> m_hits {std::make_shared<std::atomic_size_t>(0)};
+    std::shared_ptr<std::atomic_size_t> m_misses {std::make_shared<std::atomic_size_t>(0)};
+    Statistics m_lastReported;
+    std::chrono::steady_clock::time_point m_lastReport {std::chrono::steady_clock::now()};
+  };
+}  // namespace mtconnect::sink::rest_sink
@@ -0,0 +1,133 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "compression.hpp"
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <list>
+#include <stdexcept>
+
+#include <zlib.h>
+
+#include "mtconnect/logging.hpp"
+
+using namespace std;
+
+namespace mtconnect::sink::rest_sink {
+  StreamCompressor::StreamCompressor(Encoding encoding, int level)
+    : m_encoding(encoding), m_stream(make_unique<z_stream_s>())
+  {
+    // Window bits of 15 produce a zlib stream, adding 16 wraps it in a gzip header and trailer
+    int windowBits = encoding == GZIP ? 15 + 16 : 15;
+    if (deflateInit2(m_stream.get(), std::clamp(level, 1, 9), Z_DEFLATED, windowBits, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+      LOG(error) << "Cannot create " << name(encoding) << " compressor";
+      throw runtime_error("Cannot create compressor");
+    }
+  }
+
+  StreamCompressor::~StreamCompressor() { deflateEnd(m_stream.get()); }
+
+  optional<StreamCompressor::Encoding> StreamCompressor::negotiate(const string &acceptEncoding)
+  {
+    optional<double> gzip, deflate, any;
+
+    list<string> codings;
+    boost::split(codings, acceptEncoding, boost::is_any_of(","));
+    for (auto &coding : codings)
+    {
+      double quality = 1.0;
+      if (auto semi = coding.find(';'); semi != string::npos)
+      {
+        auto param = boost::trim_copy(coding.substr(semi + 1));
+        if (boost::istarts_with(param, "q="))
+        {
+          try
+          {
+            quality = stod(param.substr(2));
+          }
+          catch (logic_error &)
+          {
+            quality = 0.0;
+          }
+        }
+        coding.erase(semi);
+      }
+      boost::trim(coding);
+      boost::to_lower(coding);
+
+      if (coding == "gzip" || coding == "x-gzip")
+        gzip = quality;
+      else if (coding == "deflate")
+        deflate = quality;
+      else if (coding == "*")
+        any = quality;
+    }
+
+    // An encoding that is not named is acceptable at the quality of the wildcard
+    double gzipQuality = gzip.value_or(any.value_or(0.0));
+    double deflateQuality = deflate.value_or(any.value_or(0.0));
+    if (gzipQuality > 0.0 && gzipQuality >= deflateQuality)
+      return GZIP;
+    if (deflateQuality > 0.0)
+      return DEFLATE;
+    return nullopt;
+  }
+
+  string StreamCompressor::compress(Encoding encoding, int level, string_view data)
+  {
+    StreamCompressor compressor(encoding, level);
+    string out;
+    out.reserve(deflateBound(compressor.m_stream.get(), uLong(data.size())));
+    compressor.deflate(data, out, Z_FINISH);
+    return out;
+  }
+
+  void StreamCompressor::write(string_view data, string &out) { deflate(data, out, Z_NO_FLUSH); }
+
+  void StreamCompressor::flush(string &out) { deflate({}, out, Z_SYNC_FLUSH); }
+
+  void StreamCompressor::finish(string &out) { deflate({}, out, Z_FINISH); }
+
+  void StreamCompressor::deflate(string_view data, string &out, int flush)
+  {
+    constexpr size_t BlockSize = 16 * 1024;
+
+    m_stream->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    m_stream->avail_in = uInt(data.size());
+
+    // Deflate until zlib has room left over, then all the input has been consumed and flushed
+    do
+    {
+      auto offset = out.size();
+      out.resize(offset + BlockSize);
+      m_stream->next_out = reinterpret_cast<Bytef *>(out.data() + offset);
+      m_stream->avail_out = uInt(BlockSize);
+
+      auto rc = ::deflate(m_stream.get(), flush);
+      out.resize(offset + BlockSize - m_stream->avail_out);
+      if (rc == Z_STREAM_ERROR)
+      {
+        LOG(error) << "Compression failed for " << name(m_encoding) << " stream";
+        throw runtime_error("Compression failed");
+      }
+    } while (m_stream->avail_out == 0);
+  }
+}  // namespace mtconnect::sink::rest_sink
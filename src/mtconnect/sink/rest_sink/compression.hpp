@@ -0,0 +1,99 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "mtconnect/config.hpp"
+
+struct z_stream_s;
+
+namespace mtconnect::sink::rest_sink {
+  /// @brief Settings for compressing dynamic HTTP responses
+  struct CompressionOptions
+  {
+    bool m_enabled {false};   ///< `true` if responses are compressed when the client accepts it
+    int m_level {6};          ///< zlib compression level from 1 (fastest) to 9 (smallest)
+    size_t m_minSize {1024};  ///< responses smaller than this are sent uncompressed
+  };
+
+  /// @brief A zlib deflate stream for the `gzip` or `deflate` content encodings
+  ///
+  /// The compressor keeps its dictionary between writes, so the parts of a multipart stream are
+  /// compressed as one continuous body. Each flush ends on a byte boundary so the client can
+  /// decode every part as soon as its chunk arrives.
+  class AGENT_LIB_API StreamCompressor
+  {
+  public:
+    /// @brief The supported content encodings
+    enum Encoding
+    {
+      GZIP,
+      DEFLATE
+    };
+
+    /// @brief Create a compressor
+    /// @param[in] encoding the content encoding
+    /// @param[in] level the zlib compression level
+    StreamCompressor(Encoding encoding, int level = 6);
+    StreamCompressor(const StreamCompressor &) = delete;
+    ~StreamCompressor();
+
+    /// @brief choose the content encoding from the request's `Accept-Encoding` header
+    ///
+    /// Honors quality values, a quality of `0` refuses the encoding. `gzip` is preferred when
+    /// both encodings are equally acceptable.
+    /// @param[in] acceptEncoding the `Accept-Encoding` request header
+    /// @return the encoding or `nullopt` if the response must not be compressed
+    static std::optional<Encoding> negotiate(const std::string &acceptEncoding);
+    /// @brief get the `Content-Encoding` header value for an encoding
+    static const char *name(Encoding encoding)
+    {
+      return encoding == GZIP ? "gzip" : "deflate";
+    }
+    /// @brief compress a complete body
+    /// @param[in] encoding the content encoding
+    /// @param[in] level the zlib compression level
+    /// @param[in] data the body
+    /// @return the compressed body
+    static std::string compress(Encoding encoding, int level, std::string_view data);
+
+    /// @brief get the content encoding
+    Encoding getEncoding() const { return m_encoding; }
+    /// @brief compress data without flushing
+    /// @param[in] data the data to compress
+    /// @param[out] out the compressed data is appended to this string
+    void write(std::string_view data, std::string &out);
+    /// @brief flush all the data written so the client can decode it
+    /// @param[out] out the compressed data is appended to this string
+    void flush(std::string &out);
+    /// @brief end the compressed stream
+    /// @param[out] out the remaining compressed data and trailer are appended to this string
+    void finish(std::string &out);
+
+  protected:
+    void deflate(std::string_view data, std::string &out, int flush);
+
+  protected:
+    Encoding m_encoding;
+    std::unique_ptr<z_stream_s> m_stream;
+  };
+}  // namespace mtconnect::sink::rest_sink
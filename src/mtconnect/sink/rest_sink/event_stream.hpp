@@ -0,0 +1,84 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <charconv>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/utilities.hpp"
+
+namespace mtconnect::sink::rest_sink {
+  /// @brief The mime type of a server-sent event stream
+  inline const std::string EventStreamMimeType {"text/event-stream"};
+
+  /// @brief Check if the request accepts a server-sent event stream
+  /// @param[in] accepts the accept header of the request
+  /// @return `true` if the response should be streamed as events
+  inline bool acceptsEventStream(const std::string &accepts)
+  {
+    return accepts.find(EventStreamMimeType) != std::string::npos;
+  }
+
+  /// @brief Append a server-sent event to a buffer
+  ///
+  /// Each line of the data is sent as a `data:` field so documents can be sent as they are
+  /// printed. Consecutive events can be appended to the same buffer and written together.
+  ///
+  /// @param[in,out] out the buffer to append the event to
+  /// @param[in] data the event data
+  /// @param[in] id the event id the client returns in `Last-Event-ID` when it reconnects
+  /// @param[in] event the optional event type
+  inline void appendEvent(std::string &out, std::string_view data,
+                          const std::optional<SequenceNumber_t> &id = std::nullopt,
+                          std::string_view event = {})
+  {
+    out.reserve(out.size() + data.size() + 64);
+    if (!event.empty())
+      out.append("event: ").append(event).append("\n");
+    if (id)
+      out.append("id: ").append(std::to_string(*id)).append("\n");
+
+    while (!data.empty())
+    {
+      auto eol = data.find('\n');
+      auto line = data.substr(0, eol);
+      if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+      out.append("data: ").append(line).append("\n");
+      if (eol == std::string_view::npos)
+        break;
+      data.remove_prefix(eol + 1);
+    }
+    out.append("\n");
+  }
+
+  /// @brief Parse the sequence from the `Last-Event-ID` header
+  /// @param[in] id the header value
+  /// @return the sequence or `nullopt` if it is not a sequence number
+  inline std::optional<SequenceNumber_t> parseEventId(std::string_view id)
+  {
+    SequenceNumber_t seq;
+    auto [ptr, ec] = std::from_chars(id.data(), id.data() + id.size(), seq);
+    if (ec != std::errc() || ptr != id.data() + id.size())
+      return std::nullopt;
+    return seq;
+  }
+}  // namespace mtconnect::sink::rest_sink
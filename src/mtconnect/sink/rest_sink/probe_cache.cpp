@@ -0,0 +1,146 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "probe_cache.hpp"
+
+#include <boost/algorithm/string.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <functional>
+#include <iomanip>
+#include <list>
+#include <sstream>
+
+#include "compression.hpp"
+#include "mtconnect/logging.hpp"
+
+using namespace std;
+
+namespace mtconnect::sink::rest_sink {
+  namespace io = boost::iostreams;
+
+  static shared_ptr<const string> compress(const string &content, bool gzip)
+  {
+    string out;
+    {
+      io::filtering_ostream stream;
+      if (gzip)
+        stream.push(io::gzip_compressor(io::gzip_params(io::gzip::best_compression)));
+      else
+        stream.push(io::zlib_compressor(io::zlib_params(io::zlib::best_compression)));
+      stream.push(io::back_inserter(out));
+      stream.write(content.data(), content.size());
+    }
+    return make_shared<const string>(std::move(out));
+  }
+
+  ProbeCache::DocumentPtr ProbeCache::find(const Key &key, const State &state) const
+  {
+    lock_guard<mutex> lock(m_mutex);
+    auto it = m_documents.find(key);
+    if (it == m_documents.end() || !(it->second->m_state == state))
+      return nullptr;
+    return it->second;
+  }
+
+  ProbeCache::DocumentPtr ProbeCache::insert(const Key &key, const State &state, string &&content)
+  {
+    // Render the encodings outside the lock, probe documents can be large
+    auto doc = make_shared<Document>();
+    doc->m_state = state;
+    doc->m_lastModified = chrono::system_clock::now();
+
+    stringstream tag;
+    tag << '"' << hex << setw(16) << setfill('0') << std::hash<string>()(content) << '"';
+    doc->m_etag = tag.str();
+
+    if (content.size() >= m_minCompressSize)
+    {
+      doc->m_gzip = compress(content, true);
+      doc->m_deflate = compress(content, false);
+      LOG(debug) << "Probe document compressed from " << content.size() << " to "
+                 << doc->m_gzip->size() << " bytes";
+    }
+    doc->m_content = make_shared<const string>(std::move(content));
+
+    lock_guard<mutex> lock(m_mutex);
+    m_documents[key] = doc;
+    return doc;
+  }
+
+  pair<shared_ptr<const string>, optional<string>> ProbeCache::Document::encode(
+      const string &acceptEncoding) const
+  {
+    auto encoding = StreamCompressor::negotiate(acceptEncoding);
+    if (m_gzip && encoding == StreamCompressor::GZIP)
+      return {m_gzip, StreamCompressor::name(*encoding)};
+    if (m_deflate && encoding == StreamCompressor::DEFLATE)
+      return {m_deflate, StreamCompressor::name(*encoding)};
+    return {m_content, nullopt};
+  }
+
+  string ProbeCache::Document::etag(const optional<string> &encoding) const
+  {
+    // Each encoding has its own tag, the content tag with the encoding appended
+    if (encoding)
+      return m_etag.substr(0, m_etag.size() - 1) + '-' + *encoding + '"';
+    return m_etag;
+  }
+
+  string ProbeCache::Document::lastModified() const
+  {
+    return getCurrentTime(m_lastModified, HUM_READ);
+  }
+
+  bool ProbeCache::Document::notModified(const string &ifNoneMatch,
+                                         const string &ifModifiedSince) const
+  {
+    if (!ifNoneMatch.empty())
+    {
+      auto content = m_etag.substr(1, m_etag.size() - 2);
+      list<string> tags;
+      boost::split(tags, ifNoneMatch, boost::is_any_of(","));
+      for (auto &tag : tags)
+      {
+        boost::trim(tag);
+        if (tag == "*")
+          return true;
+        if (boost::starts_with(tag, "W/"))
+          tag.erase(0, 2);
+        boost::trim_if(tag, boost::is_any_of("\""));
+        if (auto dash = tag.find('-'); dash != string::npos)
+          tag.erase(dash);
+        if (tag == content)
+          return true;
+      }
+      return false;
+    }
+
+    if (!ifModifiedSince.empty())
+    {
+      istringstream in(ifModifiedSince);
+      date::sys_seconds since;
+      in >> date::parse("%a, %d %b %Y %H:%M:%S GMT", since);
+      if (!in.fail())
+        return chrono::floor<chrono::seconds>(m_lastModified) <= since;
+    }
+
+    return false;
+  }
+}  // namespace mtconnect::sink::rest_sink
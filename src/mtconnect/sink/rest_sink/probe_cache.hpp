@@ -0,0 +1,142 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/utilities.hpp"
+
+namespace mtconnect::printer {
+  class Printer;
+}
+
+namespace mtconnect::sink::rest_sink {
+  /// @brief Probe documents rendered once for each device model
+  ///
+  /// A probe document only changes when the device model, the printer configuration, or the
+  /// asset counts change. The cache keeps the rendered document with its gzip and deflate
+  /// encodings and an entity tag, so repeated probe requests are served without printing the
+  /// device model and conditional requests can be answered with `304 Not Modified`.
+  class AGENT_LIB_API ProbeCache
+  {
+  public:
+    /// @brief The request parameters that select a probe document
+    struct Key
+    {
+      const printer::Printer *m_printer {nullptr};
+      std::string m_device;
+      std::string m_deviceType;
+      bool m_pretty {false};
+
+      bool operator<(const Key &other) const
+      {
+        return std::tie(m_printer, m_device, m_deviceType, m_pretty) <
+               std::tie(other.m_printer, other.m_device, other.m_deviceType, other.m_pretty);
+      }
+    };
+
+    /// @brief The agent state a probe document was rendered from
+    struct State
+    {
+      uint64_t m_modelVersion {0};  ///< the printer's model version
+      unsigned int m_assetCount {0};
+      std::map<std::string, size_t> m_assetCounts;
+
+      bool operator==(const State &other) const
+      {
+        return m_modelVersion == other.m_modelVersion && m_assetCount == other.m_assetCount &&
+               m_assetCounts == other.m_assetCounts;
+      }
+    };
+
+    /// @brief A rendered probe document and its encodings
+    struct Document
+    {
+      std::shared_ptr<const std::string> m_content;
+      std::shared_ptr<const std::string> m_gzip;     ///< empty if the document is small
+      std::shared_ptr<const std::string> m_deflate;  ///< empty if the document is small
+      std::string m_etag;                            ///< quoted entity tag of the content
+      Timestamp m_lastModified;                      ///< when the document was rendered
+      State m_state;
+
+      /// @brief select the representation the client prefers
+      /// @param[in] acceptEncoding the `Accept-Encoding` request header, empty if the response
+      ///                           must not be compressed
+      /// @return the body and the content encoding, or `nullopt` for the identity encoding
+      std::pair<std::shared_ptr<const std::string>, std::optional<std::string>> encode(
+          const std::string &acceptEncoding) const;
+      /// @brief get the entity tag of an encoding
+      /// @param[in] encoding the content encoding or `nullopt` for the identity encoding
+      /// @return the quoted entity tag
+      std::string etag(const std::optional<std::string> &encoding) const;
+      /// @brief get the `Last-Modified` header value
+      std::string lastModified() const;
+      /// @brief check the conditional request headers
+      ///
+      /// `If-None-Match` takes precedence over `If-Modified-Since`. An entity tag matches
+      /// regardless of its content encoding since the encodings have the same content.
+      ///
+      /// @param[in] ifNoneMatch the `If-None-Match` request header
+      /// @param[in] ifModifiedSince the `If-Modified-Since` request header
+      /// @return `true` if the client already has this document
+      bool notModified(const std::string &ifNoneMatch, const std::string &ifModifiedSince) const;
+    };
+    using DocumentPtr = std::shared_ptr<const Document>;
+
+    /// @brief Create a probe cache
+    /// @param minCompressSize documents smaller than this are only kept uncompressed
+    ProbeCache(size_t minCompressSize = 1024) : m_minCompressSize(minCompressSize) {}
+    ProbeCache(const ProbeCache &) = delete;
+
+    /// @brief find the document rendered for the request and agent state
+    /// @param[in] key the request parameters
+    /// @param[in] state the current agent state
+    /// @return the document or `nullptr` if the state has changed since it was rendered
+    DocumentPtr find(const Key &key, const State &state) const;
+    /// @brief compress a rendered document and add it to the cache
+    /// @param[in] key the request parameters
+    /// @param[in] state the agent state the document was rendered from
+    /// @param[in] content the rendered document
+    /// @return the cached document
+    DocumentPtr insert(const Key &key, const State &state, std::string &&content);
+    /// @brief remove all the documents
+    void clear()
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_documents.clear();
+    }
+    /// @brief get the number of documents in the cache
+    size_t size() const
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_documents.size();
+    }
+
+  protected:
+    mutable std::mutex m_mutex;
+    std::map<Key, DocumentPtr> m_documents;
+    size_t m_minCompressSize;
+  };
+}  // namespace mtconnect::sink::rest_sink
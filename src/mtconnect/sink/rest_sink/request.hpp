@@ -62,6 +62,9 @@ namespace mtconnect::sink::rest_sink {
     std::string m_accepts;            ///< The accepts header
     std::string m_acceptsEncoding;    ///< Encodings that can be returned
     std::string m_contentType;        ///< The content type for the body
+    std::string m_ifNoneMatch;        ///< The If-None-Match header
+    std::string m_ifModifiedSince;    ///< The If-Modified-Since header
+    std::string m_lastEventId;        ///< The Last-Event-ID header of a reconnecting event stream
     std::string m_path;               ///< The URI for the request
     std::string m_foreignIp;          ///< The requestors IP Address
     uint16_t m_foreignPort;           ///< The requestors Port
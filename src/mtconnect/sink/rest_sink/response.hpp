@@ -40,11 +40,11 @@ namespace mtconnect {
     {
       /// @brief Create a response with a status and a body
       /// @param[in] status the status
-      /// @param[in] body the body of the response
+      /// @param[in] body the body of the response, rendered documents are moved into the response
       /// @param[in] mimeType the mime type of the response
-      Response(status status = status::ok, const std::string &body = "",
+      Response(status status = status::ok, std::string body = "",
                const std::string &mimeType = "text/xml")
-        : m_status(status), m_body(body), m_mimeType(mimeType), m_expires(0)
+        : m_status(status), m_body(std::move(body)), m_mimeType(mimeType), m_expires(0)
       {}
       /// @brief Create a response with a status and a cached file
       /// @param[in] status the status of the response
@@ -57,10 +57,14 @@ namespace mtconnect {
       Response(RequestError &e) : m_status(e.m_code), m_body(e.m_body), m_mimeType(e.m_contentType)
       {}
 
-      status m_status;                        ///< The return status
-      std::string m_body;                     ///< The body of the response
-      std::string m_mimeType;                 ///< The mime type of the response
-      std::optional<std::string> m_location;  ///< optional location
+      status m_status;                                  ///< The return status
+      std::string m_body;                               ///< The body of the response
+      std::string m_mimeType;                           ///< The mime type of the response
+      std::optional<std::string> m_location;            ///< optional location
+      std::optional<std::string> m_etag;                ///< optional entity tag
+      std::optional<std::string> m_lastModified;        ///< optional last modified time
+      std::optional<std::string> m_contentEncoding;     ///< optional encoding of the body
+      std::shared_ptr<const std::string> m_sharedBody;  ///< body shared with other responses
       std::chrono::seconds
           m_expires;         ///< how long should this session should stay open before it is closed
       bool m_close {false};  ///< `true` if this session should closed after it responds
@@ -17,8 +17,10 @@
 
 #include "rest_service.hpp"
 
+#include <algorithm>
 #include <regex>
 
+#include "event_stream.hpp"
 #include "mtconnect/configuration/config_options.hpp"
 #include "mtconnect/entity/xml_parser.hpp"
 #include "mtconnect/pipeline/shdr_token_mapper.hpp"
@@ -48,7 +50,9 @@ namespace mtconnect {
         m_strand(context),
         m_schemaVersion(GetOption<string>(options, config::SchemaVersion).value_or("x.y")),
         m_options(options),
-        m_logStreamData(GetOption<bool>(options, config::LogStreams).value_or(false))
+        m_logStreamData(GetOption<bool>(options, config::LogStreams).value_or(false)),
+        m_sampleChunkCache("Sample chunk"),
+        m_currentCache("Current")
     {
       auto maxSize =
           ConvertFileSize(options, mtconnect::configuration::MaxCachedFileSize, 20 * 1024);
@@ -58,8 +62,9 @@ namespace mtconnect {
       m_fileCache.setMaxCachedFileSize(maxSize);
       m_fileCache.setMinCompressedFileSize(compressSize);
 
-      // Unique id number for agent instance
-      m_instanceId = getCurrentTimeInSec();
+      // Unique id number for agent instance, preserved when the buffer is restored
+      m_instanceId =
+          m_sinkContract->getCircularBuffer().getInstanceId().value_or(getCurrentTimeInSec());
 
       // Get the HTTP Headers
       loadHttpHeaders(config);
@@ -71,7 +76,7 @@ namespace mtconnect {
             {
               auto printer = m_sinkContract->getPrinter("xml");
               auto doc = printError(printer, "INVALID_REQUEST", msg);
-              ResponsePtr resp = std::make_unique<Response>(st, doc, printer->mimeType());
+              ResponsePtr resp = std::make_unique<Response>(st, std::move(doc), printer->mimeType());
               session->writeFailureResponse(std::move(resp));
             }
           });
@@ -484,7 +489,7 @@ namespace mtconnect {
           return false;
         }
 
-        respond(session, probeRequest(printer, device, pretty, deviceType));
+        respond(session, probeRequest(printer, device, pretty, deviceType, request));
         return true;
       };
 
@@ -660,7 +665,8 @@ namespace mtconnect {
           streamCurrentRequest(
               session, printerForAccepts(request->m_accepts), *interval,
               request->parameter<string>("device"), request->parameter<string>("path"),
-              *request->parameter<bool>("pretty"), request->parameter<string>("deviceType"));
+              *request->parameter<bool>("pretty"), request->parameter<string>("deviceType"),
+              acceptsEventStream(request->m_accepts));
         }
         else
         {
@@ -669,7 +675,7 @@ namespace mtconnect {
                                           request->parameter<uint64_t>("at"),
                                           request->parameter<string>("path"),
                                           *request->parameter<bool>("pretty"),
-                                          request->parameter<string>("deviceType")));
+                                          request->parameter<string>("deviceType"), request));
         }
         return true;
       };
@@ -695,12 +701,19 @@ namespace mtconnect {
         auto interval = request->parameter<int32_t>("interval");
         if (interval)
         {
+          // An event source reconnects with the id of the last event it received, which is the
+          // next sequence to send, so the stream resumes where it left off.
+          auto eventStream = acceptsEventStream(request->m_accepts);
+          auto from = request->parameter<uint64_t>("from");
+          if (eventStream && !from && !request->m_lastEventId.empty())
+            from = resumeSequence(request->m_lastEventId);
+
           streamSampleRequest(
               session, printerForAccepts(request->m_accepts), *interval,
               *request->parameter<int32_t>("heartbeat"), *request->parameter<int32_t>("count"),
-              request->parameter<string>("device"), request->parameter<uint64_t>("from"),
-              request->parameter<string>("path"), *request->parameter<bool>("pretty"),
-              request->parameter<string>("deviceType"));
+              request->parameter<string>("device"), from, request->parameter<string>("path"),
+              *request->parameter<bool>("pretty"), request->parameter<string>("deviceType"),
+              eventStream);
         }
         else
         {
@@ -773,13 +786,23 @@ namespace mtconnect {
 
     bool RestService::publish(ObservationPtr &observation) { return true; }
 
+    bool RestService::publish(DevicePtr device)
+    {
+      // The documents rendered for the old device model are no longer valid
+      m_sampleChunkCache.clear();
+      m_currentCache.clear();
+      m_probeCache.clear();
+      return true;
+    }
+
     // -------------------------------------------
     // ReST API Requests
     // -------------------------------------------
 
     ResponsePtr RestService::probeRequest(const Printer *printer,
                                           const std::optional<std::string> &device, bool pretty,
-                                          const std::optional<std::string> &deviceType)
+                                          const std::optional<std::string> &deviceType,
+                                          const RequestPtr &request)
     {
       NAMED_SCOPE("RestService::probeRequest");
 
@@ -790,33 +813,61 @@ namespace mtconnect {
         auto dev = checkDevice(printer, *device);
         deviceList.emplace_back(dev);
       }
-      else
+
+      // The document only changes with the device model and the assets, render it once for each
+      // change and serve the cached document and its encodings until then.
+      auto assets = m_sinkContract->getAssetStorage();
+      ProbeCache::Key key {printer, device.value_or(""), deviceType.value_or(""), pretty};
+      ProbeCache::State state {printer->getModelVersion(), uint32_t(assets->getCount()),
+                               assets->getCountsByType()};
+
+      auto doc = m_probeCache.find(key, state);
+      if (!doc)
       {
-        deviceList = m_sinkContract->getDevices();
-        if (deviceType)
+        if (!device)
         {
-          deviceList.remove_if(
-              [&deviceType](const DevicePtr &dev) { return dev->getName() != *deviceType; });
+          deviceList = m_sinkContract->getDevices();
+          if (deviceType)
+          {
+            deviceList.remove_if(
+                [&deviceType](const DevicePtr &dev) { return dev->getName() != *deviceType; });
+          }
         }
+
+        doc = m_probeCache.insert(
+            key, state,
+            printer->printProbe(m_instanceId, m_sinkContract->getCircularBuffer().getBufferSize(),
+                                m_sinkContract->getCircularBuffer().getSequence(),
+                                uint32_t(assets->getMaxAssets()), state.m_assetCount, deviceList,
+                                &state.m_assetCounts, false, pretty));
       }
 
-      auto counts = m_sinkContract->getAssetStorage()->getCountsByType();
+      const auto &compression = m_server->getCompression();
+      auto [body, encoding] =
+          doc->encode(request && compression.m_enabled ? request->m_acceptsEncoding : "");
+      auto response = make_unique<Response>(rest_sink::status::ok, "", printer->mimeType());
+      response->m_etag = doc->etag(encoding);
+      response->m_lastModified = doc->lastModified();
 
-      return make_unique<Response>(
-          rest_sink::status::ok,
-          printer->printProbe(m_instanceId, m_sinkContract->getCircularBuffer().getBufferSize(),
-                              m_sinkContract->getCircularBuffer().getSequence(),
-                              uint32_t(m_sinkContract->getAssetStorage()->getMaxAssets()),
-                              uint32_t(m_sinkContract->getAssetStorage()->getCount()), deviceList,
-                              &counts, false, pretty),
-          printer->mimeType());
+      if (request && doc->notModified(request->m_ifNoneMatch, request->m_ifModifiedSince))
+      {
+        response->m_status = rest_sink::status::not_modified;
+      }
+      else
+      {
+        response->m_sharedBody = body;
+        response->m_contentEncoding = encoding;
+      }
+
+      return response;
     }
 
     ResponsePtr RestService::currentRequest(const Printer *printer,
                                             const std::optional<std::string> &device,
                                             const std::optional<SequenceNumber_t> &at,
                                             const std::optional<std::string> &path, bool pretty,
-                                            const std::optional<std::string> &deviceType)
+                                            const std::optional<std::string> &deviceType,
+                                            const RequestPtr &request)
     {
       using namespace rest_sink;
       DevicePtr dev {nullptr};
@@ -831,10 +882,27 @@ namespace mtconnect {
         checkPath(printer, path, dev, *filter, deviceType);
       }
 
-      // Check if there is a frequency to stream data or not
-      return make_unique<Response>(rest_sink::status::ok,
-                                   fetchCurrentData(printer, filter, at, pretty),
-                                   printer->mimeType());
+      if (at)
+        return make_unique<Response>(rest_sink::status::ok,
+                                     renderCurrentData(printer, filter, at, pretty),
+                                     printer->mimeType());
+
+      // Requests for the same state share the rendered document and its compressed encodings
+      auto chunk = fetchCachedCurrentData(printer, filter, pretty);
+      auto response = make_unique<Response>(rest_sink::status::ok, "", printer->mimeType());
+      response->m_sharedBody = chunk.m_content;
+
+      const auto &compression = m_server->getCompression();
+      if (request && compression.m_enabled && chunk.m_content->size() >= compression.m_minSize)
+      {
+        if (auto encoding = StreamCompressor::negotiate(request->m_acceptsEncoding))
+        {
+          response->m_sharedBody = ChunkCache::encode(chunk, *encoding, compression.m_level);
+          response->m_contentEncoding = StreamCompressor::name(*encoding);
+        }
+      }
+
+      return response;
     }
 
     ResponsePtr RestService::sampleRequest(const Printer *printer, const int count,
@@ -867,9 +935,12 @@ namespace mtconnect {
           printer->mimeType());
     }
 
+    /// @brief The size of the events sent in one write to a client that has fallen behind
+    static constexpr size_t MaxCoalescedEventSize {1024 * 1024};
+
     struct AsyncSampleResponse : public observation::AsyncObserver
     {
-      AsyncSampleResponse(boost::asio::io_context::strand &strand,
+      AsyncSampleResponse(observation::ObserverStrand &strand,
                           mtconnect::buffer::CircularBuffer &buffer, FilterSet &&filter,
                           std::chrono::milliseconds interval, std::chrono::milliseconds heartbeat,
                           rest_sink::SessionPtr &session)
@@ -917,6 +988,9 @@ namespace mtconnect {
       rest_sink::SessionPtr m_session;
       ofstream m_log;
       bool m_pretty {false};
+      std::shared_ptr<const FilterSet> m_chunkFilter;  //! The filter used in the chunk cache key
+      size_t m_chunkFilterHash {0};
+      bool m_eventStream {false};  //! Send server-sent events instead of multipart documents
     };
 
     void RestService::streamSampleRequest(rest_sink::SessionPtr session, const Printer *printer,
@@ -924,7 +998,8 @@ namespace mtconnect {
                                           const int count, const std::optional<std::string> &device,
                                           const std::optional<SequenceNumber_t> &from,
                                           const std::optional<std::string> &path, bool pretty,
-                                          const std::optional<std::string> &deviceType)
+                                          const std::optional<std::string> &deviceType,
+                                          bool eventStream)
     {
       NAMED_SCOPE("RestService::streamSampleRequest");
 
@@ -936,8 +1011,8 @@ namespace mtconnect {
       checkRange(printer, heartbeatIn, 1, numeric_limits<int>().max(), "heartbeat");
       if (from)
       {
-        std::lock_guard<CircularBuffer> lock(m_sinkContract->getCircularBuffer());
-        auto firstSeq = m_sinkContract->getCircularBuffer().getFirstSequence();
+        std::shared_lock<CircularBuffer> lock(m_sinkContract->getCircularBuffer());
+        auto firstSeq = m_sinkContract->getCircularBuffer().getOldestSequence();
         auto seq = m_sinkContract->getCircularBuffer().getSequence();
         checkRange(printer, *from, firstSeq - 1, seq + 1, "from");
       }
@@ -951,13 +1026,18 @@ namespace mtconnect {
       FilterSet filter;
       checkPath(printer, path, dev, filter, deviceType);
 
+      // Each stream has its own strand so the streams render on all the worker threads
+      auto strand = asio::make_strand(m_context);
       auto asyncResponse = make_shared<AsyncSampleResponse>(
-          m_strand, m_sinkContract->getCircularBuffer(), std::move(filter),
+          strand, m_sinkContract->getCircularBuffer(), std::move(filter),
           std::chrono::milliseconds(interval), std::chrono::milliseconds(heartbeatIn), session);
       asyncResponse->m_count = count;
       asyncResponse->m_printer = printer;
       asyncResponse->m_sink = getptr();
       asyncResponse->m_pretty = pretty;
+      asyncResponse->m_chunkFilter = make_shared<const FilterSet>(asyncResponse->getFilter());
+      asyncResponse->m_chunkFilterHash = ChunkCache::hash(*asyncResponse->m_chunkFilter);
+      asyncResponse->m_eventStream = eventStream;
 
       if (m_logStreamData)
       {
@@ -967,14 +1047,12 @@ namespace mtconnect {
       }
 
       asyncResponse->m_logStreamData = m_logStreamData;
-      asyncResponse->observe(from, [this](const std::string &id) {
-        return m_sinkContract->getDataItemById(id).get();
-      });
+      asyncResponse->observe(from);
       asyncResponse->m_handler = boost::bind(&RestService::streamNextSampleChunk, this, _1);
 
       session->beginStreaming(
-          printer->mimeType(),
-          asio::bind_executor(m_strand,
+          eventStream ? EventStreamMimeType : printer->mimeType(),
+          asio::bind_executor(asyncResponse->getStrand(),
                               boost::bind(&AsyncObserver::handlerCompleted, asyncResponse)));
     }
 
@@ -997,16 +1075,30 @@ namespace mtconnect {
         if (asyncResponse->getSequence() > 0)
           from.emplace(asyncResponse->getSequence());
 
-        string content = fetchSampleData(asyncResponse->m_printer, asyncResponse->getFilter(),
-                                         asyncResponse->m_count, from, nullopt, end,
-                                         asyncObserver->m_endOfBuffer, asyncResponse->m_pretty);
+        auto content = fetchSampleChunk(*asyncResponse, from, end);
+
+        // A client that is slower than the observations arrive falls behind the buffer. Send the
+        // events it missed in one write instead of waiting for each write to complete.
+        if (asyncResponse->m_eventStream && !asyncObserver->m_endOfBuffer)
+        {
+          string events(*content);
+          while (!asyncObserver->m_endOfBuffer && events.size() < MaxCoalescedEventSize)
+          {
+            from.emplace(end);
+            events.append(*fetchSampleChunk(*asyncResponse, from, end));
+            if (end <= *from)
+              break;
+          }
+          content = make_shared<const string>(std::move(events));
+        }
 
         if (m_logStreamData)
-          asyncResponse->m_log << content << endl;
+          asyncResponse->m_log << *content << endl;
 
         asyncResponse->m_session->writeChunk(
             content, asio::bind_executor(
-                         m_strand, boost::bind(&AsyncObserver::handlerCompleted, asyncResponse)));
+                         asyncResponse->getStrand(),
+                         boost::bind(&AsyncObserver::handlerCompleted, asyncResponse)));
 
         return end;
       }
@@ -1031,26 +1123,86 @@ namespace mtconnect {
       return 0;
     }
 
+    SharedChunk RestService::fetchSampleChunk(AsyncSampleResponse &asyncResponse,
+                                              const std::optional<SequenceNumber_t> &from,
+                                              SequenceNumber_t &end)
+    {
+      // Streams with the same request parameters render the same chunk for the same buffer
+      // sequence, so the first one renders it and the others share it.
+      ChunkCache::Key key;
+      key.m_printer = asyncResponse.m_printer;
+      key.m_filter = asyncResponse.m_chunkFilter;
+      key.m_filterHash = asyncResponse.m_chunkFilterHash;
+      key.m_count = asyncResponse.m_count;
+      key.m_from = from.value_or(0);
+      key.m_pretty = asyncResponse.m_pretty;
+      key.m_eventStream = asyncResponse.m_eventStream;
+      key.m_bufferSequence = m_sinkContract->getCircularBuffer().getSequence();
+
+      if (auto chunk = m_sampleChunkCache.find(key))
+      {
+        end = chunk->m_end;
+        asyncResponse.m_endOfBuffer = chunk->m_endOfBuffer;
+        return chunk->m_content;
+      }
+
+      auto document =
+          fetchSampleData(asyncResponse.m_printer, asyncResponse.getFilter(), asyncResponse.m_count,
+                          from, nullopt, end, asyncResponse.m_endOfBuffer, asyncResponse.m_pretty);
+
+      SharedChunk content;
+      if (asyncResponse.m_eventStream)
+      {
+        // The event id is the next sequence, the client sends it back as the Last-Event-ID
+        string event;
+        appendEvent(event, document, end);
+        content = make_shared<const string>(std::move(event));
+      }
+      else
+      {
+        content = make_shared<const string>(std::move(document));
+      }
+      m_sampleChunkCache.insert(key, {content, end, asyncResponse.m_endOfBuffer});
+
+      return content;
+    }
+
+    std::optional<SequenceNumber_t> RestService::resumeSequence(const std::string &lastEventId)
+    {
+      auto id = parseEventId(lastEventId);
+      if (!id)
+        return nullopt;
+
+      // The client may have fallen behind the buffer or reconnected to a restarted agent, resume
+      // from the closest sequence instead of failing the request.
+      auto &buffer = m_sinkContract->getCircularBuffer();
+      std::shared_lock<CircularBuffer> lock(buffer);
+      return std::clamp(*id, buffer.getOldestSequence(), buffer.getSequence());
+    }
+
     struct AsyncCurrentResponse
     {
       AsyncCurrentResponse(rest_sink::SessionPtr session, asio::io_context &context)
-        : m_session(session), m_timer(context)
+        : m_session(session), m_strand(asio::make_strand(context)), m_timer(context)
       {}
 
       std::weak_ptr<Sink> m_service;
       rest_sink::SessionPtr m_session;
+      asio::strand<asio::io_context::executor_type> m_strand;
       chrono::milliseconds m_interval;
       const Printer *m_printer {nullptr};
       FilterSetOpt m_filter;
       boost::asio::steady_timer m_timer;
       bool m_pretty {false};
+      bool m_eventStream {false};
     };
 
     void RestService::streamCurrentRequest(SessionPtr session, const Printer *printer,
                                            const int interval,
                                            const std::optional<std::string> &device,
                                            const std::optional<std::string> &path, bool pretty,
-                                           const std::optional<std::string> &deviceType)
+                                           const std::optional<std::string> &deviceType,
+                                           bool eventStream)
     {
       checkRange(printer, interval, 0, numeric_limits<int>().max(), "interval");
       DevicePtr dev {nullptr};
@@ -1069,9 +1221,11 @@ namespace mtconnect {
       asyncResponse->m_printer = printer;
       asyncResponse->m_service = getptr();
       asyncResponse->m_pretty = pretty;
+      asyncResponse->m_eventStream = eventStream;
 
       asyncResponse->m_session->beginStreaming(
-          printer->mimeType(), boost::asio::bind_executor(m_strand, [this, asyncResponse]() {
+          eventStream ? EventStreamMimeType : printer->mimeType(),
+          boost::asio::bind_executor(asyncResponse->m_strand, [this, asyncResponse]() {
             streamNextCurrent(asyncResponse, boost::system::error_code {});
           }));
     }
@@ -1105,13 +1259,24 @@ namespace mtconnect {
           return;
         }
 
+        auto content = fetchCachedCurrentData(asyncResponse->m_printer, asyncResponse->m_filter,
+                                              asyncResponse->m_pretty)
+                           .m_content;
+        if (asyncResponse->m_eventStream)
+        {
+          // Each event is a snapshot, so it has no id to resume from
+          string event;
+          appendEvent(event, *content);
+          content = make_shared<const string>(std::move(event));
+        }
+
         asyncResponse->m_session->writeChunk(
-            fetchCurrentData(asyncResponse->m_printer, asyncResponse->m_filter, nullopt,
-                             asyncResponse->m_pretty),
-            boost::asio::bind_executor(m_strand, [this, asyncResponse]() {
+            content,
+            boost::asio::bind_executor(asyncResponse->m_strand, [this, asyncResponse]() {
               asyncResponse->m_timer.expires_from_now(asyncResponse->m_interval);
               asyncResponse->m_timer.async_wait(boost::asio::bind_executor(
-                  m_strand, boost::bind(&RestService::streamNextCurrent, this, asyncResponse, _1)));
+                  asyncResponse->m_strand,
+                  boost::bind(&RestService::streamNextCurrent, this, asyncResponse, _1)));
             }));
       }
       catch (RequestError &re)
@@ -1289,12 +1454,7 @@ namespace mtconnect {
       Timestamp ts;
       if (time)
       {
-        istringstream in(*time);
-        in >> std::setw(6) >> date::parse("%FT%T", ts);
-        if (!in.good())
-        {
-          ts = chrono::system_clock::now();
-        }
+        ts = parseTimestamp(*time);
       }
       else
       {
@@ -1448,16 +1608,46 @@ namespace mtconnect {
     // Data Collection and Formatting
     // -------------------------------------------
 
-    string RestService::fetchCurrentData(const Printer *printer, const FilterSetOpt &filterSet,
-                                         const optional<SequenceNumber_t> &at, bool pretty)
+    ChunkCache::Chunk RestService::fetchCachedCurrentData(const Printer *printer,
+                                                          const FilterSetOpt &filterSet,
+                                                          bool pretty)
+    {
+      // The document only changes when the buffer sequence advances, so requests polling faster
+      // than the observations arrive are given the document that was already rendered.
+      ChunkCache::Key key;
+      key.m_printer = printer;
+      if (filterSet)
+      {
+        // Refer to the request's filter for the lookup, a copy is only kept when inserting
+        key.m_filter = shared_ptr<const FilterSet>(shared_ptr<const FilterSet>(), &*filterSet);
+        key.m_filterHash = ChunkCache::hash(*filterSet);
+      }
+      key.m_pretty = pretty;
+      key.m_bufferSequence = m_sinkContract->getCircularBuffer().getSequence();
+
+      if (auto chunk = m_currentCache.find(key))
+        return *chunk;
+
+      ChunkCache::Chunk chunk {
+          make_shared<const string>(renderCurrentData(printer, filterSet, nullopt, pretty)),
+          key.m_bufferSequence, true, make_shared<ChunkCache::Encodings>()};
+      if (filterSet)
+        key.m_filter = make_shared<const FilterSet>(*filterSet);
+      m_currentCache.insert(key, chunk);
+
+      return chunk;
+    }
+
+    string RestService::renderCurrentData(const Printer *printer, const FilterSetOpt &filterSet,
+                                          const optional<SequenceNumber_t> &at, bool pretty)
     {
       ObservationList observations;
       SequenceNumber_t firstSeq, seq;
 
       {
-        std::lock_guard<CircularBuffer> lock(m_sinkContract->getCircularBuffer());
+        std::shared_lock<CircularBuffer> lock(m_sinkContract->getCircularBuffer());
 
-        firstSeq = m_sinkContract->getCircularBuffer().getFirstSequence();
+        firstSeq = m_sinkContract->getCircularBuffer().getOldestSequence();
         seq = m_sinkContract->getCircularBuffer().getSequence();
         if (at)
         {
@@ -1468,7 +1658,8 @@ namespace mtconnect {
         }
         else
         {
-          m_sinkContract->getCircularBuffer().getLatest().getObservations(observations, filterSet);
+          auto &buffer = m_sinkContract->getCircularBuffer();
+          buffer.getLatest().getObservations(observations, buffer.getFilterBits(filterSet));
         }
       }
 
@@ -1485,10 +1676,9 @@ namespace mtconnect {
       SequenceNumber_t firstSeq, lastSeq;
 
       {
-        std::lock_guard<CircularBuffer> lock(m_sinkContract->getCircularBuffer());
-        firstSeq = m_sinkContract->getCircularBuffer().getFirstSequence();
+        // The buffer locks itself while reading, so the range is checked against a snapshot
+        firstSeq = m_sinkContract->getCircularBuffer().getOldestSequence();
         auto seq = m_sinkContract->getCircularBuffer().getSequence();
-        lastSeq = seq - 1;
         int upperCountLimit = m_sinkContract->getCircularBuffer().getBufferSize() + 1;
         int lowerCountLimit = -upperCountLimit;
 
@@ -1506,6 +1696,7 @@ namespace mtconnect {
 
         observations = m_sinkContract->getCircularBuffer().getObservations(
             count, filterSet, from, to, end, firstSeq, endOfBuffer);
+        lastSeq = m_sinkContract->getCircularBuffer().getSequence() - 1;
       }
 
       return printer->printSample(m_instanceId, m_sinkContract->getCircularBuffer().getBufferSize(),
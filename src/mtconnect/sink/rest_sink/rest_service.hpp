@@ -24,6 +24,8 @@
 #include "mtconnect/sink/sink.hpp"
 #include "mtconnect/source/loopback_source.hpp"
 #include "mtconnect/utilities.hpp"
+#include "chunk_cache.hpp"
+#include "probe_cache.hpp"
 #include "request.hpp"
 #include "response.hpp"
 #include "server.hpp"
@@ -81,6 +83,8 @@ namespace mtconnect {
       bool publish(observation::ObservationPtr &observation) override;
 
       bool publish(asset::AssetPtr asset) override { return false; }
+
+      bool publish(device_model::DevicePtr device) override;
       ///@}
 
       /// @brief Get the HTTP server
@@ -89,6 +93,21 @@ namespace mtconnect {
       /// @brief Get the file cache
       /// @return pointer to the file cache
       auto getFileCache() { return &m_fileCache; }
+      /// @brief get the cache of rendered sample chunks shared between streams
+      /// @return pointer to the chunk cache
+      auto getSampleChunkCache() { return &m_sampleChunkCache; }
+      /// @brief get the cache of rendered current documents
+      /// @return pointer to the current cache
+      auto getCurrentCache() { return &m_currentCache; }
+      /// @brief get the chunk caches by the prefix of their metric data items in the agent device
+      /// @return the caches keyed by data item id prefix
+      std::map<std::string, ChunkCache *> getChunkCaches()
+      {
+        return {{"sample_chunk_cache", &m_sampleChunkCache}, {"current_cache", &m_currentCache}};
+      }
+      /// @brief get the cache of rendered probe documents
+      /// @return pointer to the probe cache
+      auto getProbeCache() { return &m_probeCache; }
 
       /// @name MTConnect Request Handlers
       ///@{
@@ -97,11 +116,14 @@ namespace mtconnect {
       /// @param[in]  p printer for doc generation
       /// @param[in] device optional device name or uuid
       /// @param[in] pretty `true` to ensure response is formatted
+      /// @param[in] deviceType optional device type filter
+      /// @param[in] request optional request for the encoding and conditional headers
       /// @return MTConnect Devices response
       ResponsePtr probeRequest(const printer::Printer *p,
                                const std::optional<std::string> &device = std::nullopt,
                                bool pretty = false,
-                               const std::optional<std::string> &deviceType = std::nullopt);
+                               const std::optional<std::string> &deviceType = std::nullopt,
+                               const RequestPtr &request = nullptr);
 
       /// @brief Handler for a current request
       /// @param[in] p printer for doc generation
@@ -109,13 +131,16 @@ namespace mtconnect {
       /// @param[in] at optional sequence number to take the snapshot
       /// @param[in] path an xpath to filter
       /// @param[in] pretty `true` to ensure response is formatted
+      /// @param[in] deviceType optional device type filter
+      /// @param[in] request optional request for the encoding
       /// @return MTConnect Streams response
       ResponsePtr currentRequest(const printer::Printer *p,
                                  const std::optional<std::string> &device = std::nullopt,
                                  const std::optional<SequenceNumber_t> &at = std::nullopt,
                                  const std::optional<std::string> &path = std::nullopt,
                                  bool pretty = false,
-                                 const std::optional<std::string> &deviceType = std::nullopt);
+                                 const std::optional<std::string> &deviceType = std::nullopt,
+                                 const RequestPtr &request = nullptr);
 
       /// @brief Handler for a sample request
       /// @param[in] p printer for doc generation
@@ -143,13 +168,16 @@ namespace mtconnect {
       /// @param[in] from optional starting sequence number
       /// @param[in] path optional path for filtering
       /// @param[in] pretty `true` to ensure response is formatted
+      /// @param[in] deviceType optional device type filter
+      /// @param[in] eventStream `true` to send server-sent events instead of multipart documents
       void streamSampleRequest(SessionPtr session, const printer::Printer *p, const int interval,
                                const int heartbeat, const int count = 100,
                                const std::optional<std::string> &device = std::nullopt,
                                const std::optional<SequenceNumber_t> &from = std::nullopt,
                                const std::optional<std::string> &path = std::nullopt,
                                bool pretty = false,
-                               const std::optional<std::string> &deviceType = std::nullopt);
+                               const std::optional<std::string> &deviceType = std::nullopt,
+                               bool eventStream = false);
 
       /// @brief Handler for a streaming current
       /// @param[in] session session to stream data to
@@ -158,11 +186,14 @@ namespace mtconnect {
       /// @param[in] device optional device name or uuid
       /// @param[in] path optional path for filtering
       /// @param[in] pretty `true` to ensure response is formatted
+      /// @param[in] deviceType optional device type filter
+      /// @param[in] eventStream `true` to send server-sent events instead of multipart documents
       void streamCurrentRequest(SessionPtr session, const printer::Printer *p, const int interval,
                                 const std::optional<std::string> &device = std::nullopt,
                                 const std::optional<std::string> &path = std::nullopt,
                                 bool pretty = false,
-                                const std::optional<std::string> &deviceType = std::nullopt);
+                                const std::optional<std::string> &deviceType = std::nullopt,
+                                bool eventStream = false);
       /// @brief Handler for put/post observation
       /// @param[in] p printer for response generation
       /// @param[in] device device
@@ -298,10 +329,16 @@ namespace mtconnect {
       void createAssetRoutings();
 
       // Current Data Collection
-      std::string fetchCurrentData(const printer::Printer *printer, const FilterSetOpt &filterSet,
-                                   const std::optional<SequenceNumber_t> &at, bool pretty = false);
+      ChunkCache::Chunk fetchCachedCurrentData(const printer::Printer *printer,
+                                               const FilterSetOpt &filterSet, bool pretty);
+      std::string renderCurrentData(const printer::Printer *printer, const FilterSetOpt &filterSet,
+                                    const std::optional<SequenceNumber_t> &at, bool pretty);
 
       // Sample data collection
+      SharedChunk fetchSampleChunk(AsyncSampleResponse &asyncResponse,
+                                   const std::optional<SequenceNumber_t> &from,
+                                   SequenceNumber_t &end);
+      std::optional<SequenceNumber_t> resumeSequence(const std::string &lastEventId);
       std::string fetchSampleData(const printer::Printer *printer, const FilterSetOpt &filterSet,
                                   int count, const std::optional<SequenceNumber_t> &from,
                                   const std::optional<SequenceNumber_t> &to, SequenceNumber_t &end,
@@ -338,6 +375,13 @@ namespace mtconnect {
       FileCache m_fileCache;
 
       bool m_logStreamData {false};
+
+      // Rendered chunks shared by identical sample streams
+      ChunkCache m_sampleChunkCache;
+      // Rendered current documents for the latest buffer sequence
+      ChunkCache m_currentCache;
+      // Rendered probe documents for the current device model
+      ProbeCache m_probeCache;
     };
   }  // namespace sink::rest_sink
 }  // namespace mtconnect
@@ -25,7 +25,9 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <variant>
+#include <vector>
 
 #include "mtconnect/config.hpp"
 #include "mtconnect/logging.hpp"
@@ -37,6 +39,9 @@ namespace mtconnect::sink::rest_sink {
   class Session;
   using SessionPtr = std::shared_ptr<Session>;
 
+  /// @brief The `/` separated segments of a request path
+  using PathSegments = std::vector<std::string_view>;
+
   /// @brief A REST routing that parses a URI pattern and associates a lambda when it is matched
   /// against a request
   class AGENT_LIB_API Routing
@@ -44,6 +49,13 @@ namespace mtconnect::sink::rest_sink {
   public:
     using Function = std::function<bool(SessionPtr, RequestPtr)>;
 
+    /// @brief A static or parameter segment of the routing's path
+    struct PathSegment
+    {
+      std::string m_text;        ///< The static text or the parameter name
+      bool m_parameter {false};  ///< `true` if the segment is a `{parameter}`
+    };
+
     Routing(const Routing &r) = default;
     /// @brief Create a routing with a string
     ///
@@ -83,6 +95,38 @@ namespace mtconnect::sink::rest_sink {
       : m_verb(verb), m_pattern(pattern), m_function(function), m_swagger(swagger)
     {}
 
+    /// @brief Split a request path into its segments
+    ///
+    /// The leading `/` is required and a single trailing `/` is ignored, so `/` has no segments
+    /// and `/ABC123/probe/` has the segments `ABC123` and `probe`. The segments refer to the
+    /// characters of `path`.
+    ///
+    /// @param[in] path the request path
+    /// @param[out] segments the segments of the path
+    /// @return `false` if the path does not start with a `/`
+    static bool splitPath(std::string_view path, PathSegments &segments)
+    {
+      segments.clear();
+      if (path.empty() || path.front() != '/')
+        return false;
+
+      path.remove_prefix(1);
+      if (!path.empty() && path.back() == '/')
+        path.remove_suffix(1);
+      if (path.empty())
+        return true;
+
+      size_t start = 0;
+      for (auto pos = path.find('/'); pos != std::string_view::npos; pos = path.find('/', start))
+      {
+        segments.emplace_back(path.substr(start, pos - start));
+        start = pos + 1;
+      }
+      segments.emplace_back(path.substr(start));
+
+      return true;
+    }
+
     /// @brief Added summary and description to the routing
     /// @param[in] summary optional summary
     /// @param[in] description optional description of the routing
@@ -162,13 +206,39 @@ namespace mtconnect::sink::rest_sink {
     /// @param[in,out] request the incoming request with a verb and a path
     /// @return `true` if the request was matched
     bool matches(SessionPtr session, RequestPtr request)
+    {
+      PathSegments segments;
+      if (!m_pattern && !splitPath(request->m_path, segments))
+      {
+        request->m_parameters.clear();
+        return false;
+      }
+
+      return matches(session, request, segments);
+    }
+
+    /// @brief match the session's request against the this routing with a split path
+    ///
+    /// Call the associated lambda when matched
+    ///
+    /// @param[in] session the session making the request to pass to the Routing if matched
+    /// @param[in,out] request the incoming request with a verb and a path
+    /// @param[in] segments the request path split with `splitPath()`
+    /// @return `true` if the request was matched
+    bool matches(SessionPtr session, RequestPtr request, const PathSegments &segments)
     {
       try
       {
         request->m_parameters.clear();
-        std::smatch m;
-        if (m_verb == request->m_verb && std::regex_match(request->m_path, m, m_pattern))
+        if (m_verb != request->m_verb)
+          return false;
+
+        if (m_pattern)
         {
+          std::smatch m;
+          if (!std::regex_match(request->m_path, m, *m_pattern))
+            return false;
+
           auto s = m.begin();
           s++;
           for (auto &p : m_pathParameters)
@@ -180,31 +250,52 @@ namespace mtconnect::sink::rest_sink {
               s++;
             }
           }
+        }
+        else
+        {
+          if (segments.size() != m_segments.size())
+            return false;
 
-          for (auto &p : m_queryParameters)
+          auto p = m_pathParameters.begin();
+          for (size_t i = 0; i < segments.size(); i++)
           {
-            auto q = request->m_query.find(p.m_name);
-            if (q != request->m_query.end())
+            const auto &segment = m_segments[i];
+            if (segment.m_parameter)
+            {
+              if (segments[i].empty())
+                return false;
+              request->m_parameters.emplace(p->m_name, ParameterValue(std::string(segments[i])));
+              p++;
+            }
+            else if (segments[i] != segment.m_text)
             {
-              try
-              {
-                auto v = convertValue(q->second, p.m_type);
-                request->m_parameters.emplace(make_pair(p.m_name, v));
-              }
-              catch (ParameterError &e)
-              {
-                std::string msg =
-                    std::string("for query parameter '") + p.m_name + "': " + e.what();
-                throw ParameterError(msg);
-              }
+              return false;
+            }
+          }
+        }
+
+        for (auto &p : m_queryParameters)
+        {
+          auto q = request->m_query.find(p.m_name);
+          if (q != request->m_query.end())
+          {
+            try
+            {
+              auto v = convertValue(q->second, p.m_type);
+              request->m_parameters.emplace(make_pair(p.m_name, v));
             }
-            else if (!std::holds_alternative<std::monostate>(p.m_default))
+            catch (ParameterError &e)
             {
-              request->m_parameters.emplace(make_pair(p.m_name, p.m_default));
+              std::string msg = std::string("for query parameter '") + p.m_name + "': " + e.what();
+              throw ParameterError(msg);
             }
           }
-          return m_function(session, request);
+          else if (!std::holds_alternative<std::monostate>(p.m_default))
+          {
+            request->m_parameters.emplace(make_pair(p.m_name, p.m_default));
+          }
         }
+        return m_function(session, request);
       }
 
       catch (ParameterError &e)
@@ -224,10 +315,47 @@ namespace mtconnect::sink::rest_sink {
     const auto &getPath() const { return m_path; }
     /// @brief Get the routing `verb`
     const auto &getVerb() const { return m_verb; }
+    /// @brief Get the compiled path segments
+    /// @return the segments, empty if the routing is matched with a regular expression
+    const auto &getSegments() const { return m_segments; }
+    /// @brief is this routing matched with a regular expression
+    /// @return `true` if the path could not be compiled into segments
+    bool isPattern() const { return bool(m_pattern); }
 
   protected:
     void pathParameters(std::string s)
     {
+      // Compile the path into static and parameter segments when every parameter is a whole
+      // segment, otherwise fall back to a regular expression.
+      PathSegments segments;
+      bool simple = splitPath(s, segments);
+      for (const auto &segment : segments)
+      {
+        auto open = segment.find('{');
+        if (open == std::string_view::npos && segment.find('}') == std::string_view::npos)
+        {
+          m_segments.push_back({std::string(segment), false});
+        }
+        else if (open == 0 && segment.size() > 2 && segment.back() == '}' &&
+                 segment.find_first_of("{}", 1) == segment.size() - 1)
+        {
+          std::string name(segment.substr(1, segment.size() - 2));
+          m_segments.push_back({name, true});
+          m_pathParameters.emplace_back(name);
+        }
+        else
+        {
+          simple = false;
+          break;
+        }
+      }
+
+      if (simple)
+        return;
+
+      m_segments.clear();
+      m_pathParameters.clear();
+
       std::regex reg("\\{([^}]+)\\}");
       std::smatch match;
       std::stringstream pat;
@@ -241,8 +369,7 @@ namespace mtconnect::sink::rest_sink {
       pat << s;
       pat << "/?";
 
-      m_patternText = pat.str();
-      m_pattern = std::regex(m_patternText);
+      m_pattern.emplace(pat.str());
     }
 
     void queryParameters(std::string s)
@@ -355,9 +482,9 @@ namespace mtconnect::sink::rest_sink {
 
   protected:
     boost::beast::http::verb m_verb;
-    std::regex m_pattern;
-    std::string m_patternText;
+    std::optional<std::regex> m_pattern;
     std::optional<std::string> m_path;
+    std::vector<PathSegment> m_segments;
     ParameterList m_pathParameters;
     QuerySet m_queryParameters;
     Function m_function;
@@ -0,0 +1,147 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <boost/beast/http/verb.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mtconnect/config.hpp"
+#include "routing.hpp"
+
+namespace mtconnect::sink::rest_sink {
+  /// @brief Finds the routings that can match a request path
+  ///
+  /// Routings are compiled into a trie of path segments per verb when they are added. Each node
+  /// has its static segments and one `{parameter}` child, so finding the routings for a path
+  /// only visits the nodes for its segments. Routings that are regular expressions are
+  /// candidates for every path with the same verb.
+  ///
+  /// The candidates are returned in the order the routings were added since a routing's
+  /// function can decline a request and let the next routing handle it.
+  class AGENT_LIB_API RoutingTrie
+  {
+  public:
+    /// @brief A routing and the order it was added
+    struct Entry
+    {
+      size_t m_order;
+      Routing *m_routing;
+
+      bool operator<(const Entry &o) const { return m_order < o.m_order; }
+    };
+    using EntryList = std::vector<Entry>;
+
+    /// @brief Add a routing to the trie
+    ///
+    /// The routing must outlive the trie.
+    ///
+    /// @param[in] routing the routing
+    void add(Routing &routing)
+    {
+      auto &root = m_roots[routing.getVerb()];
+      Entry entry {m_count++, &routing};
+
+      if (routing.isPattern())
+      {
+        root.m_patterns.emplace_back(entry);
+        return;
+      }
+
+      Node *node = &root.m_root;
+      for (const auto &segment : routing.getSegments())
+      {
+        std::unique_ptr<Node> *child;
+        if (segment.m_parameter)
+          child = &node->m_parameter;
+        else
+          child = &node->m_children[segment.m_text];
+
+        if (!*child)
+          *child = std::make_unique<Node>();
+        node = child->get();
+      }
+      node->m_routings.emplace_back(entry);
+    }
+
+    /// @brief Find the routings that can match the path in the order they were added
+    /// @param[in] verb the request verb
+    /// @param[in] segments the path split with `Routing::splitPath()`
+    /// @param[out] candidates the routings that can match
+    void find(boost::beast::http::verb verb, const PathSegments &segments,
+              EntryList &candidates) const
+    {
+      candidates.clear();
+      auto root = m_roots.find(verb);
+      if (root == m_roots.end())
+        return;
+
+      find(root->second.m_root, segments, 0, candidates);
+      candidates.insert(candidates.end(), root->second.m_patterns.begin(),
+                        root->second.m_patterns.end());
+      std::sort(candidates.begin(), candidates.end());
+    }
+
+    /// @brief Remove all routings
+    void clear()
+    {
+      m_roots.clear();
+      m_count = 0;
+    }
+
+  protected:
+    struct Node
+    {
+      std::map<std::string, std::unique_ptr<Node>, std::less<>> m_children;
+      std::unique_ptr<Node> m_parameter;
+      EntryList m_routings;
+    };
+
+    struct Root
+    {
+      Node m_root;
+      EntryList m_patterns;
+    };
+
+    static void find(const Node &node, const PathSegments &segments, size_t level,
+                     EntryList &candidates)
+    {
+      if (level == segments.size())
+      {
+        candidates.insert(candidates.end(), node.m_routings.begin(), node.m_routings.end());
+        return;
+      }
+
+      const auto &segment = segments[level];
+      auto child = node.m_children.find(segment);
+      if (child != node.m_children.end())
+        find(*child->second, segments, level + 1, candidates);
+      if (node.m_parameter && !segment.empty())
+        find(*node.m_parameter, segments, level + 1, candidates);
+    }
+
+  protected:
+    std::map<boost::beast::http::verb, Root> m_roots;
+    size_t m_count {0};
+  };
+}  // namespace mtconnect::sink::rest_sink
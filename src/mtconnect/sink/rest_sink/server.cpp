@@ -104,48 +104,95 @@ namespace mtconnect::sink::rest_sink {
     }
   }
 
-  // Listen for an HTTP server connection
-  void Server::listen()
-  {
-    NAMED_SCOPE("Server::listen");
+#ifdef __linux__
+  // Linux balances the connections to a port between the sockets bound with SO_REUSEPORT
+  using reuse_port = net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
 
+  bool Server::openAcceptor(tcp::acceptor &acceptor, const tcp::endpoint &ep, bool reusePort)
+  {
     beast::error_code ec;
 
-    // Blocking call to listen for a connection
-    tcp::endpoint ep(m_address, m_port);
-    m_acceptor.open(ep.protocol(), ec);
+    acceptor.open(ep.protocol(), ec);
     if (ec)
     {
       fail(ec, "Cannot open server socket");
-      return;
+      return false;
     }
-    m_acceptor.set_option(boost::asio::socket_base::reuse_address(true), ec);
+    acceptor.set_option(boost::asio::socket_base::reuse_address(true), ec);
     if (ec)
     {
       fail(ec, "Cannot set reuse address");
-      return;
+      return false;
+    }
+#ifdef __linux__
+    if (reusePort)
+    {
+      acceptor.set_option(reuse_port(true), ec);
+      if (ec)
+      {
+        fail(ec, "Cannot set reuse port");
+        return false;
+      }
     }
-    m_acceptor.bind(ep, ec);
+#endif
+    acceptor.bind(ep, ec);
     if (ec)
     {
       fail(ec, "Cannot bind to server address");
-      return;
+      return false;
     }
-    if (m_port == 0)
+    acceptor.listen(net::socket_base::max_listen_connections, ec);
+    if (ec)
     {
-      m_port = m_acceptor.local_endpoint().port();
+      fail(ec, "Cannot set listen queue length");
+      return false;
     }
 
-    m_acceptor.listen(net::socket_base::max_listen_connections, ec);
-    if (ec)
+    return true;
+  }
+
+  // Listen for an HTTP server connection
+  void Server::listen()
+  {
+    NAMED_SCOPE("Server::listen");
+
+    int count = 1;
+#ifdef __linux__
+    count = m_acceptorCount;
+#else
+    if (m_acceptorCount > 1)
+      LOG(warning) << "Multiple HTTP acceptors require SO_REUSEPORT, using one acceptor";
+#endif
+
+    // All the acceptors bind to the port of the first so an ephemeral port is shared
+    m_acceptors.clear();
+    for (int i = 0; i < count; i++)
     {
-      fail(ec, "Cannot set listen queue length");
-      return;
+      tcp::endpoint ep(m_address, m_port);
+      auto &acceptor = m_acceptors.emplace_back(m_context);
+      if (!openAcceptor(acceptor, ep, count > 1))
+      {
+        m_acceptors.pop_back();
+        if (m_acceptors.empty())
+          return;
+        break;
+      }
+      if (m_port == 0)
+      {
+        m_port = acceptor.local_endpoint().port();
+      }
     }
 
+    LOG(debug) << "Listening on port " << m_port << " with " << m_acceptors.size()
+               << " acceptor(s)";
+
     m_listening = true;
-    m_acceptor.async_accept(net::make_strand(m_context),
-                            beast::bind_front_handler(&Server::accept, this));
+    for (auto &acceptor : m_acceptors)
+    {
+      acceptor.async_accept(net::make_strand(m_context),
+                            beast::bind_front_handler(&Server::accept, this, std::ref(acceptor)));
+    }
   }
 
   bool Server::allowPutFrom(const std::string &host)
@@ -173,7 +220,7 @@ namespace mtconnect::sink::rest_sink {
     return true;
   }
 
-  void Server::accept(beast::error_code ec, tcp::socket socket)
+  void Server::accept(tcp::acceptor &acceptor, beast::error_code ec, tcp::socket socket)
   {
     NAMED_SCOPE("Server::accept");
 
@@ -198,7 +245,8 @@ namespace mtconnect::sink::rest_sink {
       {
         auto dectector =
             make_shared<TlsDector>(std::move(socket), m_sslContext, m_tlsOnly, m_allowPuts,
-                                   m_allowPutsFrom, m_fields, dispatcher, m_errorFunction);
+                                   m_allowPutsFrom, m_compression, m_fields, dispatcher,
+                                   m_errorFunction);
 
         dectector->run();
       }
@@ -213,11 +261,12 @@ namespace mtconnect::sink::rest_sink {
           session->allowPutsFrom(m_allowPutsFrom);
         else if (m_allowPuts)
           session->allowPuts();
+        session->setCompression(m_compression);
 
         session->run();
       }
-      m_acceptor.async_accept(net::make_strand(m_context),
-                              beast::bind_front_handler(&Server::accept, this));
+      acceptor.async_accept(net::make_strand(m_context),
+                            beast::bind_front_handler(&Server::accept, this, std::ref(acceptor)));
     }
   }
 
@@ -23,9 +23,11 @@
 #include <boost/beast/http/status.hpp>
 #include <boost/bind/bind.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
 #include <iostream>
+#include <list>
 #include <mutex>
 #include <regex>
 #include <sstream>
@@ -39,6 +41,7 @@
 #include "mtconnect/utilities.hpp"
 #include "response.hpp"
 #include "routing.hpp"
+#include "routing_trie.hpp"
 #include "session.hpp"
 #include "tls_dector.hpp"
 
@@ -54,12 +57,15 @@ namespace mtconnect::sink::rest_sink {
     /// - AllowPut, defaults to false
     /// - ServerIp, defaults to 0.0.0.0
     /// - HttpHeaders
+    /// - HttpCompression, defaults to true
+    /// - HttpCompressionLevel, defaults to 6
+    /// - HttpMinCompressSize, defaults to 1k
+    /// - HttpAcceptors, defaults to 1, 0 uses one per WorkerThreads
     Server(boost::asio::io_context &context, const ConfigOptions &options = {})
       : m_context(context),
         m_port(GetOption<int>(options, configuration::Port).value_or(5000)),
         m_options(options),
         m_allowPuts(IsOptionSet(options, configuration::AllowPut)),
-        m_acceptor(context),
         m_sslContext(boost::asio::ssl::context::tls)
     {
       auto inter = GetOption<std::string>(options, configuration::ServerIp);
@@ -75,6 +81,18 @@ namespace mtconnect::sink::rest_sink {
       if (fields)
         setHttpHeaders(*fields);
 
+      m_compression.m_enabled =
+          GetOption<bool>(options, configuration::HttpCompression).value_or(true);
+      m_compression.m_level =
+          GetOption<int>(options, configuration::HttpCompressionLevel).value_or(6);
+      m_compression.m_minSize =
+          size_t(ConvertFileSize(options, configuration::HttpMinCompressSize, 1024));
+
+      auto acceptors = GetOption<int>(options, configuration::HttpAcceptors).value_or(1);
+      if (acceptors <= 0)
+        acceptors = GetOption<int>(options, configuration::WorkerThreads).value_or(1);
+      m_acceptorCount = std::max(acceptors, 1);
+
       m_errorFunction = [](SessionPtr session, status st, const std::string &msg) {
         ResponsePtr response = std::make_unique<Response>(st, msg, "text/plain");
         session->writeFailureResponse(std::move(response));
@@ -93,7 +111,8 @@ namespace mtconnect::sink::rest_sink {
     void stop()
     {
       m_run = false;
-      m_acceptor.close();
+      for (auto &acceptor : m_acceptors)
+        acceptor.close();
     };
 
     /// @brief Listen for async connections
@@ -116,9 +135,18 @@ namespace mtconnect::sink::rest_sink {
     /// @brief Get the list of header fields
     /// @return header fields
     const auto &getHttpHeaders() const { return m_fields; }
+    /// @brief set how dynamic responses are compressed
+    /// @param[in] options the compression options
+    void setCompression(const CompressionOptions &options) { m_compression = options; }
+    /// @brief get the compression options
+    /// @return the compression options
+    const auto &getCompression() const { return m_compression; }
     /// @brief get the bind port
     /// @return the port being bound
     auto getPort() const { return m_port; }
+    /// @brief get the number of sockets listening on the port
+    /// @return the number of acceptors
+    auto getAcceptorCount() const { return m_acceptors.size(); }
 
     /// @name PUT and POST handling
     ///@{
@@ -151,7 +179,8 @@ namespace mtconnect::sink::rest_sink {
     /// @brief Entry point for all requests
     ///
     /// Search routings for a match, if a match is found, then dispatch the request, otherwise
-    /// return an error.
+    /// return an error. Only the routings whose path segments match the request are tried, in
+    /// the order they were added.
     /// @param[in] session the client session
     /// @param[in] request the incoming request
     /// @return `true` if the request was matched and dispatched
@@ -159,10 +188,16 @@ namespace mtconnect::sink::rest_sink {
     {
       try
       {
-        for (auto &r : m_routings)
+        PathSegments segments;
+        if (Routing::splitPath(request->m_path, segments))
         {
-          if (r.matches(session, request))
-            return true;
+          RoutingTrie::EntryList candidates;
+          m_routingTrie.find(request->m_verb, segments, candidates);
+          for (auto &c : candidates)
+          {
+            if (c.m_routing->matches(session, request, segments))
+              return true;
+          }
         }
 
         std::stringstream txt;
@@ -202,9 +237,11 @@ namespace mtconnect::sink::rest_sink {
     }
 
     /// @brief accept a connection from a client
+    /// @param[in] acceptor the acceptor the connection arrived on
     /// @param[in] ec an error code
     /// @param[in] soc the incoming connection socket
-    void accept(boost::system::error_code ec, boost::asio::ip::tcp::socket soc);
+    void accept(boost::asio::ip::tcp::acceptor &acceptor, boost::system::error_code ec,
+                boost::asio::ip::tcp::socket soc);
     /// @brief Method that generates an MTConnect Error document
     /// @param[in] ec an error code
     /// @param[in] what the description why the request failed
@@ -215,6 +252,7 @@ namespace mtconnect::sink::rest_sink {
     Routing &addRouting(const Routing &routing)
     {
       auto &route = m_routings.emplace_back(routing);
+      m_routingTrie.add(route);
       if (m_parameterDocumentation)
         route.documentParameters(*m_parameterDocumentation);
       return route;
@@ -242,6 +280,8 @@ namespace mtconnect::sink::rest_sink {
 
   protected:
     void loadTlsCertificate();
+    bool openAcceptor(boost::asio::ip::tcp::acceptor &acceptor,
+                      const boost::asio::ip::tcp::endpoint &ep, bool reusePort);
 
     /// @name Swagger Support
     /// @{
@@ -272,13 +312,17 @@ namespace mtconnect::sink::rest_sink {
     std::set<boost::asio::ip::address> m_allowPutsFrom;
 
     std::list<Routing> m_routings;
+    RoutingTrie m_routingTrie;
     std::unique_ptr<FileCache> m_fileCache;
     ErrorFunction m_errorFunction;
     FieldList m_fields;
+    CompressionOptions m_compression;
 
     std::optional<ParameterDocList> m_parameterDocumentation;
 
-    boost::asio::ip::tcp::acceptor m_acceptor;
+    // One acceptor per listening socket, the kernel balances connections between them
+    std::list<boost::asio::ip::tcp::acceptor> m_acceptors;
+    int m_acceptorCount {1};
     boost::asio::ssl::context m_sslContext;
     bool m_tlsEnabled {false};
     bool m_tlsOnly {false};
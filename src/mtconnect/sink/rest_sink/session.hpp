@@ -24,6 +24,7 @@
 #include <functional>
 #include <memory>
 
+#include "compression.hpp"
 #include "mtconnect/config.hpp"
 #include "routing.hpp"
 
@@ -38,6 +39,8 @@ namespace mtconnect::sink::rest_sink {
   using Dispatch = std::function<bool(SessionPtr, RequestPtr)>;
   using Complete = std::function<void()>;
   using FieldList = std::list<std::pair<std::string, std::string>>;
+  /// @brief An immutable rendered chunk that can be written to many sessions
+  using SharedChunk = std::shared_ptr<const std::string>;
 
   /// @brief An abstract Session for an HTTP connection to a client
   ///
@@ -69,6 +72,12 @@ namespace mtconnect::sink::rest_sink {
     /// @param chunk the chunk to write
     /// @param complete a completion callback
     virtual void writeChunk(const std::string &chunk, Complete complete) = 0;
+    /// @brief write a chunk shared with other streaming sessions
+    ///
+    /// The default implementation writes a copy of the chunk.
+    /// @param chunk the chunk to write, retained until the write completes
+    /// @param complete a completion callback
+    virtual void writeChunk(SharedChunk chunk, Complete complete) { writeChunk(*chunk, complete); }
     /// @brief close the session
     virtual void close() = 0;
     /// @brief close the stream
@@ -105,6 +114,9 @@ namespace mtconnect::sink::rest_sink {
       m_allowPuts = true;
       m_allowPutsFrom = hosts;
     }
+    /// @brief set how responses are compressed for the session
+    /// @param options the compression options
+    void setCompression(const CompressionOptions &options) { m_compression = options; }
     /// @brief get the remote endpoint
     /// @return the asio tcp endpoint
     auto &getRemote() const { return m_remote; }
@@ -124,6 +136,7 @@ namespace mtconnect::sink::rest_sink {
     bool m_unauthorized {false};
     bool m_allowPuts {false};
     std::set<boost::asio::ip::address> m_allowPutsFrom;
+    CompressionOptions m_compression;
     boost::asio::ip::tcp::endpoint m_remote;
   };
 
@@ -30,10 +30,12 @@
 #include <boost/uuid/random_generator.hpp>
 #include <boost/uuid/uuid_io.hpp>
 
+#include "event_stream.hpp"
 #include "mtconnect/logging.hpp"
 #include "request.hpp"
 #include "response.hpp"
 #include "tls_dector.hpp"
+#include "websocket_session.hpp"
 
 namespace mtconnect::sink::rest_sink {
   namespace beast = boost::beast;  // from <boost/beast.hpp>
@@ -86,14 +88,14 @@ namespace mtconnect::sink::rest_sink {
     return ch;
   }
 
-  const string urldecode(const string_view str)
+  void urldecode(const string_view str, string &result)
   {
-    ostringstream result;
+    result.reserve(result.size() + str.size());
     for (auto ch = str.cbegin(); ch != str.end(); ch++)
     {
       if (*ch == '+')
       {
-        result << ' ';
+        result.push_back(' ');
       }
       else if (*ch == '%')
       {
@@ -102,43 +104,53 @@ namespace mtconnect::sink::rest_sink {
         auto cb = unhex(*ch);
         if (++ch == str.end())
           break;
-        result << char(cb << 4 | unhex(*ch));
+        result.push_back(char(cb << 4 | unhex(*ch)));
       }
       else
       {
-        result << *ch;
+        result.push_back(*ch);
       }
     }
-    return result.str();
   }
 
-  void parseQueries(string qp, map<string, string> &queries)
+  const string urldecode(const string_view str)
+  {
+    string result;
+    urldecode(str, result);
+    return result;
+  }
+
+  void parseQueries(const string_view qp, map<string, string> &queries)
   {
-    vector<boost::iterator_range<string::iterator>> toks;
-    algo::split(toks, qp, boost::is_any_of("&"));
-    for (auto tok : toks)
+    // Split on & and = and decode in one pass over the query string
+    size_t start = 0;
+    while (start <= qp.size())
     {
-      auto qv = string_view(&*tok.begin(), tok.size());
+      auto end = qp.find('&', start);
+      if (end == string_view::npos)
+        end = qp.size();
+
+      auto qv = qp.substr(start, end - start);
       auto eq = qv.find('=');
       if (eq != string_view::npos)
       {
-        string f(urldecode(qv.substr(0, eq)));
-        string s(urldecode(qv.substr(eq + 1)));
-        auto pair = std::make_pair(f, s);
-        queries.insert(pair);
+        string f, s;
+        urldecode(qv.substr(0, eq), f);
+        urldecode(qv.substr(eq + 1), s);
+        queries.emplace(std::move(f), std::move(s));
       }
+
+      start = end + 1;
     }
   }
 
-  string parseUrl(string url, map<string, string> &queries)
+  string parseUrl(const string_view url, map<string, string> &queries)
   {
     auto pos = url.find('?');
-    if (pos != string::npos)
+    if (pos != string_view::npos)
     {
-      auto path = urldecode(url.substr(0, pos));
-      auto qp = url.substr(pos + 1);
-      parseQueries(qp, queries);
-      return path;
+      parseQueries(url.substr(pos + 1), queries);
+      return urldecode(url.substr(0, pos));
     }
     else
     {
@@ -194,6 +206,51 @@ namespace mtconnect::sink::rest_sink {
       return;
     }
 
+    // Keep handling the pipelined requests in the buffer while their responses are queued
+    while (handleRequest())
+    {
+      if (!parseBuffered())
+      {
+        writeBatch();
+        return;
+      }
+    }
+  }
+
+  template <class Derived>
+  bool SessionImpl<Derived>::parseBuffered()
+  {
+    NAMED_SCOPE("SessionImpl::parseBuffered");
+
+    // Parse the next request from the bytes already read. If the request is not complete, the
+    // bytes are left in the buffer and parsed again by the next read.
+    reset();
+    m_parser->body_limit(100000);
+    m_parser->eager(true);
+
+    auto data = m_buffer.cdata();
+    size_t used = 0;
+    beast::error_code ec;
+    while (!m_parser->is_done() && used < data.size())
+    {
+      auto n = m_parser->put(data + used, ec);
+      if (ec || n == 0)
+        return false;
+      used += n;
+    }
+
+    if (!m_parser->is_done())
+      return false;
+
+    m_buffer.consume(used);
+    return true;
+  }
+
+  template <class Derived>
+  bool SessionImpl<Derived>::handleRequest()
+  {
+    NAMED_SCOPE("SessionImpl::handleRequest");
+
     auto &msg = m_parser->get();
     const auto &remote = beast::get_lowest_layer(derived().stream()).socket().remote_endpoint();
 
@@ -205,20 +262,21 @@ namespace mtconnect::sink::rest_sink {
         fail(http::status::bad_request,
              "PUT, POST, and DELETE are not allowed. MTConnect Agent is read only and only GET "
              "is allowed.");
-        return;
+        return false;
       }
       else if (!m_allowPutsFrom.empty() &&
                m_allowPutsFrom.find(remote.address()) == m_allowPutsFrom.end())
       {
         fail(http::status::bad_request,
              "PUT, POST, and DELETE are not allowed from " + remote.address().to_string());
-        return;
+        return false;
       }
     }
 
     m_request = make_shared<Request>();
     m_request->m_verb = msg.method();
-    m_request->m_path = parseUrl(string(msg.target()), m_request->m_query);
+    auto target = msg.target();
+    m_request->m_path = parseUrl(string_view(target.data(), target.size()), m_request->m_query);
 
     if (auto a = msg.find(http::field::accept); a != msg.end())
       m_request->m_accepts = string(a->value());
@@ -226,6 +284,12 @@ namespace mtconnect::sink::rest_sink {
       m_request->m_contentType = string(a->value());
     if (auto a = msg.find(http::field::accept_encoding); a != msg.end())
       m_request->m_acceptsEncoding = string(a->value());
+    if (auto a = msg.find(http::field::if_none_match); a != msg.end())
+      m_request->m_ifNoneMatch = string(a->value());
+    if (auto a = msg.find(http::field::if_modified_since); a != msg.end())
+      m_request->m_ifModifiedSince = string(a->value());
+    if (auto a = msg.find("Last-Event-ID"); a != msg.end())
+      m_request->m_lastEventId = string(a->value());
     m_request->m_body = msg.body();
 
     if (auto f = msg.find(http::field::content_type);
@@ -243,12 +307,33 @@ namespace mtconnect::sink::rest_sink {
     LOG(info) << "ReST Request: From [" << m_request->m_foreignIp << ':' << remote.port()
               << "]: " << msg.method() << " " << msg.target();
 
+    // The socket is handed over to a WebSocket session that carries its own requests. The
+    // responses to the pipelined requests before it are written first.
+    if (beast::websocket::is_upgrade(msg))
+    {
+      if (!m_pending.empty())
+      {
+        m_afterBatch = [this]() { upgrade(); };
+        writeBatch();
+      }
+      else
+      {
+        upgrade();
+      }
+      return false;
+    }
+
+    m_queued = false;
+    m_dispatching = true;
     if (!m_dispatch(shared_ptr(), m_request))
     {
       ostringstream txt;
       txt << "Failed to find handler for " << msg.method() << " " << msg.target();
       LOG(error) << txt.str();
     }
+    m_dispatching = false;
+
+    return m_queued;
   }
 
   template <class Derived>
@@ -278,17 +363,100 @@ namespace mtconnect::sink::rest_sink {
     }
   }
 
+  template <class Derived>
+  void SessionImpl<Derived>::upgrade()
+  {
+    NAMED_SCOPE("SessionImpl::upgrade");
+
+    using Stream = std::decay_t<decltype(derived().releaseStream())>;
+    auto socket = make_shared<WebsocketSessionImpl<Stream>>(
+        derived().releaseStream(), m_parser->release(), std::move(m_request), m_dispatch,
+        m_errorFunction);
+    socket->run();
+  }
+
+  template <class Derived>
+  void SessionImpl<Derived>::writeBatch()
+  {
+    NAMED_SCOPE("SessionImpl::writeBatch");
+
+    beast::get_lowest_layer(derived().stream()).expires_after(30s);
+
+    m_gathered.clear();
+    for (const auto &pending : m_pending)
+    {
+      m_gathered.emplace_back(asio::buffer(pending.m_header));
+      if (pending.m_body.size() > 0)
+        m_gathered.emplace_back(pending.m_body);
+    }
+
+    asio::async_write(derived().stream(), m_gathered,
+                      beast::bind_front_handler(&SessionImpl::sentBatch, shared_ptr()));
+  }
+
+  template <class Derived>
+  void SessionImpl<Derived>::sentBatch(boost::system::error_code ec, size_t len)
+  {
+    NAMED_SCOPE("SessionImpl::sentBatch");
+
+    auto pending = std::move(m_pending);
+    m_pending.clear();
+
+    if (ec)
+    {
+      fail(status::internal_server_error, "Error sending message - ", ec);
+      return;
+    }
+
+    for (auto &p : pending)
+    {
+      if (p.m_complete)
+        p.m_complete();
+    }
+
+    // A response that could not be batched is written after the responses before it
+    if (m_afterBatch)
+    {
+      auto next = std::move(m_afterBatch);
+      m_afterBatch = nullptr;
+      next();
+    }
+    else if (!m_streaming)
+    {
+      if (!m_close)
+        read();
+      else
+        close();
+    }
+  }
+
   template <class Derived>
   void SessionImpl<Derived>::beginStreaming(const std::string &mimeType, Complete complete)
   {
     NAMED_SCOPE("SessionImpl::beginStreaming");
 
+    if (!m_pending.empty())
+    {
+      m_afterBatch = [this, mimeType, complete]() { beginStreaming(mimeType, complete); };
+      writeBatch();
+      return;
+    }
+
     beast::get_lowest_layer(derived().stream()).expires_after(30s);
 
     using namespace http;
     using namespace boost::uuids;
-    random_generator gen;
-    m_boundary = to_string(gen());
+    // Server-sent events are written as they are formatted, without multipart boundaries
+    m_eventStream = mimeType == EventStreamMimeType;
+    if (m_eventStream)
+    {
+      m_boundary.clear();
+    }
+    else
+    {
+      random_generator gen;
+      m_boundary = to_string(gen());
+    }
     m_complete = complete;
     m_mimeType = mimeType;
     m_streaming = true;
@@ -298,7 +466,10 @@ namespace mtconnect::sink::rest_sink {
     res->chunked(true);
     res->set(field::server, "MTConnectAgent");
     res->set(field::connection, "close");
-    res->set(field::content_type, "multipart/mixed;boundary=" + m_boundary);
+    if (m_eventStream)
+      res->set(field::content_type, mimeType);
+    else
+      res->set(field::content_type, "multipart/mixed;boundary=" + m_boundary);
     res->set(field::expires, "-1");
     res->set(field::cache_control, "no-cache, no-store, max-age=0");
     for (const auto &f : m_fields)
@@ -306,6 +477,18 @@ namespace mtconnect::sink::rest_sink {
       res->set(f.first, f.second);
     }
 
+    // The whole multipart body is one compressed stream, each part is flushed as it is written
+    m_compressor.reset();
+    if (m_compression.m_enabled && m_request)
+    {
+      if (auto encoding = StreamCompressor::negotiate(m_request->m_acceptsEncoding))
+      {
+        m_compressor = make_unique<StreamCompressor>(*encoding, m_compression.m_level);
+        res->set(field::content_encoding, StreamCompressor::name(*encoding));
+        res->set(field::vary, "Accept-Encoding");
+      }
+    }
+
     auto sr = make_shared<response_serializer<empty_body>>(*res);
     m_serializer = sr;
     async_write_header(derived().stream(), *sr,
@@ -322,15 +505,97 @@ namespace mtconnect::sink::rest_sink {
     beast::get_lowest_layer(derived().stream()).expires_after(30s);
 
     m_complete = complete;
-    m_streamBuffer.emplace();
+    resetStreamBuffer();
+    ostream str(&m_streamBuffer.value());
+
+    if (m_eventStream)
+      str << body;
+    else
+      str << "--" + m_boundary << "\r\n"
+          << to_string(field::content_type) << ": " << m_mimeType << "\r\n"
+          << to_string(field::content_length) << ": " << to_string(body.length()) << "\r\n\r\n"
+          << body << "\r\n";
+
+    if (m_compressor)
+    {
+      auto data = m_streamBuffer->data();
+      writeCompressedChunk({string_view(static_cast<const char *>(data.data()), data.size())});
+      return;
+    }
+
+    async_write(derived().stream(), http::make_chunk(m_streamBuffer->data()),
+                beast::bind_front_handler(&SessionImpl::sent, shared_ptr()));
+  }
+
+  template <class Derived>
+  void SessionImpl<Derived>::writeChunk(SharedChunk body, Complete complete)
+  {
+    NAMED_SCOPE("SessionImpl::writeChunk");
+
+    using namespace http;
+
+    beast::get_lowest_layer(derived().stream()).expires_after(30s);
+
+    // The part headers are written to the stream buffer and the body is written from the shared
+    // chunk, which is held until the next chunk so it is not copied for each session.
+    m_complete = complete;
+    m_sharedChunk = body;
+
+    // Events are formatted by the caller, so the chunk is written as it is
+    if (m_eventStream)
+    {
+      if (m_compressor)
+      {
+        writeCompressedChunk({string_view(*m_sharedChunk)});
+        return;
+      }
+
+      async_write(derived().stream(), http::make_chunk(asio::buffer(*m_sharedChunk)),
+                  beast::bind_front_handler(&SessionImpl::sent, shared_ptr()));
+      return;
+    }
+
+    resetStreamBuffer();
     ostream str(&m_streamBuffer.value());
 
     str << "--" + m_boundary << "\r\n"
         << to_string(field::content_type) << ": " << m_mimeType << "\r\n"
-        << to_string(field::content_length) << ": " << to_string(body.length()) << "\r\n\r\n"
-        << body << "\r\n";
+        << to_string(field::content_length) << ": " << to_string(body->length()) << "\r\n\r\n";
 
-    async_write(derived().stream(), http::make_chunk(m_streamBuffer->data()),
+    if (m_compressor)
+    {
+      auto data = m_streamBuffer->data();
+      writeCompressedChunk({string_view(static_cast<const char *>(data.data()), data.size()),
+                            string_view(*m_sharedChunk), "\r\n"sv});
+      return;
+    }
+
+    std::array<asio::const_buffer, 3> buffers {m_streamBuffer->data(),
+                                               asio::buffer(*m_sharedChunk),
+                                               asio::buffer("\r\n", 2)};
+    async_write(derived().stream(), http::make_chunk(buffers),
+                beast::bind_front_handler(&SessionImpl::sent, shared_ptr()));
+  }
+
+  template <class Derived>
+  void SessionImpl<Derived>::resetStreamBuffer()
+  {
+    // Keep the session's buffer between chunks so its storage is reused for every part
+    if (m_streamBuffer)
+      m_streamBuffer->consume(m_streamBuffer->size());
+    else
+      m_streamBuffer.emplace();
+  }
+
+  template <class Derived>
+  void SessionImpl<Derived>::writeCompressedChunk(std::initializer_list<std::string_view> parts)
+  {
+    m_compressed.clear();
+    for (const auto &part : parts)
+      m_compressor->write(part, m_compressed);
+    m_compressor->flush(m_compressed);
+
+    async_write(derived().stream(), http::make_chunk(asio::buffer(m_compressed)),
                 beast::bind_front_handler(&SessionImpl::sent, shared_ptr()));
   }
 
@@ -340,6 +605,20 @@ namespace mtconnect::sink::rest_sink {
     NAMED_SCOPE("SessionImpl::closeStream");
 
     m_complete = [this]() { close(); };
+
+    // Finish the compressed body in the last data chunk before the terminating chunk
+    if (m_compressor)
+    {
+      m_compressed.clear();
+      m_compressor->finish(m_compressed);
+      m_compressor.reset();
+      async_write(derived().stream(),
+                  beast::buffers_cat(http::make_chunk(asio::buffer(m_compressed)),
+                                     http::make_chunk_last()),
+                  beast::bind_front_handler(&SessionImpl::sent, shared_ptr()));
+      return;
+    }
+
     http::fields trailer;
     async_write(derived().stream(), http::make_chunk_last(trailer),
                 beast::bind_front_handler(&SessionImpl::sent, shared_ptr()));
@@ -352,7 +631,12 @@ namespace mtconnect::sink::rest_sink {
     res->set(http::field::server, "MTConnectAgent");
     if (response.m_close || m_close)
       res->set(http::field::connection, "close");
-    if (response.m_expires == 0s)
+    // Tagged responses may be stored, but are revalidated with the entity tag on each use
+    if (response.m_etag)
+    {
+      res->set(http::field::cache_control, "no-cache");
+    }
+    else if (response.m_expires == 0s)
     {
       res->set(http::field::expires, "-1");
       res->set(http::field::cache_control, "no-store, max-age=0");
@@ -366,6 +650,14 @@ namespace mtconnect::sink::rest_sink {
     {
       res->set(http::field::location, *response.m_location);
     }
+    if (response.m_etag)
+      res->set(http::field::etag, *response.m_etag);
+    if (response.m_lastModified)
+      res->set(http::field::last_modified, *response.m_lastModified);
+    if (response.m_contentEncoding)
+      res->set(http::field::content_encoding, *response.m_contentEncoding);
+    if (response.m_etag || response.m_contentEncoding)
+      res->set(http::field::vary, "Accept-Encoding");
   }
 
   template <class Derived>
@@ -378,6 +670,16 @@ namespace mtconnect::sink::rest_sink {
     namespace fs = std::filesystem;
     using std::move;
 
+    if (!m_pending.empty() && responsePtr->m_file && !responsePtr->m_file->m_cached)
+    {
+      auto deferred = make_shared<ResponsePtr>(std::move(responsePtr));
+      m_afterBatch = [this, deferred, complete]() {
+        writeResponse(std::move(*deferred), complete);
+      };
+      writeBatch();
+      return;
+    }
+
     m_complete = complete;
     m_outgoing = std::move(responsePtr);
 
@@ -427,19 +729,85 @@ namespace mtconnect::sink::rest_sink {
         bp = m_outgoing->m_file->m_buffer;
         size = m_outgoing->m_file->m_size;
       }
+      else if (m_outgoing->m_sharedBody)
+      {
+        bp = m_outgoing->m_sharedBody->data();
+        size = m_outgoing->m_sharedBody->size();
+      }
       else
       {
         bp = m_outgoing->m_body.c_str();
         size = m_outgoing->m_body.size();
       }
 
+      // Compress generated documents. Files, and tagged documents that select their own
+      // encoding, are sent as is.
+      if (m_compression.m_enabled && m_request && !m_outgoing->m_file && !m_outgoing->m_etag &&
+          !m_outgoing->m_contentEncoding && m_outgoing->m_status != status::not_modified &&
+          size >= m_compression.m_minSize)
+      {
+        if (auto encoding = StreamCompressor::negotiate(m_request->m_acceptsEncoding))
+        {
+          m_compressed =
+              StreamCompressor::compress(*encoding, m_compression.m_level, string_view(bp, size));
+          m_outgoing->m_contentEncoding = StreamCompressor::name(*encoding);
+          bp = m_compressed.data();
+          size = m_compressed.size();
+        }
+      }
+
+      // Queue the response while more pipelined requests are in the buffer, and write the
+      // queue when it is the last one
+      bool batch = m_dispatching && !m_close && !m_outgoing->m_close && m_buffer.size() > 0;
+      PendingResponse *pending {nullptr};
+      if (batch || !m_pending.empty())
+      {
+        pending = &m_pending.emplace_back();
+        if (bp == m_compressed.data())
+        {
+          pending->m_compressed = std::move(m_compressed);
+          m_compressed.clear();
+          bp = pending->m_compressed.data();
+        }
+      }
+
       auto res = make_shared<http::response<http::span_body<const char>>>(
           std::piecewise_construct, std::make_tuple(bp, size),
           std::make_tuple(m_outgoing->m_status, 11));
 
       addHeaders(*m_outgoing, res);
       res->chunked(false);
-      res->content_length(size);
+      // A not modified response has no body and must not claim one
+      if (m_outgoing->m_status != status::not_modified)
+        res->content_length(size);
+
+      if (pending)
+      {
+        // Serialize the header and refer to the body for the gathered write
+        http::response_serializer<http::span_body<const char>> sr(*res);
+        sr.split(true);
+        beast::error_code ec;
+        while (!ec && !sr.is_header_done())
+        {
+          sr.next(ec, [&sr, pending](beast::error_code &ec, const auto &buffers) {
+            for (auto b : beast::buffers_range_ref(buffers))
+              pending->m_header.append(static_cast<const char *>(b.data()), b.size());
+            sr.consume(beast::buffer_bytes(buffers));
+          });
+        }
+        if (m_outgoing->m_status != status::not_modified)
+          pending->m_body = asio::const_buffer(bp, size);
+        pending->m_response = res;
+        pending->m_outgoing = std::move(m_outgoing);
+        pending->m_complete = std::move(m_complete);
+        m_complete = nullptr;
+
+        if (batch)
+          m_queued = true;
+        else
+          writeBatch();
+        return;
+      }
 
       m_response = res;
 
@@ -454,7 +822,16 @@ namespace mtconnect::sink::rest_sink {
     if (m_streaming)
     {
       m_outgoing = std::move(response);
-      writeChunk(m_outgoing->m_body, [this] { closeStream(); });
+      if (m_eventStream)
+      {
+        string event;
+        appendEvent(event, m_outgoing->m_body, nullopt, "error");
+        writeChunk(event, [this] { closeStream(); });
+      }
+      else
+      {
+        writeChunk(m_outgoing->m_body, [this] { closeStream(); });
+      }
     }
     else
     {
@@ -503,7 +880,12 @@ namespace mtconnect::sink::rest_sink {
 
     /// @brief return the stream and hand over ownership
     /// @return the stream
-    beast::ssl_stream<beast::tcp_stream> releaseStream() { return std::move(m_stream); }
+    beast::ssl_stream<beast::tcp_stream> releaseStream()
+    {
+      // The released stream is closed by its new owner
+      m_closing = true;
+      return std::move(m_stream);
+    }
 
     /// @brief shutdown the stream asyncronously closing the secure stream
     void close() override
@@ -597,6 +979,7 @@ namespace mtconnect::sink::rest_sink {
         session->allowPutsFrom(m_allowPutsFrom);
       else if (m_allowPuts)
         session->allowPuts();
+      session->setCompression(m_compression);
 
       session->run();
     }
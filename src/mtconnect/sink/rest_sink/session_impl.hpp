@@ -20,9 +20,12 @@
 #include <boost/asio.hpp>
 #include <boost/beast.hpp>
 
+#include <deque>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <string_view>
+#include <vector>
 
 #include "mtconnect/config.hpp"
 #include "mtconnect/configuration/config_options.hpp"
@@ -36,6 +39,11 @@ namespace mtconnect {
 
   namespace sink::rest_sink {
     /// @brief A session implementation `Derived` subclass pattern
+    ///
+    /// Requests pipelined by the client are handled from the read buffer without waiting for the
+    /// next read. Their responses are queued and written in order with one gathered write when
+    /// the buffer holds no more complete requests.
+    ///
     /// @tparam subclass of this class to use the same methods with http or https protocol streams
     template <class Derived>
     class SessionImpl : public Session
@@ -71,6 +79,7 @@ namespace mtconnect {
       void writeFailureResponse(ResponsePtr &&response, Complete complete = nullptr) override;
       void beginStreaming(const std::string &mimeType, Complete complete) override;
       void writeChunk(const std::string &chunk, Complete complete) override;
+      void writeChunk(SharedChunk chunk, Complete complete) override;
       void closeStream() override;
       ///@}
     protected:
@@ -78,9 +87,16 @@ namespace mtconnect {
       void addHeaders(const Response &response, T &res);
 
       void requested(boost::system::error_code ec, size_t len);
+      bool handleRequest();
+      bool parseBuffered();
       void sent(boost::system::error_code ec, size_t len);
+      void sentBatch(boost::system::error_code ec, size_t len);
+      void writeBatch();
+      void upgrade();
       void read();
       void reset();
+      void resetStreamBuffer();
+      void writeCompressedChunk(std::initializer_list<std::string_view> parts);
 
     protected:
       using RequestParser = boost::beast::http::request_parser<boost::beast::http::string_body>;
@@ -90,6 +106,7 @@ namespace mtconnect {
 
       // For Streaming
       std::string m_boundary;
+      bool m_eventStream {false};
       std::string m_mimeType;
       bool m_close {false};
 
@@ -100,10 +117,29 @@ namespace mtconnect {
       RequestPtr m_request;
       boost::beast::flat_buffer m_buffer;
       std::optional<boost::asio::streambuf> m_streamBuffer;
+      SharedChunk m_sharedChunk;
+      std::unique_ptr<StreamCompressor> m_compressor;
+      std::string m_compressed;
       std::optional<RequestParser> m_parser;
       std::shared_ptr<void> m_response;
       std::shared_ptr<void> m_serializer;
       ResponsePtr m_outgoing;
+
+      // For pipelined requests
+      struct PendingResponse
+      {
+        ResponsePtr m_outgoing;
+        std::shared_ptr<void> m_response;
+        std::string m_header;
+        std::string m_compressed;
+        boost::asio::const_buffer m_body;
+        Complete m_complete;
+      };
+      std::deque<PendingResponse> m_pending;
+      std::vector<boost::asio::const_buffer> m_gathered;
+      std::function<void()> m_afterBatch;
+      bool m_dispatching {false};
+      bool m_queued {false};
     };
 
     /// @brief An HTTP Session for communication without TLS
@@ -134,6 +170,13 @@ namespace mtconnect {
       /// @brief get the stream
       /// @return the stream
       auto &stream() { return m_stream; }
+      /// @brief return the stream and hand over ownership
+      /// @return the stream
+      boost::beast::tcp_stream releaseStream()
+      {
+        m_released = true;
+        return std::move(m_stream);
+      }
 
       /// @brief close the session and shutdown the socket
       void close() override
@@ -141,12 +184,15 @@ namespace mtconnect {
         NAMED_SCOPE("HttpSession::close");
 
         m_request.reset();
+        if (m_released)
+          return;
         boost::beast::error_code ec;
         m_stream.socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
       }
 
     protected:
       boost::beast::tcp_stream m_stream;
+      bool m_released {false};
     };
   }  // namespace sink::rest_sink
 }  // namespace mtconnect
@@ -37,17 +37,20 @@ namespace mtconnect::sink::rest_sink {
     /// @param[in] tlsOnly only allow TLS connects, reject otherwise
     /// @param[in] allowPuts allow puts
     /// @param[in] allowPutsFrom allow puts from an address
+    /// @param[in] compression the response compression options
     /// @param[in] list the header fields
     /// @param[in] dispatch a dispatcher function
     /// @param[in] error an error function
     TlsDector(boost::asio::ip::tcp::socket &&socket, boost::asio::ssl::context &context,
               bool tlsOnly, bool allowPuts, const std::set<boost::asio::ip::address> &allowPutsFrom,
-              const FieldList &list, Dispatch dispatch, ErrorFunction error)
+              const CompressionOptions &compression, const FieldList &list, Dispatch dispatch,
+              ErrorFunction error)
       : m_stream(std::move(socket)),
         m_tlsContext(context),
         m_tlsOnly(tlsOnly),
         m_allowPuts(allowPuts),
         m_allowPutsFrom(allowPutsFrom),
+        m_compression(compression),
         m_fields(list),
         m_dispatch(dispatch),
         m_errorFunction(error)
@@ -87,6 +90,7 @@ namespace mtconnect::sink::rest_sink {
     bool m_tlsOnly;
     bool m_allowPuts;
     std::set<boost::asio::ip::address> m_allowPutsFrom;
+    CompressionOptions m_compression;
 
     FieldList m_fields;
     Dispatch m_dispatch;
@@ -0,0 +1,277 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#include "websocket_session.hpp"
+
+#include <rapidjson/document.h>
+
+#include "mtconnect/utilities.hpp"
+
+namespace mtconnect::sink::rest_sink {
+  namespace http = boost::beast::http;
+  namespace rj = rapidjson;
+
+  using namespace std;
+
+  WebsocketSubscription::WebsocketSubscription(shared_ptr<WebsocketSession> socket,
+                                               const string &id, Dispatch dispatch,
+                                               ErrorFunction error)
+    : Session(dispatch, error), m_socket(socket), m_id(id)
+  {
+    m_remote = socket->getRemote();
+  }
+
+  void WebsocketSubscription::writeResponse(ResponsePtr &&response, Complete complete)
+  {
+    NAMED_SCOPE("WebsocketSubscription::writeResponse");
+
+    auto socket = m_socket.lock();
+    if (!socket || m_closed)
+      return;
+
+    SharedChunk body;
+    auto code = response->m_status;
+    if (response->m_sharedBody)
+    {
+      body = response->m_sharedBody;
+    }
+    else if (response->m_file)
+    {
+      // Only files held in memory are sent on a WebSocket
+      if (response->m_file->m_cached)
+        body = make_shared<const string>(response->m_file->m_buffer, response->m_file->m_size);
+      else
+        code = status::not_found;
+    }
+    else
+    {
+      body = make_shared<const string>(std::move(response->m_body));
+    }
+
+    // A single response finishes the subscription
+    auto self = static_pointer_cast<WebsocketSubscription>(shared_from_this());
+    bool streaming = m_streaming;
+    socket->send(WebsocketSession::header(m_id, code, response->m_mimeType), body,
+                 [self, streaming, complete]() {
+                   if (complete)
+                     complete();
+                   if (!streaming)
+                     self->close();
+                 });
+  }
+
+  void WebsocketSubscription::writeFailureResponse(ResponsePtr &&response, Complete complete)
+  {
+    // The failure ends a stream as well
+    m_streaming = false;
+    writeResponse(std::move(response), complete);
+  }
+
+  void WebsocketSubscription::beginStreaming(const string &mimeType, Complete complete)
+  {
+    NAMED_SCOPE("WebsocketSubscription::beginStreaming");
+
+    auto socket = m_socket.lock();
+    if (!socket || m_closed)
+      return;
+
+    m_mimeType = mimeType;
+    m_streaming = true;
+    socket->send(WebsocketSession::header(m_id, status::ok, m_mimeType), nullptr, complete);
+  }
+
+  void WebsocketSubscription::writeChunk(const string &chunk, Complete complete)
+  {
+    writeChunk(make_shared<const string>(chunk), complete);
+  }
+
+  void WebsocketSubscription::writeChunk(SharedChunk chunk, Complete complete)
+  {
+    // When the subscription is closed the completion is not called, which ends the stream
+    auto socket = m_socket.lock();
+    if (!socket || m_closed)
+      return;
+
+    socket->send(WebsocketSession::header(m_id, nullopt, m_mimeType), chunk, complete);
+  }
+
+  void WebsocketSubscription::close()
+  {
+    if (!m_closed.exchange(true))
+    {
+      if (auto socket = m_socket.lock())
+        socket->finished(static_pointer_cast<WebsocketSubscription>(shared_from_this()));
+    }
+  }
+
+  void WebsocketSubscription::closeStream() { close(); }
+
+  string WebsocketSession::header(const string &id, optional<status> code, const string &mimeType)
+  {
+    string header;
+    header.reserve(48 + id.size() + mimeType.size());
+    header.append("id: ").append(id).append("\r\n");
+    if (code)
+      header.append("status: ").append(to_string(static_cast<unsigned>(*code))).append("\r\n");
+    header.append("content-type: ").append(mimeType).append("\r\n\r\n");
+    return header;
+  }
+
+  void WebsocketSession::send(string &&header, SharedChunk body, Complete complete)
+  {
+    execute([this, header = std::move(header), body, complete]() mutable {
+      if (m_closing)
+        return;
+
+      m_messages.push_back({std::move(header), body, complete});
+      if (m_messages.size() == 1)
+        write();
+    });
+  }
+
+  void WebsocketSession::finished(shared_ptr<WebsocketSubscription> subscription)
+  {
+    execute([this, subscription]() {
+      auto it = m_subscriptions.find(subscription->getId());
+      if (it != m_subscriptions.end() && it->second == subscription)
+        m_subscriptions.erase(it);
+    });
+  }
+
+  void WebsocketSession::cancel(const string &id)
+  {
+    auto it = m_subscriptions.find(id);
+    if (it != m_subscriptions.end())
+    {
+      auto subscription = it->second;
+      m_subscriptions.erase(it);
+      subscription->close();
+    }
+  }
+
+  void WebsocketSession::closeSubscriptions()
+  {
+    auto subscriptions = std::move(m_subscriptions);
+    m_subscriptions.clear();
+    for (auto &s : subscriptions)
+      s.second->close();
+  }
+
+  void WebsocketSession::sendError(const string &id, status code, const string &message)
+  {
+    auto subscription =
+        make_shared<WebsocketSubscription>(shared_from_this(), id, m_dispatch, m_errorFunction);
+    subscription->fail(code, message);
+  }
+
+  static optional<string> memberValue(const rj::Value &value)
+  {
+    if (value.IsString())
+      return string(value.GetString(), value.GetStringLength());
+    else if (value.IsBool())
+      return value.GetBool() ? "true"s : "false"s;
+    else if (value.IsInt64())
+      return to_string(value.GetInt64());
+    else if (value.IsUint64())
+      return to_string(value.GetUint64());
+    else if (value.IsNumber())
+      return format(value.GetDouble());
+    else
+      return nullopt;
+  }
+
+  void WebsocketSession::received(string_view message)
+  {
+    NAMED_SCOPE("WebsocketSession::received");
+
+    rj::Document doc;
+    doc.Parse(message.data(), message.size());
+    if (doc.HasParseError() || !doc.IsObject())
+    {
+      sendError("", status::bad_request, "WebSocket requests must be JSON objects");
+      return;
+    }
+
+    optional<string> id, type;
+    if (auto m = doc.FindMember("id"); m != doc.MemberEnd())
+      id = memberValue(m->value);
+    if (!id)
+    {
+      sendError("", status::bad_request, "WebSocket requests must have an id");
+      return;
+    }
+    if (auto m = doc.FindMember("request"); m != doc.MemberEnd() && m->value.IsString())
+      type.emplace(m->value.GetString(), m->value.GetStringLength());
+    if (!type || type->empty())
+    {
+      sendError(*id, status::bad_request, "WebSocket requests must have a request");
+      return;
+    }
+
+    // A new request with the same id replaces the previous one
+    cancel(*id);
+    if (*type == "cancel")
+      return;
+
+    // The request inherits the headers and remote address of the upgrade request
+    auto request = make_shared<Request>(*m_request);
+    request->m_verb = http::verb::get;
+    request->m_body.clear();
+    request->m_acceptsEncoding.clear();
+    request->m_ifNoneMatch.clear();
+    request->m_ifModifiedSince.clear();
+    request->m_query.clear();
+    request->m_parameters.clear();
+
+    string device;
+    for (const auto &member : doc.GetObject())
+    {
+      string_view name(member.name.GetString(), member.name.GetStringLength());
+      if (name == "id" || name == "request")
+        continue;
+
+      auto value = memberValue(member.value);
+      if (!value)
+      {
+        sendError(*id, status::bad_request, "Invalid value for " + string(name));
+        return;
+      }
+
+      if (name == "device")
+        device = *value;
+      else if (name == "format")
+        request->m_accepts = "application/" + *value;
+      else
+        request->m_query.emplace(name, *value);
+    }
+
+    request->m_path.clear();
+    if (!device.empty())
+      request->m_path.append("/").append(device);
+    request->m_path.append("/").append(*type);
+
+    LOG(info) << "WebSocket Request " << *id << ": From [" << request->m_foreignIp << ':'
+              << request->m_foreignPort << "]: " << request->m_path;
+
+    auto subscription =
+        make_shared<WebsocketSubscription>(shared_from_this(), *id, m_dispatch, m_errorFunction);
+    m_subscriptions.emplace(*id, subscription);
+    if (!m_dispatch(subscription, request))
+      subscription->close();
+  }
+}  // namespace mtconnect::sink::rest_sink
@@ -0,0 +1,329 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "mtconnect/config.hpp"
+#include "mtconnect/logging.hpp"
+#include "request.hpp"
+#include "response.hpp"
+#include "session.hpp"
+
+namespace mtconnect::sink::rest_sink {
+  class WebsocketSession;
+
+  /// @brief One request carried by a WebSocket
+  ///
+  /// The subscription is the session the request is dispatched to, so sample and current
+  /// streams use the same handlers and `AsyncObserver`s as an HTTP session. Everything written
+  /// to the subscription is sent as a message on the WebSocket with a header giving the
+  /// subscription's id.
+  class AGENT_LIB_API WebsocketSubscription : public Session
+  {
+  public:
+    /// @brief Create a subscription on a WebSocket
+    /// @param socket the WebSocket session
+    /// @param id the id the client gave the request
+    /// @param dispatch dispatch function
+    /// @param error error function
+    WebsocketSubscription(std::shared_ptr<WebsocketSession> socket, const std::string &id,
+                          Dispatch dispatch, ErrorFunction error);
+    ~WebsocketSubscription() override = default;
+
+    /// @brief get the id of the subscription
+    const auto &getId() const { return m_id; }
+    /// @brief is the subscription cancelled or finished
+    bool isClosed() const { return m_closed; }
+
+    /// @name Session Interface
+    ///@{
+    void run() override {}
+    void writeResponse(ResponsePtr &&response, Complete complete = nullptr) override;
+    void writeFailureResponse(ResponsePtr &&response, Complete complete = nullptr) override;
+    void beginStreaming(const std::string &mimeType, Complete complete) override;
+    void writeChunk(const std::string &chunk, Complete complete) override;
+    void writeChunk(SharedChunk chunk, Complete complete) override;
+    void close() override;
+    void closeStream() override;
+    ///@}
+
+  protected:
+    std::weak_ptr<WebsocketSession> m_socket;
+    std::string m_id;
+    std::string m_mimeType;
+    std::atomic_bool m_closed {false};
+    bool m_streaming {false};
+  };
+
+  /// @brief A WebSocket carrying many requests
+  ///
+  /// Requests are JSON text messages with an `id` and a `request`, such as
+  /// `{"id": "axes", "request": "sample", "interval": 500, "path": "//Axes"}`. The optional
+  /// `device` selects the device and `format` selects the printer. The other members are the
+  /// query parameters of the request. `{"id": "axes", "request": "cancel"}` stops a stream.
+  ///
+  /// Each message to the client is a header followed by the document:
+  /// ```
+  /// id: axes
+  /// status: 200
+  /// content-type: application/xml
+  ///
+  /// <MTConnectStreams ...
+  /// ```
+  /// The `status` is only given on the first message of a stream and on single responses.
+  /// Lines end with CRLF. Messages are written one at a time in the order they are sent.
+  class AGENT_LIB_API WebsocketSession : public std::enable_shared_from_this<WebsocketSession>
+  {
+  public:
+    /// @brief Create a WebSocket session
+    /// @param request the upgrade request, used as a template for the requests on the socket
+    /// @param dispatch dispatch function
+    /// @param error error function
+    WebsocketSession(RequestPtr &&request, Dispatch dispatch, ErrorFunction error)
+      : m_request(std::move(request)), m_dispatch(dispatch), m_errorFunction(error)
+    {}
+    virtual ~WebsocketSession() = default;
+
+    /// @brief complete the upgrade and start reading requests
+    virtual void run() = 0;
+    /// @brief close the socket and all its subscriptions
+    virtual void close() = 0;
+
+    /// @brief send a message, can be called from any thread
+    /// @param header the message header
+    /// @param body the document, retained until it is written
+    /// @param complete called when the message has been written
+    void send(std::string &&header, SharedChunk body, Complete complete);
+    /// @brief remove a finished subscription, can be called from any thread
+    /// @param subscription the subscription
+    void finished(std::shared_ptr<WebsocketSubscription> subscription);
+
+    /// @brief get the remote endpoint
+    auto &getRemote() const { return m_remote; }
+
+    /// @brief format the header of a message
+    /// @param id the subscription id
+    /// @param code the status of a response or the start of a stream
+    /// @param mimeType the content type of the document
+    /// @return the header
+    static std::string header(const std::string &id, std::optional<status> code,
+                              const std::string &mimeType);
+
+  protected:
+    /// @brief run a function on the socket's strand
+    virtual void execute(std::function<void()> &&func) = 0;
+    /// @brief write the first message in the queue
+    virtual void write() = 0;
+
+    void received(std::string_view message);
+    void cancel(const std::string &id);
+    void closeSubscriptions();
+    void sendError(const std::string &id, status status, const std::string &message);
+
+  protected:
+    struct Message
+    {
+      std::string m_header;
+      SharedChunk m_body;
+      Complete m_complete;
+    };
+
+    RequestPtr m_request;
+    Dispatch m_dispatch;
+    ErrorFunction m_errorFunction;
+    boost::asio::ip::tcp::endpoint m_remote;
+
+    // Only used on the socket's strand
+    std::map<std::string, std::shared_ptr<WebsocketSubscription>> m_subscriptions;
+    std::deque<Message> m_messages;
+    bool m_closing {false};
+  };
+
+  /// @brief A WebSocket session over a plain or TLS stream
+  /// @tparam Stream the `tcp_stream` or `ssl_stream` taken from the HTTP session
+  template <class Stream>
+  class WebsocketSessionImpl : public WebsocketSession
+  {
+  public:
+    using RequestMessage = boost::beast::http::request<boost::beast::http::string_body>;
+
+    /// @brief Create a WebSocket session from an upgrade request
+    /// @param stream the stream of the HTTP session (takes ownership)
+    /// @param upgrade the upgrade request message
+    /// @param request the parsed upgrade request
+    /// @param dispatch dispatch function
+    /// @param error error function
+    WebsocketSessionImpl(Stream &&stream, RequestMessage &&upgrade, RequestPtr &&request,
+                         Dispatch dispatch, ErrorFunction error)
+      : WebsocketSession(std::move(request), dispatch, error),
+        m_stream(std::move(stream)),
+        m_upgrade(std::move(upgrade))
+    {
+      m_remote = boost::beast::get_lowest_layer(m_stream).socket().remote_endpoint();
+    }
+
+    /// @brief get a shared pointer to this
+    std::shared_ptr<WebsocketSessionImpl> getptr()
+    {
+      return std::static_pointer_cast<WebsocketSessionImpl>(shared_from_this());
+    }
+
+    void run() override
+    {
+      namespace ws = boost::beast::websocket;
+
+      // The WebSocket has its own ping based timeouts
+      boost::beast::get_lowest_layer(m_stream).expires_never();
+      m_stream.set_option(ws::stream_base::timeout::suggested(boost::beast::role_type::server));
+      m_stream.set_option(ws::stream_base::decorator([](ws::response_type &res) {
+        res.set(boost::beast::http::field::server, "MTConnectAgent");
+      }));
+      m_stream.async_accept(m_upgrade, boost::beast::bind_front_handler(
+                                           &WebsocketSessionImpl::accepted, getptr()));
+    }
+
+    void close() override
+    {
+      execute([this]() {
+        if (!m_closing)
+        {
+          m_closing = true;
+          closeSubscriptions();
+          if (m_messages.empty())
+            shutdown();
+        }
+      });
+    }
+
+  protected:
+    void execute(std::function<void()> &&func) override
+    {
+      boost::asio::post(m_stream.get_executor(),
+                        [self = getptr(), func = std::move(func)]() { func(); });
+    }
+
+    void accepted(boost::beast::error_code ec)
+    {
+      NAMED_SCOPE("WebsocketSession::accepted");
+
+      if (ec)
+      {
+        LOG(warning) << "WebSocket upgrade failed: " << ec.message();
+        return;
+      }
+
+      read();
+    }
+
+    void read()
+    {
+      m_stream.async_read(m_buffer,
+                          boost::beast::bind_front_handler(&WebsocketSessionImpl::readed, getptr()));
+    }
+
+    void readed(boost::beast::error_code ec, size_t len)
+    {
+      NAMED_SCOPE("WebsocketSession::readed");
+
+      if (ec)
+      {
+        if (ec != boost::beast::websocket::error::closed)
+          LOG(warning) << "WebSocket read failed: " << ec.message();
+        m_closing = true;
+        closeSubscriptions();
+        return;
+      }
+
+      if (!m_closing)
+      {
+        auto data = m_buffer.cdata();
+        received(std::string_view(static_cast<const char *>(data.data()), data.size()));
+      }
+      m_buffer.consume(m_buffer.size());
+
+      // Keep reading to process the close handshake
+      read();
+    }
+
+    void write() override
+    {
+      auto &message = m_messages.front();
+      std::array<boost::asio::const_buffer, 2> buffers {
+          boost::asio::buffer(message.m_header),
+          message.m_body ? boost::asio::buffer(*message.m_body) : boost::asio::const_buffer()};
+
+      m_stream.text(true);
+      m_stream.async_write(buffers, boost::beast::bind_front_handler(
+                                        &WebsocketSessionImpl::written, getptr()));
+    }
+
+    void written(boost::beast::error_code ec, size_t len)
+    {
+      NAMED_SCOPE("WebsocketSession::written");
+
+      if (ec)
+      {
+        LOG(warning) << "WebSocket write failed: " << ec.message();
+        m_closing = true;
+        m_messages.clear();
+        closeSubscriptions();
+        return;
+      }
+
+      auto complete = std::move(m_messages.front().m_complete);
+      m_messages.pop_front();
+      if (m_closing)
+      {
+        m_messages.clear();
+        shutdown();
+        return;
+      }
+
+      if (complete)
+        complete();
+      if (!m_messages.empty())
+        write();
+    }
+
+    void shutdown()
+    {
+      m_stream.async_close(boost::beast::websocket::close_code::normal,
+                           [self = getptr()](boost::beast::error_code) {});
+    }
+
+  protected:
+    boost::beast::websocket::stream<Stream> m_stream;
+    boost::beast::flat_buffer m_buffer;
+    RequestMessage m_upgrade;
+  };
+}  // namespace mtconnect::sink::rest_sink
@@ -29,6 +29,7 @@
 #include <boost/regex.hpp>
 #include <boost/uuid/detail/sha1.hpp>
 
+#include <charconv>
 #include <chrono>
 #include <date/date.h>
 #include <filesystem>
@@ -42,6 +43,7 @@
 
 #include "mtconnect/config.hpp"
 #include "mtconnect/logging.hpp"
+#include "mtconnect/utilities/iso8601.hpp"
 
 // ####### CONSTANTS #######
 
@@ -117,15 +119,41 @@ namespace mtconnect {
     return value;
   }
 
+  /// @brief The size of a buffer large enough for any double written by `formatDouble()`
+  constexpr size_t DOUBLE_BUFFER_SIZE = 32;
+
+  /// @brief writes a double into a buffer without allocating
+  ///
+  /// The output is the same as an output stream with a precision of `digits10` (15) significant
+  /// digits, the `%.15g` format.
+  ///
+  /// @param[out] out a buffer of at least `DOUBLE_BUFFER_SIZE` characters
+  /// @param[in] value the double
+  /// @return a pointer past the last character written, the text is not null terminated
+  inline char *formatDouble(char *out, double value)
+  {
+    constexpr int precision = std::numeric_limits<double>::digits10;
+    return std::to_chars(out, out + DOUBLE_BUFFER_SIZE, value, std::chars_format::general,
+                         precision)
+        .ptr;
+  }
+
+  /// @brief appends a double to a string
+  /// @param[in,out] out the string
+  /// @param[in] value the double
+  inline void appendDouble(std::string &out, double value)
+  {
+    char buffer[DOUBLE_BUFFER_SIZE];
+    out.append(buffer, formatDouble(buffer, value) - buffer);
+  }
+
   /// @brief converts a double to a string
   /// @param[in] value the double
-  /// @return the string representation of the double (10 places max)
+  /// @return the string representation of the double (15 significant digits max)
   inline std::string format(double value)
   {
-    std::stringstream s;
-    constexpr int precision = std::numeric_limits<double>::digits10;
-    s << std::setprecision(precision) << value;
-    return s.str();
+    char buffer[DOUBLE_BUFFER_SIZE];
+    return std::string(buffer, formatDouble(buffer, value) - buffer);
   }
 
   /// @brief inline formattor support for doubles
@@ -149,8 +177,9 @@ namespace mtconnect {
     inline friend std::basic_ostream<_CharT, _Traits> &operator<<(
         std::basic_ostream<_CharT, _Traits> &os, const format_double_stream &fmter)
     {
-      constexpr int precision = std::numeric_limits<double>::digits10;
-      os << std::setprecision(precision) << fmter.val;
+      char buffer[DOUBLE_BUFFER_SIZE];
+      auto end = formatDouble(buffer, fmter.val);
+      os.write(buffer, end - buffer);
       return os;
     }
   };
@@ -224,7 +253,7 @@ namespace mtconnect {
       case HUM_READ:
         return date::format("%a, %d %b %Y %H:%M:%S GMT", date::floor<seconds>(timePoint));
       case GMT:
-        return date::format(ISO_8601_FMT, date::floor<seconds>(timePoint));
+        return formatIso8601(timePoint, false);
       case GMT_UV_SEC:
         return date::format(ISO_8601_FMT, date::floor<microseconds>(timePoint));
       case LOCAL:
@@ -664,20 +693,7 @@ namespace mtconnect {
   /// @brief Format a timestamp as a string in microseconds
   /// @param[in] ts the timestamp
   /// @return the time with microsecond resolution
-  inline std::string format(const Timestamp &ts)
-  {
-    using namespace std;
-    string time = date::format("%FT%T", date::floor<Microseconds>(ts));
-    auto pos = time.find_last_not_of("0");
-    if (pos != string::npos)
-    {
-      if (time[pos] != '.')
-        pos++;
-      time.erase(pos);
-    }
-    time.append("Z");
-    return time;
-  }
+  inline std::string format(const Timestamp &ts) { return formatIso8601(ts); }
 
   /// @brief Capitalize a word
   ///
@@ -761,6 +777,9 @@ namespace mtconnect {
     using namespace std::chrono_literals;
     using namespace date::literals;
 
+    if (auto ts = parseIso8601(timestamp))
+      return *ts;
+
     Timestamp ts;
     std::istringstream in(timestamp);
     in >> std::setw(6) >> parse("%FT%T", ts);
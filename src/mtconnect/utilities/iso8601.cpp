@@ -0,0 +1,221 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "iso8601.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <date/date.h>
+#include <limits>
+
+using namespace std;
+using namespace std::chrono;
+
+namespace mtconnect {
+  /// @brief The text of every two digit number from `00` to `99`
+  struct DigitPairs
+  {
+    constexpr DigitPairs() : m_text()
+    {
+      for (int i = 0; i < 100; i++)
+      {
+        m_text[i * 2] = char('0' + i / 10);
+        m_text[i * 2 + 1] = char('0' + i % 10);
+      }
+    }
+
+    char m_text[200];
+  };
+
+  static constexpr DigitPairs s_digits;
+
+  static inline char *writeTwo(char *out, unsigned value)
+  {
+    memcpy(out, s_digits.m_text + value * 2, 2);
+    return out + 2;
+  }
+
+  /// @brief The formatted `YYYY-MM-DDTHH:MM:SS` of the last second formatted on this thread
+  struct SecondPrefix
+  {
+    int64_t m_second {numeric_limits<int64_t>::min()};
+    size_t m_length {0};
+    char m_text[ISO_8601_BUFFER_SIZE];
+  };
+
+  static thread_local SecondPrefix t_prefix;
+
+  // Conversions between days since 1970-01-01 and the civil date from
+  // http://howardhinnant.github.io/date_algorithms.html
+  static inline void civilFromDays(int64_t z, int64_t &year, unsigned &month, unsigned &day)
+  {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = static_cast<int64_t>(yoe) + era * 400 + (month <= 2);
+  }
+
+  static inline int64_t daysFromCivil(int64_t year, unsigned month, unsigned day)
+  {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(year - era * 400);
+    const unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+  }
+
+  static inline unsigned lastDayOfMonth(unsigned year, unsigned month)
+  {
+    static constexpr unsigned days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)))
+      return 29;
+    return days[month - 1];
+  }
+
+  static void formatPrefix(SecondPrefix &prefix, int64_t second)
+  {
+    int64_t days = second / 86400;
+    int64_t time = second % 86400;
+    if (time < 0)
+    {
+      time += 86400;
+      days--;
+    }
+
+    int64_t year;
+    unsigned month, day;
+    civilFromDays(days, year, month, day);
+
+    if (year < 0 || year > 9999)
+    {
+      // Leave years that are not four digits to the date library
+      auto text = date::format("%FT%T", sys_seconds(seconds(second)));
+      prefix.m_length = min(text.size(), sizeof(prefix.m_text) - 8);
+      memcpy(prefix.m_text, text.data(), prefix.m_length);
+    }
+    else
+    {
+      char *out = prefix.m_text;
+      out = writeTwo(out, unsigned(year / 100));
+      out = writeTwo(out, unsigned(year % 100));
+      *out++ = '-';
+      out = writeTwo(out, month);
+      *out++ = '-';
+      out = writeTwo(out, day);
+      *out++ = 'T';
+      out = writeTwo(out, unsigned(time / 3600));
+      *out++ = ':';
+      out = writeTwo(out, unsigned(time / 60 % 60));
+      *out++ = ':';
+      out = writeTwo(out, unsigned(time % 60));
+      prefix.m_length = out - prefix.m_text;
+    }
+
+    prefix.m_second = second;
+  }
+
+  char *formatIso8601(const system_clock::time_point &timestamp, char *out, bool fraction)
+  {
+    auto micros = floor<microseconds>(timestamp.time_since_epoch()).count();
+    int64_t second = micros / 1000000;
+    int64_t part = micros % 1000000;
+    if (part < 0)
+    {
+      part += 1000000;
+      second--;
+    }
+
+    auto &prefix = t_prefix;
+    if (prefix.m_second != second)
+      formatPrefix(prefix, second);
+
+    memcpy(out, prefix.m_text, prefix.m_length);
+    out += prefix.m_length;
+
+    if (fraction && part != 0)
+    {
+      char digits[6];
+      writeTwo(digits, unsigned(part / 10000));
+      writeTwo(digits + 2, unsigned(part / 100 % 100));
+      writeTwo(digits + 4, unsigned(part % 100));
+
+      size_t length = 6;
+      while (digits[length - 1] == '0')
+        length--;
+
+      *out++ = '.';
+      memcpy(out, digits, length);
+      out += length;
+    }
+
+    *out++ = 'Z';
+    return out;
+  }
+
+  optional<system_clock::time_point> parseIso8601(string_view text)
+  {
+    // YYYY-MM-DDTHH:MM:SS
+    if (text.size() < 19)
+      return nullopt;
+
+    const char *p = text.data();
+    if (p[4] != '-' || p[7] != '-' || p[10] != 'T' || p[13] != ':' || p[16] != ':')
+      return nullopt;
+
+    bool valid = true;
+    auto two = [p, &valid](int pos) -> unsigned {
+      unsigned tens = unsigned(p[pos] - '0'), ones = unsigned(p[pos + 1] - '0');
+      valid = valid && tens < 10 && ones < 10;
+      return tens * 10 + ones;
+    };
+
+    unsigned year = two(0) * 100 + two(2);
+    unsigned month = two(5);
+    unsigned day = two(8);
+    unsigned hour = two(11);
+    unsigned minute = two(14);
+    unsigned second = two(17);
+
+    if (!valid || month < 1 || month > 12 || day < 1 || day > lastDayOfMonth(year, month) ||
+        hour > 23 || minute > 59 || second > 59)
+      return nullopt;
+
+    int64_t nanos = 0;
+    if (text.size() > 19 && p[19] == '.')
+    {
+      size_t pos = 20;
+      int64_t scale = 100000000;
+      for (; pos < text.size() && unsigned(p[pos] - '0') < 10; pos++)
+      {
+        nanos += (p[pos] - '0') * scale;
+        scale /= 10;
+      }
+      if (pos == 20)
+        return nullopt;
+    }
+
+    int64_t total = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    return system_clock::time_point(
+        duration_cast<system_clock::duration>(seconds(total) + nanoseconds(nanos)));
+  }
+}  // namespace mtconnect
@@ -0,0 +1,68 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+/// @file iso8601.hpp
+/// @brief Fast ISO 8601 timestamp formatting and parsing
+
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "mtconnect/config.hpp"
+
+namespace mtconnect {
+  /// @brief The size of a buffer large enough for any timestamp written by `formatIso8601()`
+  constexpr size_t ISO_8601_BUFFER_SIZE = 40;
+
+  /// @brief Write a timestamp as `YYYY-MM-DDTHH:MM:SS[.ffffff]Z`
+  ///
+  /// The fraction is in microseconds with the trailing zeros removed and is left out if it is
+  /// zero. The `YYYY-MM-DDTHH:MM:SS` prefix is cached per thread for the last second formatted,
+  /// so timestamps within the same second only format the fraction.
+  ///
+  /// @param[in] timestamp the timestamp
+  /// @param[out] out a buffer of at least `ISO_8601_BUFFER_SIZE` characters
+  /// @param[in] fraction `false` to write only whole seconds
+  /// @return a pointer past the last character written, the text is not null terminated
+  AGENT_LIB_API char *formatIso8601(const std::chrono::system_clock::time_point &timestamp,
+                                    char *out, bool fraction = true);
+
+  /// @brief Format a timestamp as `YYYY-MM-DDTHH:MM:SS[.ffffff]Z`
+  /// @param[in] timestamp the timestamp
+  /// @param[in] fraction `false` to write only whole seconds
+  /// @return the timestamp as a string
+  inline std::string formatIso8601(const std::chrono::system_clock::time_point &timestamp,
+                                   bool fraction = true)
+  {
+    char buffer[ISO_8601_BUFFER_SIZE];
+    auto end = formatIso8601(timestamp, buffer, fraction);
+    return std::string(buffer, end - buffer);
+  }
+
+  /// @brief Parse a `YYYY-MM-DDTHH:MM:SS[.fffffffff]` timestamp
+  ///
+  /// Only the fixed width form is parsed. Up to nine fractional digits are used and any text
+  /// after the seconds, such as a `Z`, is ignored.
+  ///
+  /// @param[in] text the timestamp
+  /// @return the timestamp or `std::nullopt` if the text is not a valid fixed width timestamp
+  AGENT_LIB_API std::optional<std::chrono::system_clock::time_point> parseIso8601(
+      std::string_view text);
+}  // namespace mtconnect
@@ -154,6 +154,30 @@ TEST_F(AgentDeviceTest, should_add_data_items_to_the_agent_devcie)
   ASSERT_EQ("DEVICE_CHANGED", changed->getType());
 }
 
+/// @test check that the hit and miss rates of the REST sink chunk caches are in the agent device
+TEST_F(AgentDeviceTest, should_add_chunk_cache_rates_to_the_agent_device)
+{
+  ASSERT_NE(nullptr, m_agentDevice);
+  for (const auto &prefix : {"sample_chunk_cache"s, "current_cache"s})
+  {
+    auto hits = m_agentDevice->getDeviceDataItem(prefix + "_hit_rate");
+    ASSERT_NE(nullptr, hits);
+    ASSERT_EQ("CHUNK_CACHE_HIT_RATE", hits->getType());
+    ASSERT_TRUE(hits->isSample());
+
+    auto misses = m_agentDevice->getDeviceDataItem(prefix + "_miss_rate");
+    ASSERT_NE(nullptr, misses);
+    ASSERT_EQ("CHUNK_CACHE_MISS_RATE", misses->getType());
+    ASSERT_TRUE(misses->isSample());
+  }
+
+  {
+    PARSE_XML_RESPONSE("/Agent/current");
+    ASSERT_XML_PATH_EQUAL(doc, "//m:ChunkCacheHitRate[@dataItemId='current_cache_hit_rate']",
+                          "UNAVAILABLE");
+  }
+}
+
 /// @test verify device added was updated
 TEST_F(AgentDeviceTest, should_have_device_added_in_buffer)
 {
@@ -246,7 +270,7 @@ TEST_F(AgentDeviceTest, should_observe_the_adapter_data_items)
     ASSERT_XML_PATH_EQUAL(doc, AGENT_DEVICE_DEVICE_STREAM "/m:Events/m:Availability", "AVAILABLE");
 
     ASSERT_XML_PATH_COUNT(doc, AGENT_DEVICE_STREAM "/*", 2);
-    ASSERT_XML_PATH_COUNT(doc, AGENT_DEVICE_DEVICE_STREAM "/*", 1);
+    ASSERT_XML_PATH_COUNT(doc, AGENT_DEVICE_DEVICE_STREAM "/*", 2);
 
     ASSERT_XML_PATH_EQUAL(doc, AGENT_DEVICE_DEVICE_STREAM "/m:Events/m:DeviceAdded", "000");
 
@@ -2767,6 +2767,73 @@ TEST_F(AgentTest, should_signal_observer_when_observations_arrive)
   }
 }
 
+/// @test Should stream server-sent events and resume from the Last-Event-ID
+TEST_F(AgentTest, should_stream_server_sent_events_from_the_last_event_id)
+{
+  addAdapter();
+  auto rest = m_agentTestHelper->getRestService();
+  rest->start();
+
+  auto &circ = m_agentTestHelper->getAgent()->getCircularBuffer();
+  for (auto line : {"204", "205", "206"})
+    m_agentTestHelper->m_adapter->processData("2021-02-01T12:00:00Z|line|"s + line);
+  auto seq = circ.getSequence();
+
+  auto &session = m_agentTestHelper->m_session;
+  auto stream = [&](SequenceNumber_t lastEventId) {
+    auto request = make_shared<mhttp::Request>();
+    request->m_verb = boost::beast::http::verb::get;
+    request->m_path = "/LinuxCNC/sample";
+    request->m_query = {{"interval", "10"},
+                        {"heartbeat", "1000"},
+                        {"count", "1"},
+                        {"path", "//DataItem[@name='line']"}};
+    request->m_accepts = "text/event-stream";
+    request->m_lastEventId = to_string(lastEventId);
+
+    session->m_chunkBody.clear();
+    ASSERT_TRUE(rest->getServer()->dispatch(session, request));
+    for (int i = 0; i < 100 && session->m_chunkBody.empty(); i++)
+      m_agentTestHelper->m_ioContext.run_one_for(5ms);
+    ASSERT_FALSE(session->m_chunkBody.empty());
+    EXPECT_EQ("text/event-stream", session->m_mimeType);
+  };
+
+  ///    - The id of the event is the next sequence, so the stream continues after it
+  {
+    stream(seq - 1);
+    const auto &chunk = session->m_chunkBody;
+    ASSERT_EQ(0, chunk.find("id: " + to_string(seq) + "\ndata: <?xml")) << chunk;
+    ASSERT_EQ(chunk.size() - 2, chunk.find("\n\n"));
+
+    string document;
+    istringstream lines(chunk.substr(chunk.find('\n') + 1));
+    for (string line; getline(lines, line) && !line.empty();)
+    {
+      ASSERT_EQ(0, line.find("data: ")) << line;
+      document.append(line.substr(6)).append("\n");
+    }
+
+    auto doc = xmlParseMemory(document.c_str(), int32_t(document.size()));
+    ASSERT_TRUE(doc);
+    XmlDocFreer cleanup(doc);
+    ASSERT_XML_PATH_EQUAL(doc, "//m:Line", "206");
+    session->closeStream();
+  }
+
+  ///    - A client that is behind is sent the events it missed in one chunk
+  {
+    stream(seq - 3);
+    const auto &chunk = session->m_chunkBody;
+    for (auto id : {seq - 2, seq - 1, seq})
+      EXPECT_NE(string::npos, chunk.find("id: " + to_string(id) + "\n")) << chunk;
+    EXPECT_LT(chunk.find("id: " + to_string(seq - 2)), chunk.find("id: " + to_string(seq)));
+    EXPECT_NE(string::npos, chunk.find(">204<"));
+    EXPECT_NE(string::npos, chunk.find(">206<"));
+    session->closeStream();
+  }
+}
+
 /// @test check request with from out of range
 TEST_F(AgentTest, should_fail_if_from_is_out_of_range)
 {
@@ -3110,3 +3177,105 @@ TEST_F(AgentTest, should_initialize_observaton_to_initial_value_when_available)
     ASSERT_XML_PATH_EQUAL(doc, "//m:DeviceStream//m:PartCount", "0");
   }
 }
+
+TEST_F(AgentTest, should_reuse_current_document_until_the_buffer_changes)
+{
+  addAdapter();
+  auto rest = m_agentTestHelper->getRestService();
+  auto cache = rest->getCurrentCache();
+
+  m_agentTestHelper->m_adapter->processData("2024-01-22T20:00:00Z|line|100");
+
+  string first;
+  {
+    PARSE_XML_RESPONSE("/current");
+    ASSERT_XML_PATH_EQUAL(doc, "//m:DeviceStream//m:Line", "100");
+    first = m_agentTestHelper->session()->m_body;
+  }
+
+  auto before = cache->getStatistics();
+  {
+    PARSE_XML_RESPONSE("/current");
+    ASSERT_XML_PATH_EQUAL(doc, "//m:DeviceStream//m:Line", "100");
+    EXPECT_EQ(first, m_agentTestHelper->session()->m_body);
+  }
+  auto after = cache->getStatistics();
+  EXPECT_EQ(before.m_hits + 1, after.m_hits);
+  EXPECT_EQ(before.m_misses, after.m_misses);
+
+  m_agentTestHelper->m_adapter->processData("2024-01-22T20:00:01Z|line|101");
+
+  {
+    PARSE_XML_RESPONSE("/current");
+    ASSERT_XML_PATH_EQUAL(doc, "//m:DeviceStream//m:Line", "101");
+  }
+  EXPECT_EQ(after.m_misses + 1, cache->getStatistics().m_misses);
+}
+
+TEST_F(AgentTest, should_share_the_compressed_current_document)
+{
+  auto rest = m_agentTestHelper->getRestService();
+  auto printer = m_agentTestHelper->getAgent()->getPrinter("xml");
+  rest->getServer()->setCompression({true, 6, 0});
+  auto request = make_shared<Request>();
+
+  auto plain = rest->currentRequest(printer, nullopt, nullopt, nullopt, false, nullopt, request);
+  ASSERT_EQ(status::ok, plain->m_status);
+  ASSERT_TRUE(plain->m_sharedBody);
+  EXPECT_FALSE(plain->m_contentEncoding);
+
+  request->m_acceptsEncoding = "gzip, deflate";
+  auto first = rest->currentRequest(printer, nullopt, nullopt, nullopt, false, nullopt, request);
+  auto second = rest->currentRequest(printer, nullopt, nullopt, nullopt, false, nullopt, request);
+  ASSERT_TRUE(first->m_contentEncoding);
+  EXPECT_EQ("gzip", *first->m_contentEncoding);
+  EXPECT_NE(plain->m_sharedBody, first->m_sharedBody);
+  EXPECT_EQ(first->m_sharedBody, second->m_sharedBody);
+}
+
+TEST_F(AgentTest, should_return_not_modified_when_the_probe_has_not_changed)
+{
+  auto rest = m_agentTestHelper->getRestService();
+  auto printer = m_agentTestHelper->getAgent()->getPrinter("xml");
+  auto request = make_shared<Request>();
+
+  auto response = rest->probeRequest(printer, nullopt, false, nullopt, request);
+  ASSERT_EQ(status::ok, response->m_status);
+  ASSERT_TRUE(response->m_etag);
+  ASSERT_TRUE(response->m_lastModified);
+  ASSERT_TRUE(response->m_sharedBody);
+  EXPECT_FALSE(response->m_contentEncoding);
+
+  request->m_ifNoneMatch = *response->m_etag;
+  auto cached = rest->probeRequest(printer, nullopt, false, nullopt, request);
+  EXPECT_EQ(status::not_modified, cached->m_status);
+  EXPECT_FALSE(cached->m_sharedBody);
+  EXPECT_EQ(*response->m_etag, *cached->m_etag);
+
+  request->m_acceptsEncoding = "gzip, deflate";
+  auto gzip = rest->probeRequest(printer, nullopt, false, nullopt, request);
+  EXPECT_EQ(status::not_modified, gzip->m_status);
+
+  request->m_ifNoneMatch.clear();
+  gzip = rest->probeRequest(printer, nullopt, false, nullopt, request);
+  ASSERT_EQ(status::ok, gzip->m_status);
+  ASSERT_TRUE(gzip->m_contentEncoding);
+  EXPECT_EQ("gzip", *gzip->m_contentEncoding);
+  EXPECT_GT(response->m_sharedBody->size(), gzip->m_sharedBody->size());
+
+  // Nothing is compressed when compression is turned off
+  rest->getServer()->setCompression({false});
+  auto identity = rest->probeRequest(printer, nullopt, false, nullopt, request);
+  EXPECT_FALSE(identity->m_contentEncoding);
+  EXPECT_EQ(*response->m_sharedBody, *identity->m_sharedBody);
+  rest->getServer()->setCompression({true});
+
+  // A device model change renders a new document
+  this_thread::sleep_for(2ms);
+  printer->setModelChangeTime(getCurrentTime(GMT_UV_SEC));
+  request->m_acceptsEncoding.clear();
+  request->m_ifNoneMatch = *response->m_etag;
+  auto changed = rest->probeRequest(printer, nullopt, false, nullopt, request);
+  EXPECT_EQ(status::ok, changed->m_status);
+  EXPECT_NE(*response->m_etag, *changed->m_etag);
+}
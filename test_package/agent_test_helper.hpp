@@ -61,9 +61,13 @@ namespace mtconnect {
           m_code = response->m_status;
           if (response->m_file)
             m_body = response->m_file->m_buffer;
+          else if (response->m_sharedBody)
+            m_body = *response->m_sharedBody;
           else
             m_body = response->m_body;
           m_mimeType = response->m_mimeType;
+          m_etag = response->m_etag;
+          m_contentEncoding = response->m_contentEncoding;
           if (complete)
             complete();
         }
@@ -99,6 +103,8 @@ namespace mtconnect {
         std::string m_mimeType;
         boost::beast::http::status m_code;
         std::chrono::seconds m_expires;
+        std::optional<std::string> m_etag;
+        std::optional<std::string> m_contentEncoding;
 
         std::string m_chunkBody;
         std::string m_chunkMimeType;
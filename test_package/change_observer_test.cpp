@@ -27,6 +27,7 @@
 #include "mtconnect/device_model/component.hpp"
 #include "mtconnect/device_model/device.hpp"
 #include "mtconnect/observation/change_observer.hpp"
+#include "mtconnect/observation/subscription_engine.hpp"
 
 using namespace std::chrono_literals;
 using namespace std;
@@ -54,7 +55,7 @@ namespace mtconnect {
     void SetUp() override
     {
       m_context = make_unique<boost::asio::io_context>();
-      m_strand = make_unique<boost::asio::io_context::strand>(*m_context);
+      m_strand = make_unique<ObserverStrand>(boost::asio::make_strand(*m_context));
       m_signaler = std::make_unique<mtconnect::ChangeSignaler>();
       m_guard.emplace(m_context->get_executor());
     }
@@ -68,7 +69,7 @@ namespace mtconnect {
     }
 
     std::unique_ptr<boost::asio::io_context> m_context;
-    std::unique_ptr<boost::asio::io_context::strand> m_strand;
+    std::unique_ptr<ObserverStrand> m_strand;
     std::unique_ptr<mtconnect::ChangeSignaler> m_signaler;
     std::optional<WorkGuard> m_guard;
   };
@@ -251,9 +252,7 @@ namespace mtconnect {
       m_dataItem2 = DataItem::make(
           {{"id", "b"s}, {"type", "LOAD"s}, {"category", "SAMPLE"s}, {"name", "DI2"s}}, errors);
       m_comp->addDataItem(m_dataItem2, errors);
-
-      m_signalers.emplace("a", m_dataItem1);
-      m_signalers.emplace("b", m_dataItem2);
+      m_buffer.getDataItemIndexes().assign(*m_device);
     }
 
     void TearDown() override { ChangeObserverTest::TearDown(); }
@@ -282,7 +281,6 @@ namespace mtconnect {
     }
 
     buffer::CircularBuffer m_buffer {8, 4};
-    map<string, DataItemPtr> m_signalers;
 
     entity::Properties m_value {{"VALUE", "123"s}};
     Timestamp m_time {std::chrono::system_clock::now()};
@@ -300,7 +298,7 @@ namespace mtconnect {
         make_shared<MockObserver>(*m_strand, m_buffer, std::move(filter), 500ms, 1000ms)};
 
     auto expected = addObservations(3);
-    observer->observe(4, [this](const string &id) { return m_signalers[id].get(); });
+    observer->observe(4);
 
     bool called {false};
     observer->m_handler = [&](std::shared_ptr<AsyncObserver> obs) {
@@ -326,6 +324,41 @@ namespace mtconnect {
     ASSERT_TRUE(called);
   }
 
+  TEST_F(AsyncObserverTest, should_only_signal_observers_interested_in_the_data_item)
+  {
+    ChangeObserver observerA(*m_strand), observerB(*m_strand);
+    SubscriptionEngine engine;
+
+    const auto &indexes = m_buffer.getDataItemIndexes();
+    engine.subscribe(&observerA, buffer::FilterBits(FilterSet {"a"}, indexes));
+    engine.subscribe(&observerB, buffer::FilterBits(FilterSet {"a", "b"}, indexes));
+    ASSERT_EQ(2, engine.size());
+    ASSERT_TRUE(engine.isSubscribed(&observerA));
+
+    engine.notify(m_dataItem2->getIndex(), 10);
+    ASSERT_FALSE(observerA.wasSignaled());
+    ASSERT_TRUE(observerB.wasSignaled());
+    ASSERT_EQ(10, observerB.getSequence());
+
+    engine.notify(m_dataItem1->getIndex(), 11);
+    ASSERT_TRUE(observerA.wasSignaled());
+    ASSERT_EQ(11, observerA.getSequence());
+    ASSERT_EQ(10, observerB.getSequence());
+
+    ASSERT_TRUE(engine.unsubscribe(&observerA));
+    ASSERT_FALSE(engine.unsubscribe(&observerA));
+    ASSERT_FALSE(engine.isSubscribed(&observerA));
+    ASSERT_EQ(1, engine.size());
+  }
+
+  TEST_F(AsyncObserverTest, should_subscribe_to_the_buffer)
+  {
+    FilterSet filter {"a", "b"};
+    auto observer = make_shared<MockObserver>(*m_strand, m_buffer, std::move(filter), 500ms, 1000ms);
+    observer->observe(1);
+    ASSERT_EQ(1, m_buffer.getSubscriptions().size());
+  }
+
   TEST_F(AsyncObserverTest, if_not_at_end_should_call_immediately)
   {
     FilterSet filter {"a", "b"};
@@ -333,7 +366,7 @@ namespace mtconnect {
         make_shared<MockObserver>(*m_strand, m_buffer, std::move(filter), 250ms, 500ms)};
 
     addObservations(3);
-    observer->observe(2, [this](const string &id) { return m_signalers[id].get(); });
+    observer->observe(2);
 
     ASSERT_FALSE(observer->isEndOfBuffer());
 
@@ -375,7 +408,7 @@ namespace mtconnect {
         make_shared<MockObserver>(*m_strand, m_buffer, std::move(filter), 200ms, 500ms)};
 
     addObservations(3);
-    observer->observe(1, [this](const string &id) { return m_signalers[id].get(); });
+    observer->observe(1);
 
     ASSERT_FALSE(observer->isEndOfBuffer());
 
@@ -439,7 +472,7 @@ namespace mtconnect {
 
     addObservations(3);
 
-    observer->observe(4, [this](const string &id) { return m_signalers[id].get(); });
+    observer->observe(4);
 
     ASSERT_TRUE(observer->isEndOfBuffer());
 
@@ -474,7 +507,7 @@ namespace mtconnect {
 
     addObservations(3);
 
-    observer->observe(4, [this](const string &id) { return m_signalers[id].get(); });
+    observer->observe(4);
 
     ASSERT_TRUE(observer->isEndOfBuffer());
 
@@ -69,6 +69,7 @@ protected:
                                   {"nativeUnits", "MILLIMETER"s}},
                                  errors);
     m_device->addDataItem(m_dataItem2, errors);
+    m_indexes.assign(*m_device);
   }
 
   void TearDown() override
@@ -78,6 +79,7 @@ protected:
     m_dataItem2.reset();
   }
 
+  DataItemIndexes m_indexes;
   std::unique_ptr<Checkpoint> m_checkpoint;
   DataItemPtr m_dataItem1;
   DataItemPtr m_dataItem2;
@@ -177,11 +179,23 @@ TEST_F(CheckpointTest, Copy)
   m_checkpoint->addObservation(p2);
   ASSERT_EQ(2, p2.use_count());
 
+  // The copy shares the observations with the original
   auto copy = make_unique<Checkpoint>(*m_checkpoint);
   ASSERT_EQ(2, p1.use_count());
+  ASSERT_EQ(2, p2.use_count());
+  ASSERT_TRUE(copy->getObservations().shares(m_checkpoint->getObservations()));
+
+  // Changing the copy does not change the original
+  auto p3 = observation::Observation::make(m_dataItem2, value, time, errors);
+  copy->addObservation(p3);
+  ASSERT_FALSE(copy->getObservations().shares(m_checkpoint->getObservations()));
+  ASSERT_EQ(p3, copy->getObservation("3", m_indexes));
+  ASSERT_FALSE(m_checkpoint->getObservation("3", m_indexes));
   ASSERT_EQ(3, p2.use_count());
+
   copy.reset();
   ASSERT_EQ(2, p2.use_count());
+  ASSERT_EQ(1, m_checkpoint->getObservations().size());
 }
 
 TEST_F(CheckpointTest, GetObservations)
@@ -221,6 +235,7 @@ TEST_F(CheckpointTest, GetObservations)
                             {"nativeUnits", "MILLIMETER"s}},
                            errors);
   d1->setComponent(m_device);
+  m_indexes.assign(*d1);
 
   filter.insert(d1->getId());
 
@@ -228,7 +243,7 @@ TEST_F(CheckpointTest, GetObservations)
   m_checkpoint->addObservation(p);
 
   ObservationList list;
-  m_checkpoint->getObservations(list, filter);
+  m_checkpoint->getObservations(list, FilterBits(filter, m_indexes));
 
   ASSERT_EQ(4, list.size());
 
@@ -236,7 +251,7 @@ TEST_F(CheckpointTest, GetObservations)
   filter2.insert(m_dataItem1->getId());
 
   ObservationList list2;
-  m_checkpoint->getObservations(list2, filter2);
+  m_checkpoint->getObservations(list2, FilterBits(filter2, m_indexes));
 
   ASSERT_EQ(2, list2.size());
 }
@@ -277,6 +292,7 @@ TEST_F(CheckpointTest, Filter)
                             {"nativeUnits", "MILLIMETER"s}},
                            errors);
   d1->setComponent(m_device);
+  m_indexes.assign(*d1);
 
   auto p4 = observation::Observation::make(d1, value, time, errors);
   m_checkpoint->addObservation(p4);
@@ -287,7 +303,7 @@ TEST_F(CheckpointTest, Filter)
   ASSERT_EQ(4, (int)list.size());
   list.clear();
 
-  m_checkpoint->filter(filter);
+  m_checkpoint->filter(FilterBits(filter, m_indexes));
   m_checkpoint->getObservations(list);
 
   ASSERT_EQ(2, (int)list.size());
@@ -336,6 +352,7 @@ TEST_F(CheckpointTest, CopyAndFilter)
                             {"nativeUnits", "MILLIMETER"s}},
                            errors);
   d1->setComponent(m_device);
+  m_indexes.assign(*d1);
 
   auto p4 = observation::Observation::make(d1, value, time, errors);
   m_checkpoint->addObservation(p4);
@@ -344,7 +361,7 @@ TEST_F(CheckpointTest, CopyAndFilter)
   m_checkpoint->getObservations(list);
   ASSERT_EQ(4, list.size());
 
-  Checkpoint check(*m_checkpoint, filter);
+  Checkpoint check(*m_checkpoint, FilterBits(filter, m_indexes));
   list.clear();
   check.getObservations(list);
   ASSERT_EQ(2, list.size());
@@ -464,7 +481,7 @@ TEST_F(CheckpointTest, ConditionChaining)
   ASSERT_FALSE(Cond(p5)->getPrev());
 
   // Check cleanup
-  ObservationPtr p7 = m_checkpoint->getObservations().at(std::string("1"));
+  ObservationPtr p7 = m_checkpoint->getObservations().at(m_dataItem1->getIndex());
   ASSERT_TRUE(p7);
   ASSERT_EQ(2, p7.use_count());
   ASSERT_NE(p5, p7);
@@ -515,7 +532,7 @@ TEST_F(CheckpointTest, LastConditionNormal)
   m_checkpoint->addObservation(p2);
 
   list.clear();
-  m_checkpoint->getObservations(list, filter);
+  m_checkpoint->getObservations(list, FilterBits(filter, m_indexes));
   ASSERT_EQ(1, list.size());
 
   auto p3 = Cond(list.front());
@@ -560,6 +577,7 @@ TEST_F(CheckpointTest, orphaned_observations_should_be_skipped)
                             {"nativeUnits", "MILLIMETER"s}},
                            errors);
   m_device->addDataItem(d1, errors);
+  m_indexes.assign(*d1);
 
   filter.insert(d1->getId());
 
@@ -567,7 +585,7 @@ TEST_F(CheckpointTest, orphaned_observations_should_be_skipped)
   m_checkpoint->addObservation(p);
 
   ObservationList list;
-  m_checkpoint->getObservations(list, filter);
+  m_checkpoint->getObservations(list, FilterBits(filter, m_indexes));
 
   ASSERT_EQ(4, list.size());
 
@@ -576,7 +594,7 @@ TEST_F(CheckpointTest, orphaned_observations_should_be_skipped)
   d1.reset();
   m_device.reset();
   ObservationList list2;
-  m_checkpoint->getObservations(list2, filter);
+  m_checkpoint->getObservations(list2, FilterBits(filter, m_indexes));
 
   ASSERT_EQ(0, list2.size());
 }
@@ -681,7 +699,7 @@ TEST_F(CheckpointTest, condition_chaining_with_condition_id_for_23)
   ASSERT_FALSE(Cond(p5)->getPrev());
 
   // Check cleanup
-  ObservationPtr p7 = m_checkpoint->getObservations().at(std::string("1"));
+  ObservationPtr p7 = m_checkpoint->getObservations().at(m_dataItem1->getIndex());
   ASSERT_TRUE(p7);
   ASSERT_EQ(2, p7.use_count());
   ASSERT_NE(p5, p7);
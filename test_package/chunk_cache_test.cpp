@@ -0,0 +1,138 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "mtconnect/sink/rest_sink/chunk_cache.hpp"
+
+using namespace std;
+using namespace mtconnect;
+using namespace mtconnect::sink::rest_sink;
+using namespace std::literals;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+class ChunkCacheTest : public testing::Test
+{
+protected:
+  void SetUp() override { m_cache = make_unique<ChunkCache>("Test", 4); }
+
+  void TearDown() override { m_cache.reset(); }
+
+  ChunkCache::Key makeKey(const FilterSet &filter, SequenceNumber_t from,
+                          SequenceNumber_t bufferSequence)
+  {
+    ChunkCache::Key key;
+    key.m_filter = make_shared<const FilterSet>(filter);
+    key.m_filterHash = ChunkCache::hash(filter);
+    key.m_count = 100;
+    key.m_from = from;
+    key.m_bufferSequence = bufferSequence;
+    return key;
+  }
+
+  unique_ptr<ChunkCache> m_cache;
+};
+
+TEST_F(ChunkCacheTest, should_share_chunks_for_identical_streams)
+{
+  auto first = makeKey({"a", "b"}, 10, 20);
+  auto second = makeKey({"a", "b"}, 10, 20);
+
+  ASSERT_FALSE(m_cache->find(first));
+  auto content = make_shared<const string>("<MTConnectStreams/>");
+  m_cache->insert(first, {content, 19, true});
+
+  auto chunk = m_cache->find(second);
+  ASSERT_TRUE(chunk);
+  EXPECT_EQ(content.get(), chunk->m_content.get());
+  EXPECT_EQ(19, chunk->m_end);
+  EXPECT_TRUE(chunk->m_endOfBuffer);
+
+  auto stats = m_cache->getStatistics();
+  EXPECT_EQ(1, stats.m_hits);
+  EXPECT_EQ(1, stats.m_misses);
+  EXPECT_DOUBLE_EQ(0.5, stats.hitRatio());
+}
+
+TEST_F(ChunkCacheTest, should_not_share_chunks_between_different_requests)
+{
+  m_cache->insert(makeKey({"a", "b"}, 10, 20), {make_shared<const string>("x"), 19, true});
+
+  EXPECT_FALSE(m_cache->find(makeKey({"a", "c"}, 10, 20)));
+  EXPECT_FALSE(m_cache->find(makeKey({"a", "b"}, 11, 20)));
+
+  auto pretty = makeKey({"a", "b"}, 10, 20);
+  pretty.m_pretty = true;
+  EXPECT_FALSE(m_cache->find(pretty));
+
+  auto count = makeKey({"a", "b"}, 10, 20);
+  count.m_count = 10;
+  EXPECT_FALSE(m_cache->find(count));
+}
+
+TEST_F(ChunkCacheTest, should_purge_chunks_when_the_buffer_changes)
+{
+  m_cache->insert(makeKey({"a"}, 10, 20), {make_shared<const string>("x"), 19, true});
+  m_cache->insert(makeKey({"b"}, 10, 20), {make_shared<const string>("y"), 19, true});
+  ASSERT_EQ(2, m_cache->size());
+
+  EXPECT_FALSE(m_cache->find(makeKey({"a"}, 10, 21)));
+
+  m_cache->insert(makeKey({"a"}, 10, 21), {make_shared<const string>("z"), 20, true});
+  EXPECT_EQ(1, m_cache->size());
+  EXPECT_FALSE(m_cache->find(makeKey({"b"}, 10, 20)));
+}
+
+TEST_F(ChunkCacheTest, should_limit_the_number_of_chunks)
+{
+  for (SequenceNumber_t from = 1; from <= 6; from++)
+    m_cache->insert(makeKey({"a"}, from, 20), {make_shared<const string>("x"), 19, true});
+
+  EXPECT_EQ(4, m_cache->size());
+  EXPECT_FALSE(m_cache->find(makeKey({"a"}, 1, 20)));
+  EXPECT_TRUE(m_cache->find(makeKey({"a"}, 6, 20)));
+}
+
+TEST_F(ChunkCacheTest, should_expire_chunks_when_the_buffer_is_idle)
+{
+  m_cache = make_unique<ChunkCache>("Test", 4, 10ms);
+
+  m_cache->insert(makeKey({"a"}, 0, 20), {make_shared<const string>("x"), 19, true});
+  ASSERT_TRUE(m_cache->find(makeKey({"a"}, 0, 20)));
+
+  this_thread::sleep_for(20ms);
+  EXPECT_FALSE(m_cache->find(makeKey({"a"}, 0, 20)));
+
+  m_cache->insert(makeKey({"a"}, 0, 20), {make_shared<const string>("y"), 19, true});
+  EXPECT_EQ(1, m_cache->size());
+  auto chunk = m_cache->find(makeKey({"a"}, 0, 20));
+  ASSERT_TRUE(chunk);
+  EXPECT_EQ("y", *chunk->m_content);
+}
@@ -0,0 +1,166 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "mtconnect/buffer/circular_buffer.hpp"
+#include "mtconnect/device_model/device.hpp"
+
+using namespace std;
+using namespace mtconnect;
+using namespace mtconnect::buffer;
+using namespace mtconnect::observation;
+using namespace device_model;
+using namespace entity;
+using namespace data_item;
+using namespace std::literals;
+using namespace date::literals;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+/// @brief Measures one writer appending to the circular buffer while several readers sample
+///        the buffer concurrently with and without the lock free read path.
+class CircularBufferBenchmarkTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    ErrorList errors;
+    Properties d1 {{"id", "d"s}, {"name", "d"s}, {"uuid", "d"s}};
+    m_device = dynamic_pointer_cast<Device>(Device::getFactory()->make("Device", d1, errors));
+    m_comp = Component::make("Axes", {{"id", "a"s}, {"name", "Axes"s}}, errors);
+    m_device->addChild(m_comp, errors);
+
+    for (int i = 0; i < 16; i++)
+    {
+      auto id = "x"s + to_string(i);
+      auto di = DataItem::make({{"id", id},
+                                {"type", "POSITION"s},
+                                {"category", "SAMPLE"s},
+                                {"units", "MILLIMETER"s}},
+                               errors);
+      m_comp->addDataItem(di, errors);
+      m_dataItems.push_back(di);
+    }
+    ASSERT_TRUE(errors.empty());
+  }
+
+  void TearDown() override
+  {
+    m_dataItems.clear();
+    m_comp.reset();
+    m_device.reset();
+  }
+
+  struct Result
+  {
+    double m_writesPerSecond;
+    double m_readsPerSecond;
+    bool m_ordered;
+  };
+
+  Result run(bool lockFree, int readers, int count)
+  {
+    CircularBuffer buffer(12, 1000, lockFree);
+    buffer.getDataItemIndexes().assign(*m_device);
+
+    ErrorList errors;
+    Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 1min;
+    vector<ObservationPtr> observations;
+    for (int i = 0; i < count; i++)
+    {
+      auto di = m_dataItems[i % m_dataItems.size()];
+      observations.emplace_back(
+          Observation::make(di, {{"VALUE", double(i)}}, time + chrono::microseconds(i), errors));
+    }
+
+    atomic_bool done {false};
+    atomic_uint64_t reads {0};
+    atomic_bool ordered {true};
+
+    vector<thread> threads;
+    for (int r = 0; r < readers; r++)
+    {
+      threads.emplace_back([&]() {
+        while (!done)
+        {
+          SequenceNumber_t end, first;
+          bool eob;
+          auto list = buffer.getObservations(100, nullopt, nullopt, nullopt, end, first, eob);
+
+          // Every observation returned must be in strictly increasing sequence
+          SequenceNumber_t last = 0;
+          for (auto &o : *list)
+          {
+            if (o->getSequence() <= last)
+              ordered = false;
+            last = o->getSequence();
+          }
+          reads++;
+        }
+      });
+    }
+
+    auto start = chrono::steady_clock::now();
+    for (auto &o : observations)
+      buffer.addToBuffer(o);
+    auto writeTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    done = true;
+    for (auto &t : threads)
+      t.join();
+    auto readTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    EXPECT_EQ(count + 1, buffer.getSequence());
+    EXPECT_EQ(count + 1 - buffer.getBufferSize(), buffer.getFirstSequence());
+
+    return {count / writeTime, reads / readTime, ordered};
+  }
+
+  DevicePtr m_device;
+  ComponentPtr m_comp;
+  vector<DataItemPtr> m_dataItems;
+};
+
+TEST_F(CircularBufferBenchmarkTest, should_append_and_read_concurrently_with_and_without_locks)
+{
+  constexpr int count = 100000;
+  constexpr int readers = 4;
+
+  auto locked = run(false, readers, count);
+  auto lockFree = run(true, readers, count);
+
+  cout << "Locked:    " << int64_t(locked.m_writesPerSecond) << " writes/s, "
+       << int64_t(locked.m_readsPerSecond) << " reads/s" << endl;
+  cout << "Lock free: " << int64_t(lockFree.m_writesPerSecond) << " writes/s, "
+       << int64_t(lockFree.m_readsPerSecond) << " reads/s" << endl;
+
+  ASSERT_TRUE(locked.m_ordered);
+  ASSERT_TRUE(lockFree.m_ordered);
+}
@@ -19,6 +19,9 @@
 #include <gtest/gtest.h>
 // Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
 
+#include <atomic>
+#include <thread>
+
 #include "agent_test_helper.hpp"
 #include "mtconnect/buffer/checkpoint.hpp"
 #include "mtconnect/buffer/circular_buffer.hpp"
@@ -77,6 +80,7 @@ protected:
                                   {"nativeUnits", "MILLIMETER"s}},
                                  errors);
     m_comp2->addDataItem(m_dataItem2, errors);
+    m_circularBuffer->getDataItemIndexes().assign(*m_device);
   }
 
   void TearDown() override
@@ -191,3 +195,343 @@ TEST_F(CircularBufferTest, should_skip_orphaned_observations)
   ASSERT_EQ(7, end);
   ASSERT_TRUE(eob);
 }
+
+TEST_F(CircularBufferTest, should_read_lock_free_buffer_after_it_wraps)
+{
+  m_circularBuffer = make_unique<CircularBuffer>(4, 4, true);
+  m_circularBuffer->getDataItemIndexes().assign(*m_device);
+  ASSERT_TRUE(m_circularBuffer->isLockFree());
+
+  entity::ErrorList errors;
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 1min;
+  for (int i = 1; i <= 40; i++)
+  {
+    auto value = entity::Properties {{"VALUE", double(i)}};
+    auto obs = observation::Observation::make(m_dataItem2, value, time, errors);
+    ASSERT_EQ(i, m_circularBuffer->addToBuffer(obs));
+  }
+
+  ASSERT_EQ(41, m_circularBuffer->getSequence());
+  ASSERT_EQ(25, m_circularBuffer->getFirstSequence());
+  ASSERT_FALSE(m_circularBuffer->getFromBuffer(24));
+  ASSERT_EQ(25, m_circularBuffer->getFromBuffer(25)->getSequence());
+  ASSERT_EQ(40, m_circularBuffer->getFromBuffer(40)->getSequence());
+  ASSERT_FALSE(m_circularBuffer->getFromBuffer(41));
+
+  std::optional<SequenceNumber_t> start {1}, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+  FilterSetOpt opt;
+  auto list {m_circularBuffer->getObservations(100, opt, start, stop, end, first, eob)};
+
+  ASSERT_EQ(16, list->size());
+  ASSERT_EQ(25, first);
+  ASSERT_EQ(41, end);
+  ASSERT_TRUE(eob);
+  ASSERT_EQ(25, list->front()->getSequence());
+  ASSERT_EQ(40, list->back()->getSequence());
+
+  auto check = m_circularBuffer->getCheckpointAt(30, opt);
+  auto obs = check->getObservation("3", m_circularBuffer->getDataItemIndexes());
+  ASSERT_TRUE(obs);
+  ASSERT_EQ(30, obs->getSequence());
+}
+
+TEST_F(CircularBufferTest, should_read_in_order_while_writing_lock_free)
+{
+  m_circularBuffer = make_unique<CircularBuffer>(6, 16, true);
+  m_circularBuffer->getDataItemIndexes().assign(*m_device);
+
+  entity::ErrorList errors;
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 1min;
+  vector<ObservationPtr> observations;
+  for (int i = 0; i < 5000; i++)
+  {
+    if (i % 3 == 0)
+      observations.emplace_back(
+          observation::Observation::make(m_dataItem1, {{"level", "NORMAL"s}}, time, errors));
+    else
+      observations.emplace_back(
+          observation::Observation::make(m_dataItem2, {{"VALUE", double(i)}}, time, errors));
+  }
+
+  atomic_bool done {false};
+  atomic_bool ordered {true};
+  atomic_bool filtered {true};
+  vector<thread> readers;
+  for (auto filter : {FilterSetOpt(), FilterSetOpt(FilterSet {"3"})})
+  {
+    readers.emplace_back([&, filter]() {
+      while (!done)
+      {
+        SequenceNumber_t end, first;
+        bool eob;
+        auto list = m_circularBuffer->getObservations(20, filter, nullopt, nullopt, end, first, eob);
+
+        SequenceNumber_t last = 0;
+        for (auto &o : *list)
+        {
+          if (o->getSequence() <= last)
+            ordered = false;
+          if (filter && o->getDataItem() != m_dataItem2)
+            filtered = false;
+          last = o->getSequence();
+        }
+      }
+    });
+  }
+
+  for (auto &o : observations)
+    m_circularBuffer->addToBuffer(o);
+  done = true;
+  for (auto &t : readers)
+    t.join();
+
+  ASSERT_TRUE(ordered);
+  ASSERT_TRUE(filtered);
+  ASSERT_EQ(5001, m_circularBuffer->getSequence());
+}
+
+TEST_F(CircularBufferTest, should_filter_observations_across_the_end_of_the_ring)
+{
+  entity::ErrorList errors;
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 1min;
+  for (int i = 1; i <= 40; i++)
+  {
+    ObservationPtr obs;
+    if (i % 5 == 0)
+      obs = observation::Observation::make(m_dataItem1, {{"level", "NORMAL"s}}, time, errors);
+    else
+      obs = observation::Observation::make(m_dataItem2, {{"VALUE", double(i)}}, time, errors);
+    ASSERT_EQ(i, m_circularBuffer->addToBuffer(obs));
+  }
+  ASSERT_EQ(25, m_circularBuffer->getFirstSequence());
+
+  std::optional<SequenceNumber_t> start {1}, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+  FilterSetOpt filter {{"1"s}};
+  auto list {m_circularBuffer->getObservations(100, filter, start, stop, end, first, eob)};
+
+  ASSERT_EQ(4, list->size());
+  ASSERT_EQ(25, list->front()->getSequence());
+  ASSERT_EQ(40, list->back()->getSequence());
+  ASSERT_EQ(41, end);
+  ASSERT_TRUE(eob);
+
+  list = m_circularBuffer->getObservations(2, filter, start, stop, end, first, eob);
+  ASSERT_EQ(2, list->size());
+  ASSERT_EQ(30, list->back()->getSequence());
+  ASSERT_EQ(31, end);
+  ASSERT_FALSE(eob);
+
+  // Read backward from the end of the buffer
+  std::optional<SequenceNumber_t> none;
+  list = m_circularBuffer->getObservations(-3, filter, none, stop, end, first, eob);
+  ASSERT_EQ(3, list->size());
+  ASSERT_EQ(40, list->front()->getSequence());
+  ASSERT_EQ(30, list->back()->getSequence());
+
+  FilterSetOpt unknown {{"not_a_data_item"s}};
+  list = m_circularBuffer->getObservations(100, unknown, start, stop, end, first, eob);
+  ASSERT_EQ(0, list->size());
+  ASSERT_EQ(41, end);
+}
+
+TEST_F(CircularBufferTest, should_read_sparse_filters_from_the_sequence_index)
+{
+  m_circularBuffer = make_unique<CircularBuffer>(4, 4, false, 4);
+  m_circularBuffer->getDataItemIndexes().assign(*m_device);
+  ASSERT_TRUE(m_circularBuffer->hasSequenceIndex());
+
+  entity::ErrorList errors;
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 1min;
+  for (int i = 1; i <= 40; i++)
+  {
+    ObservationPtr obs;
+    if (i % 5 == 0)
+      obs = observation::Observation::make(m_dataItem1, {{"level", "NORMAL"s}}, time, errors);
+    else
+      obs = observation::Observation::make(m_dataItem2, {{"VALUE", double(i)}}, time, errors);
+    ASSERT_EQ(i, m_circularBuffer->addToBuffer(obs));
+  }
+
+  std::optional<SequenceNumber_t> start {1}, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+  FilterSetOpt filter {{"1"s}};
+  auto list {m_circularBuffer->getObservations(100, filter, start, stop, end, first, eob)};
+
+  ASSERT_EQ(4, list->size());
+  ASSERT_EQ(25, list->front()->getSequence());
+  ASSERT_EQ(40, list->back()->getSequence());
+  ASSERT_EQ(41, end);
+  ASSERT_TRUE(eob);
+
+  list = m_circularBuffer->getObservations(2, filter, start, stop, end, first, eob);
+  ASSERT_EQ(2, list->size());
+  ASSERT_EQ(30, list->back()->getSequence());
+  ASSERT_EQ(31, end);
+  ASSERT_FALSE(eob);
+
+  std::optional<SequenceNumber_t> none;
+  list = m_circularBuffer->getObservations(-3, filter, none, stop, end, first, eob);
+  ASSERT_EQ(3, list->size());
+  ASSERT_EQ(40, list->front()->getSequence());
+  ASSERT_EQ(30, list->back()->getSequence());
+
+  // Only the last four sequences of data item 3 are indexed, so this scans the buffer
+  FilterSetOpt dense {{"3"s}};
+  list = m_circularBuffer->getObservations(100, dense, start, stop, end, first, eob);
+  ASSERT_EQ(12, list->size());
+  ASSERT_EQ(26, list->front()->getSequence());
+  ASSERT_EQ(39, list->back()->getSequence());
+}
+
+TEST_F(CircularBufferTest, should_restore_observations_from_the_segment_store)
+{
+  namespace fs = std::filesystem;
+  fs::path dir {fs::path(TEST_BIN_ROOT_DIR) / "circular_buffer_segments"};
+  fs::remove_all(dir);
+
+  m_circularBuffer->setStore(make_unique<SegmentStore>(dir, m_circularBuffer->getBufferSize()));
+  ASSERT_TRUE(m_circularBuffer->isPersistent());
+  auto instanceId = m_circularBuffer->getInstanceId();
+  ASSERT_TRUE(instanceId);
+
+  addSomeObservations();
+
+  entity::ErrorList errors;
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 2min;
+  for (int i = 1; i <= 20; i++)
+  {
+    auto value = entity::Properties {{"VALUE", double(i)}};
+    auto obs = observation::Observation::make(m_dataItem2, value, time, errors);
+    m_circularBuffer->addToBuffer(obs);
+  }
+  ASSERT_EQ(27, m_circularBuffer->getSequence());
+  ASSERT_EQ(11, m_circularBuffer->getFirstSequence());
+
+  // Restart with a new buffer on the same directory
+  m_circularBuffer = make_unique<CircularBuffer>(4, 4);
+  m_circularBuffer->getDataItemIndexes().assign(*m_device);
+  m_circularBuffer->setStore(make_unique<SegmentStore>(dir, m_circularBuffer->getBufferSize()));
+  ASSERT_EQ(*instanceId, *m_circularBuffer->getInstanceId());
+
+  auto restored = m_circularBuffer->restore([this](const string &id) -> DataItemPtr {
+    if (id == "1")
+      return m_dataItem1;
+    else if (id == "3")
+      return m_dataItem2;
+    return nullptr;
+  });
+  ASSERT_LE(16, restored);
+  ASSERT_EQ(27, m_circularBuffer->getSequence());
+  ASSERT_EQ(11, m_circularBuffer->getFirstSequence());
+
+  auto obs = m_circularBuffer->getFromBuffer(26);
+  ASSERT_TRUE(obs);
+  ASSERT_EQ(26, obs->getSequence());
+  ASSERT_EQ(m_dataItem2, obs->getDataItem());
+  ASSERT_EQ(20.0, obs->getValue<double>());
+  ASSERT_EQ(time, obs->getTimestamp());
+
+  // The conditions are only in the checkpoints
+  FilterSetOpt opt;
+  auto check = m_circularBuffer->getCheckpointAt(11, opt);
+  auto cond = dynamic_pointer_cast<Condition>(
+      check->getObservation("1", m_circularBuffer->getDataItemIndexes()));
+  ASSERT_TRUE(cond);
+  ASSERT_EQ(Condition::WARNING, cond->getLevel());
+  ASSERT_EQ("CODE1", cond->get<string>("nativeCode"));
+
+  check = m_circularBuffer->getCheckpointAt(20, opt);
+  obs = check->getObservation("3", m_circularBuffer->getDataItemIndexes());
+  ASSERT_TRUE(obs);
+  ASSERT_EQ(20, obs->getSequence());
+  ASSERT_EQ(14.0, obs->getValue<double>());
+
+  // New observations continue the sequence
+  auto value = entity::Properties {{"VALUE", 21.0}};
+  obs = observation::Observation::make(m_dataItem2, value, time, errors);
+  ASSERT_EQ(27, m_circularBuffer->addToBuffer(obs));
+
+  m_circularBuffer.reset();
+  fs::remove_all(dir);
+}
+
+TEST_F(CircularBufferTest, should_read_evicted_observations_from_the_cold_store)
+{
+  namespace fs = std::filesystem;
+  fs::path dir {fs::path(TEST_BIN_ROOT_DIR) / "circular_buffer_cold"};
+
+  auto store = make_unique<ColdStore>(dir, 1000, 4);
+  auto cold = store.get();
+  m_circularBuffer->setColdStore(std::move(store));
+  ASSERT_TRUE(m_circularBuffer->hasColdStore());
+
+  entity::ErrorList errors;
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 1min;
+  for (int i = 1; i <= 40; i++)
+  {
+    auto value = entity::Properties {{"VALUE", double(i)}};
+    auto obs = observation::Observation::make(m_dataItem2, value, time + i * 1s, errors);
+    m_circularBuffer->addToBuffer(obs);
+  }
+
+  ASSERT_EQ(25, m_circularBuffer->getFirstSequence());
+  ASSERT_EQ(1, m_circularBuffer->getOldestSequence());
+
+  // The full blocks are written in the background
+  cold->flush();
+  int files = 0;
+  for (const auto &entry : fs::directory_iterator(dir))
+  {
+    if (entry.path().extension() == ".blk")
+      files++;
+  }
+  ASSERT_EQ(6, files);
+
+  std::optional<SequenceNumber_t> start {3}, stop;
+  SequenceNumber_t first, end;
+  bool eob = false;
+  FilterSetOpt opt;
+  auto list {m_circularBuffer->getObservations(10, opt, start, stop, end, first, eob)};
+
+  ASSERT_EQ(10, list->size());
+  ASSERT_EQ(1, first);
+  ASSERT_EQ(13, end);
+  ASSERT_FALSE(eob);
+  ASSERT_EQ(3, list->front()->getSequence());
+  ASSERT_EQ(3.0, list->front()->getValue<double>());
+  ASSERT_EQ(time + 3s, list->front()->getTimestamp());
+  ASSERT_EQ(m_dataItem2, list->front()->getDataItem());
+  ASSERT_EQ(12, list->back()->getSequence());
+
+  // Continues from the cold store into the ring
+  start = 20;
+  list = m_circularBuffer->getObservations(100, opt, start, stop, end, first, eob);
+  ASSERT_EQ(21, list->size());
+  ASSERT_EQ(41, end);
+  ASSERT_TRUE(eob);
+  ASSERT_EQ(20, list->front()->getSequence());
+  ASSERT_EQ(40, list->back()->getSequence());
+
+  // Reading backward continues from the ring into the cold store
+  start = 27;
+  list = m_circularBuffer->getObservations(-5, opt, start, stop, end, first, eob);
+  ASSERT_EQ(5, list->size());
+  ASSERT_EQ(27, list->front()->getSequence());
+  ASSERT_EQ(23, list->back()->getSequence());
+  ASSERT_EQ(22, end);
+  ASSERT_FALSE(eob);
+
+  auto check = m_circularBuffer->getCheckpointAt(10, opt);
+  auto obs = check->getObservation("3", m_circularBuffer->getDataItemIndexes());
+  ASSERT_TRUE(obs);
+  ASSERT_EQ(10, obs->getSequence());
+  ASSERT_EQ(10.0, obs->getValue<double>());
+
+  m_circularBuffer.reset();
+  fs::remove_all(dir);
+}
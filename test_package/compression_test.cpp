@@ -0,0 +1,148 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <sstream>
+#include <string>
+
+#include <zlib.h>
+
+#include "mtconnect/sink/rest_sink/compression.hpp"
+
+using namespace std;
+using namespace mtconnect;
+using namespace mtconnect::sink::rest_sink;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+namespace io = boost::iostreams;
+
+class CompressionTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    for (int i = 0; i < 100; i++)
+      m_document += "<Position dataItemId=\"x\" sequence=\"" + to_string(i) + "\">10.0</Position>";
+  }
+
+  string decompress(const string &data, bool gzip)
+  {
+    istringstream in(data);
+    io::filtering_istream stream;
+    if (gzip)
+      stream.push(io::gzip_decompressor());
+    else
+      stream.push(io::zlib_decompressor());
+    stream.push(in);
+    ostringstream out;
+    io::copy(stream, out);
+    return out.str();
+  }
+
+  string m_document;
+};
+
+TEST_F(CompressionTest, should_negotiate_the_content_encoding)
+{
+  using E = StreamCompressor;
+  EXPECT_EQ(E::GZIP, E::negotiate("gzip, deflate, br"));
+  EXPECT_EQ(E::GZIP, E::negotiate("deflate, gzip"));
+  EXPECT_EQ(E::DEFLATE, E::negotiate("deflate"));
+  EXPECT_EQ(E::DEFLATE, E::negotiate("gzip;q=0.5, deflate"));
+  EXPECT_EQ(E::DEFLATE, E::negotiate("gzip;q=0, *"));
+  EXPECT_EQ(E::GZIP, E::negotiate("*"));
+  EXPECT_EQ(E::GZIP, E::negotiate("X-GZIP"));
+  EXPECT_FALSE(E::negotiate(""));
+  EXPECT_FALSE(E::negotiate("identity"));
+  EXPECT_FALSE(E::negotiate("br"));
+  EXPECT_FALSE(E::negotiate("gzip;q=0, deflate;q=0.000"));
+  EXPECT_FALSE(E::negotiate("*;q=0"));
+}
+
+TEST_F(CompressionTest, should_compress_a_document)
+{
+  auto gzip = StreamCompressor::compress(StreamCompressor::GZIP, 6, m_document);
+  EXPECT_GT(m_document.size(), gzip.size());
+  EXPECT_EQ(m_document, decompress(gzip, true));
+
+  auto deflate = StreamCompressor::compress(StreamCompressor::DEFLATE, 9, m_document);
+  EXPECT_GT(m_document.size(), deflate.size());
+  EXPECT_EQ(m_document, decompress(deflate, false));
+}
+
+TEST_F(CompressionTest, should_flush_each_part_of_a_stream)
+{
+  StreamCompressor compressor(StreamCompressor::GZIP, 6);
+
+  z_stream inflater {};
+  ASSERT_EQ(Z_OK, inflateInit2(&inflater, 15 + 16));
+
+  // Every flushed chunk must decode on its own, without waiting for the next one
+  auto inflate = [&inflater](string &chunk) {
+    string out(64 * 1024, '\0');
+    inflater.next_in = reinterpret_cast<Bytef *>(chunk.data());
+    inflater.avail_in = uInt(chunk.size());
+    inflater.next_out = reinterpret_cast<Bytef *>(out.data());
+    inflater.avail_out = uInt(out.size());
+    auto rc = ::inflate(&inflater, Z_SYNC_FLUSH);
+    EXPECT_TRUE(rc == Z_OK || rc == Z_STREAM_END);
+    EXPECT_EQ(0, inflater.avail_in);
+    out.resize(out.size() - inflater.avail_out);
+    return out;
+  };
+
+  string stream;
+  for (int i = 0; i < 3; i++)
+  {
+    string part = "--boundary\r\n" + m_document + "\r\n";
+    string chunk;
+    compressor.write(part.substr(0, 12), chunk);
+    compressor.write(part.substr(12), chunk);
+    compressor.flush(chunk);
+    stream += chunk;
+
+    EXPECT_EQ(part, inflate(chunk));
+  }
+
+  string last;
+  compressor.finish(last);
+  EXPECT_EQ("", inflate(last));
+  stream += last;
+  inflateEnd(&inflater);
+
+  string parts;
+  for (int i = 0; i < 3; i++)
+    parts += "--boundary\r\n" + m_document + "\r\n";
+  EXPECT_EQ(parts, decompress(stream, true));
+
+  // Later parts reuse the dictionary of the earlier ones
+  EXPECT_GT(m_document.size(), stream.size());
+}
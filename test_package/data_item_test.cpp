@@ -19,6 +19,7 @@
 #include <gtest/gtest.h>
 // Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
 
+#include "mtconnect/buffer/data_item_indexes.hpp"
 #include "mtconnect/device_model/data_item/data_item.hpp"
 #include "mtconnect/source/adapter/adapter.hpp"
 
@@ -107,6 +108,39 @@ TEST_F(DataItemTest, Getters)
   ASSERT_EQ(1.0, m_dataItemB->get<double>("nativeScale"));
 }
 
+TEST_F(DataItemTest, DenseIndexesAreSharedById)
+{
+  buffer::DataItemIndexes indexes;
+  ASSERT_EQ(DataItem::NoIndex, m_dataItemA->getIndex());
+
+  indexes.assign(*m_dataItemA);
+  indexes.assign(*m_dataItemB);
+  indexes.assign(*m_dataItemC);
+  ASSERT_NE(m_dataItemA->getIndex(), m_dataItemB->getIndex());
+  ASSERT_NE(m_dataItemA->getIndex(), m_dataItemC->getIndex());
+  ASSERT_LT(m_dataItemA->getIndex(), indexes.size());
+
+  Properties props {{"id", "1"s}, {"type", "LOAD"s}, {"category", "SAMPLE"s}};
+  ErrorList errors;
+  auto item = DataItem::make(props, errors);
+  ASSERT_EQ(0, errors.size());
+  ASSERT_EQ(m_dataItemA->getIndex(), indexes.assign(*item));
+  ASSERT_EQ(m_dataItemA->getIndex(), item->getIndex());
+  ASSERT_EQ(m_dataItemA->getIndex(), *indexes.find("1"));
+  ASSERT_FALSE(indexes.find("not_a_data_item"));
+  ASSERT_EQ(3, indexes.size());
+
+  // The index of a removed id is given to the next new id
+  indexes.release("3");
+  ASSERT_FALSE(indexes.find("3"));
+
+  Properties newProps {{"id", "5"s}, {"type", "LOAD"s}, {"category", "SAMPLE"s}};
+  auto added = DataItem::make(newProps, errors);
+  ASSERT_EQ(0, errors.size());
+  ASSERT_EQ(m_dataItemB->getIndex(), indexes.assign(*added));
+  ASSERT_EQ(3, indexes.size());
+}
+
 TEST_F(DataItemTest, HasNameAndSource)
 {
   namespace di = mtconnect::device_model::data_item;
@@ -106,7 +106,7 @@ TEST_F(DataSetTest, InitialSet)
   ASSERT_EQ(4, get<int64_t>(ds.find("d"_E)->m_value));
 
   m_checkpoint->addObservation(ce);
-  auto ce2 = m_checkpoint->getObservation("v1");
+  auto ce2 = m_checkpoint->getObservation(m_dataItem1->getIndex());
   auto ds2 = ce2->getValue<DataSet>();
 
   ASSERT_EQ(4, ce2->get<int64_t>("count"));
@@ -212,14 +212,14 @@ TEST_F(DataSetTest, UpdateOneElement)
   ASSERT_EQ(0, errors.size());
   m_checkpoint->addObservation(ce);
 
-  auto cecp = m_checkpoint->getObservation("v1");
+  auto cecp = m_checkpoint->getObservation(m_dataItem1->getIndex());
   ASSERT_EQ(4, cecp->getValue<DataSet>().size());
 
   auto ce2 = Observation::make(m_dataItem1, Properties {{"VALUE", "c=5"s}}, time, errors);
   ASSERT_EQ(0, errors.size());
   m_checkpoint->addObservation(ce2);
 
-  auto ce3 = m_checkpoint->getObservation("v1");
+  auto ce3 = m_checkpoint->getObservation(m_dataItem1->getIndex());
   ASSERT_EQ(4, ce3->getValue<DataSet>().size());
 
   auto map1 = ce3->getValue<DataSet>();
@@ -232,7 +232,7 @@ TEST_F(DataSetTest, UpdateOneElement)
   ASSERT_EQ(0, errors.size());
   m_checkpoint->addObservation(ce4);
 
-  auto ce5 = m_checkpoint->getObservation("v1");
+  auto ce5 = m_checkpoint->getObservation(m_dataItem1->getIndex());
   ASSERT_EQ(5, ce5->getValue<DataSet>().size());
 
   auto map2 = ce5->getValue<DataSet>();
@@ -253,14 +253,14 @@ TEST_F(DataSetTest, UpdateMany)
   ASSERT_EQ(0, errors.size());
   m_checkpoint->addObservation(ce);
 
-  auto cecp = m_checkpoint->getObservation("v1");
+  auto cecp = m_checkpoint->getObservation(m_dataItem1->getIndex());
   ASSERT_EQ(4, cecp->getValue<DataSet>().size());
 
   auto ce2 = Observation::make(m_dataItem1, Properties {{"VALUE", "c=5 e=6"s}}, time, errors);
   ASSERT_EQ(0, errors.size());
   m_checkpoint->addObservation(ce2);
 
-  auto ce3 = m_checkpoint->getObservation("v1");
+  auto ce3 = m_checkpoint->getObservation(m_dataItem1->getIndex());
 
   auto map1 = ce3->getValue<DataSet>();
   ASSERT_EQ(5, map1.size());
@@ -275,7 +275,7 @@ TEST_F(DataSetTest, UpdateMany)
   ASSERT_EQ(0, errors.size());
   m_checkpoint->addObservation(ce4);
 
-  auto ce5 = m_checkpoint->getObservation("v1");
+  auto ce5 = m_checkpoint->getObservation(m_dataItem1->getIndex());
 
   auto map2 = ce5->getValue<DataSet>();
   ASSERT_EQ(6, map2.size());
@@ -298,7 +298,7 @@ TEST_F(DataSetTest, Reset)
   ASSERT_EQ(0, errors.size());
   m_checkpoint->addObservation(ce);
 
-  auto cecp = m_checkpoint->getObservation("v1");
+  auto cecp = m_checkpoint->getObservation(m_dataItem1->getIndex());
   ASSERT_EQ(4, cecp->getValue<DataSet>().size());
 
   auto ce2 = Observation::make(
@@ -306,7 +306,7 @@ TEST_F(DataSetTest, Reset)
   ASSERT_EQ(0, errors.size());
   m_checkpoint->addObservation(ce2);
 
-  auto ce3 = m_checkpoint->getObservation("v1");
+  auto ce3 = m_checkpoint->getObservation(m_dataItem1->getIndex());
   auto map1 = ce3->getValue<DataSet>();
   ASSERT_EQ(2, map1.size());
 
@@ -317,7 +317,7 @@ TEST_F(DataSetTest, Reset)
   ASSERT_EQ(0, errors.size());
   m_checkpoint->addObservation(ce4);
 
-  auto ce5 = m_checkpoint->getObservation("v1");
+  auto ce5 = m_checkpoint->getObservation(m_dataItem1->getIndex());
   auto map2 = ce5->getValue<DataSet>();
   ASSERT_EQ(4, map2.size());
 
@@ -568,7 +568,7 @@ TEST_F(DataSetTest, DeleteKey)
   ASSERT_EQ(0, errors.size());
   m_checkpoint->addObservation(ce);
 
-  auto cecp = m_checkpoint->getObservation("v1");
+  auto cecp = m_checkpoint->getObservation(m_dataItem1->getIndex());
   ASSERT_EQ(4, cecp->getValue<DataSet>().size());
 
   auto ce2 = Observation::make(m_dataItem1, Properties {{"VALUE", "c e=6 a"s}}, time, errors);
@@ -579,7 +579,7 @@ TEST_F(DataSetTest, DeleteKey)
   ASSERT_TRUE(ds.find("a"_E)->m_removed);
   ASSERT_TRUE(ds.find("c"_E)->m_removed);
 
-  auto ce3 = m_checkpoint->getObservation("v1");
+  auto ce3 = m_checkpoint->getObservation(m_dataItem1->getIndex());
   auto &map1 = ce3->getValue<DataSet>();
   ASSERT_EQ(3, map1.size());
 
@@ -101,6 +101,7 @@ protected:
     auto di = DataItem::make(attributes, errors);
     m_dataItems.emplace(di->getId(), di);
     m_component->addDataItem(di, errors);
+    m_indexes.assign(*di);
 
     return di;
   }
@@ -117,6 +118,7 @@ protected:
 
   shared_ptr<ShdrTokenMapper> m_mapper;
   std::map<string, DataItemPtr> m_dataItems;
+  buffer::DataItemIndexes m_indexes;
   shared_ptr<PipelineContext> m_context;
   ComponentPtr m_component;
 };
@@ -20,6 +20,7 @@
 // Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
 
 #include <date/date.h>
+#include <iomanip>
 #include <thread>
 
 #include "mtconnect/utilities.hpp"
@@ -50,6 +51,36 @@ TEST(GlobalsTest, FloatToString)
   ASSERT_EQ((string) "1", format(1.0));
 }
 
+TEST(GlobalsTest, FloatToStringIsTheSameAsAStream)
+{
+  auto stream = [](double value) {
+    stringstream s;
+    s << setprecision(numeric_limits<double>::digits10) << value;
+    return s.str();
+  };
+
+  for (double value :
+       {0.0, -0.0, 1.0, -1.5, 0.1 + 0.2, 1.1 * 25.4, 100000.0, 1e15, 1e16, 123456789012345678.0,
+        1e-4, 1e-5, 0.00199, -273.15, 1.0 / 3.0, 6.02214076e23, 5e-324, 1.7976931348623157e308,
+        numeric_limits<double>::infinity(), -numeric_limits<double>::infinity()})
+  {
+    ASSERT_EQ(stream(value), format(value)) << value;
+
+    string appended {"x="};
+    appendDouble(appended, value);
+    ASSERT_EQ("x=" + stream(value), appended);
+  }
+
+  ASSERT_EQ("0.3", format(0.1 + 0.2));
+  ASSERT_EQ("27.94", format(1.1 * 25.4));
+  ASSERT_EQ("1e+16", format(1e16));
+  ASSERT_EQ("1e-05", format(1e-5));
+
+  stringstream s;
+  s << formatted(1.0 / 3.0) << ' ' << formatted(2.5);
+  ASSERT_EQ("0.333333333333333 2.5", s.str());
+}
+
 TEST(GlobalsTest, ToUpperCase)
 {
   string lower = "abcDef";
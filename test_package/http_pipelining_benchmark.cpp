@@ -0,0 +1,155 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <boost/asio/spawn.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mtconnect/sink/rest_sink/server.hpp"
+
+using namespace std;
+using namespace mtconnect;
+using namespace mtconnect::sink::rest_sink;
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+/// @brief Measures the requests per second on one keep-alive connection with and without
+///        pipelining.
+class HttpPipeliningBenchmarkTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    using namespace mtconnect::configuration;
+    m_server = make_unique<Server>(m_context, ConfigOptions {{Port, 0}, {ServerIp, "127.0.0.1"s}});
+  }
+
+  void TearDown() override { m_server.reset(); }
+
+  void start()
+  {
+    m_server->start();
+    while (!m_server->isListening())
+      m_context.run_one();
+  }
+
+  /// @brief Writes requests on a keep-alive connection and reads the responses in order
+  /// @param pipelined write all the requests before reading the responses
+  static void requestMany(tcp::socket &socket, const vector<string> &targets, bool pipelined,
+                          vector<string> &bodies, asio::yield_context yield)
+  {
+    beast::error_code ec;
+    beast::flat_buffer buffer;
+
+    auto request = [](const string &target) {
+      return "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    };
+    auto response = [&]() {
+      http::response<http::string_body> res;
+      http::async_read(socket, buffer, res, yield[ec]);
+      ASSERT_FALSE(ec) << ec.message();
+      ASSERT_EQ(200, res.result_int());
+      bodies.emplace_back(res.body());
+    };
+
+    if (pipelined)
+    {
+      string all;
+      for (const auto &target : targets)
+        all += request(target);
+      asio::async_write(socket, asio::buffer(all), yield[ec]);
+      ASSERT_FALSE(ec) << ec.message();
+      for (size_t i = 0; i < targets.size(); i++)
+        response();
+    }
+    else
+    {
+      for (const auto &target : targets)
+      {
+        asio::async_write(socket, asio::buffer(request(target)), yield[ec]);
+        ASSERT_FALSE(ec) << ec.message();
+        response();
+      }
+    }
+  }
+
+  asio::io_context m_context;
+  unique_ptr<Server> m_server;
+};
+
+TEST_F(HttpPipeliningBenchmarkTest, should_serve_keep_alive_requests_with_and_without_pipelining)
+{
+  const string document(2048, 'x');
+  auto current = [&](SessionPtr session, RequestPtr request) -> bool {
+    session->writeResponse(make_unique<Response>(status::ok, document));
+    return true;
+  };
+
+  m_server->addRouting({boost::beast::http::verb::get, "/{device}/current", current});
+
+  start();
+
+  vector<string> targets;
+  for (int i = 0; i < 40; i++)
+    targets.emplace_back("/device" + to_string(i) + "/current");
+
+  tcp::socket socket(m_context);
+  socket.connect(tcp::endpoint(asio::ip::make_address("127.0.0.1"), m_server->getPort()));
+
+  constexpr int rounds = 50;
+  auto run = [&](bool pipelined) {
+    vector<string> bodies;
+    bool done = false;
+    auto start = chrono::steady_clock::now();
+    asio::spawn(m_context, [&](asio::yield_context yield) {
+      for (int i = 0; i < rounds; i++)
+        requestMany(socket, targets, pipelined, bodies, yield);
+      done = true;
+    });
+    while (!done && m_context.run_for(20ms) > 0)
+      ;
+    EXPECT_TRUE(done);
+    EXPECT_EQ(rounds * targets.size(), bodies.size());
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  };
+
+  auto unpipelined = run(false);
+  auto pipelined = run(true);
+
+  auto count = double(rounds * targets.size());
+  cout << "Keep-alive: " << int64_t(count / unpipelined) << " requests/s" << endl;
+  cout << "Pipelined:  " << int64_t(count / pipelined) << " requests/s" << endl;
+}
@@ -24,15 +24,21 @@
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/version.hpp>
+#include <boost/beast/websocket.hpp>
 
+#include <chrono>
 #include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <set>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "mtconnect/logging.hpp"
+#include "mtconnect/sink/rest_sink/event_stream.hpp"
 #include "mtconnect/sink/rest_sink/server.hpp"
 
 using namespace std;
@@ -648,6 +654,60 @@ TEST_F(RestServiceTest, streaming_response)
     ;
 }
 
+TEST_F(RestServiceTest, should_stream_server_sent_events_without_boundaries)
+{
+  string lastEventId;
+  auto sample = [&](SessionPtr session, RequestPtr request) -> bool {
+    lastEventId = request->m_lastEventId;
+    session->beginStreaming(EventStreamMimeType, [session]() {
+      auto first = make_shared<string>();
+      appendEvent(*first, "<Streams>\n  <Line>204</Line>\n</Streams>\n", 11);
+      session->writeChunk(first, [session]() {
+        string second;
+        appendEvent(second, "<Streams/>", 12);
+        session->writeChunk(second, [session]() { session->closeStream(); });
+      });
+    });
+    return true;
+  };
+
+  m_server->addRouting({boost::beast::http::verb::get, "/sample", sample});
+
+  start();
+
+  http::response<http::string_body> res;
+  bool done = false;
+  asio::spawn(m_context, [&](asio::yield_context yield) {
+    beast::error_code ec;
+    tcp::socket socket(m_context);
+    socket.async_connect(tcp::endpoint(asio::ip::make_address("127.0.0.1"), m_server->getPort()),
+                         yield[ec]);
+    ASSERT_FALSE(ec) << ec.message();
+
+    string request(
+        "GET /sample HTTP/1.1\r\nHost: localhost\r\nAccept: text/event-stream\r\n"
+        "Last-Event-ID: 10\r\n\r\n");
+    asio::async_write(socket, asio::buffer(request), yield[ec]);
+    ASSERT_FALSE(ec) << ec.message();
+
+    beast::flat_buffer buffer;
+    http::async_read(socket, buffer, res, yield[ec]);
+    ASSERT_FALSE(ec) << ec.message();
+    done = true;
+  });
+  while (!done && m_context.run_for(20ms) > 0)
+    ;
+
+  ASSERT_TRUE(done);
+  EXPECT_EQ("10", lastEventId);
+  EXPECT_EQ(200, res.result_int());
+  EXPECT_EQ("text/event-stream", res[http::field::content_type]);
+  EXPECT_EQ(
+      "id: 11\ndata: <Streams>\ndata:   <Line>204</Line>\ndata: </Streams>\n\n"
+      "id: 12\ndata: <Streams/>\n\n",
+      res.body());
+}
+
 TEST_F(RestServiceTest, additional_header_fields)
 {
   m_server->setHttpHeaders({"Access-Control-Allow-Origin:*", "Origin:https://foo.example"});
@@ -710,3 +770,289 @@ TEST_F(RestServiceTest, failure_when_tls_only)
 
   EXPECT_EQ((unsigned)boost::beast::http::status::unauthorized, m_client->m_status);
 }
+
+TEST_F(RestServiceTest, should_accept_connections_on_every_acceptor)
+{
+  using namespace mtconnect::configuration;
+  createServer({{HttpAcceptors, 4}});
+
+  set<Session*> sessions;
+  auto probe = [&](SessionPtr session, RequestPtr request) -> bool {
+    sessions.insert(session.get());
+    ResponsePtr resp = make_unique<Response>(status::ok, "Probe");
+    session->writeResponse(std::move(resp));
+    return true;
+  };
+
+  m_server->addRouting({boost::beast::http::verb::get, "/probe", probe});
+
+  start();
+#ifdef __linux__
+  ASSERT_EQ(4, m_server->getAcceptorCount());
+#else
+  ASSERT_EQ(1, m_server->getAcceptorCount());
+#endif
+
+  // Every connection is served no matter which acceptor the kernel gives it to
+  vector<unique_ptr<Client>> clients;
+  for (int i = 0; i < 16; i++)
+  {
+    auto& client = clients.emplace_back(make_unique<Client>(m_context));
+    asio::spawn(m_context, std::bind(&Client::connect, client.get(),
+                                     static_cast<unsigned short>(m_server->getPort()),
+                                     std::placeholders::_1));
+    while (!client->m_connected)
+      m_context.run_one();
+  }
+
+  for (auto& client : clients)
+  {
+    client->spawnRequest(http::verb::get, "/probe");
+    ASSERT_TRUE(client->m_done);
+    EXPECT_EQ(200, client->m_status);
+    EXPECT_EQ("Probe", client->m_result);
+  }
+
+  EXPECT_EQ(16, sessions.size());
+
+  m_server->stop();
+  for (auto& client : clients)
+    client->close();
+  m_context.run_for(2ms);
+}
+
+/// @brief Writes requests on a keep-alive connection and reads the responses in order
+/// @param pipelined write all the requests before reading the responses
+static void requestMany(tcp::socket& socket, const vector<string>& targets, bool pipelined,
+                        vector<string>& bodies, asio::yield_context yield)
+{
+  beast::error_code ec;
+  beast::flat_buffer buffer;
+
+  auto request = [](const string& target) {
+    return "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  };
+  auto response = [&]() {
+    http::response<http::string_body> res;
+    http::async_read(socket, buffer, res, yield[ec]);
+    ASSERT_FALSE(ec) << ec.message();
+    ASSERT_EQ(200, res.result_int());
+    bodies.emplace_back(res.body());
+  };
+
+  if (pipelined)
+  {
+    string all;
+    for (const auto& target : targets)
+      all += request(target);
+    asio::async_write(socket, asio::buffer(all), yield[ec]);
+    ASSERT_FALSE(ec) << ec.message();
+    for (size_t i = 0; i < targets.size(); i++)
+      response();
+  }
+  else
+  {
+    for (const auto& target : targets)
+    {
+      asio::async_write(socket, asio::buffer(request(target)), yield[ec]);
+      ASSERT_FALSE(ec) << ec.message();
+      response();
+    }
+  }
+}
+
+TEST_F(RestServiceTest, should_respond_to_pipelined_requests_in_order)
+{
+  int dispatched = 0;
+  auto current = [&](SessionPtr session, RequestPtr request) -> bool {
+    dispatched++;
+    auto device = get<string>(request->m_parameters.find("device")->second);
+    session->writeResponse(make_unique<Response>(status::ok, "Current " + device));
+    return true;
+  };
+
+  m_server->addRouting({boost::beast::http::verb::get, "/{device}/current", current});
+
+  start();
+
+  vector<string> targets;
+  for (int i = 0; i < 40; i++)
+    targets.emplace_back("/device" + to_string(i) + "/current");
+
+  tcp::socket socket(m_context);
+  socket.connect(tcp::endpoint(asio::ip::make_address("127.0.0.1"), m_server->getPort()));
+
+  vector<string> bodies;
+  bool done = false;
+  asio::spawn(m_context, [&](asio::yield_context yield) {
+    requestMany(socket, targets, true, bodies, yield);
+    done = true;
+  });
+  while (!done && m_context.run_for(20ms) > 0)
+    ;
+
+  ASSERT_TRUE(done);
+  ASSERT_EQ(40, dispatched);
+  ASSERT_EQ(40, bodies.size());
+  for (int i = 0; i < 40; i++)
+    EXPECT_EQ("Current device" + to_string(i), bodies[i]);
+
+  // The connection is kept alive after the batch
+  bodies.clear();
+  done = false;
+  asio::spawn(m_context, [&](asio::yield_context yield) {
+    requestMany(socket, {"/device1/current"}, false, bodies, yield);
+    done = true;
+  });
+  while (!done && m_context.run_for(20ms) > 0)
+    ;
+
+  ASSERT_TRUE(done);
+  ASSERT_EQ(1, bodies.size());
+  EXPECT_EQ("Current device1", bodies[0]);
+}
+
+TEST_F(RestServiceTest, should_upgrade_after_the_pipelined_responses)
+{
+  auto probe = [&](SessionPtr session, RequestPtr request) -> bool {
+    auto device = get<string>(request->m_parameters.find("device")->second);
+    session->writeResponse(make_unique<Response>(status::ok, "Probe " + device, "text/plain"));
+    return true;
+  };
+
+  m_server->addRouting({boost::beast::http::verb::get, "/{device}/probe", probe});
+
+  start();
+
+  tcp::socket socket(m_context);
+  socket.connect(tcp::endpoint(asio::ip::make_address("127.0.0.1"), m_server->getPort()));
+
+  vector<pair<int, string>> responses;
+  bool done = false;
+  asio::spawn(m_context, [&](asio::yield_context yield) {
+    beast::error_code ec;
+    beast::flat_buffer buffer;
+
+    string all =
+        "GET /dev1/probe HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "GET /dev2/probe HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "GET / HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    asio::async_write(socket, asio::buffer(all), yield[ec]);
+    ASSERT_FALSE(ec) << ec.message();
+
+    for (int i = 0; i < 3; i++)
+    {
+      http::response<http::string_body> res;
+      http::async_read(socket, buffer, res, yield[ec]);
+      ASSERT_FALSE(ec) << ec.message();
+      responses.emplace_back(res.result_int(), res.body());
+    }
+    done = true;
+  });
+  while (!done && m_context.run_for(20ms) > 0)
+    ;
+
+  ASSERT_TRUE(done);
+  ASSERT_EQ(3, responses.size());
+  EXPECT_EQ(make_pair(200, "Probe dev1"s), responses[0]);
+  EXPECT_EQ(make_pair(200, "Probe dev2"s), responses[1]);
+  EXPECT_EQ(101, responses[2].first);
+}
+
+TEST_F(RestServiceTest, should_multiplex_requests_on_a_websocket)
+{
+  namespace websocket = beast::websocket;
+
+  auto probe = [&](SessionPtr session, RequestPtr request) -> bool {
+    auto device = get<string>(request->m_parameters.find("device")->second);
+    session->writeResponse(make_unique<Response>(status::ok, "Probe " + device, "text/plain"));
+    return true;
+  };
+  auto sample = [&](SessionPtr session, RequestPtr request) -> bool {
+    auto name = *request->parameter<string>("name");
+    session->beginStreaming("text/plain", [session, name]() {
+      session->writeChunk(name + " 1", [session, name]() {
+        session->writeChunk(name + " 2", [session]() { session->closeStream(); });
+      });
+    });
+    return true;
+  };
+
+  m_server->addRouting({boost::beast::http::verb::get, "/{device}/probe", probe});
+  m_server->addRouting({boost::beast::http::verb::get, "/sample?name={string}", sample});
+
+  start();
+
+  // The status and body of the messages for each request id
+  map<string, vector<pair<string, string>>> messages;
+  bool done = false;
+  asio::spawn(m_context, [&](asio::yield_context yield) {
+    beast::error_code ec;
+    websocket::stream<tcp::socket> ws(m_context);
+    ws.next_layer().async_connect(
+        tcp::endpoint(asio::ip::make_address("127.0.0.1"), m_server->getPort()), yield[ec]);
+    ASSERT_FALSE(ec) << ec.message();
+    ws.async_handshake("localhost", "/", yield[ec]);
+    ASSERT_FALSE(ec) << ec.message();
+
+    for (string request : {R"({"id": "a", "request": "sample", "name": "A"})",
+                           R"({"id": "b", "request": "sample", "name": "B"})",
+                           R"({"id": "p", "request": "probe", "device": "dev1"})",
+                           R"({"id": "x", "request": "nothing"})"})
+    {
+      ws.async_write(asio::buffer(request), yield[ec]);
+      ASSERT_FALSE(ec) << ec.message();
+    }
+
+    for (int i = 0; i < 8; i++)
+    {
+      beast::flat_buffer buffer;
+      ws.async_read(buffer, yield[ec]);
+      ASSERT_FALSE(ec) << ec.message();
+
+      auto text = beast::buffers_to_string(buffer.data());
+      auto end = text.find("\r\n\r\n");
+      ASSERT_NE(string::npos, end) << text;
+
+      map<string, string> header;
+      vector<string> lines;
+      boost::split(lines, text.substr(0, end), boost::is_any_of("\r\n"), boost::token_compress_on);
+      for (const auto& line : lines)
+      {
+        auto colon = line.find(": ");
+        ASSERT_NE(string::npos, colon) << line;
+        header[line.substr(0, colon)] = line.substr(colon + 2);
+      }
+
+      messages[header["id"]].emplace_back(header["status"], text.substr(end + 4));
+    }
+
+    ws.async_close(websocket::close_code::normal, yield[ec]);
+    done = true;
+  });
+  while (!done && m_context.run_for(20ms) > 0)
+    ;
+
+  ASSERT_TRUE(done);
+  ASSERT_EQ(4, messages.size());
+
+  // Streams start with a status and then send their chunks in order
+  for (auto [id, name] : {pair {"a"s, "A"s}, pair {"b"s, "B"s}})
+  {
+    const auto& stream = messages[id];
+    ASSERT_EQ(3, stream.size());
+    EXPECT_EQ("200", stream[0].first);
+    EXPECT_EQ("", stream[0].second);
+    EXPECT_EQ("", stream[1].first);
+    EXPECT_EQ(name + " 1", stream[1].second);
+    EXPECT_EQ(name + " 2", stream[2].second);
+  }
+
+  ASSERT_EQ(1, messages["p"].size());
+  EXPECT_EQ("200", messages["p"][0].first);
+  EXPECT_EQ("Probe dev1", messages["p"][0].second);
+
+  ASSERT_EQ(1, messages["x"].size());
+  EXPECT_EQ("404", messages["x"][0].first);
+}
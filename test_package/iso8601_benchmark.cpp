@@ -0,0 +1,119 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <chrono>
+#include <date/date.h>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "mtconnect/utilities.hpp"
+#include "mtconnect/utilities/iso8601.hpp"
+
+using namespace std;
+using namespace std::chrono;
+using namespace mtconnect;
+using namespace date::literals;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+/// @brief Measures the ISO 8601 formatter and parser on one core against the date library.
+class Iso8601BenchmarkTest : public testing::Test
+{
+protected:
+  /// @brief The date library formatting used before the fast formatter
+  static string dateFormat(const Timestamp &ts)
+  {
+    string time = date::format("%FT%T", date::floor<Microseconds>(ts));
+    auto pos = time.find_last_not_of("0");
+    if (pos != string::npos)
+    {
+      if (time[pos] != '.')
+        pos++;
+      time.erase(pos);
+    }
+    time.append("Z");
+    return time;
+  }
+
+  /// @brief The date library parsing used before the fast parser
+  static Timestamp dateParse(const string &text)
+  {
+    Timestamp ts;
+    istringstream in(text);
+    in >> std::setw(6) >> date::parse("%FT%T", ts);
+    return ts;
+  }
+
+  const Timestamp m_base {date::sys_days(2021_y / jan / 19_d) + 10h + 1min};
+};
+
+TEST_F(Iso8601BenchmarkTest, should_format_and_parse_on_one_core)
+{
+  constexpr int count = 20000000;
+  constexpr int dateCount = count / 100;
+
+  char buffer[ISO_8601_BUFFER_SIZE];
+  size_t total = 0;
+  auto start = steady_clock::now();
+  for (int i = 0; i < count; i++)
+  {
+    auto end = formatIso8601(m_base + microseconds(i * 7), buffer);
+    total += end - buffer;
+  }
+  auto formatTime = duration<double>(steady_clock::now() - start).count();
+
+  start = steady_clock::now();
+  for (int i = 0; i < dateCount; i++)
+    total += dateFormat(m_base + microseconds(i * 7)).size();
+  auto dateFormatTime = duration<double>(steady_clock::now() - start).count();
+
+  string text = formatIso8601(m_base + 123456us);
+  Timestamp sum {};
+  start = steady_clock::now();
+  for (int i = 0; i < count; i++)
+  {
+    text[18] = char('0' + i % 10);
+    sum += parseIso8601(text)->time_since_epoch() / count;
+  }
+  auto parseTime = duration<double>(steady_clock::now() - start).count();
+
+  start = steady_clock::now();
+  for (int i = 0; i < dateCount; i++)
+  {
+    text[18] = char('0' + i % 10);
+    sum += dateParse(text).time_since_epoch() / count;
+  }
+  auto dateParseTime = duration<double>(steady_clock::now() - start).count();
+
+  cout << "Format: " << int64_t(count / formatTime) << "/s, date library "
+       << int64_t(dateCount / dateFormatTime) << "/s" << endl;
+  cout << "Parse:  " << int64_t(count / parseTime) << "/s, date library "
+       << int64_t(dateCount / dateParseTime) << "/s" << endl;
+
+  ASSERT_LT(0, total);
+  ASSERT_LT(Timestamp {}, sum);
+}
@@ -0,0 +1,112 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <chrono>
+#include <date/date.h>
+#include <sstream>
+
+#include "mtconnect/utilities.hpp"
+#include "mtconnect/utilities/iso8601.hpp"
+
+using namespace std;
+using namespace std::chrono;
+using namespace mtconnect;
+using namespace date::literals;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+/// @brief The date library formatting used before the fast formatter
+static string dateFormat(const Timestamp &ts)
+{
+  string time = date::format("%FT%T", date::floor<Microseconds>(ts));
+  auto pos = time.find_last_not_of("0");
+  if (pos != string::npos)
+  {
+    if (time[pos] != '.')
+      pos++;
+    time.erase(pos);
+  }
+  time.append("Z");
+  return time;
+}
+
+/// @brief The date library parsing used before the fast parser
+static Timestamp dateParse(const string &text)
+{
+  Timestamp ts;
+  istringstream in(text);
+  in >> std::setw(6) >> date::parse("%FT%T", ts);
+  return ts;
+}
+
+TEST(Iso8601Test, should_format_the_same_as_the_date_library)
+{
+  Timestamp base = date::sys_days(2021_y / jan / 19_d) + 10h + 1min;
+  ASSERT_EQ("2021-01-19T10:01:00Z", formatIso8601(base));
+  ASSERT_EQ("2021-01-19T10:01:00.1Z", formatIso8601(base + 100ms));
+  ASSERT_EQ("2021-01-19T10:01:00.12345Z", formatIso8601(base + 123450us));
+  ASSERT_EQ("2021-01-19T10:01:00.000001Z", formatIso8601(base + 1us + 999ns));
+  ASSERT_EQ("2021-01-19T10:01:00Z", formatIso8601(base + 123450us, false));
+
+  // Leap days, year boundaries, and the epoch
+  for (Timestamp ts : {Timestamp(date::sys_days(2020_y / feb / 29_d) + 23h + 59min + 59s),
+                       Timestamp(date::sys_days(2000_y / dec / 31_d) + 23h + 59min + 59s),
+                       Timestamp(date::sys_days(1970_y / jan / 1_d)),
+                       Timestamp(date::sys_days(1969_y / dec / 31_d) + 12h + 500ms),
+                       Timestamp(date::sys_days(2100_y / mar / 1_d) + 1h + 2min + 3s + 4us)})
+  {
+    ASSERT_EQ(dateFormat(ts), formatIso8601(ts));
+  }
+
+  // Every second of a day, crossing the cached second
+  for (auto ts = base; ts < base + 24h; ts += 997ms)
+    ASSERT_EQ(dateFormat(ts), format(ts));
+}
+
+TEST(Iso8601Test, should_parse_the_same_as_the_date_library)
+{
+  for (auto text : {"2021-01-19T10:01:00Z", "2021-01-19T10:01:00.12345Z",
+                    "2021-01-19T10:01:00.123456Z", "2020-02-29T23:59:59.5Z",
+                    "1970-01-01T00:00:00Z", "2012-11-29T05:01:36.666666",
+                    "2021-01-19T12:00:00.12345Z@100.0"})
+  {
+    auto ts = parseIso8601(text);
+    ASSERT_TRUE(ts) << text;
+    ASSERT_EQ(dateParse(text), *ts) << text;
+  }
+
+  ASSERT_EQ("2021-01-19T12:00:00.12345Z", format(*parseIso8601("2021-01-19T12:00:00.12345Z")));
+}
+
+TEST(Iso8601Test, should_not_parse_invalid_timestamps)
+{
+  for (auto text : {"", "2021-01-19", "2021-01-19 10:01:00Z", "2021-1-19T10:01:00Z",
+                    "2021-13-19T10:01:00Z", "2021-02-29T10:01:00Z", "2021-01-19T24:01:00Z",
+                    "2021-01-19T10:60:00Z", "2021-01-19T10:01:0xZ", "2021-01-19T10:01:00.Z"})
+  {
+    ASSERT_FALSE(parseIso8601(text)) << text;
+  }
+}
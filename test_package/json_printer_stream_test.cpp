@@ -96,6 +96,7 @@ protected:
     ASSERT_EQ(0, errors.size());
 
     event->setSequence(sequence);
+    m_indexes.assign(*d);
     checkpoint.addObservation(event);
   }
 
@@ -121,6 +122,7 @@ protected:
   std::unique_ptr<parser::XmlParser> m_config;
   std::unique_ptr<printer::XmlPrinter> m_xmlPrinter;
   std::list<DevicePtr> m_devices;
+  DataItemIndexes m_indexes;
 };
 
 Properties operator"" _value(unsigned long long value)
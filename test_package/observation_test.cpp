@@ -132,18 +132,40 @@ inline ConditionPtr Cond(ObservationPtr ptr) { return dynamic_pointer_cast<Condi
 TEST_F(ObservationTest, GetAttributes)
 {
   ASSERT_EQ("1", m_compEventA->get<string>("dataItemId"));
-  ASSERT_EQ(m_time, m_compEventA->get<Timestamp>("timestamp"));
+  ASSERT_EQ(m_time, m_compEventA->getTimestamp());
   ASSERT_FALSE(m_compEventA->hasProperty("subType"));
   ASSERT_EQ("DataItemTest1", m_compEventA->get<string>("name"));
-  ASSERT_EQ(2, m_compEventA->get<int64_t>("sequence"));
+  ASSERT_EQ(2, m_compEventA->getSequence());
 
   ASSERT_EQ("Test", m_compEventA->getValue<string>());
 
   ASSERT_EQ("3", m_compEventB->get<string>("dataItemId"));
-  ASSERT_EQ(m_time + 10min, m_compEventB->get<Timestamp>("timestamp"));
+  ASSERT_EQ(m_time + 10min, m_compEventB->getTimestamp());
   ASSERT_EQ("ACTUAL", m_compEventB->get<string>("subType"));
   ASSERT_EQ("DataItemTest2", m_compEventB->get<string>("name"));
-  ASSERT_EQ(4, m_compEventB->get<int64_t>("sequence"));
+  ASSERT_EQ(4, m_compEventB->getSequence());
+}
+
+TEST_F(ObservationTest, should_share_data_item_properties)
+{
+  const auto &props = m_compEventB->getProperties();
+  ASSERT_EQ(1, props.size());
+  ASSERT_EQ(1, props.count("VALUE"));
+
+  Properties scratch;
+  const auto &all = m_compEventB->getAllProperties(scratch);
+  ASSERT_EQ(6, all.size());
+  ASSERT_EQ("3", get<string>(all.at("dataItemId")));
+  ASSERT_EQ("DataItemTest2", get<string>(all.at("name")));
+  ASSERT_EQ("ACTUAL", get<string>(all.at("subType")));
+  ASSERT_EQ(m_time + 10min, get<Timestamp>(all.at("timestamp")));
+  ASSERT_EQ(4, get<int64_t>(all.at("sequence")));
+  ASSERT_EQ(1.1231, get<double>(all.at("VALUE")));
+
+  ErrorList errors;
+  auto unsequenced = Observation::make(m_dataItem1, {{"VALUE", "Test"s}}, m_time, errors);
+  ASSERT_FALSE(unsequenced->hasProperty("sequence"));
+  ASSERT_EQ(0, unsequenced->getAllProperties(scratch).count("sequence"));
 }
 
 TEST_F(ObservationTest, Getters)
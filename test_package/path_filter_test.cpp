@@ -0,0 +1,177 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <memory>
+#include <string>
+
+#include "mtconnect/device_model/device.hpp"
+#include "mtconnect/device_model/path_filter.hpp"
+#include "mtconnect/parser/xml_parser.hpp"
+#include "mtconnect/printer/xml_printer.hpp"
+#include "test_utilities.hpp"
+
+using namespace std;
+using namespace mtconnect;
+using namespace device_model;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+/// @brief Compares the path filter with the libxml2 XPath evaluation in the XML parser
+class PathFilterTest : public testing::Test
+{
+protected:
+  void SetUp() override { load("test_config.xml"); }
+
+  void TearDown() override
+  {
+    m_devices.clear();
+    m_parser.reset();
+    m_printer.reset();
+  }
+
+  void load(const string &file)
+  {
+    m_printer = make_unique<printer::XmlPrinter>();
+    m_parser = make_unique<parser::XmlParser>();
+    m_devices =
+        m_parser->parseFile(string(TEST_RESOURCE_DIR "/samples/") + file, m_printer.get());
+  }
+
+  FilterSet native(const string &path)
+  {
+    auto filter = PathFilter::compile(path);
+    EXPECT_TRUE(filter) << path;
+    FilterSet set;
+    if (filter)
+      filter->getDataItems(m_devices, set);
+    return set;
+  }
+
+  FilterSet libxml(const string &path)
+  {
+    FilterSet set;
+    m_parser->getDataItems(set, path);
+    return set;
+  }
+
+  unique_ptr<printer::XmlPrinter> m_printer;
+  unique_ptr<parser::XmlParser> m_parser;
+  list<DevicePtr> m_devices;
+};
+
+TEST_F(PathFilterTest, should_select_the_same_data_items_as_libxml2)
+{
+  for (auto path : {"//Linear", "//Linear//DataItem[@category='CONDITION']",
+                    "//Controller/electric/*", "//Device/DataItems", "//Devices/Device",
+                    R"(//Rotary[@name="C"]//DataItem[@type="LOAD"])",
+                    R"(//Rotary[@name="C"]//DataItem[@category="CONDITION" or @category="SAMPLE"])",
+                    "//Rotary[@name='C']//DataItem[@category='SAMPLE' or @category='CONDITION']",
+                    "//DataItem[@type='POSITION' and @subType='ACTUAL']",
+                    "//DataItem[(@type='POSITION' or @type='LOAD') and @subType]",
+                    "//DataItem[@category!='EVENT']", "//Axes//DataItem[@type='POSITION']",
+                    "//Power", "//Axes/Components/*", "//*[@id='path']", "//DataItem[@name]",
+                    "//Devices/Device[@uuid=\"000\"]//Axes|//Devices/Device[@uuid=\"000\"]//Power",
+                    "/MTConnectDevices/Devices/Device/Components/Axes",
+                    "Devices/Device//Controller", "//DataItem[@id='Xact']", "//Nothing",
+                    "//DataItem[ @type = 'EXECUTION' ]"})
+  {
+    auto expected = libxml(path);
+    ASSERT_EQ(expected, native(path)) << path;
+  }
+
+  ASSERT_EQ(13, native("//Linear").size());
+  ASSERT_EQ(3, native("//Linear//DataItem[@category='CONDITION']").size());
+  ASSERT_EQ(2, native("//Device/DataItems").size());
+}
+
+TEST_F(PathFilterTest, should_follow_references_the_same_as_libxml2)
+{
+  load("reference_example.xml");
+
+  for (auto path : {"//BarFeederInterface", "//DataItemRef[@name='chuck']", "//ComponentRef",
+                    "//Door", "//*[@id='d']"})
+  {
+    auto expected = libxml(path);
+    ASSERT_FALSE(expected.empty()) << path;
+    ASSERT_EQ(expected, native(path)) << path;
+  }
+
+  // References only selects the data items below its children
+  ASSERT_EQ(libxml("//BarFeederInterface/References"),
+            native("//BarFeederInterface/References"));
+}
+
+TEST_F(PathFilterTest, should_not_compile_unsupported_paths)
+{
+  for (auto path : {"", "//////Linear", "//Axes?//Linear", "//Device/DataItems/",
+                    "//Devices/Device[@name=\"I_DON'T_EXIST\"", "//Device//x:Pump",
+                    "//DataItem[1]", "//DataItem[contains(@type, 'POS')]", "//Linear/..",
+                    "//DataItem[@nativeScale=1]", "//DataItem/@id"})
+  {
+    ASSERT_FALSE(PathFilter::compile(path)) << path;
+  }
+}
+
+TEST_F(PathFilterTest, should_cache_results_until_the_model_changes)
+{
+  PathFilterCache cache;
+  cache.modelChanged(m_devices);
+  ASSERT_EQ(1, cache.getModelVersion());
+
+  FilterSet filter;
+  ASSERT_TRUE(cache.getDataItems("//Linear", filter));
+  ASSERT_EQ(13, filter.size());
+
+  filter.clear();
+  ASSERT_TRUE(cache.getDataItems("//Linear", filter));
+  ASSERT_EQ(13, filter.size());
+
+  filter.clear();
+  ASSERT_FALSE(cache.getDataItems("//Device//x:Pump", filter));
+  ASSERT_TRUE(filter.empty());
+
+  cache.modelChanged({});
+  ASSERT_EQ(2, cache.getModelVersion());
+  ASSERT_TRUE(cache.getDataItems("//Linear", filter));
+  ASSERT_TRUE(filter.empty());
+}
+
+TEST_F(PathFilterTest, should_select_the_same_cached_data_items_as_libxml2)
+{
+  const string path = "//Axes//DataItem[@type='POSITION' or @category='CONDITION']";
+  auto expected = libxml(path);
+  ASSERT_FALSE(expected.empty());
+  ASSERT_EQ(expected, native(path));
+
+  PathFilterCache cache;
+  cache.modelChanged(m_devices);
+  for (int i = 0; i < 2; i++)
+  {
+    FilterSet filter;
+    ASSERT_TRUE(cache.getDataItems(path, filter));
+    ASSERT_EQ(expected, filter);
+  }
+}
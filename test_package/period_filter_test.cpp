@@ -21,6 +21,7 @@
 
 #include <chrono>
 
+#include "mtconnect/buffer/data_item_indexes.hpp"
 #include "mtconnect/observation/observation.hpp"
 #include "mtconnect/pipeline/deliver.hpp"
 #include "mtconnect/pipeline/delta_filter.hpp"
@@ -111,6 +112,7 @@ protected:
     auto di = DataItem::make(attributes, errors);
     m_dataItems.emplace(di->getId(), di);
     m_component->addDataItem(di, errors);
+    m_indexes.assign(*di);
 
     return di;
   }
@@ -157,6 +159,7 @@ protected:
 
   shared_ptr<ShdrTokenMapper> m_mapper;
   std::map<string, DataItemPtr> m_dataItems;
+  buffer::DataItemIndexes m_indexes;
   ComponentPtr m_component;
   shared_ptr<PipelineContext> m_context;
   boost::asio::io_context m_ioContext;
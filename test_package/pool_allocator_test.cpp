@@ -0,0 +1,174 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+#include "mtconnect/buffer/circular_buffer.hpp"
+#include "mtconnect/device_model/device.hpp"
+#include "mtconnect/entity/pool_allocator.hpp"
+#include "mtconnect/pipeline/shdr_tokenizer.hpp"
+
+using namespace std;
+using namespace mtconnect;
+using namespace mtconnect::buffer;
+using namespace mtconnect::observation;
+using namespace mtconnect::pipeline;
+using namespace device_model;
+using namespace entity;
+using namespace data_item;
+using namespace std::literals;
+using namespace date::literals;
+
+// Count the heap allocations made by the test
+static atomic_uint64_t s_heapAllocations {0};
+
+void *operator new(size_t size)
+{
+  s_heapAllocations.fetch_add(1, memory_order_relaxed);
+  if (auto p = malloc(size == 0 ? 1 : size))
+    return p;
+  throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+/// @brief Counts the heap allocations on the ingest path with and without the block pools
+class PoolAllocatorTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    ErrorList errors;
+    Properties d1 {{"id", "d"s}, {"name", "d"s}, {"uuid", "d"s}};
+    m_device = dynamic_pointer_cast<Device>(Device::getFactory()->make("Device", d1, errors));
+    m_comp = Component::make("Axes", {{"id", "a"s}, {"name", "Axes"s}}, errors);
+    m_device->addChild(m_comp, errors);
+
+    for (int i = 0; i < 16; i++)
+    {
+      auto id = "x"s + to_string(i);
+      auto di = DataItem::make({{"id", id},
+                                {"type", "POSITION"s},
+                                {"category", "SAMPLE"s},
+                                {"units", "MILLIMETER"s}},
+                               errors);
+      m_comp->addDataItem(di, errors);
+      m_dataItems.push_back(di);
+    }
+    ASSERT_TRUE(errors.empty());
+  }
+
+  void TearDown() override
+  {
+    m_dataItems.clear();
+    m_comp.reset();
+    m_device.reset();
+  }
+
+  template <typename F>
+  static uint64_t countAllocations(F f)
+  {
+    auto allocations = s_heapAllocations.load();
+    f();
+    return s_heapAllocations.load() - allocations;
+  }
+
+  DevicePtr m_device;
+  ComponentPtr m_comp;
+  vector<DataItemPtr> m_dataItems;
+};
+
+TEST_F(PoolAllocatorTest, should_recycle_blocks_between_threads)
+{
+  struct Block
+  {
+    char m_data[100];
+  };
+
+  vector<shared_ptr<Block>> blocks;
+  for (int i = 0; i < 1000; i++)
+    blocks.emplace_back(MakePooled<Block>());
+  auto slabs = BlockPool::forSize(sizeof(Block)).getStatistics().m_slabs;
+
+  // Release on another thread, like the buffer evicting observations made by an adapter
+  thread([&blocks]() { blocks.clear(); }).join();
+
+  for (int i = 0; i < 1000; i++)
+    blocks.emplace_back(MakePooled<Block>());
+  EXPECT_EQ(slabs, BlockPool::forSize(sizeof(Block)).getStatistics().m_slabs);
+}
+
+TEST_F(PoolAllocatorTest, should_allocate_tokens_from_the_pool)
+{
+  constexpr int count = 100000;
+
+  auto heap = countAllocations([]() {
+    for (int i = 0; i < count; i++)
+      auto tokens = make_shared<Tokens>("Tokens", Properties {});
+  });
+  auto pooled = countAllocations([]() {
+    for (int i = 0; i < count; i++)
+      auto tokens = MakePooled<Tokens>("Tokens", Properties {});
+  });
+
+  EXPECT_LE(count, heap);
+  EXPECT_GT(count / 100, pooled);
+}
+
+TEST_F(PoolAllocatorTest, should_reuse_observation_blocks_after_eviction)
+{
+  constexpr int count = 100000;
+  CircularBuffer buffer(12, 1000);
+  buffer.getDataItemIndexes().assign(*m_device);
+
+  ErrorList errors;
+  Timestamp time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 1min;
+  auto add = [&](int from, int to) {
+    for (int i = from; i < to; i++)
+    {
+      auto di = m_dataItems[i % m_dataItems.size()];
+      buffer.addToBuffer(
+          Observation::make(di, {{"VALUE", double(i)}}, time + chrono::microseconds(i), errors));
+    }
+  };
+
+  // Fill the buffer so the following observations each evict one
+  add(0, 2 * buffer.getBufferSize());
+  auto before = BlockPool::totals();
+  add(0, count);
+  auto after = BlockPool::totals();
+
+  EXPECT_TRUE(errors.empty());
+  EXPECT_LE(after.m_allocations - before.m_allocations, uint64_t(count));
+  EXPECT_EQ(before.m_slabs, after.m_slabs);
+}
@@ -0,0 +1,144 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "mtconnect/sink/rest_sink/probe_cache.hpp"
+
+using namespace std;
+using namespace mtconnect;
+using namespace mtconnect::sink::rest_sink;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+class ProbeCacheTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_cache = make_unique<ProbeCache>(64);
+    for (int i = 0; i < 100; i++)
+      m_document += "<Component id=\"c" + to_string(i) + "\"/>";
+  }
+
+  void TearDown() override { m_cache.reset(); }
+
+  unique_ptr<ProbeCache> m_cache;
+  string m_document;
+};
+
+TEST_F(ProbeCacheTest, should_reuse_document_until_the_state_changes)
+{
+  ProbeCache::Key key {nullptr, "", "", false};
+  ProbeCache::State state {1, 0, {}};
+
+  ASSERT_FALSE(m_cache->find(key, state));
+  auto doc = m_cache->insert(key, state, string(m_document));
+  EXPECT_EQ(doc, m_cache->find(key, state));
+
+  ProbeCache::Key pretty {nullptr, "", "", true};
+  EXPECT_FALSE(m_cache->find(pretty, state));
+
+  ProbeCache::State model {2, 0, {}};
+  EXPECT_FALSE(m_cache->find(key, model));
+
+  ProbeCache::State assets {1, 1, {{"CuttingTool", 1}}};
+  EXPECT_FALSE(m_cache->find(key, assets));
+}
+
+TEST_F(ProbeCacheTest, should_select_the_encoding)
+{
+  auto doc = m_cache->insert({nullptr, "", "", false}, {}, string(m_document));
+
+  auto [gzip, gzipEncoding] = doc->encode("deflate, gzip;q=1.0");
+  ASSERT_TRUE(gzipEncoding);
+  EXPECT_EQ("gzip", *gzipEncoding);
+  EXPECT_GT(m_document.size(), gzip->size());
+
+  // Decompress to check the content
+  namespace io = boost::iostreams;
+  istringstream in(*gzip);
+  io::filtering_istream stream;
+  stream.push(io::gzip_decompressor());
+  stream.push(in);
+  ostringstream out;
+  io::copy(stream, out);
+  EXPECT_EQ(m_document, out.str());
+
+  auto [deflate, deflateEncoding] = doc->encode("deflate");
+  ASSERT_TRUE(deflateEncoding);
+  EXPECT_EQ("deflate", *deflateEncoding);
+
+  // Quality values are honored, a refused encoding is never selected
+  auto [refused, refusedEncoding] = doc->encode("gzip;q=0, deflate");
+  ASSERT_TRUE(refusedEncoding);
+  EXPECT_EQ("deflate", *refusedEncoding);
+
+  auto [identity, identityEncoding] = doc->encode("");
+  EXPECT_FALSE(identityEncoding);
+  EXPECT_EQ(m_document, *identity);
+
+  auto small = m_cache->insert({nullptr, "small", "", false}, {}, "<Devices/>");
+  EXPECT_FALSE(small->encode("gzip").second);
+}
+
+TEST_F(ProbeCacheTest, should_match_entity_tags_for_all_encodings)
+{
+  auto doc = m_cache->insert({nullptr, "", "", false}, {}, string(m_document));
+  auto etag = doc->etag(nullopt);
+  auto gzip = doc->etag("gzip"s);
+
+  ASSERT_EQ('"', etag.front());
+  ASSERT_EQ('"', etag.back());
+  EXPECT_NE(etag, gzip);
+
+  EXPECT_TRUE(doc->notModified(etag, ""));
+  EXPECT_TRUE(doc->notModified(gzip, ""));
+  EXPECT_TRUE(doc->notModified("W/" + etag, ""));
+  EXPECT_TRUE(doc->notModified("\"other\", " + gzip, ""));
+  EXPECT_TRUE(doc->notModified("*", ""));
+  EXPECT_FALSE(doc->notModified("\"other\"", ""));
+  EXPECT_FALSE(doc->notModified("", ""));
+}
+
+TEST_F(ProbeCacheTest, should_check_if_modified_since)
+{
+  auto doc = m_cache->insert({nullptr, "", "", false}, {}, string(m_document));
+
+  EXPECT_TRUE(doc->notModified("", doc->lastModified()));
+  EXPECT_TRUE(doc->notModified("", "Fri, 01 Jan 2100 00:00:00 GMT"));
+  EXPECT_FALSE(doc->notModified("", "Thu, 01 Jan 2015 00:00:00 GMT"));
+  EXPECT_FALSE(doc->notModified("", "not a date"));
+
+  // The entity tag takes precedence
+  EXPECT_FALSE(doc->notModified("\"other\"", doc->lastModified()));
+}
@@ -0,0 +1,126 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <regex>
+#include <string>
+
+#include "mtconnect/sink/rest_sink/response.hpp"
+#include "mtconnect/sink/rest_sink/routing.hpp"
+#include "mtconnect/sink/rest_sink/routing_trie.hpp"
+
+using namespace std;
+using namespace mtconnect;
+using namespace mtconnect::sink::rest_sink;
+using verb = boost::beast::http::verb;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+/// @brief Measures dispatching through the routing trie against matching every route with a
+///        regular expression.
+class RoutingBenchmarkTest : public testing::Test
+{
+protected:
+  const Routing::Function m_func {[](SessionPtr, const RequestPtr) { return true; }};
+};
+
+TEST_F(RoutingBenchmarkTest, should_dispatch_with_the_trie_and_regular_expressions)
+{
+  const string qp = "?pretty={bool:false}&format={string}";
+  const vector<string> patterns {"/probe",
+                                 "/{device}/probe",
+                                 "/assets",
+                                 "/asset",
+                                 "/{device}/assets",
+                                 "/{device}/asset",
+                                 "/assets/{assetIds}",
+                                 "/asset/{assetIds}",
+                                 "/current",
+                                 "/{device}/current",
+                                 "/sample",
+                                 "/{device}/sample",
+                                 "/{device}/asset/{assetId}",
+                                 "/",
+                                 "/{device}"};
+
+  list<Routing> routings;
+  RoutingTrie trie;
+  vector<regex> expressions;
+  for (const auto &p : patterns)
+  {
+    trie.add(routings.emplace_back(verb::get, p + qp, m_func));
+    expressions.emplace_back(regex_replace(p, regex("\\{[^}]+\\}"), "([^/]+)") + "/?");
+  }
+
+  const vector<string> paths {"/current", "/ABC123/sample", "/probe", "/ABC123", "/asset/A1"};
+  constexpr int count = 20000;
+
+  RequestPtr request = make_shared<Request>();
+  request->m_verb = verb::get;
+
+  size_t matched = 0;
+  auto start = chrono::steady_clock::now();
+  for (int i = 0; i < count; i++)
+  {
+    request->m_path = paths[i % paths.size()];
+    for (auto &e : expressions)
+    {
+      smatch m;
+      if (regex_match(request->m_path, m, e))
+      {
+        matched++;
+        break;
+      }
+    }
+  }
+  auto linear = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  PathSegments segments;
+  RoutingTrie::EntryList candidates;
+  start = chrono::steady_clock::now();
+  for (int i = 0; i < count; i++)
+  {
+    request->m_path = paths[i % paths.size()];
+    Routing::splitPath(request->m_path, segments);
+    trie.find(request->m_verb, segments, candidates);
+    for (auto &c : candidates)
+    {
+      if (c.m_routing->matches(0, request, segments))
+      {
+        matched++;
+        break;
+      }
+    }
+  }
+  auto compiled = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  cout << "Regex: " << int64_t(count / linear) << " dispatches/s" << endl;
+  cout << "Trie:  " << int64_t(count / compiled) << " dispatches/s" << endl;
+
+  ASSERT_EQ(count * 2, matched);
+}
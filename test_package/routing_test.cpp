@@ -22,12 +22,16 @@
 #include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <optional>
+#include <regex>
 #include <sstream>
 #include <string>
 
 #include "mtconnect/sink/rest_sink/response.hpp"
 #include "mtconnect/sink/rest_sink/routing.hpp"
+#include "mtconnect/sink/rest_sink/routing_trie.hpp"
 
 using namespace std;
 using namespace mtconnect;
@@ -230,3 +234,160 @@ TEST_F(RoutingTest, simple_put_with_trailing_slash)
   ASSERT_TRUE(r.matches(0, request));
   ASSERT_EQ("ADevice", get<string>(request->m_parameters["device"]));
 }
+
+TEST_F(RoutingTest, should_split_paths_into_segments)
+{
+  PathSegments segments;
+  ASSERT_TRUE(Routing::splitPath("/", segments));
+  ASSERT_TRUE(segments.empty());
+
+  ASSERT_TRUE(Routing::splitPath("/ABC123/probe/", segments));
+  ASSERT_EQ(2, segments.size());
+  ASSERT_EQ("ABC123", segments[0]);
+  ASSERT_EQ("probe", segments[1]);
+
+  ASSERT_TRUE(Routing::splitPath("/a//b", segments));
+  ASSERT_EQ(3, segments.size());
+  ASSERT_EQ("", segments[1]);
+
+  ASSERT_FALSE(Routing::splitPath("probe", segments));
+  ASSERT_FALSE(Routing::splitPath("", segments));
+}
+
+TEST_F(RoutingTest, should_compile_mixed_segments_to_a_pattern)
+{
+  Routing simple(verb::get, "/{device}/sample?from={unsigned_integer}", m_func);
+  ASSERT_FALSE(simple.isPattern());
+  ASSERT_EQ(2, simple.getSegments().size());
+  ASSERT_TRUE(simple.getSegments()[0].m_parameter);
+  ASSERT_EQ("sample", simple.getSegments()[1].m_text);
+
+  Routing mixed(verb::get, "/files/{name}.xml", m_func);
+  ASSERT_TRUE(mixed.isPattern());
+  ASSERT_EQ(1, mixed.getPathParameters().size());
+
+  RequestPtr request = make_shared<Request>();
+  request->m_verb = verb::get;
+  request->m_path = "/files/Devices.xml";
+  ASSERT_TRUE(mixed.matches(0, request));
+  ASSERT_EQ("Devices", get<string>(request->m_parameters["name"]));
+}
+
+TEST_F(RoutingTest, should_find_candidates_in_the_order_they_were_added)
+{
+  list<Routing> routings;
+  RoutingTrie trie;
+  auto add = [&](verb v, const string &pattern) {
+    trie.add(routings.emplace_back(v, pattern, m_func));
+  };
+
+  add(verb::get, "/probe");
+  add(verb::get, "/{device}/probe");
+  add(verb::get, "/current");
+  add(verb::get, "/{device}/current");
+  trie.add(routings.emplace_back(verb::get, regex("/.+"), m_func));
+  add(verb::get, "/");
+  add(verb::get, "/{device}");
+  add(verb::put, "/{device}");
+
+  auto find = [&](verb v, const string &path) {
+    PathSegments segments;
+    Routing::splitPath(path, segments);
+    RoutingTrie::EntryList candidates;
+    trie.find(v, segments, candidates);
+    vector<size_t> order;
+    for (auto &c : candidates)
+      order.push_back(c.m_order);
+    return order;
+  };
+
+  ASSERT_EQ((vector<size_t> {0, 4, 6}), find(verb::get, "/probe"));
+  ASSERT_EQ((vector<size_t> {1, 4}), find(verb::get, "/ABC123/probe"));
+  ASSERT_EQ((vector<size_t> {3, 4}), find(verb::get, "/current/current"));
+  ASSERT_EQ((vector<size_t> {2, 4, 6}), find(verb::get, "/current/"));
+  ASSERT_EQ((vector<size_t> {4, 5}), find(verb::get, "/"));
+  ASSERT_EQ((vector<size_t> {4, 6}), find(verb::get, "/ABC123"));
+  ASSERT_EQ((vector<size_t> {7}), find(verb::put, "/ABC123"));
+  ASSERT_EQ((vector<size_t> {4}), find(verb::get, "/ABC123/probe/x"));
+  ASSERT_TRUE(find(verb::delete_, "/probe").empty());
+}
+
+TEST_F(RoutingTest, should_dispatch_the_same_as_regular_expressions)
+{
+  const string qp = "?pretty={bool:false}&format={string}";
+  const vector<string> patterns {"/probe",
+                                 "/{device}/probe",
+                                 "/assets",
+                                 "/asset",
+                                 "/{device}/assets",
+                                 "/{device}/asset",
+                                 "/assets/{assetIds}",
+                                 "/asset/{assetIds}",
+                                 "/current",
+                                 "/{device}/current",
+                                 "/sample",
+                                 "/{device}/sample",
+                                 "/{device}/asset/{assetId}",
+                                 "/",
+                                 "/{device}"};
+
+  list<Routing> routings;
+  RoutingTrie trie;
+  vector<regex> expressions;
+  vector<vector<string>> names;
+  const regex parameter("\\{([^}]+)\\}");
+  for (const auto &p : patterns)
+  {
+    trie.add(routings.emplace_back(verb::get, p + qp, m_func));
+    expressions.emplace_back(regex_replace(p, parameter, "([^/]+)") + "/?");
+    auto &pn = names.emplace_back();
+    for (sregex_iterator it(p.begin(), p.end(), parameter), end; it != end; it++)
+      pn.push_back((*it)[1]);
+  }
+
+  const vector<string> paths {"/current", "/ABC123/sample", "/probe", "/ABC123", "/asset/A1",
+                              "/ABC123/", "/assets/A1;A2", "/", "/ABC123/asset/T1",
+                              "/ABC123/current/", "/ABC123/probe/x", "/current/sample/x"};
+
+  RequestPtr request = make_shared<Request>();
+  request->m_verb = verb::get;
+  PathSegments segments;
+  RoutingTrie::EntryList candidates;
+
+  for (const auto &path : paths)
+  {
+    optional<size_t> expected;
+    map<string, string> expectedParameters;
+    for (size_t i = 0; i < expressions.size(); i++)
+    {
+      smatch m;
+      if (regex_match(path, m, expressions[i]))
+      {
+        expected = i;
+        for (size_t j = 0; j < names[i].size(); j++)
+          expectedParameters[names[i][j]] = m[j + 1];
+        break;
+      }
+    }
+
+    optional<size_t> actual;
+    map<string, string> actualParameters;
+    request->m_path = path;
+    request->m_parameters.clear();
+    ASSERT_TRUE(Routing::splitPath(path, segments)) << path;
+    trie.find(request->m_verb, segments, candidates);
+    for (auto &c : candidates)
+    {
+      if (c.m_routing->matches(0, request, segments))
+      {
+        actual = c.m_order;
+        for (const auto &param : c.m_routing->getPathParameters())
+          actualParameters[param.m_name] = get<string>(request->m_parameters[param.m_name]);
+        break;
+      }
+    }
+
+    ASSERT_EQ(expected, actual) << path;
+    ASSERT_EQ(expectedParameters, actualParameters) << path;
+  }
+}
@@ -71,6 +71,7 @@ protected:
   mtconnect::parser::XmlParser *m_config {nullptr};
   mtconnect::printer::XmlPrinter *m_printer {nullptr};
   std::list<mtconnect::DevicePtr> m_devices;
+  mtconnect::buffer::DataItemIndexes m_indexes;
 
   // Construct a component event and set it as the data item's latest event
   ObservationPtr addEventToCheckpoint(Checkpoint &checkpoint, const char *name, uint64_t sequence,
@@ -99,6 +100,7 @@ ObservationPtr XmlPrinterTest::addEventToCheckpoint(Checkpoint &checkpoint, cons
                                                     uint64_t sequence, const Properties &props)
 {
   auto event = newEvent(name, sequence, props);
+  m_indexes.assign(*event->getDataItem());
   checkpoint.addObservation(event);
   return event;
 }
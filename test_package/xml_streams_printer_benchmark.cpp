@@ -0,0 +1,118 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <chrono>
+
+#include "mtconnect/device_model/device.hpp"
+#include "mtconnect/observation/observation.hpp"
+#include "mtconnect/parser/xml_parser.hpp"
+#include "mtconnect/printer/xml_printer.hpp"
+#include "mtconnect/utilities.hpp"
+#include "test_utilities.hpp"
+
+using namespace std;
+using namespace mtconnect;
+using namespace mtconnect::observation;
+using namespace mtconnect::entity;
+using namespace mtconnect::printer;
+using namespace mtconnect::parser;
+using namespace std::literals;
+using namespace date::literals;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+/// @brief Measures the streams written directly into the document against the streams written
+///        with the libxml2 text writer.
+class XmlStreamsPrinterBenchmarkTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_config = make_unique<XmlParser>();
+    m_fast = make_unique<XmlPrinter>(false);
+    m_fast->setSchemaVersion("2.0");
+    m_libxml = make_unique<XmlPrinter>(false);
+    m_libxml->setSchemaVersion("2.0");
+    m_libxml->setFastStreams(false);
+    m_devices = m_config->parseFile(TEST_RESOURCE_DIR "/samples/test_config.xml", m_fast.get());
+    m_time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 1min + 123456us;
+  }
+
+  void TearDown() override
+  {
+    m_devices.clear();
+    m_config.reset();
+    m_fast.reset();
+    m_libxml.reset();
+  }
+
+  ObservationPtr observe(const char *name, const Properties &props, uint64_t sequence)
+  {
+    const auto dataItem = m_devices.front()->getDeviceDataItem(name);
+    EXPECT_TRUE(dataItem) << "Could not find data item " << name;
+    ErrorList errors;
+    auto o = Observation::make(dataItem, props, m_time + chrono::seconds(sequence), errors);
+    EXPECT_TRUE(errors.empty());
+    o->setSequence(sequence);
+    return o;
+  }
+
+  unique_ptr<XmlParser> m_config;
+  unique_ptr<XmlPrinter> m_fast;
+  unique_ptr<XmlPrinter> m_libxml;
+  list<DevicePtr> m_devices;
+  Timestamp m_time;
+};
+
+TEST_F(XmlStreamsPrinterBenchmarkTest, should_print_samples_with_and_without_libxml2)
+{
+  constexpr int count = 1000;
+  constexpr int documents = 50;
+
+  const char *names[] = {"Xact", "Xcom", "Yact", "Ycom", "Zact", "Zcom", "Sspeed", "Sovr"};
+  ObservationList list;
+  for (int i = 0; i < count; i++)
+    list.emplace_back(observe(names[i % 8], {{"VALUE", double(i) * 1.125}}, i + 1));
+
+  auto run = [&list](XmlPrinter &printer) {
+    size_t size = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < documents; i++)
+    {
+      ObservationList copy(list);
+      size += printer.printSample(123, 131072, count + 1, 1, count, copy).size();
+    }
+    EXPECT_LT(0, size);
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  };
+
+  auto libxml = run(*m_libxml);
+  auto fast = run(*m_fast);
+
+  cout << "libxml2: " << int64_t(count * documents / libxml) << " observations/s" << endl;
+  cout << "Direct:  " << int64_t(count * documents / fast) << " observations/s" << endl;
+  cout << "Speedup: " << libxml / fast << "x" << endl;
+}
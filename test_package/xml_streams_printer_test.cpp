@@ -0,0 +1,189 @@
+//
+// Copyright Copyright 2009-2022, AMT – The Association For Manufacturing Technology (“AMT”)
+// All rights reserved.
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Ensure that gtest is the first header otherwise Windows raises an error
+#include <gtest/gtest.h>
+// Keep this comment to keep gtest.h above. (clang-format off/on is not working here!)
+
+#include <chrono>
+#include <regex>
+
+#include "mtconnect/device_model/device.hpp"
+#include "mtconnect/observation/observation.hpp"
+#include "mtconnect/parser/xml_parser.hpp"
+#include "mtconnect/printer/observation_fragments.hpp"
+#include "mtconnect/printer/xml_printer.hpp"
+#include "mtconnect/utilities.hpp"
+#include "test_utilities.hpp"
+
+using namespace std;
+using namespace mtconnect;
+using namespace mtconnect::observation;
+using namespace mtconnect::entity;
+using namespace mtconnect::printer;
+using namespace mtconnect::parser;
+using namespace std::literals;
+using namespace date::literals;
+
+// main
+int main(int argc, char *argv[])
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+/// @brief Compares the streams written directly into the document with the streams written with
+///        the libxml2 text writer.
+class XmlStreamsPrinterTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_config = make_unique<XmlParser>();
+    m_fast = make_unique<XmlPrinter>(false);
+    m_fast->setSchemaVersion("2.0");
+    m_libxml = make_unique<XmlPrinter>(false);
+    m_libxml->setSchemaVersion("2.0");
+    m_libxml->setFastStreams(false);
+    m_devices = m_config->parseFile(TEST_RESOURCE_DIR "/samples/test_config.xml", m_fast.get());
+    m_time = Timestamp(date::sys_days(2021_y / jan / 19_d)) + 10h + 1min + 123456us;
+  }
+
+  void TearDown() override
+  {
+    m_devices.clear();
+    m_config.reset();
+    m_fast.reset();
+    m_libxml.reset();
+  }
+
+  ObservationPtr observe(const char *name, const Properties &props, uint64_t sequence)
+  {
+    const auto dataItem = m_devices.front()->getDeviceDataItem(name);
+    EXPECT_TRUE(dataItem) << "Could not find data item " << name;
+    ErrorList errors;
+    auto o = Observation::make(dataItem, props, m_time + chrono::seconds(sequence), errors);
+    EXPECT_TRUE(errors.empty());
+    o->setSequence(sequence);
+    return o;
+  }
+
+  /// @brief remove the creation time, the only part of the document that changes between calls
+  static string stripCreationTime(const string &doc)
+  {
+    static regex creationTime("creationTime=\"[^\"]+\"");
+    return regex_replace(doc, creationTime, "creationTime=\"\"");
+  }
+
+  void assertSameDocument(ObservationList &observations)
+  {
+    ObservationList copy(observations);
+    auto fast = m_fast->printSample(123, 131072, 10254805, 10123733, 10123800, observations);
+    auto libxml = m_libxml->printSample(123, 131072, 10254805, 10123733, 10123800, copy);
+    ASSERT_FALSE(libxml.empty());
+    ASSERT_EQ(stripCreationTime(libxml), stripCreationTime(fast));
+  }
+
+  unique_ptr<XmlParser> m_config;
+  unique_ptr<XmlPrinter> m_fast;
+  unique_ptr<XmlPrinter> m_libxml;
+  list<DevicePtr> m_devices;
+  Timestamp m_time;
+};
+
+TEST_F(XmlStreamsPrinterTest, should_print_the_same_samples_and_events)
+{
+  ObservationList list {observe("Xact", {{"VALUE", 0.0}}, 10),
+                        observe("SspeedOvr", {{"VALUE", 100.0}}, 11),
+                        observe("Xcom", {{"VALUE", 1.5}}, 12),
+                        observe("Yact", {{"VALUE", 0.00199}}, 13),
+                        observe("Zact", {{"VALUE", 0.0002}}, 14),
+                        observe("z_motor_temp", {{"VALUE", 44.5}}, 15),
+                        observe("block", {{"VALUE", "x-0.132010 y-0.158143"s}}, 16),
+                        observe("mode", {{"VALUE", "AUTOMATIC"s}}, 17),
+                        observe("line", {{"VALUE", "0"s}}, 18),
+                        observe("program", {{"VALUE", "/home/mtconnect/spiral.ngc"s}}, 19),
+                        observe("execution", {{"VALUE", "READY"s}}, 20),
+                        observe("power", {{"VALUE", "ON"s}}, 21)};
+
+  assertSameDocument(list);
+}
+
+TEST_F(XmlStreamsPrinterTest, should_print_the_same_empty_and_unavailable_streams)
+{
+  ObservationList empty;
+  assertSameDocument(empty);
+
+  auto o = observe("Xact", {{"VALUE", 1.0}}, 10);
+  o->makeUnavailable();
+  ObservationList list {o, observe("block", {{"VALUE", ""s}}, 11)};
+  assertSameDocument(list);
+}
+
+TEST_F(XmlStreamsPrinterTest, should_print_the_same_conditions_and_time_series)
+{
+  ObservationList list {
+      observe("clc", {{"level", "FAULT"s}, {"nativeCode", "1234"s}, {"VALUE", "Overload"s}}, 10),
+      observe("ctmp", {{"level", "NORMAL"s}}, 11),
+      observe("Xts", {{"sampleCount", int64_t(3)}, {"VALUE", "1.1 2.2 3.3"s}}, 12)};
+
+  assertSameDocument(list);
+}
+
+TEST_F(XmlStreamsPrinterTest, should_escape_the_same_as_libxml2)
+{
+  ObservationList list {
+      observe("block", {{"VALUE", "G01 X<1 & Y>2 \"quoted\""s}}, 10),
+      observe("program", {{"VALUE", "Fräsen µm"s}}, 11),
+      observe("clc", {{"level", "FAULT"s}, {"nativeCode", "A&B"s}, {"VALUE", "Gr\xC3\xBC\xC3\x9F"s}},
+              12),
+      observe("line", {{"VALUE", "1\r\n2\t3"s}}, 13)};
+
+  assertSameDocument(list);
+}
+
+TEST_F(XmlStreamsPrinterTest, should_escape_data_item_fragments)
+{
+  Properties props {{"dataItemId", "f1"s}, {"name", "a<b & \"c\""s}, {"type", "LOAD"s}};
+  auto fragments = ObservationFragmentCache::build(props);
+  ASSERT_EQ(3, fragments.size());
+
+  ASSERT_EQ("dataItemId", fragments[0].m_key);
+  ASSERT_EQ(" dataItemId=\"f1\"", fragments[0].m_xml);
+  ASSERT_EQ("\"dataItemId\"", fragments[0].m_jsonKey);
+  ASSERT_EQ("\"f1\"", fragments[0].m_jsonValue);
+
+  ASSERT_EQ("name", fragments[1].m_key);
+  ASSERT_EQ(" name=\"a&lt;b &amp; &quot;c&quot;\"", fragments[1].m_xml);
+  ASSERT_EQ("\"a<b & \\\"c\\\"\"", fragments[1].m_jsonValue);
+
+  ASSERT_EQ("type", fragments[2].m_key);
+  ASSERT_EQ(" type=\"LOAD\"", fragments[2].m_xml);
+}
+
+TEST_F(XmlStreamsPrinterTest, should_rebuild_fragments_when_the_model_changes)
+{
+  ObservationFragmentCache cache;
+  const auto dataItem = m_devices.front()->getDeviceDataItem("block");
+  ASSERT_TRUE(dataItem);
+
+  auto first = cache.get(*dataItem, 1);
+  ASSERT_EQ(first, cache.get(*dataItem, 1));
+  auto second = cache.get(*dataItem, 2);
+  ASSERT_NE(first, second);
+  ASSERT_EQ(first->size(), second->size());
+}